@@ -96,6 +96,18 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define INCLUDE_xTimerGetTimerDaemonTaskHandle 0
 #endif
 
+#ifndef INCLUDE_xTimerPendFunctionCall
+	#define INCLUDE_xTimerPendFunctionCall 0
+#endif
+
+#ifndef configUSE_QUEUE_SETS
+	#define configUSE_QUEUE_SETS 0
+#endif
+
+#ifndef configUSE_TRACE_RECORDER
+	#define configUSE_TRACE_RECORDER 0
+#endif
+
 #ifndef INCLUDE_pcTaskGetTaskName
 	#define INCLUDE_pcTaskGetTaskName 0
 #endif
@@ -173,6 +185,42 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 
 #endif /* configUSE_TIMERS */
 
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configUSE_LOCK_PROFILER
+	#define configUSE_LOCK_PROFILER 0
+#endif
+
+#ifndef configLOCK_PROFILER_SIZE
+	#define configLOCK_PROFILER_SIZE 8
+#endif
+
+#ifndef configUSE_PERIODIC_TASKS
+	#define configUSE_PERIODIC_TASKS 0
+#endif
+
+#ifndef configUSE_DEADLINE_MISSED_HOOK
+	#define configUSE_DEADLINE_MISSED_HOOK 0
+#endif
+
+#ifndef configINITIAL_TICK_COUNT
+	#define configINITIAL_TICK_COUNT 0
+#endif
+
+#ifndef configUSE_MPU_STACK_GUARD
+	#define configUSE_MPU_STACK_GUARD 0
+#endif
+
+#ifndef configUSE_EDF_SCHEDULER
+	#define configUSE_EDF_SCHEDULER 0
+#endif
+
+#ifndef configEDF_PRIORITY
+	#define configEDF_PRIORITY ( configMAX_PRIORITIES - 2 )
+#endif
+
 #ifndef INCLUDE_xTaskGetSchedulerState
 	#define INCLUDE_xTaskGetSchedulerState 0
 #endif
@@ -190,6 +238,14 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue ) ( void ) uxSavedStatusValue
 #endif
 
+#ifndef portRAISE_INTERRUPT_MASK
+	#define portRAISE_INTERRUPT_MASK() portSET_INTERRUPT_MASK_FROM_ISR()
+#endif
+
+#ifndef portRESTORE_INTERRUPT_MASK
+	#define portRESTORE_INTERRUPT_MASK( uxSavedStatusValue ) portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue )
+#endif
+
 #ifndef portCLEAN_UP_TCB
 	#define portCLEAN_UP_TCB( pxTCB ) ( void ) pxTCB
 #endif
@@ -411,6 +467,64 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )
 #endif
 
+#ifndef tracePEND_FUNC_CALL
+	#define tracePEND_FUNC_CALL( xFunctionToPend, pvParameter1, ulParameter2, xReturn )
+#endif
+
+#ifndef tracePEND_FUNC_CALL_FROM_ISR
+	#define tracePEND_FUNC_CALL_FROM_ISR( xFunctionToPend, pvParameter1, ulParameter2, xReturn )
+#endif
+
+#ifndef traceEVENT_GROUP_CREATE
+	#define traceEVENT_GROUP_CREATE( xEventGroup )
+#endif
+
+#ifndef traceEVENT_GROUP_CREATE_FAILED
+	#define traceEVENT_GROUP_CREATE_FAILED()
+#endif
+
+#ifndef traceEVENT_GROUP_SYNC_BLOCK
+	#define traceEVENT_GROUP_SYNC_BLOCK( xEventGroup, uxBitsToSet, uxBitsToWaitFor )
+#endif
+
+#ifndef traceEVENT_GROUP_SYNC_END
+	#define traceEVENT_GROUP_SYNC_END( xEventGroup, uxBitsToSet, uxBitsToWaitFor, xTimeoutOccurred ) ( void ) xTimeoutOccurred
+#endif
+
+#ifndef traceEVENT_GROUP_WAIT_BITS_BLOCK
+	#define traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor )
+#endif
+
+#ifndef traceEVENT_GROUP_WAIT_BITS_END
+	#define traceEVENT_GROUP_WAIT_BITS_END( xEventGroup, uxBitsToWaitFor, xTimeoutOccurred ) ( void ) xTimeoutOccurred
+#endif
+
+#ifndef traceEVENT_GROUP_CLEAR_BITS
+	#define traceEVENT_GROUP_CLEAR_BITS( xEventGroup, uxBitsToClear )
+#endif
+
+#ifndef traceEVENT_GROUP_SET_BITS
+	#define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet )
+#endif
+
+#ifndef traceEVENT_GROUP_DELETE
+	#define traceEVENT_GROUP_DELETE( xEventGroup )
+#endif
+
+#ifndef traceQUEUE_SET_SEND
+	#define traceQUEUE_SET_SEND traceQUEUE_SEND
+#endif
+
+#ifndef traceISR_ENTER
+	/* Called by interrupt handlers on entry, with their IRQ number. */
+	#define traceISR_ENTER( ucIRQ )
+#endif
+
+#ifndef traceISR_EXIT
+	/* Called by interrupt handlers just before they return. */
+	#define traceISR_EXIT( ucIRQ )
+#endif
+
 #ifndef configGENERATE_RUN_TIME_STATS
 	#define configGENERATE_RUN_TIME_STATS 0
 #endif
@@ -429,6 +543,22 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 
 #endif /* configGENERATE_RUN_TIME_STATS */
 
+#if ( configUSE_LOCK_PROFILER == 1 ) && ( configGENERATE_RUN_TIME_STATS == 0 )
+	#error configUSE_LOCK_PROFILER times waits and holds with the run time stats counter, so configGENERATE_RUN_TIME_STATS must also be 1.
+#endif
+
+#if ( configUSE_PERIODIC_TASKS == 1 ) && ( configGENERATE_RUN_TIME_STATS == 0 )
+	#error configUSE_PERIODIC_TASKS times each activation with the run time stats counter, so configGENERATE_RUN_TIME_STATS must also be 1.
+#endif
+
+#if ( configUSE_MPU_STACK_GUARD == 1 ) && !defined( portSET_STACK_GUARD )
+	#error configUSE_MPU_STACK_GUARD needs a port that can guard a stack with the MPU, which defines portSET_STACK_GUARD.
+#endif
+
+#if ( configUSE_EDF_SCHEDULER == 1 ) && ( configUSE_PERIODIC_TASKS == 0 )
+	#error configUSE_EDF_SCHEDULER orders tasks by the deadlines of their periodic activations, so configUSE_PERIODIC_TASKS must also be 1.
+#endif
+
 #ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
 	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #endif
@@ -437,6 +567,58 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
 
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 1
+#endif
+
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+#ifndef configSUPPORT_DYNAMIC_ALLOCATION
+	#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#endif
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error At least one of configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION must be 1
+#endif
+
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
+#endif
+
+#ifndef configPRE_SLEEP_PROCESSING
+	#define configPRE_SLEEP_PROCESSING( x )
+#endif
+
+#ifndef configPOST_SLEEP_PROCESSING
+	#define configPOST_SLEEP_PROCESSING( x )
+#endif
+
+#ifndef traceLOW_POWER_IDLE_BEGIN
+	#define traceLOW_POWER_IDLE_BEGIN()
+#endif
+
+#ifndef traceLOW_POWER_IDLE_END
+	#define traceLOW_POWER_IDLE_END()
+#endif
+
 #ifndef portPRIVILEGE_BIT
 	#define portPRIVILEGE_BIT ( ( unsigned portBASE_TYPE ) 0x00 )
 #endif
@@ -453,5 +635,143 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+/*
+ * Memory for kernel objects supplied by the application, for the
+ * xxxCreateStatic() functions.  Each matches the layout of the private
+ * structure in the kernel source file so the size is right, the members are
+ * not for use.  The kernel source fails to compile if the two ever differ in
+ * size.
+ */
+#include "FreeRTOS_List.h"
+
+/*
+ * The timing of a periodic task, see xTaskCreatePeriodicStatic() and
+ * vTaskWaitForNextPeriod() in FreeRTOS_Task.h.  Kept in the task's TCB and
+ * copied out by xTaskGetPeriodicStatus().  Periods and deadlines are in ticks,
+ * budgets, jitter and execution times in run time stats counter ticks.  An
+ * activation runs from one release to the vTaskWaitForNextPeriod() that ends
+ * it, and its execution time is the time the task was running in between, so
+ * time spent blocked or preempted is not counted.
+ */
+typedef struct xPERIODIC_TASK
+{
+	portTickType xPeriod;				/*< Ticks from one release to the next, 0 if the task is not periodic. */
+	portTickType xDeadline;				/*< Ticks after its release an activation must have finished by. */
+	unsigned long ulBudget;				/*< Most an activation is expected to run for, 0 for no limit. */
+	portTickType xRelease;				/*< Tick the current activation was released at. */
+	unsigned long ulReleasedAt;			/*< Run time counter when the current activation was made ready. */
+	unsigned long ulStartRunTime;		/*< The task's run time total when the current activation started. */
+	portBASE_TYPE xWaitingForRelease;	/*< pdTRUE while blocked in vTaskWaitForNextPeriod(). */
+	unsigned long ulActivations;		/*< Activations finished. */
+	unsigned long ulDeadlineMisses;		/*< Activations finished at or after xRelease + xDeadline. */
+	unsigned long ulBudgetOverruns;		/*< Activations that ran for longer than ulBudget. */
+	unsigned long ulJitterTotal;		/*< From being made ready to running, over every activation. */
+	unsigned long ulJitterMax;
+	unsigned long ulExecutionTotal;
+	unsigned long ulExecutionMax;
+	unsigned long ulExecutionLast;
+} xPeriodicTaskType;
+
+typedef struct xSTATIC_TCB
+{
+	void *pxDummy1;
+	#if ( portUSING_MPU_WRAPPERS == 1 )
+		xMPU_SETTINGS xDummy2;
+	#endif
+	xListItem xDummy3[ 2 ];
+	unsigned portBASE_TYPE uxDummy4;
+	void *pxDummy5;
+	signed char ucDummy6[ configMAX_TASK_NAME_LEN ];
+	#if ( portSTACK_GROWTH > 0 )
+		void *pxDummy7;
+	#endif
+	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+		unsigned portBASE_TYPE uxDummy8;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned portBASE_TYPE uxDummy9[ 2 ];
+		unsigned short usDummy16;
+	#endif
+	#if ( configUSE_MUTEXES == 1 )
+		unsigned portBASE_TYPE uxDummy10;
+	#endif
+	#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+		void *pxDummy11;
+	#endif
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		unsigned long ulDummy12;
+	#endif
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		unsigned long ulDummy13;
+		int eDummy14;
+	#endif
+	#if ( configUSE_PERIODIC_TASKS == 1 )
+		xPeriodicTaskType xDummy17;
+	#endif
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		unsigned char ucDummy15;
+	#endif
+} xStaticTaskType;
+
+typedef struct xSTATIC_QUEUE
+{
+	void *pvDummy1[ 4 ];
+	xList xDummy2[ 2 ];
+	unsigned portBASE_TYPE uxDummy3[ 3 ];
+	signed portBASE_TYPE xDummy4[ 2 ];
+	#if ( configUSE_QUEUE_SETS == 1 )
+		void *pvDummy7;
+	#endif
+	#if ( configUSE_LOCK_PROFILER == 1 )
+		void *pvDummy8;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned char ucDummy5[ 2 ];
+	#endif
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		unsigned char ucDummy6;
+	#endif
+} xStaticQueueType;
+
+/*
+ * What the lock profiler has seen of one semaphore or mutex, see
+ * uxQueueGetLockProfile() in FreeRTOS_Queue.h.  Times are in run time stats
+ * counter ticks.  A wait is from the first time a take blocks until it gets
+ * the lock or gives up.  A hold is from a take until the next give, so is
+ * only kept for semaphores with a count of one and only means something for
+ * those used as a lock.  The handles are void * so this can be used without
+ * FreeRTOS_Task.h or FreeRTOS_Queue.h.
+ */
+typedef struct xLOCK_PROFILE
+{
+	void *pvLock;						/*< The semaphore or mutex, NULL if this record is free. */
+	const signed char *pcLockName;		/*< The name it was given in the queue registry, NULL if it has none. */
+	unsigned char ucQueueType;			/*< One of the queueQUEUE_TYPE_ values in FreeRTOS_Queue.h. */
+	void *pvHolder;						/*< The task that has it now, NULL if it is free. */
+	void *pvLongestHolder;				/*< The task that held it for ulHoldMax. */
+	void *pvLongestWaiter;				/*< The task that waited ulWaitMax for it. */
+	unsigned long ulTakes;				/*< Successful takes. */
+	unsigned long ulContentions;		/*< Takes that had to block. */
+	unsigned long ulTimeouts;			/*< Takes that blocked and gave up. */
+	unsigned long ulInversions;			/*< Takes that blocked on a lower priority holder. */
+	unsigned long ulWaitTotal;
+	unsigned long ulWaitMax;
+	unsigned long ulHoldTotal;
+	unsigned long ulHoldMax;
+	unsigned long ulTakenAt;			/*< When pvHolder took it. */
+} xLockProfileType;
+
+typedef struct xSTATIC_TIMER
+{
+	void *pvDummy1;
+	xListItem xDummy2;
+	portTickType xDummy3;
+	unsigned portBASE_TYPE uxDummy4;
+	void *pvDummy5[ 2 ];
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		unsigned char ucDummy6;
+	#endif
+} xStaticTimerType;
+
 #endif /* INC_FREERTOS_H */
 
@@ -15,6 +15,9 @@
 #define FREERTOS_CONFIG_H
 
 #include <stdint.h>
+#ifndef FREERTOS_POSIX_PORT
+	#include "LPC17xx.h"
+#endif
 extern uint32_t SystemCoreClock;
 
 /* Priorities to assign to tasks created by this demo. */
@@ -49,7 +52,13 @@ http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_CLI/ */
 #define configCPU_CLOCK_HZ				( SystemCoreClock )
 #define configTICK_RATE_HZ				( ( portTickType ) 1000 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 90 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 15 * 1024 ) )
+#ifndef FREERTOS_POSIX_PORT
+	#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 4 * 1024 ) )
+#else
+	/* Pointers and stack words are twice the size on a 64 bit host. */
+	#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 64 * 1024 ) )
+	#define configHEAP_FL_INDEX_MAX		( 16 )
+#endif
 #define configMAX_TASK_NAME_LEN			( 12 )
 #define configIDLE_SHOULD_YIELD			0
 #define configQUEUE_REGISTRY_SIZE		10
@@ -61,12 +70,63 @@ http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_CLI/ */
 #define configUSE_COUNTING_SEMAPHORES 	0
 #define configUSE_ALTERNATIVE_API 		0
 #define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_TASK_NOTIFICATIONS	1
+
+/* Queue sets. Lets TuneTask block on the button and end of song semaphores at
+once instead of polling both. Adds one pointer to every queue. */
+#define configUSE_QUEUE_SETS			1
+
+/* Object allocation. The application tasks, semaphores and timer, and the idle
+and timer service tasks, are created from buffers in Main.c so their RAM is
+fixed at link time. Dynamic allocation stays on because the FreeRTOS_IO
+drivers allocate their transfer control structures with pvPortMalloc() and
+KernelBench creates its tasks at run time; the heap above only has to cover
+those. */
+#define configSUPPORT_STATIC_ALLOCATION		1
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+
+/* Ready task selection. 1 keeps a bitmap of the priorities that have ready
+tasks and picks the highest with one CLZ instruction, so a context switch costs
+the same however many priorities sit empty between the task switching out and
+the one switching in. 0 is the generic C scan down the ready lists. Needs
+configMAX_PRIORITIES <= 32. Can be set on the compiler command line to compare
+the two in KernelBench. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#endif
+
+/* Tickless idle. When nothing is ready the idle task stops SysTick until the
+next task is due (at most 0xFFFFFF / (CCLK / 1000) ticks, 167 at 100MHz) and
+sleeps in WFI. Plain sleep only, SLEEPDEEP must stay clear so the peripherals
+and their interrupts keep running. Can be set on the compiler command line
+to compare the power with and without. */
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE				1
+#endif
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP	2
 
 /* Hook function related definitions. */
 #define configUSE_TICK_HOOK				0
 #define configUSE_IDLE_HOOK				0
 #define configUSE_MALLOC_FAILED_HOOK	1
-#define configCHECK_FOR_STACK_OVERFLOW	2
+
+/* Stack overflow detection. On the target the MPU guards the bottom 32 bytes
+of the running task's stack, moved to the next task on every context switch,
+so the write that overflows it takes a MemManage fault straight away and
+vApplicationStackOverflowHook() is called with the task. That replaces the
+pattern check of configCHECK_FOR_STACK_OVERFLOW 2, which compared 16 bytes on
+every switch and only caught an overflow after the fact. The guard is read
+only, so the high water marks can still be read. It starts at the first 32
+byte boundary in the stack, so the stacks in Main.c are aligned to 32 bytes,
+which makes it exactly their bottom 8 words, and are 8 words deeper to make
+up for it (see StackUsage.h). The host port has no MPU and keeps the pattern check. */
+#ifndef FREERTOS_POSIX_PORT
+	#define configUSE_MPU_STACK_GUARD		1
+	#define configCHECK_FOR_STACK_OVERFLOW	0
+#else
+	#define configUSE_MPU_STACK_GUARD		0
+	#define configCHECK_FOR_STACK_OVERFLOW	2
+#endif
 
 
 /* Software timer related definitions. */
@@ -75,10 +135,90 @@ http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_CLI/ */
 #define configTIMER_QUEUE_LENGTH		10
 #define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
 
-/* Run time stats gathering definitions. */
-//#define configGENERATE_RUN_TIME_STATS	0
-//#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() (void*)
-//#define portGET_RUN_TIME_COUNTER_VALUE() (void*)
+/* Keep active timers in a timing wheel rather than a sorted list, so starting,
+stopping and expiring one costs the same however many are running. The wheel
+is 129 list heads, 2.5KB of RAM, and the sorted list is as quick until there
+are a hundred or so active timers (see SimTimers.c), so it is off for the few
+the application has. Can be set on the compiler command line. */
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL		0
+#endif
+
+/* Run time stats gathering definitions. TIMER1 free runs at 1MHz as the
+time base, set up by vConfigureTimerForRunTimeStats() in CpuLoad.c. The
+count wraps after about 71 minutes. */
+#define configGENERATE_RUN_TIME_STATS	1
+#ifndef FREERTOS_POSIX_PORT
+	extern void vConfigureTimerForRunTimeStats( void );
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vConfigureTimerForRunTimeStats()
+	#define portGET_RUN_TIME_COUNTER_VALUE() ( LPC_TIM1->TC )
+#else
+	/* Microseconds of simulated time, see vPortUseVirtualTime(). */
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+	#define portGET_RUN_TIME_COUNTER_VALUE() ulPortGetRunTimeCounterValue()
+#endif
+
+/* Lock profiler. Every semaphore and mutex created gets a record of how often
+it was taken, how often a take had to wait and for how long, how long it was
+held and by whom, read with uxQueueGetLockProfile() or LCK_Report(). Each record
+is 64 bytes and there are only a handful of locks, so it stays on. Locks made
+once the records run out are counted but not profiled. */
+#define configUSE_LOCK_PROFILER			1
+#define configLOCK_PROFILER_SIZE		8
+
+/* Periodic tasks. A task made with xTaskCreatePeriodicStatic() is given its
+period, deadline and run time budget, and the kernel times every activation
+(from its release to the vTaskWaitForNextPeriod() that ends it) for jitter
+and execution time and counts deadline misses and budget overruns, read with
+xTaskGetPeriodicStatus() or RMA_Report(). 60 bytes per task. Set
+configUSE_DEADLINE_MISSED_HOOK to 1 to have vApplicationDeadlineMissedHook()
+called on each miss as well. */
+#define configUSE_PERIODIC_TASKS		1
+
+/* The tick count at start up. The simulator starts it 3000 ticks before it
+wraps, so the longer host runs go across the wrap and SimKernel.c can check
+the EDF order on both sides of it. */
+#ifndef configINITIAL_TICK_COUNT
+	#ifndef FREERTOS_POSIX_PORT
+		#define configINITIAL_TICK_COUNT	0
+	#else
+		#define configINITIAL_TICK_COUNT	( ( portTickType ) 0U - 3000U )
+	#endif
+#endif
+
+/* Earliest deadline first. The tasks at configEDF_PRIORITY are run in order of
+the absolute deadline of their current activation (release plus deadline, see
+above) rather than round robin, so that one priority level is scheduled
+dynamically and the levels above and below it stay fixed. A task at that level
+that isn't periodic goes first, as if it were due now, so nothing that runs for
+long should be put there. Making a task ready at that level is a sorted insert,
+linear in the number of ready tasks there, and picking the next one is the head
+of the list, so a context switch costs no more than before. Two ready
+deadlines are ordered by ( xA - xB ) taken as signed, so the order holds across
+the tick count wrap as long as all pending deadlines are within 2^31 ticks of
+each other. A mutex holder is not given the deadline of the task waiting for
+it, only its priority. Off, so the tasks keep the fixed
+priorities in Main.c; set it to 1 here or on the compiler command line to
+compare the two (see KernelBench.c). */
+#ifndef configUSE_EDF_SCHEDULER
+	#define configUSE_EDF_SCHEDULER		0
+#endif
+#define configEDF_PRIORITY				( 7U )
+
+/* Scheduler trace recorder. Task switches, queue and semaphore operations,
+interrupts and tickless sleeps go into a ring of 8 byte records, timestamped
+by the 1MHz run time stats counter above (TIMER1 keeps counting through the
+idle WFI, which the core cycle counter does not). 1024 records is 8KB of the
+AHB RAM bank, a second or two of normal running. main() starts it with
+vTraceEnable(). */
+#define configUSE_TRACE_RECORDER		1
+#define configTRACE_RECORDER_LENGTH		1024
+#define configTRACE_RECORDER_TIMER_HZ	1000000UL
+#ifndef FREERTOS_POSIX_PORT
+	#define configTRACE_RECORDER_SECTION	__attribute__ ((section(".bss.$RAM2")))
+#else
+	#define configTRACE_RECORDER_SECTION
+#endif
 
 
 /* Set the following definitions to 1 to include the API function, or zero
@@ -92,9 +232,12 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay					1
 #define INCLUDE_uxTaskGetStackHighWaterMark	1
 #define INCLUDE_xTimerGetTimerTaskHandle	0
+#define INCLUDE_xTimerPendFunctionCall		1
 #define INCLUDE_xTaskGetIdleTaskHandle		0
 
-#ifdef DEBUG
+#if defined( FREERTOS_POSIX_PORT )
+	#define configASSERT( x ) if( ( x ) == 0 ) { vPortAssertFailed( __FILE__, __LINE__ ); }
+#elif defined( DEBUG )
 	#define configASSERT( x ) if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }
 #endif
 
@@ -124,7 +267,12 @@ standard names. */
 #define vPortSVCHandler SVCall_Handler
 #define xPortPendSVHandler PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
+#define xPortMemManageHandler MemManage_Handler
+
 
 
+#if configUSE_TRACE_RECORDER == 1
+	#include "FreeRTOS_TraceRecorder.h"
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
@@ -79,6 +79,8 @@ typedef struct xPERIPHREAL_CONTROL
 #define ioctlUSE_CHARACTER_QUEUE_TX			3
 #define ioctlUSE_CHARACTER_QUEUE_RX			4
 #define ioctlUSE_CIRCULAR_BUFFER_RX			5
+#define ioctlUSE_STREAM_BUFFER_TX			6
+#define ioctlUSE_STREAM_BUFFER_RX			7
 
 /* Transfer mode related ioctl() requests. */
 #define ioctlOBTAIN_WRITE_MUTEX				10
@@ -87,6 +89,7 @@ typedef struct xPERIPHREAL_CONTROL
 #define ioctlSET_TX_TIMEOUT					13
 #define ioctlSET_RX_TIMEOUT					14
 #define ioctlCLEAR_RX_BUFFER				15
+#define ioctlSET_RX_TRIGGER_LEVEL			16
 
 /* Generic peripheral ioctl requests. */
 #define ioctlSET_SPEED						100
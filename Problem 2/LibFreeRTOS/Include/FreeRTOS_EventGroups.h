@@ -0,0 +1,470 @@
+/**************************************************************************//**
+ *
+ * @file        EventGroups.h
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef EVENT_GROUPS_H
+#define EVENT_GROUPS_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include EventGroups.h"
+#endif
+
+#include "FreeRTOS_Timers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * MACROS AND DEFINITIONS
+ *----------------------------------------------------------*/
+
+/*
+ * An event group is a collection of bits to which an application can assign a
+ * meaning.  For example, an application may create an event group to convey
+ * the status of various CAN bus related events in which bit 0 might mean "A CAN
+ * message has been received and is ready for processing", bit 1 might mean "The
+ * application has queued a message that is ready for sending onto the CAN
+ * network", and bit 2 might mean "It is time to send a SYNC message onto the
+ * CAN network" etc.  A task can then test the bit values to see which events
+ * are active, and optionally enter the Blocked state to wait for a specified
+ * bit or a group of bits to be active.  To continue the CAN bus example, a CAN
+ * controlling task can enter the Blocked state (and therefore not consume any
+ * processing time) until either bit 0, bit 1 or bit 2 are active, at which time
+ * the bit that was actually active would inform the task which action it had to
+ * take (process a received message, send a message, or send a SYNC).
+ *
+ * The event groups implementation contains intelligence to avoid race
+ * conditions that would otherwise occur were an application to use a simple
+ * variable for the same purpose.  This is particularly important with respect
+ * to when a bit within an event group is to be cleared, and when bits have to
+ * be set and then tested atomically - as is the case where event groups are
+ * used to create a synchronisation point between multiple tasks (a
+ * 'rendezvous').
+ *
+ * Interrupts never walk the list of waiting tasks.  The ...FromISR() functions
+ * defer the work to the timer service task with
+ * xTimerPendFunctionCallFromISR(), so the time the kernel spends with
+ * interrupts masked does not depend on the number of waiting tasks.
+ */
+
+/**
+ * Type by which event groups are referenced.  For example, a call to
+ * xEventGroupCreate() returns an xEventGroupHandle variable that can then
+ * be used as a parameter to other event group functions.
+ */
+typedef void * xEventGroupHandle;
+
+/*
+ * The type that holds event bits always matches portTickType - therefore the
+ * number of bits it holds is set by configUSE_16_BIT_TICKS (16 bits if set to 1,
+ * 32 bits if set to 0.  The top 8 bits are reserved for the kernel, so an event
+ * group holds 8 or 24 bits that the application can use.
+ */
+typedef portTickType xEventBitsType;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+
+	/* Memory for a statically allocated event group.  The members mirror the
+	private xEVENT_BITS structure in FreeRTOS_EventGroups.c so that this can be
+	the same size without exposing it; they are not to be accessed directly. */
+	typedef struct xSTATIC_EVENT_GROUP
+	{
+		portTickType xDummy1;
+		xList xDummy2;
+		#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+			unsigned char ucDummy3;
+		#endif
+	} xStaticEventGroupType;
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
+/**
+ * EventGroups.h
+ *<pre>
+ xEventGroupHandle xEventGroupCreate( void );
+ </pre>
+ *
+ * Create a new event group, taking the memory for it from the FreeRTOS heap.
+ *
+ * @return If the event group was created then a handle to the event group is
+ * returned.  If there was insufficient FreeRTOS heap available to create the
+ * event group then NULL is returned.
+ *
+ * Example usage:
+   <pre>
+	// Declare a variable to hold the created event group.
+	xEventGroupHandle xCreatedEventGroup;
+
+	// Attempt to create the event group.
+	xCreatedEventGroup = xEventGroupCreate();
+
+	// Was the event group created successfully?
+	if( xCreatedEventGroup == NULL )
+	{
+		// The event group was not created because there was insufficient
+		// FreeRTOS heap available.
+	}
+	else
+	{
+		// The event group was created.
+	}
+   </pre>
+ * \defgroup xEventGroupCreate xEventGroupCreate
+ * \ingroup EventGroup
+ */
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+	xEventGroupHandle xEventGroupCreate( void ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * EventGroups.h
+ *<pre>
+ xEventGroupHandle xEventGroupCreateStatic( xStaticEventGroupType *pxEventGroupBuffer );
+ </pre>
+ *
+ * Create a new event group in memory supplied by the application, so nothing
+ * is taken from the heap.
+ *
+ * @param pxEventGroupBuffer Must point to an xStaticEventGroupType that stays
+ * in scope for as long as the event group exists.
+ *
+ * @return A handle to the event group, or NULL if pxEventGroupBuffer was NULL.
+ *
+ * \defgroup xEventGroupCreateStatic xEventGroupCreateStatic
+ * \ingroup EventGroup
+ */
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	xEventGroupHandle xEventGroupCreateStatic( xStaticEventGroupType *pxEventGroupBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * EventGroups.h
+ *<pre>
+	xEventBitsType xEventGroupWaitBits( 	xEventGroupHandle xEventGroup,
+										const xEventBitsType uxBitsToWaitFor,
+										const portBASE_TYPE xClearOnExit,
+										const portBASE_TYPE xWaitForAllBits,
+										portTickType xTicksToWait );
+ </pre>
+ *
+ * [Potentially] block to wait for one or more bits to be set within a
+ * previously created event group.
+ *
+ * This function cannot be called from an interrupt.
+ *
+ * @param xEventGroup The event group in which the bits are being tested.  The
+ * event group must have previously been created using a call to
+ * xEventGroupCreate() or xEventGroupCreateStatic().
+ *
+ * @param uxBitsToWaitFor A bitwise value that indicates the bit or bits to test
+ * inside the event group.  For example, to wait for bit 0 and/or bit 2 set
+ * uxBitsToWaitFor to 0x05.  To wait for bits 0 and/or bit 1 and/or bit 2 set
+ * uxBitsToWaitFor to 0x07.  Etc.  uxBitsToWaitFor must not be set to 0.
+ *
+ * @param xClearOnExit If xClearOnExit is set to pdTRUE then any bits within
+ * uxBitsToWaitFor that are set within the event group will be cleared before
+ * xEventGroupWaitBits() returns if the wait condition was met (if the function
+ * returns for a reason other than a timeout).  If xClearOnExit is set to
+ * pdFALSE then the bits set in the event group are not altered when the call to
+ * xEventGroupWaitBits() returns.
+ *
+ * @param xWaitForAllBits If xWaitForAllBits is set to pdTRUE then
+ * xEventGroupWaitBits() will return when either all the bits in uxBitsToWaitFor
+ * are set or the specified block time expires.  If xWaitForAllBits is set to
+ * pdFALSE then xEventGroupWaitBits() will return when any one of the bits set
+ * in uxBitsToWaitFor is set or the specified block time expires.  The block
+ * time is specified by the xTicksToWait parameter.
+ *
+ * @param xTicksToWait The maximum amount of time (specified in 'ticks') to wait
+ * for one/all (depending on the xWaitForAllBits value) of the bits specified by
+ * uxBitsToWaitFor to become set.
+ *
+ * @return The value of the event group at the time either the bits being waited
+ * for became set, or the block time expired.  Test the return value to know
+ * which bits were set.  If xEventGroupWaitBits() returned because its timeout
+ * expired then not all the bits being waited for will be set.  If
+ * xEventGroupWaitBits() returned because the bits it was waiting for were set
+ * then the returned value is the event group value before any bits were
+ * automatically cleared in the case that xClearOnExit parameter was set to
+ * pdTRUE.
+ *
+ * Example usage:
+   <pre>
+   #define BIT_0	( 1 << 0 )
+   #define BIT_4	( 1 << 4 )
+
+   void aFunction( xEventGroupHandle xEventGroup )
+   {
+   xEventBitsType uxBits;
+   const portTickType xTicksToWait = 100 / portTICK_RATE_MS;
+
+		// Wait a maximum of 100ms for either bit 0 or bit 4 to be set within
+		// the event group.  Clear the bits before exiting.
+		uxBits = xEventGroupWaitBits(
+					xEventGroup,	// The event group being tested.
+					BIT_0 | BIT_4,	// The bits within the event group to wait for.
+					pdTRUE,			// BIT_0 and BIT_4 should be cleared before returning.
+					pdFALSE,		// Don't wait for both bits, either bit will do.
+					xTicksToWait );	// Wait a maximum of 100ms for either bit to be set.
+
+		if( ( uxBits & ( BIT_0 | BIT_4 ) ) == ( BIT_0 | BIT_4 ) )
+		{
+			// xEventGroupWaitBits() returned because both bits were set.
+		}
+		else if( ( uxBits & BIT_0 ) != 0 )
+		{
+			// xEventGroupWaitBits() returned because just BIT_0 was set.
+		}
+		else if( ( uxBits & BIT_4 ) != 0 )
+		{
+			// xEventGroupWaitBits() returned because just BIT_4 was set.
+		}
+		else
+		{
+			// xEventGroupWaitBits() returned because xTicksToWait ticks passed
+			// without either BIT_0 or BIT_4 becoming set.
+		}
+   }
+   </pre>
+ * \defgroup xEventGroupWaitBits xEventGroupWaitBits
+ * \ingroup EventGroup
+ */
+xEventBitsType xEventGroupWaitBits( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToWaitFor, const portBASE_TYPE xClearOnExit, const portBASE_TYPE xWaitForAllBits, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * EventGroups.h
+ *<pre>
+	xEventBitsType xEventGroupClearBits( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToClear );
+ </pre>
+ *
+ * Clear bits within an event group.  This function cannot be called from an
+ * interrupt.
+ *
+ * @param xEventGroup The event group in which the bits are to be cleared.
+ *
+ * @param uxBitsToClear A bitwise value that indicates the bit or bits to clear
+ * in the event group.  For example, to clear bit 3 only, set uxBitsToClear to
+ * 0x08.  To clear bit 3 and bit 0 set uxBitsToClear to 0x09.
+ *
+ * @return The value of the event group before the specified bits were cleared.
+ *
+ * \defgroup xEventGroupClearBits xEventGroupClearBits
+ * \ingroup EventGroup
+ */
+xEventBitsType xEventGroupClearBits( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToClear ) PRIVILEGED_FUNCTION;
+
+/**
+ * EventGroups.h
+ *<pre>
+	portBASE_TYPE xEventGroupClearBitsFromISR( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToClear );
+ </pre>
+ *
+ * A version of xEventGroupClearBits() that can be called from an interrupt.
+ *
+ * Clearing bits in an event group is not a deterministic operation because
+ * there are an unknown number of tasks that may be waiting for the bit or
+ * bits being cleared.  FreeRTOS does not allow nondeterministic operations to
+ * be performed while interrupts are disabled, so protects event groups that
+ * are accessed from tasks by suspending the scheduler rather than disabling
+ * interrupts.  As a result event groups cannot be accessed directly from an
+ * interrupt service routine.  Therefore xEventGroupClearBitsFromISR() sends a
+ * message to the timer task to have the clear operation performed in the
+ * context of the timer task.
+ *
+ * @param xEventGroup The event group in which the bits are to be cleared.
+ *
+ * @param uxBitsToClear A bitwise value that indicates the bit or bits to clear.
+ *
+ * @return If the request to execute the function was posted successfully then
+ * pdPASS is returned, otherwise pdFALSE is returned.  pdFALSE will be returned
+ * if the timer service queue was full.
+ *
+ * \defgroup xEventGroupClearBitsFromISR xEventGroupClearBitsFromISR
+ * \ingroup EventGroup
+ */
+#if ( configUSE_TIMERS == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 )
+	#define xEventGroupClearBitsFromISR( xEventGroup, uxBitsToClear ) xTimerPendFunctionCallFromISR( vEventGroupClearBitsCallback, ( void * ) ( xEventGroup ), ( unsigned long ) ( uxBitsToClear ), NULL )
+#endif
+
+/**
+ * EventGroups.h
+ *<pre>
+	xEventBitsType xEventGroupSetBits( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToSet );
+ </pre>
+ *
+ * Set bits within an event group.
+ * This function cannot be called from an interrupt.  xEventGroupSetBitsFromISR()
+ * is a version that can be called from an interrupt.
+ *
+ * Setting bits in an event group will automatically unblock tasks that are
+ * blocked waiting for the bits.
+ *
+ * @param xEventGroup The event group in which the bits are to be set.
+ *
+ * @param uxBitsToSet A bitwise value that indicates the bit or bits to set.
+ * For example, to set bit 3 only, set uxBitsToSet to 0x08.  To set bit 3
+ * and bit 0 set uxBitsToSet to 0x09.
+ *
+ * @return The value of the event group at the time the call to
+ * xEventGroupSetBits() returns.  There are two reasons why the returned value
+ * might have the bits specified by the uxBitsToSet parameter cleared.  First,
+ * if setting a bit results in a task that was waiting for the bit leaving the
+ * blocked state then it is possible the bit will be cleared automatically
+ * (see the xClearBitOnExit parameter of xEventGroupWaitBits()).  Second, any
+ * unblocked (or otherwise Ready state) task that has a priority above that of
+ * the task that called xEventGroupSetBits() will execute and may change the
+ * event group value before the call to xEventGroupSetBits() returns.
+ *
+ * \defgroup xEventGroupSetBits xEventGroupSetBits
+ * \ingroup EventGroup
+ */
+xEventBitsType xEventGroupSetBits( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToSet ) PRIVILEGED_FUNCTION;
+
+/**
+ * EventGroups.h
+ *<pre>
+	portBASE_TYPE xEventGroupSetBitsFromISR( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToSet, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ </pre>
+ *
+ * A version of xEventGroupSetBits() that can be called from an interrupt.
+ *
+ * Setting bits in an event group is not a deterministic operation because
+ * there are an unknown number of tasks that may be waiting for the bit or bits
+ * being set.  As with xEventGroupClearBitsFromISR(), the set operation is sent
+ * to the timer service task and performed there.
+ *
+ * @param xEventGroup The event group in which the bits are to be set.
+ *
+ * @param uxBitsToSet A bitwise value that indicates the bit or bits to set.
+ *
+ * @param pxHigherPriorityTaskWoken As mentioned above, calling this function
+ * will result in a message being sent to the timer daemon task.  If the
+ * priority of the timer daemon task is higher than the priority of the
+ * currently running task (the task the interrupt interrupted) then
+ * *pxHigherPriorityTaskWoken will be set to pdTRUE by
+ * xEventGroupSetBitsFromISR(), indicating that a context switch should be
+ * requested before the interrupt exits.  For that reason
+ * *pxHigherPriorityTaskWoken must be initialised to pdFALSE.
+ *
+ * @return If the request to execute the function was posted successfully then
+ * pdPASS is returned, otherwise pdFALSE is returned.  pdFALSE will be returned
+ * if the timer service queue was full.
+ *
+ * \defgroup xEventGroupSetBitsFromISR xEventGroupSetBitsFromISR
+ * \ingroup EventGroup
+ */
+#if ( configUSE_TIMERS == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 )
+	#define xEventGroupSetBitsFromISR( xEventGroup, uxBitsToSet, pxHigherPriorityTaskWoken ) xTimerPendFunctionCallFromISR( vEventGroupSetBitsCallback, ( void * ) ( xEventGroup ), ( unsigned long ) ( uxBitsToSet ), ( pxHigherPriorityTaskWoken ) )
+#endif
+
+/**
+ * EventGroups.h
+ *<pre>
+	xEventBitsType xEventGroupSync(	xEventGroupHandle xEventGroup,
+									const xEventBitsType uxBitsToSet,
+									const xEventBitsType uxBitsToWaitFor,
+									portTickType xTicksToWait );
+ </pre>
+ *
+ * Atomically set bits within an event group, then wait for a combination of
+ * bits to be set within the same event group.  This functionality is typically
+ * used to synchronise multiple tasks, where each task has to wait for the other
+ * tasks to reach a synchronisation point before proceeding.
+ *
+ * This function cannot be used from an interrupt.
+ *
+ * The function will return before its block time expires if the bits specified
+ * by the uxBitsToWait parameter are set, or become set within that time.  In
+ * this case all the bits specified by uxBitsToWait will be automatically
+ * cleared before the function returns.
+ *
+ * @param xEventGroup The event group in which the bits are being tested.
+ *
+ * @param uxBitsToSet The bits to set in the event group before determining
+ * if, and possibly waiting for, all the bits specified by the uxBitsToWait
+ * parameter are set.
+ *
+ * @param uxBitsToWaitFor A bitwise value that indicates the bit or bits to test
+ * inside the event group.
+ *
+ * @param xTicksToWait The maximum amount of time (specified in 'ticks') to wait
+ * for all of the bits specified by uxBitsToWaitFor to become set.
+ *
+ * @return The value of the event group at the time either the bits being waited
+ * for became set, or the block time expired.  Test the return value to know
+ * which bits were set.  If the bits were all set then the value returned is
+ * the value before they were automatically cleared.
+ *
+ * \defgroup xEventGroupSync xEventGroupSync
+ * \ingroup EventGroup
+ */
+xEventBitsType xEventGroupSync( xEventGroupHandle xEventGroup, const xEventBitsType uxBitsToSet, const xEventBitsType uxBitsToWaitFor, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * EventGroups.h
+ *<pre>
+	xEventBitsType xEventGroupGetBits( xEventGroupHandle xEventGroup );
+ </pre>
+ *
+ * Returns the current value of the bits in an event group.  This function
+ * cannot be used from an interrupt.
+ *
+ * @param xEventGroup The event group being queried.
+ *
+ * @return The event group bits at the time xEventGroupGetBits() was called.
+ *
+ * \defgroup xEventGroupGetBits xEventGroupGetBits
+ * \ingroup EventGroup
+ */
+#define xEventGroupGetBits( xEventGroup ) xEventGroupClearBits( xEventGroup, 0 )
+
+/**
+ * EventGroups.h
+ *<pre>
+	xEventBitsType xEventGroupGetBitsFromISR( xEventGroupHandle xEventGroup );
+ </pre>
+ *
+ * A version of xEventGroupGetBits() that can be called from an ISR.
+ *
+ * @param xEventGroup The event group being queried.
+ *
+ * @return The event group bits at the time xEventGroupGetBitsFromISR() was called.
+ *
+ * \defgroup xEventGroupGetBitsFromISR xEventGroupGetBitsFromISR
+ * \ingroup EventGroup
+ */
+xEventBitsType xEventGroupGetBitsFromISR( xEventGroupHandle xEventGroup ) PRIVILEGED_FUNCTION;
+
+/**
+ * EventGroups.h
+ *<pre>
+	void xEventGroupDelete( xEventGroupHandle xEventGroup );
+ </pre>
+ *
+ * Delete an event group that was previously created by a call to
+ * xEventGroupCreate() or xEventGroupCreateStatic().  Tasks that are blocked on
+ * the event group will be unblocked and obtain 0 as the event group's value.
+ *
+ * @param xEventGroup The event group being deleted.
+ */
+void vEventGroupDelete( xEventGroupHandle xEventGroup ) PRIVILEGED_FUNCTION;
+
+/* For internal use only. */
+void vEventGroupSetBitsCallback( void *pvEventGroup, unsigned long ulBitsToSet ) PRIVILEGED_FUNCTION;
+void vEventGroupClearBitsCallback( void *pvEventGroup, unsigned long ulBitsToClear ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_GROUPS_H */
@@ -24,6 +24,8 @@
 #define ioconfigUSE_TX_CHAR_QUEUE  							1
 #define ioconfigUSE_CIRCULAR_BUFFER_RX 						1
 #define ioconfigUSE_RX_CHAR_QUEUE 							1
+#define ioconfigUSE_TX_STREAM_BUFFER						1
+#define ioconfigUSE_RX_STREAM_BUFFER						1
 
 /* Peripheral options --------------------------------------------------------*/
 #define ioconfigINCLUDE_UART								1
@@ -33,6 +35,8 @@
 	#define ioconfigUSE_UART_TX_CHAR_QUEUE					1
 	#define ioconfigUSE_UART_CIRCULAR_BUFFER_RX				1
 	#define ioconfigUSE_UART_RX_CHAR_QUEUE					1
+	#define ioconfigUSE_UART_TX_STREAM_BUFFER				1
+	#define ioconfigUSE_UART_RX_STREAM_BUFFER				1
 
 #define ioconfigINCLUDE_SSP									1
 	#define ioconfigUSE_SSP_POLLED_TX						1
@@ -41,6 +45,8 @@
 	#define ioconfigUSE_SSP_CIRCULAR_BUFFER_RX				0
 	#define ioconfigUSE_SSP_RX_CHAR_QUEUE					0
 	#define ioconfigUSE_SSP_TX_CHAR_QUEUE					0
+	#define ioconfigUSE_SSP_TX_STREAM_BUFFER				0
+	#define ioconfigUSE_SSP_RX_STREAM_BUFFER				0
 
 #define ioconfigINCLUDE_I2C									1
 	#define ioconfigUSE_I2C_POLLED_TX						1
@@ -49,6 +55,17 @@
 	#define ioconfigUSE_I2C_CIRCULAR_BUFFER_RX				1
 	#define ioconfigUSE_I2C_TX_CHAR_QUEUE					1
 
+/* Driver structure pool -----------------------------------------------------*/
+/* The peripheral, transfer control and transfer state structures are taken
+from a fixed-block pool instead of the heap.  Blocks are ioconfigPOOL_BLOCK_SIZE
+bytes, which covers every structure except the I2C transfer definitions and the
+circular buffer storage; those, and anything requested once the pool is empty,
+still come from pvPortMalloc().  vIOUtilsGetPoolStats() reports the high water
+mark to size ioconfigPOOL_BLOCKS by. */
+#define ioconfigUSE_POOL									1
+	#define ioconfigPOOL_BLOCK_SIZE							32
+	#define ioconfigPOOL_BLOCKS								16
+
 
 
 
@@ -69,6 +86,14 @@
 	#error ioconfigUSE_RX_CHAR_QUEUE must also be set to 1 if ioconfigUSE_UART_RX_CHAR_QUEUE is set to 1
 #endif
 
+#if ( ioconfigINCLUDE_UART == 1 ) && ( ioconfigUSE_UART_TX_STREAM_BUFFER == 1 ) && ( ioconfigUSE_TX_STREAM_BUFFER != 1 )
+	#error ioconfigUSE_TX_STREAM_BUFFER must also be set to 1 if ioconfigUSE_UART_TX_STREAM_BUFFER is set to 1
+#endif
+
+#if ( ioconfigINCLUDE_UART == 1 ) && ( ioconfigUSE_UART_RX_STREAM_BUFFER == 1 ) && ( ioconfigUSE_RX_STREAM_BUFFER != 1 )
+	#error ioconfigUSE_RX_STREAM_BUFFER must also be set to 1 if ioconfigUSE_UART_RX_STREAM_BUFFER is set to 1
+#endif
+
 #if ( ioconfigUSE_SSP == 1 ) && ( ioconfigUSE_SSP_ZERO_COPY_TX == 1 ) && ( ioconfigUSE_ZERO_COPY_TX != 1 )
 	#error ioconfigUSE_ZERO_COPY_TX must also be set to 1 if ioconfigUSE_SSP_ZERO_COPY_TX is set to 1
 #endif
@@ -85,6 +110,18 @@
 	#error ioconfigUSE_RX_CHAR_QUEUE must also be set to 1 if ioconfigUSE_SSP_RX_CHAR_QUEUE is set to 1
 #endif
 
+#if ( ioconfigINCLUDE_SSP == 1 ) && ( ioconfigUSE_SSP_TX_STREAM_BUFFER == 1 ) && ( ioconfigUSE_TX_STREAM_BUFFER != 1 )
+	#error ioconfigUSE_TX_STREAM_BUFFER must also be set to 1 if ioconfigUSE_SSP_TX_STREAM_BUFFER is set to 1
+#endif
+
+#if ( ioconfigINCLUDE_SSP == 1 ) && ( ioconfigUSE_SSP_RX_STREAM_BUFFER == 1 ) && ( ioconfigUSE_RX_STREAM_BUFFER != 1 )
+	#error ioconfigUSE_RX_STREAM_BUFFER must also be set to 1 if ioconfigUSE_SSP_RX_STREAM_BUFFER is set to 1
+#endif
+
+#if ( ( ioconfigUSE_TX_STREAM_BUFFER == 1 ) || ( ioconfigUSE_RX_STREAM_BUFFER == 1 ) ) && ( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error configUSE_TASK_NOTIFICATIONS must be set to 1 in FreeRTOSConfig.h to use the stream buffer transfer modes
+#endif
+
 #if ( ioconfigUSE_I2C == 1 ) && ( ioconfigUSE_I2C_ZERO_COPY_TX == 1 ) && ( ioconfigUSE_ZERO_COPY_TX != 1 )
 	#error ioconfigUSE_ZERO_COPY_TX must also be set to 1 if ioconfigUSE_I2C_ZERO_COPY_TX is set to 1
 #endif
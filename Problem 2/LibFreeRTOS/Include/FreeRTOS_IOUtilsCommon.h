@@ -14,13 +14,32 @@
 #ifndef FREERTOS_IO_UTILS_H
 #define FREERTOS_IO_UTILS_H
 
+#include "FreeRTOS_Pool.h"
 #include "FreeRTOS_IOUtilsCharQueueTxAndRx.h"
 #include "FreeRTOS_IOUtilsCircularBufferRx.h"
 #include "FreeRTOS_IOUtilsZeroCopyTx.h"
+#include "FreeRTOS_StreamBuffer.h"
+#include "FreeRTOS_IOUtilsStreamBufferTxAndRx.h"
 
 /* For internal use only. */
 void vIOUtilsCreateTransferControlStructure( Transfer_Control_t **ppxTransferControl );
 
+/* Allocation for the driver structures.  pvIOUtilsAlloc() takes a block from
+the driver pool when xSize fits and one is free, otherwise it falls back to
+pvPortMalloc(), so it must only be called from a task.
+pvIOUtilsAllocFromISR() only ever uses the pool and returns NULL if xSize is
+larger than ioconfigPOOL_BLOCK_SIZE or the pool is empty.  vIOUtilsFree()
+accepts memory from either; from an interrupt it must only be given pool
+blocks. */
+void *pvIOUtilsAlloc( size_t xSize );
+void *pvIOUtilsAllocFromISR( size_t xSize );
+void vIOUtilsFree( void *pv );
+
+/* Reports the usage and high water mark of the driver pool. */
+#if ioconfigUSE_POOL == 1
+	void vIOUtilsGetPoolStats( xPoolStatsType *pxPoolStats );
+#endif
+
 #endif
 
 
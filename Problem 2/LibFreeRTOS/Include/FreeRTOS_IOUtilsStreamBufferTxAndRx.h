@@ -0,0 +1,173 @@
+/**************************************************************************//**
+ *
+ * @file        IOUtilsStreamBufferTxAndRx.h
+ * @brief       Part of FreeRTOS+IO
+ * @author      Real Time Engineers Ltd.
+ * @version     1.0.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2012 Real Time Engineers ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef IOUTILS_TXANDRX_STREAM_BUFFERS_H
+#define IOUTILS_TXANDRX_STREAM_BUFFERS_H
+
+/* The transfer structure used when a stream buffer is used for transmission
+or reception.  Unlike the character queue, bytes are moved between the
+peripheral FIFO and the buffer in blocks, with one stream buffer call per
+interrupt rather than one queue call per byte. */
+typedef struct xSTREAM_BUFFER_STATE
+{
+	xStreamBufferHandle xStreamBuffer;	/* The stream buffer itself. */
+	portTickType xBlockTime;			/* The amount of time a task should be held in the Blocked state (not using CPU time) to wait for data to become available if a read attempt is made on an empty buffer, or for space to become available when a write attempt is made on a full buffer. */
+	uint16_t usErrorState;				/* Currently just set to pdFALSE or pdTRUE if a buffer overrun has not/has occurred respectively. */
+} Stream_Buffer_State_t;
+
+/* Transfer type casts from peripheral structs. */
+#define prvTX_STREAM_BUFFER_STATE( pxPeripheralControl ) ( ( Stream_Buffer_State_t * ) ( pxPeripheralControl )->pxTxControl->pvTransferState )
+#define prvRX_STREAM_BUFFER_STATE( pxPeripheralControl ) ( ( Stream_Buffer_State_t * ) ( pxPeripheralControl )->pxRxControl->pvTransferState )
+
+/* The most bytes moved between a peripheral FIFO and a stream buffer in one
+call.  Covers the 16 byte UART FIFO and the 8 byte SSP FIFO.  The stream
+buffers used must be larger than this. */
+#define ioutilsSTREAM_BUFFER_FIFO_BLOCK		( 16U )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Stream buffer Tx macros.
+ */
+#define ioutilsTX_CHARS_FROM_STREAM_BUFFER_FROM_ISR( pxTransferControl, xFifoSpace, xTransmitFunction, xHigherPriorityTaskWoken )	\
+{																															\
+Stream_Buffer_State_t *pxStreamBufferState = ( Stream_Buffer_State_t * ) ( ( pxTransferControl )->pvTransferState );		\
+uint8_t ucBlock[ ioutilsSTREAM_BUFFER_FIFO_BLOCK ], ucChar;																	\
+size_t xCount, xIndex;																										\
+																															\
+	xCount = ( size_t ) ( xFifoSpace );																						\
+	if( xCount > ioutilsSTREAM_BUFFER_FIFO_BLOCK )																			\
+	{																														\
+		xCount = ioutilsSTREAM_BUFFER_FIFO_BLOCK;																			\
+	}																														\
+																															\
+	/* One copy out of the stream buffer for the whole FIFO's worth. */														\
+	xCount = xStreamBufferReceiveFromISR( pxStreamBufferState->xStreamBuffer, ucBlock, xCount, &( xHigherPriorityTaskWoken ) );	\
+	for( xIndex = 0U; xIndex < xCount; xIndex++ )																			\
+	{																														\
+		ucChar = ucBlock[ xIndex ];																							\
+		( xTransmitFunction );																								\
+	}																														\
+}
+/*-----------------------------------------------------------*/
+
+/* Start a transmission the interrupt is not already handling.  The interrupt
+is disabled while the FIFO is filled, as it is the only other reader of the
+stream buffer. */
+#define ioutilsFILL_FIFO_FROM_TX_STREAM_BUFFER( pxPeripheralControl, xDisablePeripheral, xEnablePeripheral, ulFifoDepth, xFifoNotFull, xPeripheralWrite )	\
+{																																	\
+uint8_t ucChar;																														\
+Stream_Buffer_State_t *pxTxState = prvTX_STREAM_BUFFER_STATE( pxPeripheralControl );												\
+uint32_t ulByte;																													\
+																																	\
+	( xDisablePeripheral );																											\
+	for( ulByte = 0; ulByte < ( ulFifoDepth ); ulByte++ )																			\
+	{																																\
+		if( ( xFifoNotFull ) )																										\
+		{																															\
+			if( xStreamBufferReceive( pxTxState->xStreamBuffer, &ucChar, sizeof( ucChar ), 0U ) != 0U )								\
+			{																														\
+				( xPeripheralWrite );																								\
+			}																														\
+			else																													\
+			{																														\
+				break;																												\
+			}																														\
+		}																															\
+		else																														\
+		{																															\
+			break;																													\
+		}																															\
+	}																																\
+	( xEnablePeripheral );																											\
+}
+/*-----------------------------------------------------------*/
+
+#define ioutilsBLOCKING_SEND_TO_TX_STREAM_BUFFER( pxPeripheralControl, xDisablePeripheral, xEnablePeripheral, ulFifoDepth, xFifoNotFull, xPeripheralWrite, pucBuffer, xTotalBytes, xBytesSent )	\
+{																															\
+portTickType xTicksToWait;																									\
+xTimeOutType xTimeOut;																										\
+Stream_Buffer_State_t *pxTxStreamState = prvTX_STREAM_BUFFER_STATE( pxPeripheralControl );								\
+																															\
+	xTicksToWait = pxTxStreamState->xBlockTime;																				\
+	vTaskSetTimeOutState( &xTimeOut );																						\
+	( xBytesSent ) = 0U;																									\
+																															\
+	for( ;; )																												\
+	{																														\
+		/* Copy in as much as fits now, then make sure the peripheral is						\
+		draining the buffer. */																								\
+		( xBytesSent ) += xIOUtilsSendToTxStreamBuffer( pxTxStreamState, ( pucBuffer ), ( xBytesSent ), ( xTotalBytes ), 0U );	\
+		ioutilsFILL_FIFO_FROM_TX_STREAM_BUFFER( pxPeripheralControl, xDisablePeripheral, xEnablePeripheral, ulFifoDepth, xFifoNotFull, xPeripheralWrite );	\
+																															\
+		if( ( xBytesSent ) >= ( xTotalBytes ) )																				\
+		{																													\
+			break;																											\
+		}																													\
+																															\
+		/* Sleep until the interrupt has freed some space. */																\
+		( xBytesSent ) += xIOUtilsSendToTxStreamBuffer( pxTxStreamState, ( pucBuffer ), ( xBytesSent ), ( xTotalBytes ), xTicksToWait );	\
+																															\
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )													\
+		{																													\
+			/* Time out has expired. */																						\
+			break;																											\
+		}																													\
+	}																														\
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Stream buffer Rx macros
+ */
+#define ioutilsRX_CHARS_INTO_STREAM_BUFFER_FROM_ISR( pxTransferControl, xCondition, xReceiveFunction, ulReceived, xHigherPriorityTaskWoken )	\
+{																															\
+Stream_Buffer_State_t *pxStreamBufferState = ( Stream_Buffer_State_t * ) ( ( pxTransferControl )->pvTransferState );		\
+uint8_t ucBlock[ ioutilsSTREAM_BUFFER_FIFO_BLOCK ];																			\
+size_t xCount;																												\
+																															\
+	do																														\
+	{																														\
+		/* Empty the FIFO into a local block, then copy the block into the						\
+		stream buffer in one go. */																							\
+		xCount = 0U;																										\
+		while( ( xCount < ioutilsSTREAM_BUFFER_FIFO_BLOCK ) && ( xCondition ) )												\
+		{																													\
+			ucBlock[ xCount ] = ( uint8_t ) ( xReceiveFunction );															\
+			xCount++;																										\
+		}																													\
+																															\
+		if( xCount > 0U )																									\
+		{																													\
+			if( xStreamBufferSendFromISR( pxStreamBufferState->xStreamBuffer, ucBlock, xCount, &( xHigherPriorityTaskWoken ) ) != xCount )	\
+			{																												\
+				pxStreamBufferState->usErrorState = pdTRUE;																	\
+			}																												\
+			( ulReceived ) += xCount;																						\
+		}																													\
+	} while( xCount == ioutilsSTREAM_BUFFER_FIFO_BLOCK );																	\
+}
+/*-----------------------------------------------------------*/
+
+
+/* Prototypes of functions that are for internal use only. */
+void vIOUtilsSetTxStreamBufferTimeout( Peripheral_Control_t * const pxPeripheralControl, const portTickType xMaxWaitTime );
+void vIOUtilsSetRxStreamBufferTimeout( Peripheral_Control_t * const pxPeripheralControl, const portTickType xMaxWaitTime );
+portBASE_TYPE xIOUtilsSetRxStreamBufferTriggerLevel( Peripheral_Control_t * const pxPeripheralControl, const size_t xTriggerLevel );
+portBASE_TYPE xIOUtilsConfigureStreamBuffer( Peripheral_Control_t * const pxPeripheralControl, const uint32_t ulRequest, const size_t xBufferSize );
+size_t xIOUtilsSendToTxStreamBuffer( Stream_Buffer_State_t * const pxTxState, const uint8_t * const pucBuffer, const size_t xBytesSent, const size_t xTotalBytes, const portTickType xTicksToWait );
+size_t xIOUtilsReceiveFromRxStreamBuffer( Peripheral_Control_t * const pxPeripheralControl, uint8_t * const pucBuffer, const size_t xTotalBytes );
+portBASE_TYPE xIOUtilsWaitTxStreamBufferEmpty( Peripheral_Control_t * const pxPeripheralControl, const portTickType xMaxWaitTime );
+void vIOUtilsClearRxStreamBuffer( Peripheral_Control_t *pxPeripheralControl );
+
+#endif /* IOUTILS_TXANDRX_STREAM_BUFFERS_H */
@@ -86,6 +86,15 @@ typedef struct xLIST
  */
 #define listSET_LIST_ITEM_OWNER( pxListItem, pxOwner )		( pxListItem )->pvOwner = ( void * ) ( pxOwner )
 
+/*
+ * Access macro to get the owner of a list item.  The owner of a list item
+ * is the object (usually a TCB) that contains the list item.
+ *
+ * \page listGET_LIST_ITEM_OWNER listGET_LIST_ITEM_OWNER
+ * \ingroup LinkedList
+ */
+#define listGET_LIST_ITEM_OWNER( pxListItem )				( ( pxListItem )->pvOwner )
+
 /*
  * Access macro to set the value of the list item.  In most cases the value is
  * used to sort the list in descending order.
@@ -114,6 +123,31 @@ typedef struct xLIST
  */
 #define listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxList )			( (&( ( pxList )->xListEnd ))->pxNext->xItemValue )
 
+/*
+ * Return the list item at the head of the list.
+ *
+ * \page listGET_HEAD_ENTRY listGET_HEAD_ENTRY
+ * \ingroup LinkedList
+ */
+#define listGET_HEAD_ENTRY( pxList )						( ( xListItem * ) ( ( pxList )->xListEnd.pxNext ) )
+
+/*
+ * Return the list item that follows pxListItem in its list.
+ *
+ * \page listGET_NEXT listGET_NEXT
+ * \ingroup LinkedList
+ */
+#define listGET_NEXT( pxListItem )							( ( xListItem * ) ( ( pxListItem )->pxNext ) )
+
+/*
+ * Return the list item that marks the end of the list.  Walking a list with
+ * listGET_NEXT() stops when this is reached.
+ *
+ * \page listGET_END_MARKER listGET_END_MARKER
+ * \ingroup LinkedList
+ */
+#define listGET_END_MARKER( pxList )						( ( const xListItem * ) ( &( ( pxList )->xListEnd ) ) )
+
 /*
  * Access macro to determine if a list contains any items.  The macro will
  * only have the value true if the list is empty.
@@ -0,0 +1,166 @@
+/**************************************************************************//**
+ *
+ * @file        Pool.h
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef POOL_H
+#define POOL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include Pool.h"
+#endif
+
+#include "FreeRTOS_Portable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * MACROS AND DEFINITIONS
+ *----------------------------------------------------------*/
+
+/*
+ * A pool hands out blocks of one fixed size from a statically allocated
+ * array.  Allocating and freeing are O(1) and only mask interrupts up to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY for a few instructions, so unlike
+ * pvPortMalloc() they can be called from interrupts as well as tasks.
+ *
+ * The members are only accessed through the functions below and poolDEFINE().
+ */
+typedef struct xPOOL
+{
+	void *pvFreeList;							/*< Blocks that have been returned, linked through their first word. */
+	unsigned char *pucNextUnused;				/*< Blocks from here to pucEnd have never been handed out. */
+	unsigned char *pucStart;					/*< First byte of the storage area. */
+	unsigned char *pucEnd;						/*< One past the last byte of the storage area. */
+	size_t xBlockSize;							/*< Size of each block, rounded up to portBYTE_ALIGNMENT. */
+	unsigned portBASE_TYPE uxNumberOfBlocks;	/*< Blocks in the storage area. */
+	unsigned portBASE_TYPE uxBlocksFree;		/*< Blocks not currently allocated. */
+	unsigned portBASE_TYPE uxMinimumEverFree;	/*< Low water mark of uxBlocksFree. */
+	unsigned long ulAllocations;				/*< Successful calls to pvPoolAlloc(). */
+	unsigned long ulFailures;					/*< Calls to pvPoolAlloc() that found the pool empty. */
+} xPoolType;
+
+/* Used to pass information about a pool out of vPoolGetStats(). */
+typedef struct xPOOL_STATS
+{
+	size_t xBlockSize;
+	unsigned portBASE_TYPE uxNumberOfBlocks;
+	unsigned portBASE_TYPE uxBlocksFree;
+	unsigned portBASE_TYPE uxMinimumEverFree;
+	unsigned long ulAllocations;
+	unsigned long ulFailures;
+} xPoolStatsType;
+
+/* The size a block of xSize bytes occupies in a pool.  A free block has to
+hold the free list link, and every block must stay aligned. */
+#define poolBLOCK_SIZE( xSize )	( ( ( ( ( xSize ) < sizeof( void * ) ) ? sizeof( void * ) : ( xSize ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/**
+ * poolDEFINE( xPoolName, xBlockSize, uxNumberOfBlocks );
+ *
+ * Defines a pool called xPoolName, together with its storage, at file scope.
+ * The block size and count are fixed at compile time and the pool is ready to
+ * use without any initialisation call, so it can be used from an interrupt
+ * that runs before the scheduler is started.  Both objects are static, so a
+ * pool is private to the file that defines it.
+ *
+ * @param xPoolName The name of the xPoolType variable to define.
+ *
+ * @param xBlockSize The largest object, in bytes, that will be allocated from
+ * the pool.
+ *
+ * @param uxNumberOfBlocks The number of blocks in the pool.
+ *
+ * Example usage:
+   <pre>
+ poolDEFINE( xMessagePool, sizeof( xMessage ), 8 );
+
+ void vAnInterruptHandler( void )
+ {
+ xMessage *pxMessage;
+
+	pxMessage = ( xMessage * ) pvPoolAlloc( &xMessagePool );
+	if( pxMessage != NULL )
+	{
+		// Fill in the message, then send the pointer to a task that will
+		// return the block with vPoolFree( &xMessagePool, pxMessage ).
+	}
+ }
+   </pre>
+ */
+#define poolDEFINE( xPoolName, xBlockSize, uxNumberOfBlocks )																\
+	static unsigned char xPoolName##Storage[ poolBLOCK_SIZE( xBlockSize ) * ( uxNumberOfBlocks ) ] __attribute__( ( aligned( portBYTE_ALIGNMENT ) ) );	\
+	static xPoolType xPoolName = { NULL, xPoolName##Storage, xPoolName##Storage, xPoolName##Storage + sizeof( xPoolName##Storage ),	\
+								   poolBLOCK_SIZE( xBlockSize ), ( uxNumberOfBlocks ), ( uxNumberOfBlocks ), ( uxNumberOfBlocks ), 0UL, 0UL }
+
+/*-----------------------------------------------------------
+ * POOL API
+ *----------------------------------------------------------*/
+
+/**
+ * void vPoolInitialise( xPoolType *pxPool,
+ *						 void *pvStorage,
+ *						 size_t xBlockSize,
+ *						 unsigned portBASE_TYPE uxNumberOfBlocks );
+ *
+ * Initialises a pool over a storage area supplied at run time, for when
+ * poolDEFINE() cannot be used.  pvStorage must be aligned to
+ * portBYTE_ALIGNMENT and hold at least
+ * poolBLOCK_SIZE( xBlockSize ) * uxNumberOfBlocks bytes.  Must not be called
+ * while the pool is in use.
+ */
+void vPoolInitialise( xPoolType *pxPool, void *pvStorage, size_t xBlockSize, unsigned portBASE_TYPE uxNumberOfBlocks );
+
+/**
+ * void *pvPoolAlloc( xPoolType *pxPool );
+ *
+ * Takes one block from the pool.  Can be called from a task or from an
+ * interrupt whose priority is at or below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ *
+ * @return A pointer to a block of at least the size the pool was defined with,
+ * or NULL if every block is in use.  Never blocks and never falls back to the
+ * heap.
+ */
+void *pvPoolAlloc( xPoolType *pxPool );
+
+/**
+ * void vPoolFree( xPoolType *pxPool, void *pv );
+ *
+ * Returns a block obtained from pvPoolAlloc() on the same pool.  Can be called
+ * from a task or an interrupt, and need not be called from the context that
+ * allocated the block.  Passing NULL does nothing.
+ */
+void vPoolFree( xPoolType *pxPool, void *pv );
+
+/**
+ * portBASE_TYPE xPoolContains( const xPoolType *pxPool, const void *pv );
+ *
+ * @return pdTRUE if pv points into the storage area of pxPool, otherwise
+ * pdFALSE.  Lets code that falls back to the heap for large objects decide
+ * which free function to use.
+ */
+portBASE_TYPE xPoolContains( const xPoolType *pxPool, const void *pv );
+
+/**
+ * void vPoolGetStats( xPoolType *pxPool, xPoolStatsType *pxPoolStats );
+ *
+ * Copies the size, current usage and high water mark of a pool into
+ * pxPoolStats.  uxNumberOfBlocks - uxMinimumEverFree is the most blocks the
+ * pool has had in use at once, which is what the pool should be sized by.
+ */
+void vPoolGetStats( xPoolType *pxPool, xPoolStatsType *pxPoolStats );
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* POOL_H */
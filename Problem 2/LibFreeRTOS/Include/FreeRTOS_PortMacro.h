@@ -91,6 +91,39 @@ extern void vPortYieldFromISR( void );
 #define portSET_INTERRUPT_MASK_FROM_ISR()		0;portSET_INTERRUPT_MASK()
 #define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	portCLEAR_INTERRUPT_MASK();(void)x
 
+/*
+ * Raise basepri to configMAX_SYSCALL_INTERRUPT_PRIORITY and return the value
+ * it held before.  Unlike the _FROM_ISR pair above, restoring puts back the
+ * previous mask rather than 0, so the pair nests and is safe from both tasks
+ * (including inside a critical section) and interrupts.
+ */
+static inline unsigned long ulPortRaiseInterruptMask( void )
+{
+unsigned long ulOriginalMask, ulNewMask;
+
+	__asm volatile
+	(
+		"	mrs %0, basepri						\n"
+		"	mov %1, %2							\n"
+		"	msr basepri, %1						\n"
+		:"=&r"( ulOriginalMask ), "=&r"( ulNewMask ):"i"( configMAX_SYSCALL_INTERRUPT_PRIORITY ):"memory"
+	);
+
+	return ulOriginalMask;
+}
+
+static inline void vPortRestoreInterruptMask( unsigned long ulMask )
+{
+	__asm volatile
+	(
+		"	msr basepri, %0						\n"
+		::"r"( ulMask ):"memory"
+	);
+}
+
+#define portRAISE_INTERRUPT_MASK()				ulPortRaiseInterruptMask()
+#define portRESTORE_INTERRUPT_MASK( x )			vPortRestoreInterruptMask( x )
+
 
 extern void vPortEnterCritical( void );
 extern void vPortExitCritical( void );
@@ -101,6 +134,62 @@ extern void vPortExitCritical( void );
 #define portEXIT_CRITICAL()			vPortExitCritical()
 /*-----------------------------------------------------------*/
 
+/* Architecture specific optimisations. */
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* The ready priorities are kept as a bitmap with one bit per priority, so
+	the highest can be found with a single CLZ whatever configMAX_PRIORITIES
+	is.  A 32 bit map limits the number of priorities to 32, which tasks.c
+	checks (configMAX_PRIORITIES contains a cast so cannot be tested here). */
+
+	/* Count the leading zero bits of ulBitmap.  Returns 32 for 0. */
+	static inline unsigned char ucPortCountLeadingZeros( unsigned long ulBitmap )
+	{
+	unsigned char ucReturn;
+
+		__asm volatile ( "clz %0, %1" : "=r" ( ucReturn ) : "r" ( ulBitmap ) );
+		return ucReturn;
+	}
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	/* The idle task is always ready, so uxReadyPriorities is never 0. */
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31 - ucPortCountLeadingZeros( ( uxReadyPriorities ) ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
+/* Tickless idle/low power functionality. */
+#if configUSE_TICKLESS_IDLE == 1
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/* Tick interrupts taken and ticks slept through since the scheduler started,
+so the two modes can be compared. */
+extern void vPortGetTickStats( unsigned long *pulTickInterrupts, unsigned long *pulSuppressedTicks );
+/*-----------------------------------------------------------*/
+
+/* MPU stack guard.  The highest numbered region, which wins where regions
+overlap, covers the lowest 32 byte aligned block of the running task's stack
+and is read only.  Moving it to the task being switched in is one write of
+the region base address register, whose VALID bit selects the region by the
+number in the same write, as the size and attributes stay the same. */
+#if configUSE_MPU_STACK_GUARD == 1
+	#define portMPU_REGION_BASE_ADDRESS		( ( volatile unsigned long * ) 0xe000ed9c )
+	#define portMPU_REGION_VALID			( 0x10UL )
+	#define portMPU_GUARD_REGION			( 7UL )
+	#define portSTACK_GUARD_SIZE			( 32UL )
+
+	/* The first guard sized boundary at or above the bottom of the stack. */
+	#define portSTACK_GUARD_BASE( pxStack )	( ( ( unsigned long ) ( pxStack ) + ( portSTACK_GUARD_SIZE - 1UL ) ) & ~( portSTACK_GUARD_SIZE - 1UL ) )
+
+	#define portSET_STACK_GUARD( pxStack )	*( portMPU_REGION_BASE_ADDRESS ) = ( portSTACK_GUARD_BASE( pxStack ) | portMPU_REGION_VALID | portMPU_GUARD_REGION )
+#endif
+/*-----------------------------------------------------------*/
+
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
@@ -256,7 +256,12 @@
 #ifdef __IAR_78K0R_Kx3L__
 	#include "../../Source/portable/IAR/78K0R/FreeRTOS_PortMacro.h"
 #endif
-	
+
+/* Host build, see Simulator/Source/FreeRTOS_PortPosix.c. */
+#ifdef FREERTOS_POSIX_PORT
+	#include "FreeRTOS_PortMacroPosix.h"
+#endif
+
 /* Catch all to ensure FreeRTOS_PortMacro.h is included in the build.  Newer demos
 have the path as part of the project options, rather than as relative from
 the project location.  If portENTER_CRITICAL() has not been defined then
@@ -317,6 +322,24 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Heap statistics, filled in by vPortGetHeapStats().  Block sizes are the
+ * bytes that could be handed out, not counting the block header.
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;		/*<< Total free bytes, including block headers. */
+	size_t xSizeOfLargestFreeBlockInBytes;	/*<< Biggest single allocation that would succeed now. */
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;	/*<< Low water mark of xAvailableHeapSpaceInBytes. */
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfSuccessfulFrees;
+} xHeapStatsType;
+
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -32,6 +32,20 @@ extern "C" {
  */
 typedef void * xQueueHandle;
 
+/**
+ * Type by which queue sets are referenced.  For example, a call to
+ * xQueueCreateSet() returns an xQueueSetHandle variable that can then be used
+ * as a parameter to xQueueSelectFromSet(), xQueueAddToSet(), etc.
+ */
+typedef void * xQueueSetHandle;
+
+/**
+ * Queue sets can contain both queues and semaphores, so the
+ * xQueueSetMemberHandle is defined as a type to be used where a parameter or
+ * return value can be either an xQueueHandle or an xSemaphoreHandle.
+ */
+typedef void * xQueueSetMemberHandle;
+
 
 /* For internal use only. */
 #define	queueSEND_TO_BACK	( 0 )
@@ -43,6 +57,7 @@ typedef void * xQueueHandle;
 #define queueQUEUE_TYPE_COUNTING_SEMAPHORE	( 2U )
 #define queueQUEUE_TYPE_BINARY_SEMAPHORE	( 3U )
 #define queueQUEUE_TYPE_RECURSIVE_MUTEX		( 4U )
+#define queueQUEUE_TYPE_SET					( 0U )
 
 /**
  * queue. h
@@ -102,6 +117,55 @@ typedef void * xQueueHandle;
  */
 #define xQueueCreate( uxQueueLength, uxItemSize ) xQueueGenericCreate( uxQueueLength, uxItemSize, queueQUEUE_TYPE_BASE )
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+							  unsigned portBASE_TYPE uxQueueLength,
+							  unsigned portBASE_TYPE uxItemSize,
+							  unsigned char *pucQueueStorageBuffer,
+							  xStaticQueueType *pxQueueBuffer
+						  );
+ * </pre>
+ *
+ * As xQueueCreate(), but the memory for the queue structure and the items is
+ * supplied by the caller rather than taken from the heap.  Both must stay
+ * valid for as long as the queue exists.  Deleting the queue does not free
+ * them.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this macro to be available.
+ *
+ * @param pucQueueStorageBuffer At least uxQueueLength * uxItemSize bytes, to
+ * hold the items.  May be NULL if uxItemSize is 0.
+ *
+ * @param pxQueueBuffer Holds the queue structure.
+ *
+ * @return The handle of the queue, or NULL if pxQueueBuffer is NULL.
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH	10
+ #define ITEM_SIZE		sizeof( unsigned long )
+
+ static xStaticQueueType xQueueBuffer;
+ static unsigned char ucQueueStorage[ QUEUE_LENGTH * ITEM_SIZE ];
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue1;
+
+	// Nothing comes from the heap, so this can't fail for lack of memory.
+	xQueue1 = xQueueCreateStatic( QUEUE_LENGTH, ITEM_SIZE, ucQueueStorage, &xQueueBuffer );
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define xQueueCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxQueueBuffer ), queueQUEUE_TYPE_BASE )
+#endif
+
 /**
  * queue. h
  * <pre>
@@ -1185,6 +1249,8 @@ signed portBASE_TYPE xQueueCRReceive( xQueueHandle pxQueue, void *pvBuffer, port
  */
 xQueueHandle xQueueCreateMutex( unsigned char ucQueueType );
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount );
+xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueueType *pxStaticQueue );
+xQueueHandle xQueueCreateCountingSemaphoreStatic( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount, xStaticQueueType *pxStaticQueue );
 void* xQueueGetMutexHolder( xQueueHandle xSemaphore );
 
 /*
@@ -1226,11 +1292,138 @@ portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle pxMutex );
 	void vQueueAddToRegistry( xQueueHandle xQueue, signed char *pcName );
 #endif
 
+/*
+ * The lock profiler keeps a record for each semaphore and mutex, up to
+ * configLOCK_PROFILER_SIZE of them, of how many times it was taken, how many
+ * takes had to block and how many of those gave up, how long the waits and
+ * holds were and which tasks had the longest, and how many takes blocked on
+ * a holder of lower priority.  See xLockProfileType in FreeRTOS.h.
+ * configUSE_LOCK_PROFILER must be set to 1 in FreeRTOSConfig.h, along with
+ * configGENERATE_RUN_TIME_STATS as its counter times the waits and holds.
+ *
+ * uxQueueGetLockProfile() copies the records of up to uxArraySize locks into
+ * pxLockProfileArray and returns how many it copied.  Each gets the name its
+ * lock was given with vQueueAddToRegistry(), if any.  If puxNotProfiled is
+ * not NULL it is set to the number of semaphores and mutexes that were
+ * created once every record was in use.
+ *
+ * vQueueResetLockProfile() zeroes the counts and times of every record, to
+ * profile one part of a run on its own.
+ *
+ * Example usage:
+   <pre>
+ static xLockProfileType xProfiles[ configLOCK_PROFILER_SIZE ];
+
+ void vAFunction( void )
+ {
+ unsigned portBASE_TYPE uxLocks, ux;
+
+	uxLocks = uxQueueGetLockProfile( xProfiles, configLOCK_PROFILER_SIZE, NULL );
+	for( ux = 0; ux < uxLocks; ux++ )
+	{
+		if( xProfiles[ ux ].ulInversions != 0 )
+		{
+			// A task has waited on a lower priority one holding this lock.
+		}
+	}
+ }
+   </pre>
+ */
+#if ( configUSE_LOCK_PROFILER == 1 )
+	unsigned portBASE_TYPE uxQueueGetLockProfile( xLockProfileType *pxLockProfileArray, unsigned portBASE_TYPE uxArraySize, unsigned portBASE_TYPE *puxNotProfiled );
+	void vQueueResetLockProfile( void );
+#endif
+
 /*
  * Generic version of the queue creation function, which is in turn called by
  * any queue, semaphore or mutex creation function or macro.
  */
 xQueueHandle xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType );
+xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue, unsigned char ucQueueType );
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+/*
+ * Queue sets let a task block on several queues and semaphores at once,
+ * instead of polling each in turn.  The task sleeps until one of the members
+ * holds something, with no periodic wake ups while nothing is happening.
+ *
+ * xQueueCreateSet() creates a set able to hold uxEventQueueLength events.  An
+ * event is recorded for every item sent to a member, so uxEventQueueLength
+ * must be the sum of the lengths of all the queues and semaphores that will
+ * be added to the set - one for each binary semaphore.  Mutexes must not be
+ * added to a set.
+ *
+ * xQueueCreateSetStatic() does the same in application supplied memory.
+ * pucQueueStorage must point to uxEventQueueLength * sizeof( void * ) bytes.
+ *
+ * Example usage:
+   <pre>
+ static xStaticQueueType xSetBuffer;
+ static unsigned char ucSetStorage[ 2 * sizeof( void * ) ];
+
+ void vATask( void * pvParameters )
+ {
+ xQueueSetHandle xSet;
+ xQueueSetMemberHandle xActivated;
+
+	xSet = xQueueCreateSetStatic( 2, ucSetStorage, &xSetBuffer );
+	xQueueAddToSet( xSemaphore1, xSet );
+	xQueueAddToSet( xSemaphore2, xSet );
+
+	for( ;; )
+	{
+		xActivated = xQueueSelectFromSet( xSet, portMAX_DELAY );
+
+		// The member returned holds something, so a zero block time read
+		// from it cannot fail.
+		if( xActivated == xSemaphore1 )
+		{
+			xSemaphoreTake( xSemaphore1, 0 );
+		}
+		else if( xActivated == xSemaphore2 )
+		{
+			xSemaphoreTake( xSemaphore2, 0 );
+		}
+	}
+ }
+ </pre>
+ */
+xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength );
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define xQueueCreateSetStatic( uxEventQueueLength, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxEventQueueLength ), sizeof( void * ), ( pucQueueStorage ), ( pxQueueBuffer ), queueQUEUE_TYPE_SET )
+#endif
+
+/*
+ * Adds a queue or semaphore to a set.  Fails if the member already belongs to
+ * a set, or is not empty.
+ *
+ * @return pdPASS if the member was added, otherwise pdFAIL.
+ */
+portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+
+/*
+ * Removes a queue or semaphore from a set.  Fails if the member is not in the
+ * set, or is not empty.
+ *
+ * @return pdPASS if the member was removed, otherwise pdFAIL.
+ */
+portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+
+/*
+ * Blocks for up to xBlockTimeTicks for any member of the set to contain data.
+ * Returns the member that does, which must then be read (queues) or taken
+ * (semaphores) before xQueueSelectFromSet() is called again, or NULL if the
+ * block time expired.
+ */
+xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks );
+
+/*
+ * A version of xQueueSelectFromSet() that can be used from an ISR.
+ */
+xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet );
+
+#endif /* configUSE_QUEUE_SETS */
 
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait );
@@ -74,6 +74,37 @@ typedef xQueueHandle xSemaphoreHandle;
 		}																																		\
 	}
 
+/**
+ * semphr. h
+ * <pre>vSemaphoreCreateBinaryStatic( xSemaphoreHandle xSemaphore, xStaticQueueType *pxSemaphoreBuffer )</pre>
+ *
+ * As vSemaphoreCreateBinary(), but the memory for the semaphore is supplied
+ * by the caller rather than taken from the heap.  The semaphore starts out
+ * given, in the same way.  The buffer must stay valid for as long as the
+ * semaphore exists.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this macro to be available.
+ *
+ * @param xSemaphore Handle to the created semaphore.  Should be of type
+ * xSemaphoreHandle.
+ *
+ * @param pxSemaphoreBuffer Holds the semaphore.
+ *
+ * \defgroup vSemaphoreCreateBinaryStatic vSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define vSemaphoreCreateBinaryStatic( xSemaphore, pxSemaphoreBuffer )																				\
+		{																																				\
+			( xSemaphore ) = xQueueGenericCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxSemaphoreBuffer ), queueQUEUE_TYPE_BINARY_SEMAPHORE );	\
+			if( ( xSemaphore ) != NULL )																												\
+			{																																			\
+				xSemaphoreGive( ( xSemaphore ) );																										\
+			}																																			\
+		}
+#endif
+
 /**
  * semphr. h
  * <pre>xSemaphoreTake(
@@ -666,6 +697,29 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateCounting( uxMaxCount, uxInitialCount ) xQueueCreateCountingSemaphore( ( uxMaxCount ), ( uxInitialCount ) )
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateMutexStatic( xStaticQueueType *pxMutexBuffer )</pre>
+ * <pre>xSemaphoreHandle xSemaphoreCreateRecursiveMutexStatic( xStaticQueueType *pxMutexBuffer )</pre>
+ * <pre>xSemaphoreHandle xSemaphoreCreateCountingStatic( unsigned portBASE_TYPE uxMaxCount, unsigned portBASE_TYPE uxInitialCount, xStaticQueueType *pxSemaphoreBuffer )</pre>
+ *
+ * As xSemaphoreCreateMutex(), xSemaphoreCreateRecursiveMutex() and
+ * xSemaphoreCreateCounting(), but the memory is supplied by the caller rather
+ * than taken from the heap.  The buffer must stay valid for as long as the
+ * semaphore exists.  Return NULL if the buffer is NULL.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * these macros to be available.
+ *
+ * \defgroup xSemaphoreCreateMutexStatic xSemaphoreCreateMutexStatic
+ * \ingroup Semaphores
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define xSemaphoreCreateMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( queueQUEUE_TYPE_MUTEX, ( pxMutexBuffer ) )
+	#define xSemaphoreCreateRecursiveMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( queueQUEUE_TYPE_RECURSIVE_MUTEX, ( pxMutexBuffer ) )
+	#define xSemaphoreCreateCountingStatic( uxMaxCount, uxInitialCount, pxSemaphoreBuffer ) xQueueCreateCountingSemaphoreStatic( ( uxMaxCount ), ( uxInitialCount ), ( pxSemaphoreBuffer ) )
+#endif
+
 /**
  * semphr. h
  * <pre>void vSemaphoreDelete( xSemaphoreHandle xSemaphore );</pre>
@@ -0,0 +1,312 @@
+/**************************************************************************//**
+ *
+ * @file        StreamBuffer.h
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include StreamBuffer.h"
+#endif
+
+#include "FreeRTOS_Task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * MACROS AND DEFINITIONS
+ *----------------------------------------------------------*/
+
+/*
+ * Stream buffers move a stream of bytes from exactly one writer to exactly one
+ * reader, which may each be a task or an interrupt.  Data is copied in and out
+ * in contiguous blocks with memcpy(), and the indexes are each only written by
+ * one side, so no critical section is needed to move the data itself.  A task
+ * blocked reading is only woken once the number of bytes in the buffer reaches
+ * the trigger level, and a blocked writer is woken when a read frees space.
+ * Blocking uses the direct to task notification of the task concerned, so a
+ * task must not wait on a stream buffer and use its notification value for
+ * something else at the same time.
+ *
+ * A message buffer is a stream buffer that stores each write as a discrete
+ * message, prefixed with its length, and whose reads return one whole message
+ * at a time.  The message buffer API is the stream buffer API under other
+ * names, see the xMessageBuffer... macros at the end of this file.
+ *
+ * If more than one task or interrupt can write (or read) the same buffer, the
+ * writes (or reads) must be serialised by the application, for example with a
+ * mutex, or by placing them in a critical section with a block time of 0.
+ */
+
+/**
+ * Type by which stream and message buffers are referenced.  For example, a
+ * call to xStreamBufferCreate() returns an xStreamBufferHandle that can then
+ * be used as a parameter to xStreamBufferSend(), xStreamBufferReceive(), etc.
+ */
+typedef void * xStreamBufferHandle;
+typedef void * xMessageBufferHandle;
+
+/* The type used to store the length of each message in a message buffer,
+which is also the largest message that can be written. */
+#ifndef configMESSAGE_BUFFER_LENGTH_TYPE
+	#define configMESSAGE_BUFFER_LENGTH_TYPE size_t
+#endif
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+
+	/* Memory for a statically allocated stream or message buffer.  The members
+	mirror the private xSTREAM_BUFFER structure in FreeRTOS_StreamBuffer.c so
+	that this can be the same size without exposing it; they are not to be
+	accessed directly. */
+	typedef struct xSTATIC_STREAM_BUFFER
+	{
+		size_t uxDummy1[ 4 ];
+		void *pvDummy2[ 3 ];
+		unsigned char ucDummy3;
+	} xStaticStreamBufferType;
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
+/*-----------------------------------------------------------
+ * STREAM BUFFER API
+ *----------------------------------------------------------*/
+
+/**
+ * <pre>
+ xStreamBufferHandle xStreamBufferCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes );
+ </pre>
+ *
+ * Creates a stream buffer, allocating the control structure and the storage
+ * area together from the FreeRTOS heap.
+ *
+ * @param xBufferSizeBytes The number of bytes the buffer can hold at once.
+ *
+ * @param xTriggerLevelBytes The number of bytes that must be in the buffer
+ * before a task blocked in xStreamBufferReceive() is woken.  A value of 0 is
+ * treated as 1.  The reader still gets whatever is available if it is already
+ * running, or when its block time expires.
+ *
+ * @return The handle of the created stream buffer, or NULL if there was not
+ * enough heap.
+ *
+ * \page xStreamBufferCreate xStreamBufferCreate
+ * \ingroup StreamBufferManagement
+ */
+#define xStreamBufferCreate( xBufferSizeBytes, xTriggerLevelBytes ) xStreamBufferGenericCreate( ( xBufferSizeBytes ), ( xTriggerLevelBytes ), pdFALSE )
+
+/**
+ * <pre>
+ xStreamBufferHandle xStreamBufferCreateStatic( size_t xBufferSizeBytes,
+												size_t xTriggerLevelBytes,
+												unsigned char *pucStreamBufferStorageArea,
+												xStaticStreamBufferType *pxStaticStreamBuffer );
+ </pre>
+ *
+ * As xStreamBufferCreate(), but uses memory supplied by the caller.
+ * pucStreamBufferStorageArea must be at least xBufferSizeBytes + 1 bytes, the
+ * extra byte lets a full buffer be told apart from an empty one.
+ *
+ * \page xStreamBufferCreateStatic xStreamBufferCreateStatic
+ * \ingroup StreamBufferManagement
+ */
+#define xStreamBufferCreateStatic( xBufferSizeBytes, xTriggerLevelBytes, pucStreamBufferStorageArea, pxStaticStreamBuffer ) xStreamBufferGenericCreateStatic( ( xBufferSizeBytes ), ( xTriggerLevelBytes ), pdFALSE, ( pucStreamBufferStorageArea ), ( pxStaticStreamBuffer ) )
+
+/**
+ * <pre>
+ size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer,
+						   const void *pvTxData,
+						   size_t xDataLengthBytes,
+						   portTickType xTicksToWait );
+ </pre>
+ *
+ * Copies bytes into a stream buffer.  If there is not enough space for all of
+ * them the calling task blocks, for up to xTicksToWait, until there is; when
+ * the block time expires as many bytes as fit are written.  For a message
+ * buffer the message is written whole or not at all.
+ *
+ * @return The number of bytes written.
+ *
+ * \page xStreamBufferSend xStreamBufferSend
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer,
+								  const void *pvTxData,
+								  size_t xDataLengthBytes,
+								  signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ </pre>
+ *
+ * A version of xStreamBufferSend() that can be called from an interrupt.  It
+ * never blocks, and writes as many bytes as fit.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the write woke a task of
+ * higher priority than the interrupted task, in which case a context switch
+ * should be requested before the interrupt exits.
+ *
+ * \page xStreamBufferSendFromISR xStreamBufferSendFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer,
+							  void *pvRxData,
+							  size_t xBufferLengthBytes,
+							  portTickType xTicksToWait );
+ </pre>
+ *
+ * Copies up to xBufferLengthBytes out of a stream buffer.  If the buffer is
+ * empty the calling task blocks, for up to xTicksToWait, until the trigger
+ * level is reached.  For a message buffer one whole message is returned, or
+ * nothing if the next message is longer than xBufferLengthBytes.
+ *
+ * @return The number of bytes read.
+ *
+ * \page xStreamBufferReceive xStreamBufferReceive
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer,
+									 void *pvRxData,
+									 size_t xBufferLengthBytes,
+									 signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ </pre>
+ *
+ * A version of xStreamBufferReceive() that can be called from an interrupt.
+ * It never blocks.
+ *
+ * \page xStreamBufferReceiveFromISR xStreamBufferReceiveFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer );
+ </pre>
+ *
+ * Deletes a stream buffer, freeing its memory if the kernel allocated it.  No
+ * task may be blocked on the buffer.
+ *
+ * \page vStreamBufferDelete vStreamBufferDelete
+ * \ingroup StreamBufferManagement
+ */
+void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ portBASE_TYPE xStreamBufferReset( xStreamBufferHandle xStreamBuffer );
+ </pre>
+ *
+ * Empties a stream buffer.  Fails, returning pdFAIL, if a task is blocked on
+ * it.
+ *
+ * \page xStreamBufferReset xStreamBufferReset
+ * \ingroup StreamBufferManagement
+ */
+portBASE_TYPE xStreamBufferReset( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ portBASE_TYPE xStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevel );
+ </pre>
+ *
+ * Changes the trigger level.  Fails, returning pdFAIL, if xTriggerLevel is
+ * larger than the buffer.
+ *
+ * \page xStreamBufferSetTriggerLevel xStreamBufferSetTriggerLevel
+ * \ingroup StreamBufferManagement
+ */
+portBASE_TYPE xStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevel ) PRIVILEGED_FUNCTION;
+
+/**
+ * <pre>
+ size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer );
+ size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer );
+ portBASE_TYPE xStreamBufferIsEmpty( xStreamBufferHandle xStreamBuffer );
+ portBASE_TYPE xStreamBufferIsFull( xStreamBufferHandle xStreamBuffer );
+ </pre>
+ *
+ * Query how much data, or space, a stream buffer holds.  For a message buffer
+ * the counts include the length stored with each message.
+ *
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+portBASE_TYPE xStreamBufferIsEmpty( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+portBASE_TYPE xStreamBufferIsFull( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------
+ * MESSAGE BUFFER API
+ *----------------------------------------------------------*/
+
+/**
+ * <pre>
+ xMessageBufferHandle xMessageBufferCreate( size_t xBufferSizeBytes );
+ xMessageBufferHandle xMessageBufferCreateStatic( size_t xBufferSizeBytes,
+												  unsigned char *pucMessageBufferStorageArea,
+												  xStaticStreamBufferType *pxStaticMessageBuffer );
+ size_t xMessageBufferSend( xMessageBufferHandle xMessageBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait );
+ size_t xMessageBufferSendFromISR( xMessageBufferHandle xMessageBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ size_t xMessageBufferReceive( xMessageBufferHandle xMessageBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait );
+ size_t xMessageBufferReceiveFromISR( xMessageBufferHandle xMessageBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ size_t xMessageBufferNextLengthBytes( xMessageBufferHandle xMessageBuffer );
+ </pre>
+ *
+ * Each message occupies its length plus sizeof( configMESSAGE_BUFFER_LENGTH_TYPE )
+ * bytes of the buffer.  A task blocked reading is woken by any complete
+ * message.  xMessageBufferNextLengthBytes() returns the length of the next
+ * message, or 0 if the buffer is empty.
+ *
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreate( xBufferSizeBytes ) ( xMessageBufferHandle ) xStreamBufferGenericCreate( ( xBufferSizeBytes ), ( size_t ) 0, pdTRUE )
+#define xMessageBufferCreateStatic( xBufferSizeBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) ( xMessageBufferHandle ) xStreamBufferGenericCreateStatic( ( xBufferSizeBytes ), ( size_t ) 0, pdTRUE, ( pucMessageBufferStorageArea ), ( pxStaticMessageBuffer ) )
+#define xMessageBufferSend( xMessageBuffer, pvTxData, xDataLengthBytes, xTicksToWait ) xStreamBufferSend( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvTxData ), ( xDataLengthBytes ), ( xTicksToWait ) )
+#define xMessageBufferSendFromISR( xMessageBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferSendFromISR( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvTxData ), ( xDataLengthBytes ), ( pxHigherPriorityTaskWoken ) )
+#define xMessageBufferReceive( xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait ) xStreamBufferReceive( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( xTicksToWait ) )
+#define xMessageBufferReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferReceiveFromISR( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxHigherPriorityTaskWoken ) )
+#define vMessageBufferDelete( xMessageBuffer ) vStreamBufferDelete( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferReset( xMessageBuffer ) xStreamBufferReset( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferSpacesAvailable( xMessageBuffer ) xStreamBufferSpacesAvailable( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferIsEmpty( xMessageBuffer ) xStreamBufferIsEmpty( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferIsFull( xMessageBuffer ) xStreamBufferIsFull( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferNextLengthBytes( xMessageBuffer ) xStreamBufferNextMessageLengthBytes( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+
+/*
+ * Functions beyond this part are not part of the public API and are intended
+ * for use by the macros above only.
+ */
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+	xStreamBufferHandle xStreamBufferGenericCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, portBASE_TYPE xIsMessageBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	xStreamBufferHandle xStreamBufferGenericCreateStatic( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, portBASE_TYPE xIsMessageBuffer, unsigned char * const pucStreamBufferStorageArea, xStaticStreamBufferType * const pxStaticStreamBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+size_t xStreamBufferNextMessageLengthBytes( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* STREAM_BUFFER_H */
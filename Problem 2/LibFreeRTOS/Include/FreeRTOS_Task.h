@@ -76,6 +76,43 @@ typedef struct xTASK_PARAMTERS
 	xMemoryRegion xRegions[ portNUM_CONFIGURABLE_REGIONS ];
 } xTaskParameters;
 
+/*
+ * Filled in by uxTaskGetSystemState(), one per task.
+ */
+typedef struct xTASK_STATUS
+{
+	xTaskHandle xHandle;						/* The handle of the task. */
+	const signed char *pcTaskName;				/* The name given when the task was created. */
+	unsigned portBASE_TYPE xTaskNumber;			/* Unique for each task ever created, so a deleted and recreated task can be told apart. */
+	signed char cStatus;						/* 'R'eady (or running), 'B'locked, 'S'uspended or 'D'eleted, as vTaskList() prints. */
+	unsigned portBASE_TYPE uxCurrentPriority;	/* Priority now, including any inherited priority. */
+	unsigned long ulRunTimeCounter;				/* Run time counter total, 0 unless configGENERATE_RUN_TIME_STATS is 1. */
+	unsigned short usStackHighWaterMark;		/* Least free stack there has been, in words. */
+	unsigned short usStackDepth;				/* Stack size the task was created with, in words. */
+} xTaskStatusType;
+
+/*
+ * Returned by eTaskConfirmSleepModeStatus(), which the port calls with
+ * interrupts disabled just before it sleeps.
+ */
+typedef enum
+{
+	eAbortSleep = 0,		/* A task was readied or a switch was pended since the sleep was decided on, so don't sleep. */
+	eStandardSleep			/* Sleep for no longer than the expected idle time. */
+} eSleepModeStatus;
+
+/*
+ * What xTaskNotify() does to the notified task's notification value.
+ */
+typedef enum
+{
+	eNoAction = 0,				/* Notify the task without updating its notify value. */
+	eSetBits,					/* Set bits in the task's notification value. */
+	eIncrement,					/* Increment the task's notification value. */
+	eSetValueWithOverwrite,		/* Set the task's notification value to a specific value even if the previous value has not yet been read by the task. */
+	eSetValueWithoutOverwrite	/* Set the task's notification value if the previous value has been read by the task. */
+} eNotifyAction;
+
 /*
  * Defines the priority used by the idle task.  This must not be modified.
  *
@@ -228,6 +265,127 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+/**
+ * task. h
+ *<pre>
+ xTaskHandle xTaskCreateStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const signed char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTaskType *pxTaskBuffer
+						  );</pre>
+ *
+ * As xTaskCreate(), but the memory for the task's stack and TCB is supplied
+ * by the caller rather than taken from the heap.  Both must stay valid for
+ * as long as the task exists.  Deleting the task does not free them.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * @param puxStackBuffer An array of at least usStackDepth portSTACK_TYPE
+ * variables, used as the task's stack.
+ *
+ * @param pxTaskBuffer Holds the task's control block.
+ *
+ * @return The handle of the created task, or NULL if either buffer is NULL.
+ *
+ * Example usage:
+   <pre>
+ #define STACK_SIZE 200
+
+ static xStaticTaskType xTaskBuffer;
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+
+ void vOtherFunction( void )
+ {
+ xTaskHandle xHandle;
+
+	 // Nothing comes from the heap, so this can't fail for lack of memory.
+	 xHandle = xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskHandle xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ *<pre>
+ xTaskHandle xTaskCreatePeriodicStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const signed char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTaskType *pxTaskBuffer,
+							  portTickType xPeriod,
+							  portTickType xDeadline,
+							  unsigned long ulBudget
+						  );</pre>
+ *
+ * As xTaskCreateStatic(), but the task is periodic.  Its first activation is
+ * released when it is created and starts when it first runs, and each call
+ * to vTaskWaitForNextPeriod() ends one activation and waits for the release
+ * of the next, xPeriod ticks after the last.  The kernel keeps the start
+ * jitter and execution time of every activation and counts those that miss
+ * their deadline or overrun their budget, see xTaskGetPeriodicStatus().
+ *
+ * If configUSE_EDF_SCHEDULER is 1 and uxPriority is configEDF_PRIORITY the
+ * task is scheduled earliest deadline first against the other tasks at that
+ * priority, by the deadline of its current activation.
+ *
+ * configUSE_PERIODIC_TASKS and configSUPPORT_STATIC_ALLOCATION must be set to
+ * 1 in FreeRTOSConfig.h for this function to be available.
+ *
+ * @param xPeriod Ticks from one release to the next.  Must not be 0.
+ *
+ * @param xDeadline Ticks after its release each activation must have
+ * finished by.  0 makes it the same as xPeriod.
+ *
+ * @param ulBudget The longest an activation is expected to run for, in run
+ * time stats counter ticks.  0 if there is no budget.
+ *
+ * @return The handle of the created task, or NULL if either buffer is NULL.
+ *
+ * Example usage:
+   <pre>
+ #define STACK_SIZE 200
+
+ static xStaticTaskType xTaskBuffer;
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+
+ void vControlTask( void *pvParameters )
+ {
+	 for( ;; )
+	 {
+		 // Perform action here.
+
+		 // Done until the next 20ms period starts.
+		 vTaskWaitForNextPeriod();
+	 }
+ }
+
+ void vOtherFunction( void )
+ {
+	 // Every 20ms, done within 10ms of the start of each period, and
+	 // expected to run for no more than 2000 counter ticks each time.
+	 xTaskCreatePeriodicStatic( vControlTask, "CTRL", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, xStack, &xTaskBuffer, 20 / portTICK_RATE_MS, 10 / portTICK_RATE_MS, 2000 );
+ }
+   </pre>
+ * \defgroup xTaskCreatePeriodicStatic xTaskCreatePeriodicStatic
+ * \ingroup Tasks
+ */
+#if ( configUSE_PERIODIC_TASKS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskHandle xTaskCreatePeriodicStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer, portTickType xPeriod, portTickType xDeadline, unsigned long ulBudget ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -499,6 +657,56 @@ void vTaskDelay( portTickType xTicksToDelay ) PRIVILEGED_FUNCTION;
  */
 void vTaskDelayUntil( portTickType * const pxPreviousWakeTime, portTickType xTimeIncrement ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <pre>void vTaskWaitForNextPeriod( void );</pre>
+ *
+ * configUSE_PERIODIC_TASKS must be defined as 1 for this function to be
+ * available, and it can only be called by a task created with
+ * xTaskCreatePeriodicStatic().
+ *
+ * Ends the calling task's current activation and blocks until the next one
+ * is released, xPeriod ticks after the current one was.  Used in place of
+ * vTaskDelayUntil() and, like it, returns straight away if that release has
+ * already passed, so a task that overruns catches up rather than losing
+ * activations.
+ *
+ * The time the activation ran for is checked against the task's budget, and
+ * the tick it ended on against its deadline.  A miss is counted and, if
+ * configUSE_DEADLINE_MISSED_HOOK is 1, reported to
+ * void vApplicationDeadlineMissedHook( xTaskHandle xTask, signed char *pcTaskName ),
+ * which is called by the task itself just before this function returns.
+ *
+ * Example usage: see xTaskCreatePeriodicStatic().
+ *
+ * \defgroup vTaskWaitForNextPeriod vTaskWaitForNextPeriod
+ * \ingroup TaskCtrl
+ */
+void vTaskWaitForNextPeriod( void ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>portBASE_TYPE xTaskGetPeriodicStatus( xTaskHandle xTask, xPeriodicTaskType *pxStatus );</pre>
+ *
+ * configUSE_PERIODIC_TASKS must be defined as 1 for this function to be
+ * available.
+ *
+ * Copies out the timing of a periodic task, see xPeriodicTaskType in
+ * FreeRTOS.h.  The figures cover every activation since the task was
+ * created.
+ *
+ * @param xTask The task, or NULL for the calling task.
+ *
+ * @param pxStatus Written with the task's timing.
+ *
+ * @return pdTRUE if the task is periodic, otherwise pdFALSE and pxStatus is
+ * left alone.
+ *
+ * \defgroup xTaskGetPeriodicStatus xTaskGetPeriodicStatus
+ * \ingroup TaskCtrl
+ */
+portBASE_TYPE xTaskGetPeriodicStatus( xTaskHandle xTask, xPeriodicTaskType *pxStatus ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <pre>unsigned portBASE_TYPE uxTaskPriorityGet( xTaskHandle pxTask );</pre>
@@ -1030,6 +1238,34 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  */
 void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime );</PRE>
+ *
+ * configUSE_TRACE_FACILITY must be defined as 1 for this function to be
+ * available.
+ *
+ * Fills one xTaskStatusType structure for each task in the system, with no
+ * string formatting, so the application can process the raw figures
+ * itself.  The scheduler is suspended while the lists are walked, but
+ * interrupts are left enabled.
+ *
+ * @param pxTaskStatusArray An array with at least uxTaskGetNumberOfTasks()
+ * entries.
+ *
+ * @param uxArraySize The number of entries in pxTaskStatusArray.  Nothing is
+ * written if this is smaller than the number of tasks.
+ *
+ * @param pulTotalRunTime If not NULL, set to the run time counter value at
+ * the same moment, or 0 if configGENERATE_RUN_TIME_STATS is not 1.
+ *
+ * @return The number of structures written.
+ *
+ * \page uxTaskGetSystemState uxTaskGetSystemState
+ * \ingroup TaskUtils
+ */
+unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>void vTaskStartTrace( char * pcBuffer, unsigned portBASE_TYPE uxBufferSize );</PRE>
@@ -1133,6 +1369,131 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be defined as 1 for this function to be
+ * available.
+ *
+ * Each task has a 32 bit notification value and a notification state in its
+ * TCB.  Sending a notification sets the state to pending and updates the
+ * value as eAction says, and unblocks the task if it was waiting in
+ * xTaskNotifyWait() or ulTaskNotifyTake().  No queue, semaphore or heap
+ * memory is involved, so it is a faster and smaller replacement for a
+ * binary or counting semaphore, or an event flag, when only one task ever
+ * waits on it.
+ *
+ * @param xTaskToNotify The handle of the task being notified.
+ *
+ * @param ulValue Used with eSetBits, eSetValueWithOverwrite and
+ * eSetValueWithoutOverwrite.
+ *
+ * @param eAction How the value is updated, see eNotifyAction.
+ *
+ * @return pdFAIL if eAction is eSetValueWithoutOverwrite and a value was
+ * already pending, otherwise pdPASS.
+ *
+ * \page xTaskNotify xTaskNotify
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * A version of xTaskNotify() that can be used from an interrupt service
+ * routine.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the notification
+ * unblocked a task with a priority above the interrupted one, in which case
+ * a context switch should be requested before the interrupt exits, as with
+ * xSemaphoreGiveFromISR().
+ *
+ * \page xTaskNotifyFromISR xTaskNotifyFromISR
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</PRE>
+ *
+ * Increments the notified task's notification value, the equivalent of
+ * giving a counting semaphore.  For use with ulTaskNotifyTake().
+ *
+ * \page xTaskNotifyGive xTaskNotifyGive
+ * \ingroup TaskNotifications
+ */
+#define xTaskNotifyGive( xTaskToNotify ) xTaskNotify( ( xTaskToNotify ), 0UL, eIncrement )
+
+/**
+ * task. h
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * A version of xTaskNotifyGive() that can be used from an interrupt service
+ * routine, in place of xSemaphoreGiveFromISR().
+ *
+ * \page vTaskNotifyGiveFromISR vTaskNotifyGiveFromISR
+ * \ingroup TaskNotifications
+ */
+void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );</PRE>
+ *
+ * Wait, optionally blocking, for a notification to be pending.
+ *
+ * @param ulBitsToClearOnEntry Bits cleared in the notification value on
+ * entry, if no notification is already pending.
+ *
+ * @param ulBitsToClearOnExit Bits cleared in the notification value before
+ * returning, if a notification was received.
+ *
+ * @param pulNotificationValue If not NULL, set to the notification value
+ * before ulBitsToClearOnExit is applied.
+ *
+ * @param xTicksToWait The maximum time to block for a notification.
+ *
+ * @return pdTRUE if a notification was received, pdFALSE on timeout.
+ *
+ * \page xTaskNotifyWait xTaskNotifyWait
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</PRE>
+ *
+ * The equivalent of taking a binary (xClearCountOnExit pdTRUE) or counting
+ * (pdFALSE) semaphore, where the notification value is the count.  Blocks
+ * while the value is zero, for at most xTicksToWait.
+ *
+ * @return The notification value before it was cleared or decremented, so
+ * zero means the call timed out.
+ *
+ * \page ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyStateClear( xTaskHandle xTask );</PRE>
+ *
+ * Clears a pending notification without changing the notification value.
+ * Pass NULL for the calling task.
+ *
+ * @return pdPASS if a notification was pending, otherwise pdFAIL.
+ *
+ * \page xTaskNotifyStateClear xTaskNotifyStateClear
+ * \ingroup TaskNotifications
+ */
+portBASE_TYPE xTaskNotifyStateClear( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1149,6 +1510,30 @@ xTaskHandle xTaskGetIdleTaskHandle( void );
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  The port calls
+ * this after the tick interrupt has been stopped for a while, to move the
+ * tick count on by the number of whole tick periods that went by without a
+ * tick interrupt.  It never moves it past the next task unblock time, so
+ * no delayed task is missed.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.  Called by the
+ * port with interrupts disabled to check nothing has happened since the
+ * idle task decided to sleep that means it shouldn't.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -1204,6 +1589,46 @@ void vTaskPlaceOnEventListRestricted( const xList * const pxEventList, portTickT
  */
 signed portBASE_TYPE xTaskRemoveFromEventList( const xList * const pxEventList ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.
+ *
+ * Used by the event groups implementation.  The calling task is added to the
+ * end of pxEventList, rather than in priority order, and xItemValue is stored
+ * in its event list item so the event group can see what the task is waiting
+ * for.  Set taskEVENT_LIST_ITEM_VALUE_IN_USE in xItemValue so the value is not
+ * overwritten if the task's priority changes while it is blocked.
+ */
+void vTaskPlaceOnUnorderedEventList( xList * pxEventList, portTickType xItemValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.
+ *
+ * Used by the event groups implementation.  Removes the task that owns
+ * pxEventListItem from whichever event list it is in, and from the list of
+ * blocked tasks, and places it on a ready queue.  xItemValue is written to the
+ * event list item first so the task can see why it was unblocked.
+ *
+ * @return pdTRUE if the task being removed has a higher priority than the task
+ * making the call, otherwise pdFALSE.
+ */
+signed portBASE_TYPE xTaskRemoveFromUnorderedEventList( xListItem * pxEventListItem, portTickType xItemValue ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Returns the value held in the calling task's event list item, and puts the
+ * item back to holding the task's priority, so it can be used in priority
+ * ordered event lists again.
+ */
+portTickType uxTaskResetEventItemValue( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
  * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
@@ -1214,6 +1639,18 @@ signed portBASE_TYPE xTaskRemoveFromEventList( const xList * const pxEventList )
  */
 void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_MPU_STACK_GUARD is set to 1.  Called from
+ * the port's MemManage fault handler when the running task has written into
+ * the guard at the bottom of its stack, and passes the task to
+ * vApplicationStackOverflowHook().  The caller must not return to the task.
+ */
+void vTaskStackGuardFault( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Return the handle of the calling task.
  */
@@ -1256,10 +1693,23 @@ void vTaskPriorityDisinherit( xTaskHandle * const pxMutexHolder ) PRIVILEGED_FUN
 
 /*
  * Generic version of the task creation function which is in turn called by the
- * xTaskCreate() and xTaskCreateRestricted() macros.
+ * xTaskCreate() and xTaskCreateRestricted() macros.  The TCB always comes
+ * from the heap, so this is only available if configSUPPORT_DYNAMIC_ALLOCATION
+ * is 1.
  */
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
 
+/*
+ * With configSUPPORT_STATIC_ALLOCATION set to 1 the application provides the
+ * memory for the idle task, which the scheduler asks for as it starts, and
+ * for the timer service task if configUSE_TIMERS is 1.  The stack size is in
+ * words, as usStackDepth is for xTaskCreate().
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	extern void vApplicationGetIdleTaskMemory( xStaticTaskType **ppxIdleTaskTCBBuffer, portSTACK_TYPE **ppxIdleTaskStackBuffer, unsigned short *pusIdleTaskStackSize );
+	extern void vApplicationGetTimerTaskMemory( xStaticTaskType **ppxTimerTaskTCBBuffer, portSTACK_TYPE **ppxTimerTaskStackBuffer, unsigned short *pusTimerTaskStackSize );
+#endif
+
 /*
  * Get the uxTCBNumber assigned to the task referenced by the xTask parameter.
  */
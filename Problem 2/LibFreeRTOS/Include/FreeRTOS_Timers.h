@@ -34,6 +34,10 @@ as defined below. */
 #define tmrCOMMAND_CHANGE_PERIOD			2
 #define tmrCOMMAND_DELETE					3
 
+/* Commands that are sent to the timer service task rather than to a timer
+have negative IDs. */
+#define tmrCOMMAND_EXECUTE_CALLBACK			( -1 )
+
 /*-----------------------------------------------------------
  * MACROS AND DEFINITIONS
  *----------------------------------------------------------*/
@@ -49,6 +53,21 @@ typedef void * xTimerHandle;
 /* Define the prototype to which timer callback functions must conform. */
 typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
 
+/* Define the prototype to which functions used with the
+xTimerPendFunctionCall() and xTimerPendFunctionCallFromISR() functions must
+conform. */
+typedef void (*tmrPENDED_FUNCTION)( void *pvParameter1, unsigned long ulParameter2 );
+
+/* Used to pass information about deferred function calls out of
+vTimerGetPendStats(). */
+typedef struct xTIMER_PEND_STATS
+{
+	unsigned portBASE_TYPE uxCommandsWaiting;		/*<< Commands, including pended calls, in the timer queue now. */
+	unsigned portBASE_TYPE uxMaximumEverWaiting;	/*<< High water mark of uxCommandsWaiting.  Equal to configTIMER_QUEUE_LENGTH means calls may have been lost. */
+	unsigned long ulFunctionCallsRun;				/*<< Pended functions the timer service task has executed. */
+	unsigned long ulFunctionCallsFailed;			/*<< Pend attempts rejected because the timer queue was full. */
+} xTimerPendStatsType;
+
 /**
  * xTimerHandle xTimerCreate( 	const signed char *pcTimerName,
  * 								portTickType xTimerPeriodInTicks,
@@ -176,7 +195,41 @@ typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
  *     for( ;; );
  * }
  */
-xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * xTimerHandle xTimerCreateStatic(	const signed char *pcTimerName,
+ * 									portTickType xTimerPeriodInTicks,
+ * 									unsigned portBASE_TYPE uxAutoReload,
+ * 									void * pvTimerID,
+ * 									tmrTIMER_CALLBACK pxCallbackFunction,
+ * 									xStaticTimerType *pxTimerBuffer );
+ *
+ * As xTimerCreate(), but the memory for the timer is supplied by the caller
+ * rather than taken from the heap.  The buffer must stay valid for as long as
+ * the timer exists.  Deleting the timer does not free it.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.  The timer command queue is then static
+ * too, and the timer service task's memory comes from
+ * vApplicationGetTimerTaskMemory().
+ *
+ * @param pxTimerBuffer Holds the timer.
+ *
+ * @return The handle of the timer, or NULL if pxTimerBuffer is NULL or
+ * xTimerPeriodInTicks is 0.
+ *
+ * Example usage:
+ *
+ * static xStaticTimerType xBacklightTimerBuffer;
+ *
+ * xBacklightTimer = xTimerCreateStatic( "BacklightTimer", ( 5000 / portTICK_RATE_MS ), pdFALSE, 0, vBacklightTimerCallback, &xBacklightTimerBuffer );
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimerType *pxTimerBuffer ) PRIVILEGED_FUNCTION;
+#endif
 
 /**
  * void *pvTimerGetTimerID( xTimerHandle xTimer );
@@ -882,6 +935,128 @@ xTaskHandle xTimerGetTimerDaemonTaskHandle( void );
  */
 #define xTimerResetFromISR( xTimer, pxHigherPriorityTaskWoken ) xTimerGenericCommand( ( xTimer ), tmrCOMMAND_START, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ), 0U )
 
+/**
+ * portBASE_TYPE xTimerPendFunctionCallFromISR( tmrPENDED_FUNCTION xFunctionToPend,
+ *                                              void *pvParameter1,
+ *                                              unsigned long ulParameter2,
+ *                                              signed portBASE_TYPE *pxHigherPriorityTaskWoken );
+ *
+ * Used from application interrupt service routines to defer the execution of a
+ * function to the RTOS daemon task (the timer service task, hence this function
+ * is implemented in timers.c and is prefixed with 'Timer').
+ *
+ * Ideally an interrupt service routine (ISR) is kept as short as possible, but
+ * sometimes an ISR either has a lot of processing to do, or needs to perform
+ * processing that is not deterministic.  In these cases
+ * xTimerPendFunctionCallFromISR() can be used to defer processing of a function
+ * to the RTOS daemon task.  The ISR then costs a single write to the timer
+ * command queue.
+ *
+ * The function is executed in the context of the timer service task, at
+ * configTIMER_TASK_PRIORITY, so it must not block.  Pended functions and timer
+ * commands share the timer queue, and are processed in the order they were
+ * sent.
+ *
+ * @param xFunctionToPend The function to execute from the timer service/
+ * daemon task.  The function must conform to the tmrPENDED_FUNCTION prototype.
+ *
+ * @param pvParameter1 The value of the callback function's first parameter.
+ * The parameter has a void * type to allow it to be used to pass any type.
+ * For example, unsigned longs can be cast to a void *, or the void * can be
+ * used to point to a structure.
+ *
+ * @param ulParameter2 The value of the callback function's second parameter.
+ *
+ * @param pxHigherPriorityTaskWoken As mentioned above, calling this function
+ * will result in a message being sent to the timer daemon task.  If the
+ * priority of the timer daemon task (which is set using
+ * configTIMER_TASK_PRIORITY in FreeRTOSConfig.h) is higher than the priority of
+ * the currently running task (the task the interrupt interrupted) then
+ * *pxHigherPriorityTaskWoken will be set to pdTRUE within
+ * xTimerPendFunctionCallFromISR(), indicating that a context switch should be
+ * requested before the interrupt exits.  For that reason
+ * *pxHigherPriorityTaskWoken must be initialised to pdFALSE.
+ *
+ * @return pdPASS is returned if the message was successfully sent to the
+ * timer daemon task, otherwise pdFALSE is returned.  The number of failures is
+ * reported by vTimerGetPendStats().
+ *
+ * Example usage:
+ *
+ *	// The callback function that will execute in the context of the daemon task.
+ *  // Note callback functions must all use this same prototype.
+ *  void vProcessInterface( void *pvParameter1, unsigned long ulParameter2 )
+ *	{
+ *		portBASE_TYPE xInterfaceToService;
+ *
+ *		// The interface that requires servicing is passed in the second
+ *      // parameter.  The first parameter is not used in this case.
+ *		xInterfaceToService = ( portBASE_TYPE ) ulParameter2;
+ *
+ *		// ...Perform the processing here...
+ *	}
+ *
+ *	// An ISR that receives data packets from multiple interfaces
+ *  void vAnISR( void )
+ *	{
+ *		signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+ *		unsigned long ulInterfaceToService;
+ *
+ *		// Query the hardware to determine which interface needs processing.
+ *		ulInterfaceToService = prvCheckInterfaces();
+ *
+ *      // The actual processing is to be deferred to a task.  Request the
+ *      // vProcessInterface() callback function is executed, passing in the
+ *		// number of the interface that needs processing.  The interface to
+ *		// service is passed in the second parameter.  The first parameter is
+ *		// not used in this case.
+ *		xTimerPendFunctionCallFromISR( vProcessInterface, NULL, ulInterfaceToService, &xHigherPriorityTaskWoken );
+ *
+ *		// If xHigherPriorityTaskWoken is now set to pdTRUE then a context
+ *		// switch should be requested.
+ *		portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+ *	}
+ */
+portBASE_TYPE xTimerPendFunctionCallFromISR( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * portBASE_TYPE xTimerPendFunctionCall( tmrPENDED_FUNCTION xFunctionToPend,
+ *                                       void *pvParameter1,
+ *                                       unsigned long ulParameter2,
+ *                                       portTickType xTicksToWait );
+ *
+ * Used to defer the execution of a function to the RTOS daemon task (the timer
+ * service task, hence this function is implemented in timers.c and is prefixed
+ * with 'Timer').  The task level equivalent of xTimerPendFunctionCallFromISR().
+ *
+ * @param xFunctionToPend The function to execute from the timer service/
+ * daemon task.  The function must conform to the tmrPENDED_FUNCTION prototype.
+ *
+ * @param pvParameter1 The value of the callback function's first parameter.
+ *
+ * @param ulParameter2 The value of the callback function's second parameter.
+ *
+ * @param xTicksToWait Calling this function will result in a message being
+ * sent to the timer daemon task on a queue.  xTicksToWait is the amount of
+ * time the calling task should remain in the Blocked state (so not using any
+ * processing time) for space to become available on the timer queue if the
+ * queue is found to be full.
+ *
+ * @return pdPASS is returned if the message was successfully sent to the
+ * timer daemon task, otherwise pdFALSE is returned.
+ */
+portBASE_TYPE xTimerPendFunctionCall( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vTimerGetPendStats( xTimerPendStatsType *pxPendStats );
+ *
+ * Fills in *pxPendStats with the current and peak depth of the timer queue,
+ * and the number of pended function calls that were executed or lost.  The
+ * peak is sampled by the timer service task each time it takes a command from
+ * the queue, so it costs the sending interrupt nothing.
+ */
+void vTimerGetPendStats( xTimerPendStatsType *pxPendStats ) PRIVILEGED_FUNCTION;
+
 /*
  * Functions beyond this part are not part of the public API and are intended
  * for use by the kernel only.
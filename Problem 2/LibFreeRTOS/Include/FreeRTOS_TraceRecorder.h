@@ -0,0 +1,189 @@
+/**************************************************************************//**
+ *
+ * @file        TraceRecorder.h
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+/*
+ * A RAM ring of timestamped scheduler events, filled through the trace macros
+ * the kernel already calls.  Each event is one eight byte record written with
+ * the interrupt mask raised, so the cost is a function call and a few dozen
+ * cycles.  When the ring is full the oldest records are overwritten.
+ *
+ * The whole of xTraceImage - header, task names, queue types and ring - is
+ * what a host decoder needs, so it can be saved from a debugger as raw memory
+ * or sent as hex text with vTraceDump().  The layout is fixed and little
+ * endian, with traceVERSION bumped whenever it changes.
+ *
+ * This file is included from the end of FreeRTOS_Config.h when
+ * configUSE_TRACE_RECORDER is 1, so the macros below replace the empty
+ * defaults in FreeRTOS.h.  It must not need anything from FreeRTOS.h itself.
+ */
+
+#include <stdint.h>
+
+#if configUSE_TRACE_FACILITY != 1
+	#error configUSE_TRACE_FACILITY must be 1 to use the trace recorder, it provides the queue numbers.
+#endif
+
+#ifndef configTRACE_RECORDER_LENGTH
+	#define configTRACE_RECORDER_LENGTH 512
+#endif
+
+#if ( configTRACE_RECORDER_LENGTH & ( configTRACE_RECORDER_LENGTH - 1 ) ) != 0
+	#error configTRACE_RECORDER_LENGTH must be a power of 2
+#endif
+
+#ifndef configTRACE_RECORDER_SECTION
+	#define configTRACE_RECORDER_SECTION
+#endif
+
+#ifndef configTRACE_RECORDER_TIMER_HZ
+	#define configTRACE_RECORDER_TIMER_HZ 1000000UL
+#endif
+
+/* Identifies a trace image, "TRC1" when read as bytes. */
+#define traceMAGIC						( 0x31435254UL )
+#define traceVERSION					( 1U )
+
+/* Task names are kept in slot ( task number % traceMAX_TASK_NAMES ). */
+#define traceMAX_TASK_NAMES				( 32U )
+
+/* Event codes.  These definitions *must* match those in the host decoder. */
+#define traceEVENT_TASK_SWITCHED_IN		( 0x01U )	/* Object task, parameter priority. */
+#define traceEVENT_TASK_SWITCHED_OUT	( 0x02U )	/* Object task. */
+#define traceEVENT_TASK_CREATE			( 0x03U )	/* Object task, parameter priority. */
+#define traceEVENT_TASK_DELETE			( 0x04U )	/* Object task. */
+#define traceEVENT_TASK_DELAY			( 0x05U )	/* Object task, parameter ticks. */
+#define traceEVENT_TASK_DELAY_UNTIL		( 0x06U )	/* Object task, parameter ticks. */
+#define traceEVENT_QUEUE_CREATE			( 0x10U )	/* Object queue, parameter queue type. */
+#define traceEVENT_QUEUE_DELETE			( 0x11U )	/* Object queue. */
+#define traceEVENT_QUEUE_SEND			( 0x12U )	/* Object queue, parameter items before the send. */
+#define traceEVENT_QUEUE_SEND_FAILED	( 0x13U )
+#define traceEVENT_QUEUE_RECEIVE		( 0x14U )	/* Object queue, parameter items before the receive. */
+#define traceEVENT_QUEUE_RECEIVE_FAILED	( 0x15U )
+#define traceEVENT_QUEUE_PEEK			( 0x16U )
+#define traceEVENT_QUEUE_SEND_FROM_ISR	( 0x17U )
+#define traceEVENT_QUEUE_SEND_FROM_ISR_FAILED		( 0x18U )
+#define traceEVENT_QUEUE_RECEIVE_FROM_ISR			( 0x19U )
+#define traceEVENT_QUEUE_RECEIVE_FROM_ISR_FAILED	( 0x1AU )
+#define traceEVENT_QUEUE_BLOCK_SEND		( 0x1BU )	/* Object queue, parameter ticks to wait. */
+#define traceEVENT_QUEUE_BLOCK_RECEIVE	( 0x1CU )	/* Object queue, parameter ticks to wait. */
+#define traceEVENT_ISR_ENTER			( 0x20U )	/* Object IRQ number. */
+#define traceEVENT_ISR_EXIT				( 0x21U )	/* Object IRQ number. */
+#define traceEVENT_LOW_POWER_IDLE_BEGIN	( 0x30U )
+#define traceEVENT_LOW_POWER_IDLE_END	( 0x31U )
+#define traceEVENT_USER					( 0x40U )	/* Object channel, parameter value. */
+
+typedef struct xTRACE_RECORD
+{
+	uint32_t ulTime;				/*< Run time stats counter when the event happened. */
+	uint8_t ucEvent;				/*< One of the traceEVENT_ codes. */
+	uint8_t ucObject;				/*< Task number, queue number or IRQ number, depending on the event. */
+	uint16_t usParameter;			/*< Depends on the event. */
+} xTraceRecordType;
+
+typedef struct xTRACE_TASK_NAME
+{
+	uint32_t ulNumber;				/*< The task's TCB number, so a reused slot can be spotted. */
+	int8_t pcName[ configMAX_TASK_NAME_LEN ];
+} xTraceTaskNameType;
+
+typedef struct xTRACE_IMAGE
+{
+	uint32_t ulMagic;				/*< traceMAGIC once vTraceEnable() has been called. */
+	uint16_t usVersion;				/*< traceVERSION. */
+	uint16_t usRecordSize;			/*< sizeof( xTraceRecordType ). */
+	uint32_t ulTimerHz;				/*< Rate of the timestamps. */
+	uint32_t ulLength;				/*< Records in the ring. */
+	volatile uint32_t ulHead;		/*< Records written since the ring was last cleared.  The next goes at ulHead % ulLength. */
+	volatile uint32_t ulRecording;	/*< pdTRUE while events are being recorded. */
+	uint16_t usMaxTaskNames;		/*< traceMAX_TASK_NAMES. */
+	uint16_t usNameLength;			/*< configMAX_TASK_NAME_LEN. */
+	xTraceTaskNameType xTaskNames[ traceMAX_TASK_NAMES ];
+	uint8_t ucQueueTypes[ 256 ];	/*< Queue type of each queue number, so semaphores and mutexes can be told from queues. */
+	xTraceRecordType xRecords[ configTRACE_RECORDER_LENGTH ];
+} xTraceImageType;
+
+/* Passed to vTraceDump() to send out each line of the hex dump. */
+typedef void (*traceWRITE_FUNCTION)( const uint8_t *pucData, uint32_t ulLength );
+
+/*
+ * Fill in the image header and start recording.  Call from main() before any
+ * tasks or queues are created, so they all get a name or type.
+ */
+void vTraceEnable( void );
+
+/*
+ * Stop and restart recording.  Restarting does not clear the ring.
+ */
+void vTraceStop( void );
+void vTraceStart( void );
+
+/*
+ * Stop recording, send the image as hex text through pxWrite, then clear the
+ * ring and carry on recording.  The text starts with a "TRACE BEGIN" line and
+ * ends with a "TRACE END" line, so it can share a port with other output.
+ */
+void vTraceDump( traceWRITE_FUNCTION pxWrite );
+
+/*
+ * Record an application event, for example the start and end of a display
+ * update, so it shows up against the scheduler events.
+ */
+void vTraceUserEvent( uint8_t ucChannel, uint16_t usValue );
+
+/* Called by the macros below, not for use by application code. */
+void vTraceRecord( uint8_t ucEvent, uint8_t ucObject, uint16_t usParameter );
+void vTraceTaskSwitchedOut( uint8_t ucTask );
+void vTraceTaskSwitchedIn( uint8_t ucTask, uint16_t usPriority );
+void vTraceTaskCreate( uint32_t ulTask, const signed char *pcName, uint16_t usPriority );
+uint8_t ucTraceQueueCreate( uint8_t ucQueueType );
+
+/* Clamp a tick count into a record parameter, portMAX_DELAY ends up as 0xffff. */
+#define traceCLAMP_TICKS( x )	( ( uint16_t ) ( ( ( x ) > 0xffffUL ) ? 0xffffUL : ( x ) ) )
+
+/*
+ * The kernel hooks.  The task ones are only expanded inside FreeRTOS_Tasks.c,
+ * and the queue ones inside FreeRTOS_Queue.c, which is where the TCB and
+ * queue members they read are visible.
+ */
+#define traceTASK_SWITCHED_OUT()				vTraceTaskSwitchedOut( ( uint8_t ) pxCurrentTCB->uxTCBNumber )
+#define traceTASK_SWITCHED_IN()					vTraceTaskSwitchedIn( ( uint8_t ) pxCurrentTCB->uxTCBNumber, ( uint16_t ) pxCurrentTCB->uxPriority )
+#define traceTASK_CREATE( pxNewTCB )			vTraceTaskCreate( ( uint32_t ) ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName, ( uint16_t ) ( pxNewTCB )->uxPriority )
+#define traceTASK_DELETE( pxTCB )				vTraceRecord( traceEVENT_TASK_DELETE, ( uint8_t ) ( pxTCB )->uxTCBNumber, 0U )
+#define traceTASK_DELAY()						vTraceRecord( traceEVENT_TASK_DELAY, ( uint8_t ) pxCurrentTCB->uxTCBNumber, traceCLAMP_TICKS( xTicksToDelay ) )
+#define traceTASK_DELAY_UNTIL()					vTraceRecord( traceEVENT_TASK_DELAY_UNTIL, ( uint8_t ) pxCurrentTCB->uxTCBNumber, traceCLAMP_TICKS( xTimeToWake - xTickCount ) )
+
+#define traceQUEUE_CREATE( pxNewQueue )			( pxNewQueue )->ucQueueNumber = ucTraceQueueCreate( ( pxNewQueue )->ucQueueType )
+#define traceCREATE_MUTEX( pxNewQueue )			( pxNewQueue )->ucQueueNumber = ucTraceQueueCreate( ( pxNewQueue )->ucQueueType )
+#define traceQUEUE_DELETE( pxQueue )			vTraceRecord( traceEVENT_QUEUE_DELETE, ( pxQueue )->ucQueueNumber, 0U )
+#define traceQUEUE_SEND( pxQueue )				vTraceRecord( traceEVENT_QUEUE_SEND, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FAILED( pxQueue )		vTraceRecord( traceEVENT_QUEUE_SEND_FAILED, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE( pxQueue )			vTraceRecord( traceEVENT_QUEUE_RECEIVE, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )	vTraceRecord( traceEVENT_QUEUE_RECEIVE_FAILED, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_PEEK( pxQueue )				vTraceRecord( traceEVENT_QUEUE_PEEK, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )		vTraceRecord( traceEVENT_QUEUE_SEND_FROM_ISR, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )		vTraceRecord( traceEVENT_QUEUE_SEND_FROM_ISR_FAILED, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )			vTraceRecord( traceEVENT_QUEUE_RECEIVE_FROM_ISR, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue )	vTraceRecord( traceEVENT_QUEUE_RECEIVE_FROM_ISR_FAILED, ( pxQueue )->ucQueueNumber, ( uint16_t ) ( pxQueue )->uxMessagesWaiting )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )			vTraceRecord( traceEVENT_QUEUE_BLOCK_SEND, ( pxQueue )->ucQueueNumber, traceCLAMP_TICKS( xTicksToWait ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )		vTraceRecord( traceEVENT_QUEUE_BLOCK_RECEIVE, ( pxQueue )->ucQueueNumber, traceCLAMP_TICKS( xTicksToWait ) )
+
+#define traceISR_ENTER( ucIRQ )					vTraceRecord( traceEVENT_ISR_ENTER, ( uint8_t ) ( ucIRQ ), 0U )
+#define traceISR_EXIT( ucIRQ )					vTraceRecord( traceEVENT_ISR_EXIT, ( uint8_t ) ( ucIRQ ), 0U )
+
+#define traceLOW_POWER_IDLE_BEGIN()				vTraceRecord( traceEVENT_LOW_POWER_IDLE_BEGIN, 0U, 0U )
+#define traceLOW_POWER_IDLE_END()				vTraceRecord( traceEVENT_LOW_POWER_IDLE_END, 0U, 0U )
+
+#endif /* TRACE_RECORDER_H */
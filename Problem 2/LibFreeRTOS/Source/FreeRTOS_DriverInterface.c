@@ -69,7 +69,7 @@ Peripheral_Control_t *pxPeripheralControl = NULL;
 		/* Create the peripheral control structure used by FreeRTOS+IO to
 		access the peripheral.  This is also used as the handle to the
 		peripheral. */
-		pxPeripheralControl = pvPortMalloc( sizeof( Peripheral_Control_t ) );
+		pxPeripheralControl = pvIOUtilsAlloc( sizeof( Peripheral_Control_t ) );
 		if( pxPeripheralControl != NULL )
 		{
 			/* Initialise the common parts of the control structure. */
@@ -85,7 +85,7 @@ Peripheral_Control_t *pxPeripheralControl = NULL;
 			if( xInitialiseResult != pdPASS )
 			{
 				/* Something went wrong.  Free up resources and return NULL. */
-				vPortFree( pxPeripheralControl );
+				vIOUtilsFree( pxPeripheralControl );
 				pxPeripheralControl = NULL;
 			}
 		}
@@ -168,6 +168,29 @@ portBASE_TYPE xReturn = pdFAIL, xCommandIsDeviceSpecific = pdFALSE;
 			break;
 
 
+		case ioctlUSE_STREAM_BUFFER_TX	:
+		case ioctlUSE_STREAM_BUFFER_RX	:
+
+			#if ( ioconfigUSE_TX_STREAM_BUFFER == 1 ) || ( ioconfigUSE_RX_STREAM_BUFFER == 1 )
+			{
+				/* The peripheral is going to use a stream buffer to transmit
+				or receive data.  pvValue is the size of the buffer in bytes.
+				The interrupt moves a whole FIFO's worth of bytes per call, and
+				a reader can ask to only be woken once a number of bytes have
+				arrived, so this suits higher throughputs than the character
+				queue. */
+				xReturn = xIOUtilsConfigureStreamBuffer( pxPeripheralControl, ulRequest, ( size_t ) pvValue );
+
+				/* Stream buffers can only be used when interrupts are also
+				used.  Enabling interrupts is a device specific operation. */
+				ulRequest = ioctlUSE_INTERRUPTS;
+				pvValue = ( void * ) pdTRUE;
+				xCommandIsDeviceSpecific = pdTRUE;
+			}
+			#endif /* ( ioconfigUSE_TX_STREAM_BUFFER == 1 ) || ( ioconfigUSE_RX_STREAM_BUFFER == 1 ) */
+			break;
+
+
 		case ioctlSET_TX_TIMEOUT 	:
 
 			if( pxPeripheralControl->pxTxControl->ucType == ioctlUSE_CHARACTER_QUEUE_TX )
@@ -179,6 +202,15 @@ portBASE_TYPE xReturn = pdFAIL, xCommandIsDeviceSpecific = pdFALSE;
 				}
 				#endif /* ( ioconfigUSE_TX_CHAR_QUEUE == 1 ) */
 			}
+			else if( pxPeripheralControl->pxTxControl->ucType == ioctlUSE_STREAM_BUFFER_TX )
+			{
+				#if ioconfigUSE_TX_STREAM_BUFFER == 1
+				{
+					vIOUtilsSetTxStreamBufferTimeout( pxPeripheralControl, ( portTickType ) pvValue );
+					xReturn = pdPASS;
+				}
+				#endif /* ioconfigUSE_TX_STREAM_BUFFER */
+			}
 			else
 			{
 				/* There is nothing to do here as xReturn is already pdFAIL. */
@@ -206,6 +238,15 @@ portBASE_TYPE xReturn = pdFAIL, xCommandIsDeviceSpecific = pdFALSE;
 				}
 				#endif /* ioconfigUSE_RX_CHAR_QUEUE */
 			}
+			else if( pxPeripheralControl->pxRxControl->ucType == ioctlUSE_STREAM_BUFFER_RX )
+			{
+				#if ioconfigUSE_RX_STREAM_BUFFER == 1
+				{
+					vIOUtilsSetRxStreamBufferTimeout( pxPeripheralControl, ( portTickType ) pvValue );
+					xReturn = pdPASS;
+				}
+				#endif /* ioconfigUSE_RX_STREAM_BUFFER */
+			}
 			else
 			{
 				/* Nothing to do here as xReturn is already pdFAIL. */
@@ -240,6 +281,14 @@ portBASE_TYPE xReturn = pdFAIL, xCommandIsDeviceSpecific = pdFALSE;
 				}
 				#endif /* ioconfigUSE_RX_CHAR_QUEUE */
 			}
+			else if( pxPeripheralControl->pxTxControl->ucType == ioctlUSE_STREAM_BUFFER_TX )
+			{
+				#if ioconfigUSE_TX_STREAM_BUFFER == 1
+				{
+					xReturn = xIOUtilsWaitTxStreamBufferEmpty( pxPeripheralControl, ( portTickType ) pvValue );
+				}
+				#endif /* ioconfigUSE_TX_STREAM_BUFFER */
+			}
 			else
 			{
 				/* Nothing to do here as xReturn is already set to pdTRUE.  It
@@ -286,6 +335,15 @@ portBASE_TYPE xReturn = pdFAIL, xCommandIsDeviceSpecific = pdFALSE;
 				}
 				#endif /* ioconfigUSE_RX_CHAR_QUEUE */
 			}
+			else if( pxPeripheralControl->pxRxControl->ucType == ioctlUSE_STREAM_BUFFER_RX )
+			{
+				#if ioconfigUSE_RX_STREAM_BUFFER == 1
+				{
+					vIOUtilsClearRxStreamBuffer( pxPeripheralControl );
+					xReturn = pdPASS;
+				}
+				#endif /* ioconfigUSE_RX_STREAM_BUFFER */
+			}
 			else
 			{
 				/* Nothing to do here as xReturn is already set to pdFAIL; */
@@ -293,6 +351,26 @@ portBASE_TYPE xReturn = pdFAIL, xCommandIsDeviceSpecific = pdFALSE;
 			break;
 
 
+		case ioctlSET_RX_TRIGGER_LEVEL :
+
+			if( pxPeripheralControl->pxRxControl->ucType == ioctlUSE_STREAM_BUFFER_RX )
+			{
+				#if ioconfigUSE_RX_STREAM_BUFFER == 1
+				{
+					/* pvValue is the number of bytes that must be in the
+					buffer before a blocked reader is woken. */
+					xReturn = xIOUtilsSetRxStreamBufferTriggerLevel( pxPeripheralControl, ( size_t ) pvValue );
+				}
+				#endif /* ioconfigUSE_RX_STREAM_BUFFER */
+			}
+			else
+			{
+				/* Only stream buffers have a trigger level, xReturn is
+				already set to pdFAIL. */
+			}
+			break;
+
+
 		default :
 
 			xCommandIsDeviceSpecific = pdTRUE;
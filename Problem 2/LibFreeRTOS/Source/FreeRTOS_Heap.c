@@ -12,12 +12,22 @@
 ******************************************************************************/
 
 /*
- * A sample implementation of pvPortMalloc() and vPortFree() that permits
- * allocated blocks to be freed, but does not combine adjacent free blocks
- * into a single larger block.
+ * A two level segregated fit (TLSF) implementation of pvPortMalloc() and
+ * vPortFree(), in place of heap_2.
  *
- * See heap_1.c and heap_3.c for alternative implementations, and the memory
- * management pages of http://www.FreeRTOS.org for more information.
+ * Free blocks are kept in lists by size class.  The first level splits sizes
+ * by power of two, the second level splits each power of two into
+ * heapSL_INDEX_COUNT equal steps.  A bitmap per level records which lists are
+ * not empty, so finding a list that is certain to hold a big enough block
+ * is a couple of count leading zeros instructions, whatever is in the heap.
+ * Every block also records the block physically below it, so a freed block
+ * is merged with free neighbours on both sides straight away.  Allocation
+ * and freeing are both constant time, and the heap does not fragment into
+ * small pieces the way heap_2 does when blocks of different sizes are
+ * created and deleted over a long run.
+ *
+ * vPortGetHeapStats() reports the free bytes, the smallest it has ever been,
+ * the largest free block and the allocation and free counts.
  */
 #include <stdlib.h>
 
@@ -43,77 +53,246 @@ static union xRTOS_HEAP
 	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
 } xHeap;
 
-/* Define the linked list structure.  This is used to link free blocks in order
-of their size. */
+/* Every block, free or allocated, starts with the first two members.  The
+free list links are only valid while the block is free, and overlay the
+start of the memory handed out while it is allocated. */
 typedef struct A_BLOCK_LINK
 {
-	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
-	size_t xBlockSize;						/*<< The size of the free block. */
+	struct A_BLOCK_LINK *pxPrevPhysBlock;	/*<< The block just below this one in memory, NULL for the first. */
+	size_t xBlockSize;						/*<< Size of the block including the header, heapBLOCK_FREE if free. */
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the same size class. */
+	struct A_BLOCK_LINK *pxPrevFreeBlock;	/*<< The previous free block in the same size class. */
 } xBlockLink;
 
+/* Bytes of header in front of the memory handed out, rounded to keep it
+aligned.  A free block must have room for the whole of xBlockLink. */
+#define heapSTRUCT_SIZE			( ( ( sizeof( struct A_BLOCK_LINK * ) + sizeof( size_t ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapMINIMUM_BLOCK_SIZE	( ( sizeof( xBlockLink ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Block sizes are a multiple of portBYTE_ALIGNMENT, so the bottom bit is
+free to mark a block that is on a free list. */
+#define heapBLOCK_FREE			( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xBlockSize & ~heapBLOCK_FREE )
+#define heapBLOCK_IS_FREE( pxBlock )	( ( ( pxBlock )->xBlockSize & heapBLOCK_FREE ) != 0 )
+#define heapNEXT_PHYS_BLOCK( pxBlock )	( ( xBlockLink * ) ( ( ( unsigned char * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* Second level lists per power of two, as a power of two itself. */
+#define heapSL_INDEX_COUNT_LOG2	( 3 )
+#define heapSL_INDEX_COUNT		( 1 << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks below heapSMALL_BLOCK_SIZE all share first level list 0, split
+into heapSL_INDEX_COUNT lists of portBYTE_ALIGNMENT steps. */
+#if portBYTE_ALIGNMENT == 8
+	#define heapALIGN_SIZE_LOG2	( 3 )
+#else
+	#define heapALIGN_SIZE_LOG2	( 2 )
+#endif
+#define heapFL_INDEX_SHIFT		( heapSL_INDEX_COUNT_LOG2 + heapALIGN_SIZE_LOG2 )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFL_INDEX_SHIFT )
 
-static const unsigned short  heapSTRUCT_SIZE	= ( sizeof( xBlockLink ) + portBYTE_ALIGNMENT - ( sizeof( xBlockLink ) % portBYTE_ALIGNMENT ) );
-#define heapMINIMUM_BLOCK_SIZE	( ( size_t ) ( heapSTRUCT_SIZE * 2 ) )
+/* Enough first level lists for a block the size of the whole heap.  The
+default covers heaps up to 16KB, the array below fails to compile if the
+heap has outgrown it. */
+#ifndef configHEAP_FL_INDEX_MAX
+	#define configHEAP_FL_INDEX_MAX	( 14 )
+#endif
+#define heapFL_INDEX_MAX		configHEAP_FL_INDEX_MAX
+typedef char xHeapFLIndexCheck[ ( configTOTAL_HEAP_SIZE <= ( ( size_t ) 1 << heapFL_INDEX_MAX ) ) ? 1 : -1 ];
+#define heapFL_INDEX_COUNT		( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
 
-/* Create a couple of list links to mark the start and end of the list. */
-static xBlockLink xStart, xEnd;
+/* Which lists have anything in them, and the lists themselves. */
+static unsigned long ulFLBitmap;
+static unsigned char ucSLBitmap[ heapFL_INDEX_COUNT ];
+static xBlockLink *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
 
 /* Keeps track of the number of free bytes remaining, but says nothing about
 fragmentation. */
-static size_t xFreeBytesRemaining = configTOTAL_HEAP_SIZE;
+static size_t xFreeBytesRemaining = ( size_t ) 0;
+static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0;
+static size_t xNumberOfSuccessfulAllocations = ( size_t ) 0;
+static size_t xNumberOfSuccessfulFrees = ( size_t ) 0;
 
-/* STATIC FUNCTIONS ARE DEFINED AS MACROS TO MINIMIZE THE FUNCTION CALL DEPTH. */
+/*
+ * Index of the most significant set bit.  CLZ on the Cortex-M3.
+ */
+#define prvFLS( ulValue )	( 31 - __builtin_clz( ( unsigned int ) ( ulValue ) ) )
+
+/*
+ * Index of the least significant set bit, from CLZ of the isolated bit.
+ */
+#define prvFFS( ulValue )	prvFLS( ( ulValue ) & ( ~( ulValue ) + 1 ) )
+
+/*
+ * Work out the first and second level list for a block of xSize bytes.
+ */
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL );
+
+/*
+ * Find the smallest non-empty list whose blocks are all at least xSize
+ * bytes.  Returns NULL if there isn't one.
+ */
+static xBlockLink *prvSearchSuitableBlock( size_t xSize );
 
 /*
- * Insert a block into the list of free blocks - which is ordered by size of
- * the block.  Small blocks at the start of the list and large blocks at the end
- * of the list.
+ * Free list maintenance.
  */
-#define prvInsertBlockIntoFreeList( pxBlockToInsert )								\
-{																					\
-xBlockLink *pxIterator;																\
-size_t xBlockSize;																	\
-																					\
-	xBlockSize = pxBlockToInsert->xBlockSize;										\
-																					\
-	/* Iterate through the list until a block is found that has a larger size */	\
-	/* than the block we are inserting. */											\
-	for( pxIterator = &xStart; pxIterator->pxNextFreeBlock->xBlockSize < xBlockSize; pxIterator = pxIterator->pxNextFreeBlock )	\
-	{																				\
-		/* There is nothing to do here - just iterate to the correct position. */	\
-	}																				\
-																					\
-	/* Update the list to include the block being inserted in the correct */		\
-	/* position. */																	\
-	pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;					\
-	pxIterator->pxNextFreeBlock = pxBlockToInsert;									\
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlock );
+static void prvRemoveBlockFromFreeList( xBlockLink *pxBlock );
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void );
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Store small blocks in the first list. */
+		uxFL = 0;
+		uxSL = ( unsigned portBASE_TYPE ) ( xSize >> heapALIGN_SIZE_LOG2 );
+	}
+	else
+	{
+		uxFL = ( unsigned portBASE_TYPE ) prvFLS( xSize );
+		uxSL = ( unsigned portBASE_TYPE ) ( xSize >> ( uxFL - heapSL_INDEX_COUNT_LOG2 ) ) ^ ( 1U << heapSL_INDEX_COUNT_LOG2 );
+		uxFL -= ( heapFL_INDEX_SHIFT - 1 );
+	}
+
+	*puxFL = uxFL;
+	*puxSL = uxSL;
+}
+/*-----------------------------------------------------------*/
+
+static xBlockLink *prvSearchSuitableBlock( size_t xSize )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+unsigned long ulSLMap, ulFLMap;
+
+	/* Round the size up to the start of the next list, so that any block in
+	the list found is big enough without searching along it. */
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( prvFLS( xSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+	prvMappingInsert( xSize, &uxFL, &uxSL );
+
+	if( uxFL >= heapFL_INDEX_COUNT )
+	{
+		return NULL;
+	}
+
+	/* First look in the same power of two for a list at least this big. */
+	ulSLMap = ucSLBitmap[ uxFL ] & ( ~0UL << uxSL );
+	if( ulSLMap == 0UL )
+	{
+		/* Nothing there, so take the smallest list of any bigger power of
+		two. */
+		ulFLMap = ulFLBitmap & ( ~0UL << ( uxFL + 1 ) );
+		if( ulFLMap == 0UL )
+		{
+			/* Out of memory. */
+			return NULL;
+		}
+
+		uxFL = ( unsigned portBASE_TYPE ) prvFFS( ulFLMap );
+		ulSLMap = ucSLBitmap[ uxFL ];
+	}
+	uxSL = ( unsigned portBASE_TYPE ) prvFFS( ulSLMap );
+
+	return pxFreeLists[ uxFL ][ uxSL ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoFreeList( xBlockLink *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+xBlockLink *pxHead;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFL, &uxSL );
+	pxHead = pxFreeLists[ uxFL ][ uxSL ];
+
+	pxBlock->xBlockSize |= heapBLOCK_FREE;
+	pxBlock->pxPrevFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxHead;
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFreeBlock = pxBlock;
+	}
+	pxFreeLists[ uxFL ][ uxSL ] = pxBlock;
+
+	ulFLBitmap |= ( 1UL << uxFL );
+	ucSLBitmap[ uxFL ] |= ( unsigned char ) ( 1U << uxSL );
+
+	xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveBlockFromFreeList( xBlockLink *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFL, &uxSL );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+	}
+
+	if( pxBlock->pxPrevFreeBlock != NULL )
+	{
+		pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* It was the head, so the list may now be empty. */
+		pxFreeLists[ uxFL ][ uxSL ] = pxBlock->pxNextFreeBlock;
+		if( pxBlock->pxNextFreeBlock == NULL )
+		{
+			ucSLBitmap[ uxFL ] &= ( unsigned char ) ~( 1U << uxSL );
+			if( ucSLBitmap[ uxFL ] == 0U )
+			{
+				ulFLBitmap &= ~( 1UL << uxFL );
+			}
+		}
+	}
+
+	pxBlock->xBlockSize &= ~heapBLOCK_FREE;
+	xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
 }
 /*-----------------------------------------------------------*/
 
-#define prvHeapInit()																\
-{																					\
-xBlockLink *pxFirstFreeBlock;														\
-																					\
-	/* xStart is used to hold a pointer to the first item in the list of free */	\
-	/* blocks.  The void cast is used to prevent compiler warnings. */				\
-	xStart.pxNextFreeBlock = ( void * ) xHeap.ucHeap;								\
-	xStart.xBlockSize = ( size_t ) 0;												\
-																					\
-	/* xEnd is used to mark the end of the list of free blocks. */					\
-	xEnd.xBlockSize = configTOTAL_HEAP_SIZE;										\
-	xEnd.pxNextFreeBlock = NULL;													\
-																					\
-	/* To start with there is a single free block that is sized to take up the		\
-	entire heap space. */															\
-	pxFirstFreeBlock = ( void * ) xHeap.ucHeap;										\
-	pxFirstFreeBlock->xBlockSize = configTOTAL_HEAP_SIZE;							\
-	pxFirstFreeBlock->pxNextFreeBlock = &xEnd;										\
+static void prvHeapInit( void )
+{
+xBlockLink *pxFirstFreeBlock, *pxSentinel;
+size_t xTotalSize;
+
+	/* One free block takes up the whole heap, apart from a zero sized
+	allocated block at the very end.  That stops the last real block ever
+	trying to merge with whatever follows the heap.  The end block is given
+	room for a whole xBlockLink even though only the header is used. */
+	xTotalSize = ( ( size_t ) configTOTAL_HEAP_SIZE ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	pxFirstFreeBlock = ( void * ) xHeap.ucHeap;
+	pxFirstFreeBlock->pxPrevPhysBlock = NULL;
+	pxFirstFreeBlock->xBlockSize = xTotalSize - heapMINIMUM_BLOCK_SIZE;
+
+	pxSentinel = heapNEXT_PHYS_BLOCK( pxFirstFreeBlock );
+	pxSentinel->pxPrevPhysBlock = pxFirstFreeBlock;
+	pxSentinel->xBlockSize = ( size_t ) 0;
+
+	prvInsertBlockIntoFreeList( pxFirstFreeBlock );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
 }
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
 {
-xBlockLink *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
+xBlockLink *pxBlock, *pxNewBlockLink;
 static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
 void *pvReturn = NULL;
 
@@ -127,61 +306,46 @@ void *pvReturn = NULL;
 			xHeapHasBeenInitialised = pdTRUE;
 		}
 
-		/* The wanted size is increased so it can contain a xBlockLink
-		structure in addition to the requested amount of bytes. */
-		if( xWantedSize > 0 )
-		{
-			xWantedSize += heapSTRUCT_SIZE;
-
-			/* Ensure that blocks are always aligned to the required number of bytes. */
-			if( xWantedSize & portBYTE_ALIGNMENT_MASK )
-			{
-				/* Byte alignment required. */
-				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
-			}
-		}
-
+		/* The wanted size is increased so it can contain the block header in
+		addition to the requested amount of bytes, and rounded up so blocks
+		stay aligned and big enough to go back on a free list. */
 		if( ( xWantedSize > 0 ) && ( xWantedSize < configTOTAL_HEAP_SIZE ) )
 		{
-			/* Blocks are stored in byte order - traverse the list from the start
-			(smallest) block until one of adequate size is found. */
-			pxPreviousBlock = &xStart;
-			pxBlock = xStart.pxNextFreeBlock;
-			while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock ) )
+			xWantedSize = ( xWantedSize + heapSTRUCT_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
 			{
-				pxPreviousBlock = pxBlock;
-				pxBlock = pxBlock->pxNextFreeBlock;
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
 			}
 
-			/* If we found the end marker then a block of adequate size was not found. */
-			if( pxBlock != &xEnd )
+			pxBlock = prvSearchSuitableBlock( xWantedSize );
+			if( pxBlock != NULL )
 			{
-				/* Return the memory space - jumping over the xBlockLink structure
-				at its start. */
-				pvReturn = ( void * ) ( ( ( unsigned char * ) pxPreviousBlock->pxNextFreeBlock ) + heapSTRUCT_SIZE );
+				prvRemoveBlockFromFreeList( pxBlock );
 
-				/* This block is being returned for use so must be taken our of the
-				list of free blocks. */
-				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
-
-				/* If the block is larger than required it can be split into two. */
-				if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+				/* If the block is larger than required it can be split into
+				two, and the rest goes back on a free list.  The block above
+				the rest must be allocated, as free neighbours are always
+				merged. */
+				if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
 				{
-					/* This block is to be split into two.  Create a new block
-					following the number of bytes requested. The void cast is
-					used to prevent byte alignment warnings from the compiler. */
 					pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
-
-					/* Calculate the sizes of two blocks split from the single
-					block. */
-					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+					pxNewBlockLink->xBlockSize = heapBLOCK_SIZE( pxBlock ) - xWantedSize;
+					pxNewBlockLink->pxPrevPhysBlock = pxBlock;
+					heapNEXT_PHYS_BLOCK( pxNewBlockLink )->pxPrevPhysBlock = pxNewBlockLink;
 					pxBlock->xBlockSize = xWantedSize;
 
-					/* Insert the new block into the list of free blocks. */
-					prvInsertBlockIntoFreeList( ( pxNewBlockLink ) );
+					prvInsertBlockIntoFreeList( pxNewBlockLink );
 				}
-				
-				xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				xNumberOfSuccessfulAllocations++;
+
+				/* Return the memory space - jumping over the header at its
+				start. */
+				pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapSTRUCT_SIZE );
 			}
 		}
 	}
@@ -204,22 +368,41 @@ void *pvReturn = NULL;
 void vPortFree( void *pv )
 {
 unsigned char *puc = ( unsigned char * ) pv;
-xBlockLink *pxLink;
+xBlockLink *pxLink, *pxNeighbour;
 
 	if( pv )
 	{
-		/* The memory being freed will have an xBlockLink structure immediately
-		before it. */
+		/* The memory being freed will have a block header immediately before
+		it. */
 		puc -= heapSTRUCT_SIZE;
 
 		/* This casting is to keep the compiler from issuing warnings. */
 		pxLink = ( void * ) puc;
+		configASSERT( !heapBLOCK_IS_FREE( pxLink ) );
 
 		vTaskSuspendAll();
 		{
-			/* Add this block to the list of free blocks. */
-			prvInsertBlockIntoFreeList( ( ( xBlockLink * ) pxLink ) );
-			xFreeBytesRemaining += pxLink->xBlockSize;
+			/* Merge with the block below if that is free. */
+			pxNeighbour = pxLink->pxPrevPhysBlock;
+			if( ( pxNeighbour != NULL ) && heapBLOCK_IS_FREE( pxNeighbour ) )
+			{
+				prvRemoveBlockFromFreeList( pxNeighbour );
+				pxNeighbour->xBlockSize += heapBLOCK_SIZE( pxLink );
+				pxLink = pxNeighbour;
+			}
+
+			/* And with the block above.  The sentinel at the end of the heap
+			is never free. */
+			pxNeighbour = heapNEXT_PHYS_BLOCK( pxLink );
+			if( heapBLOCK_IS_FREE( pxNeighbour ) )
+			{
+				prvRemoveBlockFromFreeList( pxNeighbour );
+				pxLink->xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+			}
+			heapNEXT_PHYS_BLOCK( pxLink )->pxPrevPhysBlock = pxLink;
+
+			prvInsertBlockIntoFreeList( pxLink );
+			xNumberOfSuccessfulFrees++;
 		}
 		xTaskResumeAll();
 	}
@@ -232,6 +415,53 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStatsType *pxHeapStats )
+{
+xBlockLink *pxBlock;
+unsigned portBASE_TYPE uxFL, uxSL;
+size_t xLargest = 0, xSmallest = ( size_t ) ~0, xBlocks = 0;
+
+	vTaskSuspendAll();
+	{
+		/* Walks every free list, so this is not constant time.  Only the
+		figures that need the walk come from it. */
+		for( uxFL = 0; uxFL < heapFL_INDEX_COUNT; uxFL++ )
+		{
+			for( uxSL = 0; uxSL < heapSL_INDEX_COUNT; uxSL++ )
+			{
+				for( pxBlock = pxFreeLists[ uxFL ][ uxSL ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+				{
+					if( heapBLOCK_SIZE( pxBlock ) > xLargest )
+					{
+						xLargest = heapBLOCK_SIZE( pxBlock );
+					}
+					if( heapBLOCK_SIZE( pxBlock ) < xSmallest )
+					{
+						xSmallest = heapBLOCK_SIZE( pxBlock );
+					}
+					xBlocks++;
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = ( xBlocks != 0 ) ? xLargest - heapSTRUCT_SIZE : 0;
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( xBlocks != 0 ) ? xSmallest - heapSTRUCT_SIZE : 0;
+		pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
@@ -70,8 +70,8 @@ I2C_M_SETUP_Type *pxI2CTxTransferDefinition = NULL, *pxI2CRxTransferDefinition =
 		/* Polled mode is used by default.  This can be changed using an
 		ioctl() call.  Create the structures used to transfer I2C data in
 		polled mode. */
-		pxI2CTxTransferDefinition = ( I2C_M_SETUP_Type * ) pvPortMalloc( sizeof( I2C_M_SETUP_Type ) );
-		pxI2CRxTransferDefinition = ( I2C_M_SETUP_Type * ) pvPortMalloc( sizeof( I2C_M_SETUP_Type ) );
+		pxI2CTxTransferDefinition = ( I2C_M_SETUP_Type * ) pvIOUtilsAlloc( sizeof( I2C_M_SETUP_Type ) );
+		pxI2CRxTransferDefinition = ( I2C_M_SETUP_Type * ) pvIOUtilsAlloc( sizeof( I2C_M_SETUP_Type ) );
 
 		if( ( pxI2CTxTransferDefinition != NULL ) && ( pxI2CRxTransferDefinition != NULL ) )
 		{
@@ -111,23 +111,23 @@ I2C_M_SETUP_Type *pxI2CTxTransferDefinition = NULL, *pxI2CRxTransferDefinition =
 			not be created.  Delete anything that was created. */
 			if( pxI2CTxTransferDefinition != NULL )
 			{
-				vPortFree( pxI2CTxTransferDefinition );
+				vIOUtilsFree( pxI2CTxTransferDefinition );
 			}
 
 			if( pxI2CRxTransferDefinition != NULL )
 			{
-				vPortFree( pxI2CRxTransferDefinition );
+				vIOUtilsFree( pxI2CRxTransferDefinition );
 			}
 
 			if( pxPeripheralControl->pxTxControl != NULL )
 			{
-				vPortFree( pxPeripheralControl->pxTxControl );
+				vIOUtilsFree( pxPeripheralControl->pxTxControl );
 				pxPeripheralControl->pxTxControl = NULL;
 			}
 
 			if( pxPeripheralControl->pxRxControl != NULL )
 			{
-				vPortFree( pxPeripheralControl->pxRxControl );
+				vIOUtilsFree( pxPeripheralControl->pxRxControl );
 				pxPeripheralControl->pxRxControl = NULL;
 			}
 		}
@@ -451,6 +451,8 @@ portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 const unsigned portBASE_TYPE uxI2CNumber = 2UL;
 Transfer_Control_t *pxTransferStruct;
 
+	traceISR_ENTER( I2C2_IRQn );
+
 	/* Determine the event that caused the interrupt. */
 	ulI2CStatus = ( LPC_I2C2->I2STAT & I2C_STAT_CODE_BITMASK );
 
@@ -604,6 +606,7 @@ Transfer_Control_t *pxTransferStruct;
 	/* If lHigherPriorityTaskWoken is now equal to pdTRUE, then a context
 	switch should be performed before the interrupt exists.  That ensures the
 	unblocked (higher priority) task is returned to immediately. */
+	traceISR_EXIT( I2C2_IRQn );
 	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
 }
 
@@ -24,6 +24,11 @@
 #include "FreeRTOS_DriverInterface.h"
 #include "FreeRTOS_IOUtilsCommon.h"
 
+#if ioconfigUSE_POOL == 1
+	/* Pool the driver structures are allocated from. */
+	poolDEFINE( xIOPool, ioconfigPOOL_BLOCK_SIZE, ioconfigPOOL_BLOCKS );
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vIOUtilsCreateTransferControlStructure( Transfer_Control_t **ppxTransferControl )
@@ -34,7 +39,7 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 	if( pxTransferControl == NULL )
 	{
 		/* The transfer control structure does not exist.  Create it. */
-		*ppxTransferControl = ( Transfer_Control_t * ) pvPortMalloc( sizeof( Transfer_Control_t ) );
+		*ppxTransferControl = ( Transfer_Control_t * ) pvIOUtilsAlloc( sizeof( Transfer_Control_t ) );
 	}
 	else
 	{
@@ -55,7 +60,7 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 					to be deleted. */
 					pxZeroCopyState = ( Zero_Copy_Tx_State_t * ) ( pxTransferControl->pvTransferState );
 					vSemaphoreDelete( pxZeroCopyState->xWriteAccessMutex );
-					vPortFree( pxZeroCopyState );
+					vIOUtilsFree( pxZeroCopyState );
 				}
 				#endif /* ioconfigUSE_ZERO_COPY_TX */
 				break;
@@ -73,12 +78,30 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 					to be deleted. */
 					pxCharQueueState = ( Character_Queue_State_t * ) ( pxTransferControl->pvTransferState );
 					vQueueDelete( pxCharQueueState->xQueue );
-					vPortFree( pxCharQueueState );
+					vIOUtilsFree( pxCharQueueState );
 				}
 				#endif /* ( ioconfigUSE_TX_CHAR_QUEUE == 1 ) || ( ioconfigUSE_RX_CHAR_QUEUE == 1 ) */
 				break;
 
 
+			case ioctlUSE_STREAM_BUFFER_TX	:
+			case ioctlUSE_STREAM_BUFFER_RX	:
+
+				#if ( ioconfigUSE_TX_STREAM_BUFFER == 1 ) || ( ioconfigUSE_RX_STREAM_BUFFER == 1 )
+				{
+					Stream_Buffer_State_t *pxStreamBufferState;
+
+					/* In this case the pvTransferState member points to a stream
+					buffer state structure, which in turn contains a stream buffer
+					that needs to be deleted. */
+					pxStreamBufferState = ( Stream_Buffer_State_t * ) ( pxTransferControl->pvTransferState );
+					vStreamBufferDelete( pxStreamBufferState->xStreamBuffer );
+					vIOUtilsFree( pxStreamBufferState );
+				}
+				#endif /* ( ioconfigUSE_TX_STREAM_BUFFER == 1 ) || ( ioconfigUSE_RX_STREAM_BUFFER == 1 ) */
+				break;
+
+
 			case ioctlUSE_CIRCULAR_BUFFER_RX	:
 
 				#if ioconfigUSE_CIRCULAR_BUFFER_RX == 1
@@ -90,8 +113,8 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 					and a buffer, both of which need to be deleted. */
 					pxCircularBufferState = ( Circular_Buffer_Rx_State_t * ) ( pxTransferControl->pvTransferState );
 					vSemaphoreDelete( pxCircularBufferState->xNewDataSemaphore );
-					vPortFree( ( void * ) ( pxCircularBufferState->pucBufferStart ) );
-					vPortFree( pxCircularBufferState );
+					vIOUtilsFree( ( void * ) ( pxCircularBufferState->pucBufferStart ) );
+					vIOUtilsFree( pxCircularBufferState );
 				}
 				#endif /* ioconfigUSE_CIRCULAR_BUFFER_RX */
 				break;
@@ -100,7 +123,7 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 			case ioctlUSE_POLLED_TX	:
 
 				/* Default assumes no specific kernel objects are being used. */
-				vPortFree( pxTransferControl->pvTransferState );
+				vIOUtilsFree( pxTransferControl->pvTransferState );
 				break;
 
 
@@ -118,18 +141,72 @@ Transfer_Control_t *pxTransferControl = *ppxTransferControl;
 		pxTransferControl->pvTransferState = NULL;
 	}
 }
+/*-----------------------------------------------------------*/
 
+void *pvIOUtilsAlloc( size_t xSize )
+{
+void *pvReturn;
 
+	pvReturn = pvIOUtilsAllocFromISR( xSize );
 
+	if( pvReturn == NULL )
+	{
+		pvReturn = pvPortMalloc( xSize );
+	}
 
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
 
+void *pvIOUtilsAllocFromISR( size_t xSize )
+{
+void *pvReturn = NULL;
 
+	#if ioconfigUSE_POOL == 1
+	{
+		if( xSize <= ioconfigPOOL_BLOCK_SIZE )
+		{
+			pvReturn = pvPoolAlloc( &xIOPool );
+		}
+	}
+	#else
+	{
+		( void ) xSize;
+	}
+	#endif /* ioconfigUSE_POOL */
 
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
 
+void vIOUtilsFree( void *pv )
+{
+	#if ioconfigUSE_POOL == 1
+	{
+		if( xPoolContains( &xIOPool, pv ) == pdTRUE )
+		{
+			vPoolFree( &xIOPool, pv );
+		}
+		else
+		{
+			vPortFree( pv );
+		}
+	}
+	#else
+	{
+		vPortFree( pv );
+	}
+	#endif /* ioconfigUSE_POOL */
+}
+/*-----------------------------------------------------------*/
 
+#if ioconfigUSE_POOL == 1
 
+	void vIOUtilsGetPoolStats( xPoolStatsType *pxPoolStats )
+	{
+		vPoolGetStats( &xIOPool, pxPoolStats );
+	}
 
-
-
-
+#endif /* ioconfigUSE_POOL */
+/*-----------------------------------------------------------*/
 
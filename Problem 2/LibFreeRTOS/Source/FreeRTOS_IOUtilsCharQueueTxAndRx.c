@@ -68,7 +68,7 @@ Transfer_Control_t **ppxTransferControl;
 	if( *ppxTransferControl != NULL )
 	{
 		/* Create the necessary structure. */
-		pxQueueState = pvPortMalloc( sizeof( Character_Queue_State_t ) );
+		pxQueueState = pvIOUtilsAlloc( sizeof( Character_Queue_State_t ) );
 
 		if( pxQueueState != NULL )
 		{
@@ -92,7 +92,7 @@ Transfer_Control_t **ppxTransferControl;
 			{
 				/* The queue was not created successfully, free the
 				Character_Queue_State_t structure and just return an error. */
-				vPortFree( pxQueueState );
+				vIOUtilsFree( pxQueueState );
 				pxQueueState = NULL;
 			}
 		}
@@ -103,7 +103,7 @@ Transfer_Control_t **ppxTransferControl;
 			be created,	so the Tx control structure (which should point to it)
 			should also	be deleted. */
 			/* _RB_ Test this path. */
-			vPortFree( *ppxTransferControl );
+			vIOUtilsFree( *ppxTransferControl );
 			*ppxTransferControl = NULL;
 		}
 	}
@@ -38,7 +38,7 @@ Circular_Buffer_Rx_State_t *pxCircularBufferState;
 	if( pxPeripheralControl->pxRxControl != NULL )
 	{
 		/* Create the necessary structure. */
-		pxCircularBufferState = pvPortMalloc( sizeof( Circular_Buffer_Rx_State_t ) );
+		pxCircularBufferState = pvIOUtilsAlloc( sizeof( Circular_Buffer_Rx_State_t ) );
 
 		if( pxCircularBufferState != NULL )
 		{
@@ -56,7 +56,7 @@ Circular_Buffer_Rx_State_t *pxCircularBufferState;
 				/* First ensure the semaphore starts in the desired state. */
 				xSemaphoreTake( pxCircularBufferState->xNewDataSemaphore, 0U );
 
-				pxCircularBufferState->pucBufferStart = pvPortMalloc( xBufferSize );
+				pxCircularBufferState->pucBufferStart = pvIOUtilsAlloc( xBufferSize );
 
 				if( pxCircularBufferState->pucBufferStart != NULL )
 				{
@@ -85,7 +85,7 @@ Circular_Buffer_Rx_State_t *pxCircularBufferState;
 				/* The semaphore was not created successfully, or the buffer
 				could not be allocated so the semaphore has been deleted.  Free
 				the	Circular_Buffer_Rx_State_t structure and just return an error. */
-				vPortFree( pxCircularBufferState );
+				vIOUtilsFree( pxCircularBufferState );
 				pxCircularBufferState = NULL;
 			}
 		}
@@ -95,7 +95,7 @@ Circular_Buffer_Rx_State_t *pxCircularBufferState;
 			/* The Rx structure, or a member it contains,  could not be created,
 			so the Rx control structure (which should point to it) should also
 			be deleted. */
-			vPortFree( pxPeripheralControl->pxRxControl );
+			vIOUtilsFree( pxPeripheralControl->pxRxControl );
 			pxPeripheralControl->pxRxControl = NULL;
 		}
 	}
@@ -0,0 +1,242 @@
+/**************************************************************************//**
+ *
+ * @file        IOUtilsStreamBufferTxAndRx.c
+ * @brief       Part of FreeRTOS+IO
+ * @author      Real Time Engineers Ltd.
+ * @version     1.0.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2012 Real Time Engineers ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+/* Standard includes. */
+#include "string.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Semaphore.h"
+
+/* Device specific library includes. */
+#include "FreeRTOS_DriverInterface.h"
+#include "FreeRTOS_IOUtilsCommon.h"
+
+/* Sent in place of data when a write is made from a NULL buffer, which is
+done to generate the clock for SPI/SSP reads. */
+static const uint8_t ucFFBlock[ ioutilsSTREAM_BUFFER_FIFO_BLOCK ] =
+{
+	0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU,
+	0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU
+};
+
+/*-----------------------------------------------------------*/
+
+void vIOUtilsSetTxStreamBufferTimeout( Peripheral_Control_t * const pxPeripheralControl, const portTickType xMaxWaitTime )
+{
+Stream_Buffer_State_t *pxTxState = prvTX_STREAM_BUFFER_STATE( pxPeripheralControl );
+
+	pxTxState->xBlockTime = xMaxWaitTime;
+}
+/*-----------------------------------------------------------*/
+
+void vIOUtilsSetRxStreamBufferTimeout( Peripheral_Control_t * const pxPeripheralControl, const portTickType xMaxWaitTime )
+{
+Stream_Buffer_State_t *pxRxState = prvRX_STREAM_BUFFER_STATE( pxPeripheralControl );
+
+	pxRxState->xBlockTime = xMaxWaitTime;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xIOUtilsSetRxStreamBufferTriggerLevel( Peripheral_Control_t * const pxPeripheralControl, const size_t xTriggerLevel )
+{
+Stream_Buffer_State_t *pxRxState = prvRX_STREAM_BUFFER_STATE( pxPeripheralControl );
+
+	/* A reader is only woken once this many bytes have arrived, so a task
+	reading fixed size records is not woken once per interrupt. */
+	return xStreamBufferSetTriggerLevel( pxRxState->xStreamBuffer, xTriggerLevel );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xIOUtilsConfigureStreamBuffer( Peripheral_Control_t * const pxPeripheralControl, const uint32_t ulRequest, const size_t xBufferSize )
+{
+portBASE_TYPE xReturn = pdFAIL;
+Stream_Buffer_State_t *pxStreamBufferState;
+Transfer_Control_t **ppxTransferControl;
+
+	/* The interrupts move up to a FIFO's worth of bytes per call, so the
+	buffer must be able to hold at least that many. */
+	configASSERT( xBufferSize > ioutilsSTREAM_BUFFER_FIFO_BLOCK );
+
+	if( ulRequest == ioctlUSE_STREAM_BUFFER_TX )
+	{
+		ppxTransferControl = &( pxPeripheralControl->pxTxControl );
+	}
+	else
+	{
+		ppxTransferControl = &( pxPeripheralControl->pxRxControl );
+	}
+
+	/* A peripheral is going to use a stream buffer to control transmission
+	or reception. */
+	vIOUtilsCreateTransferControlStructure( ppxTransferControl );
+	configASSERT( *ppxTransferControl );
+
+	if( *ppxTransferControl != NULL )
+	{
+		/* Create the necessary structure. */
+		pxStreamBufferState = pvIOUtilsAlloc( sizeof( Stream_Buffer_State_t ) );
+
+		if( pxStreamBufferState != NULL )
+		{
+			/* The structure just created contains a stream buffer handle.
+			Create the stream buffer too.  The trigger level starts at one
+			byte, so reads behave as they do with the character queue until
+			it is changed with ioctlSET_RX_TRIGGER_LEVEL. */
+			pxStreamBufferState->xStreamBuffer = xStreamBufferCreate( xBufferSize, ( size_t ) 1 );
+
+			if( pxStreamBufferState->xStreamBuffer != NULL )
+			{
+				/* The stream buffer was created correctly.  Fill in the
+				private data structure. */
+				pxStreamBufferState->xBlockTime = portMAX_DELAY;
+				pxStreamBufferState->usErrorState = pdFALSE;
+				( *ppxTransferControl )->pvTransferState = ( void * ) pxStreamBufferState;
+				( *ppxTransferControl )->ucType = ( uint8_t ) ulRequest;
+				xReturn = pdPASS;
+			}
+			else
+			{
+				/* The stream buffer was not created successfully, free the
+				Stream_Buffer_State_t structure and just return an error. */
+				vIOUtilsFree( pxStreamBufferState );
+				pxStreamBufferState = NULL;
+			}
+		}
+
+		if( pxStreamBufferState == NULL )
+		{
+			/* The transfer structure, or a member it contains, could not be
+			created, so the transfer control structure (which should point to
+			it) should also be deleted. */
+			vIOUtilsFree( *ppxTransferControl );
+			*ppxTransferControl = NULL;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xIOUtilsSendToTxStreamBuffer( Stream_Buffer_State_t * const pxTxState, const uint8_t * const pucBuffer, const size_t xBytesSent, const size_t xTotalBytes, const portTickType xTicksToWait )
+{
+size_t xBytesToSend, xSent = 0U, xChunk, xWritten;
+
+	configASSERT( xBytesSent <= xTotalBytes );
+	xBytesToSend = xTotalBytes - xBytesSent;
+
+	if( xTicksToWait != 0U )
+	{
+		/* When blocking, only wait for a FIFO's worth of space.  Waiting for
+		space for the whole remainder would never finish if the remainder is
+		larger than the buffer. */
+		if( xBytesToSend > ioutilsSTREAM_BUFFER_FIFO_BLOCK )
+		{
+			xBytesToSend = ioutilsSTREAM_BUFFER_FIFO_BLOCK;
+		}
+	}
+
+	if( pucBuffer == NULL )
+	{
+		/* Having a null buffer just means send 0xff.  This is necessary for
+		SPI/SSP. */
+		while( xSent < xBytesToSend )
+		{
+			xChunk = xBytesToSend - xSent;
+			if( xChunk > sizeof( ucFFBlock ) )
+			{
+				xChunk = sizeof( ucFFBlock );
+			}
+
+			xWritten = xStreamBufferSend( pxTxState->xStreamBuffer, ucFFBlock, xChunk, xTicksToWait );
+			xSent += xWritten;
+
+			if( xWritten != xChunk )
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		xSent = xStreamBufferSend( pxTxState->xStreamBuffer, &( pucBuffer[ xBytesSent ] ), xBytesToSend, xTicksToWait );
+	}
+
+	return xSent;
+}
+/*-----------------------------------------------------------*/
+
+size_t xIOUtilsReceiveFromRxStreamBuffer( Peripheral_Control_t * const pxPeripheralControl, uint8_t * const pucBuffer, const size_t xTotalBytes )
+{
+size_t xBytesReceived = 0U;
+portTickType xTicksToWait;
+xTimeOutType xTimeOut;
+Stream_Buffer_State_t *pxTransferState = prvRX_STREAM_BUFFER_STATE( pxPeripheralControl );
+
+	xTicksToWait = pxTransferState->xBlockTime;
+	vTaskSetTimeOutState( &xTimeOut );
+
+	/* Are there any more bytes to be received? */
+	while( xBytesReceived < xTotalBytes )
+	{
+		/* Take everything that is there, up to the number still wanted, in
+		one copy. */
+		xBytesReceived += xStreamBufferReceive( pxTransferState->xStreamBuffer, &( pucBuffer[ xBytesReceived ] ), xTotalBytes - xBytesReceived, xTicksToWait );
+
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+		{
+			/* Time out has expired. */
+			break;
+		}
+	}
+
+	return xBytesReceived;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xIOUtilsWaitTxStreamBufferEmpty( Peripheral_Control_t * const pxPeripheralControl, const portTickType xMaxWaitTime )
+{
+portBASE_TYPE xReturn = pdTRUE;
+Stream_Buffer_State_t *pxTransferControlState = prvTX_STREAM_BUFFER_STATE( pxPeripheralControl );
+portTickType xTimeOnEntering;
+const portTickType xPollDelay = ( portTickType ) 2;
+
+	configASSERT( pxTransferControlState );
+
+	xTimeOnEntering = xTaskGetTickCount();
+	while( xStreamBufferIsEmpty( pxTransferControlState->xStreamBuffer ) == pdFALSE )
+	{
+		/* As with the character queue, the task does not use any CPU time
+		while in the Blocked state between polls. */
+		vTaskDelay( xPollDelay );
+		if( ( xTaskGetTickCount() - xTimeOnEntering ) >= xMaxWaitTime )
+		{
+			xReturn = pdFALSE;
+			break;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vIOUtilsClearRxStreamBuffer( Peripheral_Control_t * const pxPeripheralControl )
+{
+Stream_Buffer_State_t *pxStreamBufferState = prvRX_STREAM_BUFFER_STATE( pxPeripheralControl );
+
+	configASSERT( pxStreamBufferState );
+	( void ) xStreamBufferReset( pxStreamBufferState->xStreamBuffer );
+	pxStreamBufferState->usErrorState = pdFALSE;
+}
+/*-----------------------------------------------------------*/
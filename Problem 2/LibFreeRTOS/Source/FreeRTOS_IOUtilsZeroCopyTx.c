@@ -39,7 +39,7 @@ Zero_Copy_Tx_State_t *pxZeroCopyState;
 	if( pxPeripheralControl->pxTxControl != NULL )
 	{
 		/* Create the necessary structure. */
-		pxZeroCopyState = pvPortMalloc( sizeof( Zero_Copy_Tx_State_t ) );
+		pxZeroCopyState = pvIOUtilsAlloc( sizeof( Zero_Copy_Tx_State_t ) );
 
 		if( pxZeroCopyState != NULL )
 		{
@@ -62,7 +62,7 @@ Zero_Copy_Tx_State_t *pxZeroCopyState;
 			{
 				/* The semaphore was not created successfully, free the
 				Zero_Copy_Tx_State_t structure and just return an error. */
-				vPortFree( pxZeroCopyState );
+				vIOUtilsFree( pxZeroCopyState );
 				pxZeroCopyState = NULL;
 			}
 		}
@@ -72,7 +72,7 @@ Zero_Copy_Tx_State_t *pxZeroCopyState;
 			/* The Tx structure, or a member it contains,  could not be created,
 			so the Tx control structure (which should point to it) should also
 			be deleted. */
-			vPortFree( pxPeripheralControl->pxTxControl );
+			vIOUtilsFree( pxPeripheralControl->pxTxControl );
 			pxPeripheralControl->pxTxControl = NULL;
 		}
 	}
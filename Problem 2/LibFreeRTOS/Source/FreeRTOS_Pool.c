@@ -0,0 +1,157 @@
+/**************************************************************************//**
+ *
+ * @file        Pool.c
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+/*
+ * Fixed-block pools.  A pool is an array of equally sized blocks.  Blocks that
+ * have never been used are handed out by advancing pucNextUnused, so a pool
+ * defined with poolDEFINE() needs no initialisation call; blocks that have been
+ * freed are kept on a singly linked list threaded through their first word.
+ * Both paths are a handful of instructions, run with basepri raised to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY so interrupts that use the kernel are
+ * held off, while higher priority interrupts are never delayed.  The mask is
+ * restored to its previous value rather than cleared, so the functions can
+ * also be called from inside a critical section.
+ */
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Pool.h"
+
+/* Free blocks are linked through their first word. */
+typedef struct xPOOL_FREE_BLOCK
+{
+	struct xPOOL_FREE_BLOCK *pxNextFreeBlock;
+} xPoolFreeBlock;
+
+/*-----------------------------------------------------------*/
+
+void vPoolInitialise( xPoolType *pxPool, void *pvStorage, size_t xBlockSize, unsigned portBASE_TYPE uxNumberOfBlocks )
+{
+	configASSERT( pxPool );
+	configASSERT( ( ( ( unsigned long ) pvStorage ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+	pxPool->xBlockSize = poolBLOCK_SIZE( xBlockSize );
+	pxPool->pvFreeList = NULL;
+	pxPool->pucStart = ( unsigned char * ) pvStorage;
+	pxPool->pucNextUnused = pxPool->pucStart;
+	pxPool->pucEnd = pxPool->pucStart + ( pxPool->xBlockSize * uxNumberOfBlocks );
+	pxPool->uxNumberOfBlocks = uxNumberOfBlocks;
+	pxPool->uxBlocksFree = uxNumberOfBlocks;
+	pxPool->uxMinimumEverFree = uxNumberOfBlocks;
+	pxPool->ulAllocations = 0UL;
+	pxPool->ulFailures = 0UL;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPoolAlloc( xPoolType *pxPool )
+{
+void *pvReturn = NULL;
+xPoolFreeBlock *pxBlock;
+unsigned long ulSavedInterruptMask;
+
+	ulSavedInterruptMask = portRAISE_INTERRUPT_MASK();
+	{
+		if( pxPool->pvFreeList != NULL )
+		{
+			/* Reuse the block that was freed most recently, it is the most
+			likely to still be in the cache on parts that have one. */
+			pxBlock = ( xPoolFreeBlock * ) pxPool->pvFreeList;
+			pxPool->pvFreeList = ( void * ) pxBlock->pxNextFreeBlock;
+			pvReturn = ( void * ) pxBlock;
+		}
+		else if( pxPool->pucNextUnused < pxPool->pucEnd )
+		{
+			/* Nothing has been freed yet, carve the next block off the part
+			of the storage that has never been used. */
+			pvReturn = ( void * ) pxPool->pucNextUnused;
+			pxPool->pucNextUnused += pxPool->xBlockSize;
+		}
+
+		if( pvReturn != NULL )
+		{
+			pxPool->uxBlocksFree--;
+			pxPool->ulAllocations++;
+
+			if( pxPool->uxBlocksFree < pxPool->uxMinimumEverFree )
+			{
+				pxPool->uxMinimumEverFree = pxPool->uxBlocksFree;
+			}
+		}
+		else
+		{
+			pxPool->ulFailures++;
+		}
+	}
+	portRESTORE_INTERRUPT_MASK( ulSavedInterruptMask );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPoolFree( xPoolType *pxPool, void *pv )
+{
+xPoolFreeBlock *pxBlock = ( xPoolFreeBlock * ) pv;
+unsigned long ulSavedInterruptMask;
+
+	if( pv != NULL )
+	{
+		/* The block must have come from this pool. */
+		configASSERT( xPoolContains( pxPool, pv ) );
+		configASSERT( ( ( ( unsigned char * ) pv - pxPool->pucStart ) % pxPool->xBlockSize ) == 0 );
+
+		ulSavedInterruptMask = portRAISE_INTERRUPT_MASK();
+		{
+			pxBlock->pxNextFreeBlock = ( xPoolFreeBlock * ) pxPool->pvFreeList;
+			pxPool->pvFreeList = ( void * ) pxBlock;
+			pxPool->uxBlocksFree++;
+		}
+		portRESTORE_INTERRUPT_MASK( ulSavedInterruptMask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPoolContains( const xPoolType *pxPool, const void *pv )
+{
+const unsigned char *puc = ( const unsigned char * ) pv;
+portBASE_TYPE xReturn;
+
+	/* The bounds never change once the pool is set up, so no need to mask
+	interrupts. */
+	if( ( puc >= pxPool->pucStart ) && ( puc < pxPool->pucEnd ) )
+	{
+		xReturn = pdTRUE;
+	}
+	else
+	{
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPoolGetStats( xPoolType *pxPool, xPoolStatsType *pxPoolStats )
+{
+unsigned long ulSavedInterruptMask;
+
+	ulSavedInterruptMask = portRAISE_INTERRUPT_MASK();
+	{
+		pxPoolStats->xBlockSize = pxPool->xBlockSize;
+		pxPoolStats->uxNumberOfBlocks = pxPool->uxNumberOfBlocks;
+		pxPoolStats->uxBlocksFree = pxPool->uxBlocksFree;
+		pxPoolStats->uxMinimumEverFree = pxPool->uxMinimumEverFree;
+		pxPoolStats->ulAllocations = pxPool->ulAllocations;
+		pxPoolStats->ulFailures = pxPool->ulFailures;
+	}
+	portRESTORE_INTERRUPT_MASK( ulSavedInterruptMask );
+}
+/*-----------------------------------------------------------*/
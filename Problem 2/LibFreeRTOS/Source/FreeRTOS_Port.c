@@ -29,15 +29,50 @@ FreeRTOS.org versions prior to V4.4.0 did not include this definition. */
 /* Constants required to manipulate the NVIC. */
 #define portNVIC_SYSTICK_CTRL		( ( volatile unsigned long *) 0xe000e010 )
 #define portNVIC_SYSTICK_LOAD		( ( volatile unsigned long *) 0xe000e014 )
+#define portNVIC_SYSTICK_CURRENT	( ( volatile unsigned long *) 0xe000e018 )
 #define portNVIC_INT_CTRL			( ( volatile unsigned long *) 0xe000ed04 )
 #define portNVIC_SYSPRI2			( ( volatile unsigned long *) 0xe000ed20 )
 #define portNVIC_SYSTICK_CLK		0x00000004
 #define portNVIC_SYSTICK_INT		0x00000002
 #define portNVIC_SYSTICK_ENABLE		0x00000001
+#define portNVIC_SYSTICK_COUNT_FLAG	0x00010000
 #define portNVIC_PENDSVSET			0x10000000
 #define portNVIC_PENDSV_PRI			( ( ( unsigned long ) configKERNEL_INTERRUPT_PRIORITY ) << 16 )
 #define portNVIC_SYSTICK_PRI		( ( ( unsigned long ) configKERNEL_INTERRUPT_PRIORITY ) << 24 )
 
+/* SysTick is 24 bits. */
+#define portMAX_24_BIT_NUMBER		( 0xffffffUL )
+
+/* Cycles lost each time SysTick is stopped and restarted around a sleep,
+found by stepping through vPortSuppressTicksAndSleep(). */
+#define portMISSED_COUNTS_FACTOR	( 45UL )
+
+/* Constants required to set up the MPU stack guard.  The guard region is
+32 bytes, read only to everyone, so the high water marks can still be read,
+and never executable.  The base address is moved on each context switch by
+portSET_STACK_GUARD(). */
+#if configUSE_MPU_STACK_GUARD == 1
+	#define portMPU_TYPE						( ( volatile unsigned long * ) 0xe000ed90 )
+	#define portMPU_CTRL						( ( volatile unsigned long * ) 0xe000ed94 )
+	#define portMPU_REGION_NUMBER				( ( volatile unsigned long * ) 0xe000ed98 )
+	#define portMPU_REGION_ATTRIBUTE_AND_SIZE	( ( volatile unsigned long * ) 0xe000eda0 )
+	#define portNVIC_SYSHND_CTRL				( ( volatile unsigned long * ) 0xe000ed24 )
+	#define portNVIC_MEM_FAULT_STATUS			( ( volatile unsigned char * ) 0xe000ed28 )
+	#define portNVIC_MEM_FAULT_ADDRESS			( ( volatile unsigned long * ) 0xe000ed34 )
+
+	#define portMPU_ENABLE						( 0x01UL )
+	#define portMPU_BACKGROUND_ENABLE			( 1UL << 2UL )
+	#define portMPU_REGION_ENABLE				( 0x01UL )
+	#define portMPU_REGION_SIZE_32_BYTES		( 4UL << 1UL )
+	#define portMPU_REGION_READ_ONLY			( 0x06UL << 24UL )
+	#define portMPU_REGION_EXECUTE_NEVER		( 1UL << 28UL )
+	#define portMPU_REGION_CACHEABLE_BUFFERABLE	( 0x07UL << 16UL )
+	#define portMPU_REGION_COUNT( ulType )		( ( ( ulType ) >> 8UL ) & 0xffUL )
+	#define portNVIC_MEM_FAULT_ENABLE			( 1UL << 16UL )
+	#define portMEM_FAULT_STACKING				( 0x10U )
+	#define portMEM_FAULT_ADDRESS_VALID			( 0x80U )
+#endif
+
 /* Constants required to set up the initial stack. */
 #define portINITIAL_XPSR			( 0x01000000 )
 
@@ -49,17 +84,45 @@ const unsigned long ulKernelPriority = configKERNEL_INTERRUPT_PRIORITY;
 variable. */
 static unsigned portBASE_TYPE uxCriticalNesting = 0xaaaaaaaa;
 
+/* Tick interrupts actually taken, and ticks that went by while asleep
+without one.  Read with vPortGetTickStats(). */
+static volatile unsigned long ulTickInterrupts = 0UL;
+static unsigned long ulSuppressedTicks = 0UL;
+
+/*
+ * The number of SysTick increments that make up one tick period, the most
+ * tick periods that fit in the 24 bit counter, and the compensation for the
+ * time SysTick is stopped for.  Worked out when the scheduler starts, as
+ * configCPU_CLOCK_HZ is SystemCoreClock rather than a constant.
+ */
+#if configUSE_TICKLESS_IDLE == 1
+	static unsigned long ulTimerCountsForOneTick = 0;
+	static unsigned long xMaximumPossibleSuppressedTicks = 0;
+	static unsigned long ulStoppedTimerCompensation = 0;
+#endif /* configUSE_TICKLESS_IDLE */
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
 static void prvSetupTimerInterrupt( void );
 
+/*
+ * Set up the MPU region that guards the bottom of the running task's stack
+ * and enable the MemManage fault that catches a write to it.
+ */
+#if configUSE_MPU_STACK_GUARD == 1
+	static void prvSetupStackGuard( void );
+#endif
+
 /*
  * Exception handlers.
  */
 void xPortPendSVHandler( void ) __attribute__ (( naked ));
 void xPortSysTickHandler( void );
 void vPortSVCHandler( void ) __attribute__ (( naked ));
+#if configUSE_MPU_STACK_GUARD == 1
+	void xPortMemManageHandler( void );
+#endif
 
 /*
  * Start first task is a separate function so it can be tested in isolation.
@@ -135,6 +198,13 @@ portBASE_TYPE xPortStartScheduler( void )
 	here already. */
 	prvSetupTimerInterrupt();
 
+	/* The kernel has already moved the guard to the first task. */
+	#if configUSE_MPU_STACK_GUARD == 1
+	{
+		prvSetupStackGuard();
+	}
+	#endif
+
 	/* Initialise the critical nesting count ready for the first task. */
 	uxCriticalNesting = 0;
 
@@ -223,21 +293,247 @@ unsigned long ulDummy;
 
 	ulDummy = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
+		ulTickInterrupts++;
 		vTaskIncrementTick();
 	}
 	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulDummy );
 }
 /*-----------------------------------------------------------*/
 
+#if configUSE_MPU_STACK_GUARD == 1
+
+	void xPortMemManageHandler( void )
+	{
+	unsigned char ucStatus = *( portNVIC_MEM_FAULT_STATUS );
+	unsigned long ulGuard;
+
+		/* Either the exception entry stacking onto the task stack went into
+		the guard, which is the only region a task stack can fault in, or a
+		write inside the guard did.  The task that overflowed is still the
+		current one in both cases, even when the fault was PendSV saving its
+		registers, as that happens before vTaskSwitchContext() is called. */
+		*( portMPU_REGION_NUMBER ) = portMPU_GUARD_REGION;
+		ulGuard = *( portMPU_REGION_BASE_ADDRESS ) & ~( portSTACK_GUARD_SIZE - 1UL );
+
+		if( ( ucStatus & portMEM_FAULT_STACKING ) != 0U )
+		{
+			vTaskStackGuardFault();
+		}
+		else if( ( ( ucStatus & portMEM_FAULT_ADDRESS_VALID ) != 0U ) && ( ( *( portNVIC_MEM_FAULT_ADDRESS ) - ulGuard ) < portSTACK_GUARD_SIZE ) )
+		{
+			vTaskStackGuardFault();
+		}
+
+		/* Nothing to return to, the stack below the task is not known to be
+		intact and the faulting instruction would only run again. */
+		for( ;; );
+	}
+
+#endif /* configUSE_MPU_STACK_GUARD */
+/*-----------------------------------------------------------*/
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+	{
+	unsigned long ulReloadValue, ulCompleteTickPeriods, ulCompletedSysTickDecrements, ulSysTickCTRL;
+	portTickType xModifiableIdleTime;
+
+		/* Make sure the SysTick reload value does not overflow the counter. */
+		if( xExpectedIdleTime > xMaximumPossibleSuppressedTicks )
+		{
+			xExpectedIdleTime = xMaximumPossibleSuppressedTicks;
+		}
+
+		/* Stop the SysTick momentarily.  The time the SysTick is stopped for
+		is accounted for as best it can be, but using the tickless mode will
+		inevitably result in some tiny drift of the time maintained by the
+		kernel with respect to calendar time. */
+		*(portNVIC_SYSTICK_CTRL) &= ~portNVIC_SYSTICK_ENABLE;
+
+		/* Calculate the reload value required to wait xExpectedIdleTime
+		tick periods.  -1 is used because this code will execute part way
+		through one of the tick periods. */
+		ulReloadValue = *(portNVIC_SYSTICK_CURRENT) + ( ulTimerCountsForOneTick * ( xExpectedIdleTime - 1UL ) );
+		if( ulReloadValue > ulStoppedTimerCompensation )
+		{
+			ulReloadValue -= ulStoppedTimerCompensation;
+		}
+
+		/* Enter a critical section but don't use the taskENTER_CRITICAL()
+		method as that will mask interrupts that should exit sleep mode. */
+		__asm volatile( "cpsid i" );
+
+		/* If a context switch is pending or a task is waiting for the scheduler
+		to be unsuspended then abandon the low power entry. */
+		if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+		{
+			/* Restart from whatever is left in the count register to complete
+			this tick period. */
+			*(portNVIC_SYSTICK_LOAD) = *(portNVIC_SYSTICK_CURRENT);
+
+			/* Restart SysTick. */
+			*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+
+			/* Reset the reload register to the value required for normal tick
+			periods. */
+			*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
+
+			/* Re-enable interrupts. */
+			__asm volatile( "cpsie i" );
+		}
+		else
+		{
+			/* Set the new reload value. */
+			*(portNVIC_SYSTICK_LOAD) = ulReloadValue;
+
+			/* Clear the SysTick count flag and set the count value back to
+			zero. */
+			*(portNVIC_SYSTICK_CURRENT) = 0UL;
+
+			/* Restart SysTick. */
+			*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+
+			/* Sleep until something happens.  configPRE_SLEEP_PROCESSING() can
+			set its parameter to 0 to indicate that its implementation contains
+			its own wait for interrupt or wait for event instruction, and so wfi
+			should not be executed again.  However, the original expected idle
+			time variable must remain unmodified, so a copy is taken. */
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+			if( xModifiableIdleTime > 0 )
+			{
+				__asm volatile( "dsb" );
+				__asm volatile( "wfi" );
+				__asm volatile( "isb" );
+			}
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			/* Stop SysTick.  Again, the time the SysTick is stopped for is
+			accounted for as best it can be, but using the tickless mode will
+			inevitably result in some tiny drift of the time maintained by the
+			kernel with respect to calendar time. */
+			ulSysTickCTRL = *(portNVIC_SYSTICK_CTRL);
+			*(portNVIC_SYSTICK_CTRL) = ( ulSysTickCTRL & ~portNVIC_SYSTICK_ENABLE );
+
+			/* Re-enable interrupts - see comments above the cpsid instruction
+			above. */
+			__asm volatile( "cpsie i" );
+
+			if( ( ulSysTickCTRL & portNVIC_SYSTICK_COUNT_FLAG ) != 0 )
+			{
+			unsigned long ulCalculatedLoadValue;
+
+				/* The tick interrupt has already executed, and the SysTick
+				count reloaded with ulReloadValue.  Reset the load register
+				with whatever remains of this tick period. */
+				ulCalculatedLoadValue = ( ulTimerCountsForOneTick - 1UL ) - ( ulReloadValue - *(portNVIC_SYSTICK_CURRENT) );
+
+				/* Don't allow a tiny value, or values that have somehow
+				underflowed because the post sleep hook did something
+				that took too long. */
+				if( ( ulCalculatedLoadValue < ulStoppedTimerCompensation ) || ( ulCalculatedLoadValue > ulTimerCountsForOneTick ) )
+				{
+					ulCalculatedLoadValue = ( ulTimerCountsForOneTick - 1UL );
+				}
+
+				*(portNVIC_SYSTICK_LOAD) = ulCalculatedLoadValue;
+
+				/* The tick interrupt handler will already have pended the tick
+				processing in the kernel.  As the pending tick will be
+				processed as soon as this function exits, the tick value
+				maintained by the tick is stepped forward by one less than the
+				time spent waiting. */
+				ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+			}
+			else
+			{
+				/* Something other than the tick interrupt ended the sleep.
+				Work out how long the sleep lasted rounded to complete tick
+				periods (not the ulReload value which accounted for part
+				ticks). */
+				ulCompletedSysTickDecrements = ( xExpectedIdleTime * ulTimerCountsForOneTick ) - *(portNVIC_SYSTICK_CURRENT);
+
+				/* How many complete tick periods passed while the processor
+				was waiting? */
+				ulCompleteTickPeriods = ulCompletedSysTickDecrements / ulTimerCountsForOneTick;
+
+				/* The reload value is set to whatever fraction of a single tick
+				period remains. */
+				*(portNVIC_SYSTICK_LOAD) = ( ( ulCompleteTickPeriods + 1 ) * ulTimerCountsForOneTick ) - ulCompletedSysTickDecrements;
+			}
+
+			/* Restart SysTick so it runs from the load register again, then
+			set the load register back to its standard value.  The critical
+			section is used to ensure the tick interrupt can only execute once
+			in the case that the reload register is near zero. */
+			*(portNVIC_SYSTICK_CURRENT) = 0UL;
+			portENTER_CRITICAL();
+			{
+				*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+				vTaskStepTick( ulCompleteTickPeriods );
+				ulSuppressedTicks += ulCompleteTickPeriods;
+				*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
+			}
+			portEXIT_CRITICAL();
+		}
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+void vPortGetTickStats( unsigned long *pulTickInterrupts, unsigned long *pulSuppressedTicks )
+{
+	portENTER_CRITICAL();
+	{
+		*pulTickInterrupts = ulTickInterrupts;
+		*pulSuppressedTicks = ulSuppressedTicks;
+	}
+	portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
 /*
  * Setup the systick timer to generate the tick interrupts at the required
  * frequency.
  */
 void prvSetupTimerInterrupt( void )
 {
+	/* Calculate the constants required to configure the tick interrupt. */
+	#if configUSE_TICKLESS_IDLE == 1
+	{
+		ulTimerCountsForOneTick = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ );
+		xMaximumPossibleSuppressedTicks = portMAX_24_BIT_NUMBER / ulTimerCountsForOneTick;
+		ulStoppedTimerCompensation = portMISSED_COUNTS_FACTOR;
+	}
+	#endif /* configUSE_TICKLESS_IDLE */
+
 	/* Configure SysTick to interrupt at the requested rate. */
 	*(portNVIC_SYSTICK_LOAD) = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) - 1UL;
 	*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
 }
 /*-----------------------------------------------------------*/
 
+#if configUSE_MPU_STACK_GUARD == 1
+
+	static void prvSetupStackGuard( void )
+	{
+		/* The guard is the highest numbered region on the Cortex-M3, which
+		has eight. */
+		configASSERT( portMPU_REGION_COUNT( *( portMPU_TYPE ) ) > portMPU_GUARD_REGION );
+
+		*( portMPU_REGION_NUMBER ) = portMPU_GUARD_REGION;
+		*( portMPU_REGION_ATTRIBUTE_AND_SIZE ) = portMPU_REGION_READ_ONLY | portMPU_REGION_EXECUTE_NEVER | portMPU_REGION_CACHEABLE_BUFFERABLE |
+												 portMPU_REGION_SIZE_32_BYTES | portMPU_REGION_ENABLE;
+
+		/* Everything else keeps the default memory map, then writes into the
+		guard fault as MemManage rather than escalating to HardFault. */
+		*( portMPU_CTRL ) = portMPU_ENABLE | portMPU_BACKGROUND_ENABLE;
+		*( portNVIC_SYSHND_CTRL ) |= portNVIC_MEM_FAULT_ENABLE;
+
+		__asm volatile( "dsb" );
+		__asm volatile( "isb" );
+	}
+
+#endif /* configUSE_MPU_STACK_GUARD */
+/*-----------------------------------------------------------*/
@@ -60,6 +60,7 @@ zero. */
 #define queueQUEUE_TYPE_COUNTING_SEMAPHORE	( 2U )
 #define queueQUEUE_TYPE_BINARY_SEMAPHORE	( 3U )
 #define queueQUEUE_TYPE_RECURSIVE_MUTEX		( 4U )
+#define queueQUEUE_TYPE_SET					( 0U )
 
 /*
  * Definition of the queue used by the scheduler.
@@ -83,12 +84,30 @@ typedef struct QueueDefinition
 	signed portBASE_TYPE xRxLock;			/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	signed portBASE_TYPE xTxLock;			/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 
+	#if ( configUSE_QUEUE_SETS == 1 )
+		struct QueueDefinition *pxQueueSetContainer;	/*< The queue set this queue belongs to, or NULL if it is not a member of a set. */
+	#endif
+
+	#if ( configUSE_LOCK_PROFILER == 1 )
+		xLockProfileType *pxLockProfile;	/*< Where the lock profiler keeps this semaphore's figures, NULL if it is not a semaphore or was not given a record. */
+	#endif
+
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		unsigned char ucQueueNumber;
 		unsigned char ucQueueType;
 	#endif
 
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the memory was supplied by the application, so is not freed when the queue is deleted. */
+	#endif
+
 } xQUEUE;
+
+/*
+ * xStaticQueueType in FreeRTOS.h must be exactly the same size as an xQUEUE.
+ * This fails to compile if the two have drifted apart.
+ */
+typedef char xStaticQueueTypeSizeCheck[ ( sizeof( xStaticQueueType ) == sizeof( xQUEUE ) ) ? 1 : -1 ];
 /*-----------------------------------------------------------*/
 
 /*
@@ -97,6 +116,8 @@ typedef struct QueueDefinition
  * pointer to void.
  */
 typedef xQUEUE * xQueueHandle;
+typedef xQUEUE * xQueueSetHandle;
+typedef void * xQueueSetMemberHandle;
 
 /*
  * Prototypes for public functions are included here so we don't have to
@@ -112,6 +133,9 @@ signed portBASE_TYPE xQueueGenericReceive( xQueueHandle pxQueue, void * const pv
 signed portBASE_TYPE xQueueReceiveFromISR( xQueueHandle pxQueue, void * const pvBuffer, signed portBASE_TYPE *pxTaskWoken ) PRIVILEGED_FUNCTION;
 xQueueHandle xQueueCreateMutex( unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount ) PRIVILEGED_FUNCTION;
+xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueueType *pxStaticQueue ) PRIVILEGED_FUNCTION;
+xQueueHandle xQueueCreateCountingSemaphoreStatic( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount, xStaticQueueType *pxStaticQueue ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueTakeMutexRecursive( xQueueHandle xMutex, portTickType xBlockTime ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle xMutex ) PRIVILEGED_FUNCTION;
 signed portBASE_TYPE xQueueAltGenericSend( xQueueHandle pxQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition ) PRIVILEGED_FUNCTION;
@@ -125,6 +149,16 @@ void vQueueSetQueueNumber( xQueueHandle pxQueue, unsigned char ucQueueNumber ) P
 unsigned char ucQueueGetQueueType( xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue ) PRIVILEGED_FUNCTION;
 xTaskHandle xQueueGetMutexHolder( xQueueHandle xSemaphore ) PRIVILEGED_FUNCTION;
+xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength ) PRIVILEGED_FUNCTION;
+portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet ) PRIVILEGED_FUNCTION;
+portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet ) PRIVILEGED_FUNCTION;
+xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks ) PRIVILEGED_FUNCTION;
+xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet ) PRIVILEGED_FUNCTION;
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+	unsigned portBASE_TYPE uxQueueGetLockProfile( xLockProfileType *pxLockProfileArray, unsigned portBASE_TYPE uxArraySize, unsigned portBASE_TYPE *puxNotProfiled ) PRIVILEGED_FUNCTION;
+	void vQueueResetLockProfile( void ) PRIVILEGED_FUNCTION;
+#endif
 
 /*
  * Co-routine queue functions differ from task queue functions.  Co-routines are
@@ -197,6 +231,60 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
  * Copies an item out of a queue.
  */
 static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a queue whose memory has already been found, however it was found.
+ * pcStorage is where the items go.
+ */
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, signed char *pcStorage, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a mutex whose memory has already been found and gives it.
+ */
+#if ( configUSE_MUTEXES == 1 )
+
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	/*
+	 * Checks to see if a queue is a member of a queue set, and if so, notifies
+	 * the queue set that the queue contains data.  Returns pdTRUE if a task of
+	 * higher priority than the calling task was unblocked by the notification.
+	 */
+	static portBASE_TYPE prvNotifyQueueSetContainer( const xQUEUE * const pxQueue, portBASE_TYPE xCopyPosition ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	/* The lock profiler's records, one per semaphore or mutex.  A NULL pvLock
+	marks a free one. */
+	PRIVILEGED_DATA static xLockProfileType xLockProfiles[ configLOCK_PROFILER_SIZE ];
+
+	/* Semaphores and mutexes created while every record was in use. */
+	PRIVILEGED_DATA static unsigned portBASE_TYPE uxLocksNotProfiled = ( unsigned portBASE_TYPE ) 0U;
+
+	/*
+	 * Gives a new semaphore or mutex a lock profiler record if there is one
+	 * free.  Queues that hold items are not profiled.
+	 */
+	static void prvLockProfileClaim( xQUEUE *pxQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Record a take that is about to block for the first time, a take that
+	 * got the semaphore, a take that blocked and gave up, and a give.  All
+	 * must be called from a critical section, or with interrupts masked from
+	 * an ISR.  prvLockProfileContended() returns the time the wait started.
+	 */
+	static unsigned long prvLockProfileContended( const xQUEUE * const pxQueue ) PRIVILEGED_FUNCTION;
+	static void prvLockProfileTaken( const xQUEUE * const pxQueue, portBASE_TYPE xWaited, unsigned long ulWaitStart ) PRIVILEGED_FUNCTION;
+	static void prvLockProfileTimedOut( const xQUEUE * const pxQueue, unsigned long ulWaitStart ) PRIVILEGED_FUNCTION;
+	static void prvLockProfileGiven( const xQUEUE * const pxQueue ) PRIVILEGED_FUNCTION;
+
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -262,103 +350,204 @@ portBASE_TYPE xReturn = pdPASS;
 }
 /*-----------------------------------------------------------*/
 
-xQueueHandle xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType )
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, signed char *pcStorage, unsigned char ucQueueType )
 {
-xQUEUE *pxNewQueue;
-size_t xQueueSizeInBytes;
-xQueueHandle xReturn = NULL;
-
 	/* Remove compiler warnings about unused parameters should
 	configUSE_TRACE_FACILITY not be set to 1. */
 	( void ) ucQueueType;
 
-	/* Allocate the new queue structure. */
-	if( uxQueueLength > ( unsigned portBASE_TYPE ) 0 )
+	/* Initialise the queue members as described above where the queue type
+	is defined. */
+	pxNewQueue->pcHead = pcStorage;
+	pxNewQueue->uxLength = uxQueueLength;
+	pxNewQueue->uxItemSize = uxItemSize;
+	xQueueGenericReset( pxNewQueue, pdTRUE );
+	#if ( configUSE_TRACE_FACILITY == 1 )
 	{
-		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
-		if( pxNewQueue != NULL )
-		{
-			/* Create the list of pointers to queue items.  The queue is one byte
-			longer than asked for to make wrap checking easier/faster. */
-			xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ) + ( size_t ) 1;
+		pxNewQueue->ucQueueType = ucQueueType;
+	}
+	#endif /* configUSE_TRACE_FACILITY */
+
+	#if ( configUSE_QUEUE_SETS == 1 )
+	{
+		pxNewQueue->pxQueueSetContainer = NULL;
+	}
+	#endif /* configUSE_QUEUE_SETS */
+
+	#if ( configUSE_LOCK_PROFILER == 1 )
+	{
+		prvLockProfileClaim( pxNewQueue, ucQueueType );
+	}
+	#endif
+
+	traceQUEUE_CREATE( pxNewQueue );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType )
+	{
+	xQUEUE *pxNewQueue;
+	size_t xQueueSizeInBytes;
+	signed char *pcStorage;
+	xQueueHandle xReturn = NULL;
 
-			pxNewQueue->pcHead = ( signed char * ) pvPortMalloc( xQueueSizeInBytes );
-			if( pxNewQueue->pcHead != NULL )
+		/* Allocate the new queue structure. */
+		if( uxQueueLength > ( unsigned portBASE_TYPE ) 0 )
+		{
+			pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
+			if( pxNewQueue != NULL )
 			{
-				/* Initialise the queue members as described above where the
-				queue type is defined. */
-				pxNewQueue->uxLength = uxQueueLength;
-				pxNewQueue->uxItemSize = uxItemSize;
-				xQueueGenericReset( pxNewQueue, pdTRUE );
-				#if ( configUSE_TRACE_FACILITY == 1 )
+				/* Create the list of pointers to queue items.  The queue is one byte
+				longer than asked for to make wrap checking easier/faster. */
+				xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ) + ( size_t ) 1;
+
+				pcStorage = ( signed char * ) pvPortMalloc( xQueueSizeInBytes );
+				if( pcStorage != NULL )
+				{
+					#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+					{
+						pxNewQueue->ucStaticallyAllocated = pdFALSE;
+					}
+					#endif
+
+					prvInitialiseNewQueue( pxNewQueue, uxQueueLength, uxItemSize, pcStorage, ucQueueType );
+					xReturn = pxNewQueue;
+				}
+				else
 				{
-					pxNewQueue->ucQueueType = ucQueueType;
+					traceQUEUE_CREATE_FAILED( ucQueueType );
+					vPortFree( pxNewQueue );
 				}
-				#endif /* configUSE_TRACE_FACILITY */
+			}
+		}
+
+		configASSERT( xReturn );
+
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueueType *pxStaticQueue, unsigned char ucQueueType )
+	{
+	xQUEUE *pxNewQueue = NULL;
+	signed char *pcStorage;
+
+		configASSERT( uxQueueLength > ( unsigned portBASE_TYPE ) 0 );
+		configASSERT( pxStaticQueue != NULL );
+
+		/* Items need storage, semaphores don't. */
+		configASSERT( !( ( pucQueueStorage == NULL ) && ( uxItemSize != ( unsigned portBASE_TYPE ) 0U ) ) );
+
+		if( ( uxQueueLength > ( unsigned portBASE_TYPE ) 0 ) && ( pxStaticQueue != NULL ) )
+		{
+			/* The queue lives in the buffer supplied, which is the same size. */
+			pxNewQueue = ( xQUEUE * ) pxStaticQueue;
 
-				traceQUEUE_CREATE( pxNewQueue );
-				xReturn = pxNewQueue;
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = pdTRUE;
+			}
+			#endif
+
+			/* Nothing is ever copied in or out of a semaphore, but pcHead must
+			not be NULL as that marks a mutex.  Point it at the queue itself. */
+			if( uxItemSize == ( unsigned portBASE_TYPE ) 0U )
+			{
+				pcStorage = ( signed char * ) pxNewQueue;
 			}
 			else
 			{
-				traceQUEUE_CREATE_FAILED( ucQueueType );
-				vPortFree( pxNewQueue );
+				pcStorage = ( signed char * ) pucQueueStorage;
 			}
+
+			prvInitialiseNewQueue( pxNewQueue, uxQueueLength, uxItemSize, pcStorage, ucQueueType );
+		}
+		else
+		{
+			traceQUEUE_CREATE_FAILED( ucQueueType );
 		}
-	}
 
-	configASSERT( xReturn );
+		return pxNewQueue;
+	}
 
-	return xReturn;
-}
+#endif /* configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
 #if ( configUSE_MUTEXES == 1 )
 
-	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType )
 	{
-	xQUEUE *pxNewQueue;
-
 		/* Prevent compiler warnings about unused parameters if
 		configUSE_TRACE_FACILITY does not equal 1. */
 		( void ) ucQueueType;
 
+		/* Information required for priority inheritance. */
+		pxNewQueue->pxMutexHolder = NULL;
+		pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
+
+		/* Queues used as a mutex no data is actually copied into or out
+		of the queue. */
+		pxNewQueue->pcWriteTo = NULL;
+		pxNewQueue->pcReadFrom = NULL;
+
+		/* Each mutex has a length of 1 (like a binary semaphore) and
+		an item size of 0 as nothing is actually copied into or out
+		of the mutex. */
+		pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
+		pxNewQueue->uxLength = ( unsigned portBASE_TYPE ) 1U;
+		pxNewQueue->uxItemSize = ( unsigned portBASE_TYPE ) 0U;
+		pxNewQueue->xRxLock = queueUNLOCKED;
+		pxNewQueue->xTxLock = queueUNLOCKED;
+
+		#if ( configUSE_TRACE_FACILITY == 1 )
+		{
+			pxNewQueue->ucQueueType = ucQueueType;
+		}
+		#endif
+
+		/* Ensure the event queues start with the correct state. */
+		vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
+		vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+
+		#if ( configUSE_LOCK_PROFILER == 1 )
+		{
+			/* Before the give below, which looks for the record. */
+			prvLockProfileClaim( pxNewQueue, ucQueueType );
+		}
+		#endif
+
+		traceCREATE_MUTEX( pxNewQueue );
+
+		/* Start with the semaphore in the expected state. */
+		xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
+	{
+	xQUEUE *pxNewQueue;
+
 		/* Allocate the new queue structure. */
 		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
 		if( pxNewQueue != NULL )
 		{
-			/* Information required for priority inheritance. */
-			pxNewQueue->pxMutexHolder = NULL;
-			pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
-
-			/* Queues used as a mutex no data is actually copied into or out
-			of the queue. */
-			pxNewQueue->pcWriteTo = NULL;
-			pxNewQueue->pcReadFrom = NULL;
-
-			/* Each mutex has a length of 1 (like a binary semaphore) and
-			an item size of 0 as nothing is actually copied into or out
-			of the mutex. */
-			pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
-			pxNewQueue->uxLength = ( unsigned portBASE_TYPE ) 1U;
-			pxNewQueue->uxItemSize = ( unsigned portBASE_TYPE ) 0U;
-			pxNewQueue->xRxLock = queueUNLOCKED;
-			pxNewQueue->xTxLock = queueUNLOCKED;
-
-			#if ( configUSE_TRACE_FACILITY == 1 )
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
-				pxNewQueue->ucQueueType = ucQueueType;
+				pxNewQueue->ucStaticallyAllocated = pdFALSE;
 			}
 			#endif
 
-			/* Ensure the event queues start with the correct state. */
-			vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
-			vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
-
-			traceCREATE_MUTEX( pxNewQueue );
-
-			/* Start with the semaphore in the expected state. */
-			xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
 		}
 		else
 		{
@@ -372,6 +561,35 @@ xQueueHandle xReturn = NULL;
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEXES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueueType *pxStaticQueue )
+	{
+	xQUEUE *pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+		configASSERT( pxNewQueue );
+
+		if( pxNewQueue != NULL )
+		{
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = pdTRUE;
+			}
+			#endif
+
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
+		}
+		else
+		{
+			traceCREATE_MUTEX_FAILED();
+		}
+
+		return pxNewQueue;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_MUTEXES == 1 )
 
 	void* xQueueGetMutexHolder( xQueueHandle xSemaphore )
@@ -482,7 +700,7 @@ xQueueHandle xReturn = NULL;
 #endif /* configUSE_RECURSIVE_MUTEXES */
 /*-----------------------------------------------------------*/
 
-#if configUSE_COUNTING_SEMAPHORES == 1
+#if ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 
 	xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount )
 	{
@@ -508,6 +726,32 @@ xQueueHandle xReturn = NULL;
 #endif /* configUSE_COUNTING_SEMAPHORES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueCreateCountingSemaphoreStatic( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount, xStaticQueueType *pxStaticQueue )
+	{
+	xQueueHandle pxHandle;
+
+		pxHandle = xQueueGenericCreateStatic( ( unsigned portBASE_TYPE ) uxCountValue, queueSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, pxStaticQueue, queueQUEUE_TYPE_COUNTING_SEMAPHORE );
+
+		if( pxHandle != NULL )
+		{
+			pxHandle->uxMessagesWaiting = uxInitialCount;
+
+			traceCREATE_COUNTING_SEMAPHORE();
+		}
+		else
+		{
+			traceCREATE_COUNTING_SEMAPHORE_FAILED();
+		}
+
+		configASSERT( pxHandle );
+		return pxHandle;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 signed portBASE_TYPE xQueueGenericSend( xQueueHandle pxQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition )
 {
 signed portBASE_TYPE xEntryTimeSet = pdFALSE;
@@ -530,19 +774,45 @@ xTimeOutType xTimeOut;
 				traceQUEUE_SEND( pxQueue );
 				prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
 
-				/* If there was a task waiting for data to arrive on the
-				queue then unblock it now. */
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				#if ( configUSE_QUEUE_SETS == 1 )
 				{
-					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) == pdTRUE )
+					if( pxQueue->pxQueueSetContainer != NULL )
 					{
-						/* The unblocked task has a priority higher than
-						our own so yield immediately.  Yes it is ok to do
-						this from within the critical section - the kernel
-						takes care of that. */
-						portYIELD_WITHIN_API();
+						/* The queue is a member of a queue set, so it is the
+						set, not this queue, that any waiting task is
+						blocked on. */
+						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) == pdTRUE )
+						{
+							portYIELD_WITHIN_API();
+						}
+					}
+					else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) == pdTRUE )
+						{
+							/* The unblocked task has a priority higher than
+							our own so yield immediately. */
+							portYIELD_WITHIN_API();
+						}
 					}
 				}
+				#else /* configUSE_QUEUE_SETS */
+				{
+					/* If there was a task waiting for data to arrive on the
+					queue then unblock it now. */
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) == pdTRUE )
+						{
+							/* The unblocked task has a priority higher than
+							our own so yield immediately.  Yes it is ok to do
+							this from within the critical section - the kernel
+							takes care of that. */
+							portYIELD_WITHIN_API();
+						}
+					}
+				}
+				#endif /* configUSE_QUEUE_SETS */
 
 				taskEXIT_CRITICAL();
 
@@ -859,15 +1129,39 @@ unsigned portBASE_TYPE uxSavedInterruptStatus;
 			be done when the queue is unlocked later. */
 			if( pxQueue->xTxLock == queueUNLOCKED )
 			{
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				#if ( configUSE_QUEUE_SETS == 1 )
+				{
+					if( pxQueue->pxQueueSetContainer != NULL )
+					{
+						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) == pdTRUE )
+						{
+							/* The queue is a member of a queue set, and
+							posting to the queue set caused a higher priority
+							task to unblock. */
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
+					}
+					else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+						{
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
+					}
+				}
+				#else /* configUSE_QUEUE_SETS */
 				{
-					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
 					{
-						/* The task waiting has a higher priority so record that a
-						context	switch is required. */
-						*pxHigherPriorityTaskWoken = pdTRUE;
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+						{
+							/* The task waiting has a higher priority so record that a
+							context	switch is required. */
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
 					}
 				}
+				#endif /* configUSE_QUEUE_SETS */
 			}
 			else
 			{
@@ -895,6 +1189,10 @@ signed portBASE_TYPE xQueueGenericReceive( xQueueHandle pxQueue, void * const pv
 signed portBASE_TYPE xEntryTimeSet = pdFALSE;
 xTimeOutType xTimeOut;
 signed char *pcOriginalReadPosition;
+#if ( configUSE_LOCK_PROFILER == 1 )
+	portBASE_TYPE xWaited = pdFALSE;
+	unsigned long ulWaitStart = 0UL;
+#endif
 
 	configASSERT( pxQueue );
 	configASSERT( !( ( pvBuffer == NULL ) && ( pxQueue->uxItemSize != ( unsigned portBASE_TYPE ) 0U ) ) );
@@ -934,6 +1232,12 @@ signed char *pcOriginalReadPosition;
 					}
 					#endif
 
+					#if ( configUSE_LOCK_PROFILER == 1 )
+					{
+						prvLockProfileTaken( pxQueue, xWaited, ulWaitStart );
+					}
+					#endif
+
 					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
 					{
 						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) == pdTRUE )
@@ -974,6 +1278,15 @@ signed char *pcOriginalReadPosition;
 				{
 					/* The queue was empty and no block time is specified (or
 					the block time has expired) so leave now. */
+					#if ( configUSE_LOCK_PROFILER == 1 )
+					{
+						if( xWaited != pdFALSE )
+						{
+							prvLockProfileTimedOut( pxQueue, ulWaitStart );
+						}
+					}
+					#endif
+
 					taskEXIT_CRITICAL();
 					traceQUEUE_RECEIVE_FAILED( pxQueue );
 					return errQUEUE_EMPTY;
@@ -1002,6 +1315,22 @@ signed char *pcOriginalReadPosition;
 			{
 				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
 
+				#if ( configUSE_LOCK_PROFILER == 1 )
+				{
+					/* Only the first block counts, a task woken by a give
+					can lose the semaphore again to a higher priority one. */
+					if( xWaited == pdFALSE )
+					{
+						portENTER_CRITICAL();
+						{
+							ulWaitStart = prvLockProfileContended( pxQueue );
+						}
+						portEXIT_CRITICAL();
+						xWaited = pdTRUE;
+					}
+				}
+				#endif
+
 				#if ( configUSE_MUTEXES == 1 )
 				{
 					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
@@ -1033,6 +1362,20 @@ signed char *pcOriginalReadPosition;
 		{
 			prvUnlockQueue( pxQueue );
 			( void ) xTaskResumeAll();
+
+			#if ( configUSE_LOCK_PROFILER == 1 )
+			{
+				if( xWaited != pdFALSE )
+				{
+					taskENTER_CRITICAL();
+					{
+						prvLockProfileTimedOut( pxQueue, ulWaitStart );
+					}
+					taskEXIT_CRITICAL();
+				}
+			}
+			#endif
+
 			traceQUEUE_RECEIVE_FAILED( pxQueue );
 			return errQUEUE_EMPTY;
 		}
@@ -1127,8 +1470,36 @@ void vQueueDelete( xQueueHandle pxQueue )
 
 	traceQUEUE_DELETE( pxQueue );
 	vQueueUnregisterQueue( pxQueue );
-	vPortFree( pxQueue->pcHead );
-	vPortFree( pxQueue );
+
+	#if ( configUSE_LOCK_PROFILER == 1 )
+	{
+		if( pxQueue->pxLockProfile != NULL )
+		{
+			/* Free the record for the next semaphore created. */
+			taskENTER_CRITICAL();
+			{
+				pxQueue->pxLockProfile->pvLock = NULL;
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+	#endif
+
+	/* Memory the application supplied is left alone. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
+	{
+		vPortFree( pxQueue->pcHead );
+		vPortFree( pxQueue );
+	}
+	#elif ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	{
+		if( pxQueue->ucStaticallyAllocated == pdFALSE )
+		{
+			vPortFree( pxQueue->pcHead );
+			vPortFree( pxQueue );
+		}
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -1162,6 +1533,166 @@ void vQueueDelete( xQueueHandle pxQueue )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	static void prvLockProfileClaim( xQUEUE *pxQueue, unsigned char ucQueueType )
+	{
+	unsigned portBASE_TYPE ux;
+
+		pxQueue->pxLockProfile = NULL;
+
+		if( pxQueue->uxItemSize == ( unsigned portBASE_TYPE ) 0U )
+		{
+			taskENTER_CRITICAL();
+			{
+				for( ux = ( unsigned portBASE_TYPE ) 0U; ux < ( unsigned portBASE_TYPE ) configLOCK_PROFILER_SIZE; ux++ )
+				{
+					if( xLockProfiles[ ux ].pvLock == NULL )
+					{
+						memset( ( void * ) &( xLockProfiles[ ux ] ), 0x00, sizeof( xLockProfileType ) );
+						xLockProfiles[ ux ].pvLock = ( void * ) pxQueue;
+						xLockProfiles[ ux ].ucQueueType = ucQueueType;
+						pxQueue->pxLockProfile = &( xLockProfiles[ ux ] );
+						break;
+					}
+				}
+
+				if( pxQueue->pxLockProfile == NULL )
+				{
+					++uxLocksNotProfiled;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	static unsigned long prvLockProfileContended( const xQUEUE * const pxQueue )
+	{
+	xLockProfileType *pxProfile = pxQueue->pxLockProfile;
+
+		if( pxProfile != NULL )
+		{
+			++( pxProfile->ulContentions );
+
+			/* Waiting on a lower priority holder is a priority inversion.
+			Mutexes bound it by lending the holder this task's priority just
+			after this, binary semaphores do not. */
+			#if ( INCLUDE_uxTaskPriorityGet == 1 )
+			{
+			void *pvCurrentTask = ( void * ) xTaskGetCurrentTaskHandle();
+
+				if( ( pxProfile->pvHolder != NULL ) && ( pxProfile->pvHolder != pvCurrentTask ) )
+				{
+					if( uxTaskPriorityGet( ( xTaskHandle ) pxProfile->pvHolder ) < uxTaskPriorityGet( NULL ) )
+					{
+						++( pxProfile->ulInversions );
+					}
+				}
+			}
+			#endif
+		}
+
+		return portGET_RUN_TIME_COUNTER_VALUE();
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	static void prvLockProfileTaken( const xQUEUE * const pxQueue, portBASE_TYPE xWaited, unsigned long ulWaitStart )
+	{
+	xLockProfileType *pxProfile = pxQueue->pxLockProfile;
+	unsigned long ulNow, ulWait;
+	void *pvCurrentTask;
+
+		if( pxProfile != NULL )
+		{
+			ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			pvCurrentTask = ( void * ) xTaskGetCurrentTaskHandle();
+
+			++( pxProfile->ulTakes );
+
+			if( xWaited != pdFALSE )
+			{
+				ulWait = ulNow - ulWaitStart;
+				pxProfile->ulWaitTotal += ulWait;
+				if( ulWait > pxProfile->ulWaitMax )
+				{
+					pxProfile->ulWaitMax = ulWait;
+					pxProfile->pvLongestWaiter = pvCurrentTask;
+				}
+			}
+
+			/* Only a semaphore with a count of one has a single holder. */
+			if( pxQueue->uxLength == ( unsigned portBASE_TYPE ) 1U )
+			{
+				pxProfile->pvHolder = pvCurrentTask;
+				pxProfile->ulTakenAt = ulNow;
+			}
+		}
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	static void prvLockProfileTimedOut( const xQUEUE * const pxQueue, unsigned long ulWaitStart )
+	{
+	xLockProfileType *pxProfile = pxQueue->pxLockProfile;
+	unsigned long ulWait;
+
+		if( pxProfile != NULL )
+		{
+			++( pxProfile->ulTimeouts );
+
+			ulWait = portGET_RUN_TIME_COUNTER_VALUE() - ulWaitStart;
+			pxProfile->ulWaitTotal += ulWait;
+			if( ulWait > pxProfile->ulWaitMax )
+			{
+				pxProfile->ulWaitMax = ulWait;
+				pxProfile->pvLongestWaiter = ( void * ) xTaskGetCurrentTaskHandle();
+			}
+		}
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	static void prvLockProfileGiven( const xQUEUE * const pxQueue )
+	{
+	xLockProfileType *pxProfile = pxQueue->pxLockProfile;
+	unsigned long ulHold;
+
+		/* The give when a semaphore is created, and gives to a semaphore
+		nobody has taken, have no hold to end. */
+		if( pxProfile != NULL )
+		{
+			if( pxProfile->pvHolder != NULL )
+			{
+				ulHold = portGET_RUN_TIME_COUNTER_VALUE() - pxProfile->ulTakenAt;
+				pxProfile->ulHoldTotal += ulHold;
+				if( ulHold > pxProfile->ulHoldMax )
+				{
+					pxProfile->ulHoldMax = ulHold;
+					pxProfile->pvLongestHolder = pxProfile->pvHolder;
+				}
+				pxProfile->pvHolder = NULL;
+			}
+		}
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
 static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, portBASE_TYPE xPosition )
 {
 	if( pxQueue->uxItemSize == ( unsigned portBASE_TYPE ) 0 )
@@ -1176,6 +1707,12 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
 			}
 		}
 		#endif
+
+		#if ( configUSE_LOCK_PROFILER == 1 )
+		{
+			prvLockProfileGiven( pxQueue );
+		}
+		#endif
 	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
@@ -1227,6 +1764,24 @@ static void prvUnlockQueue( xQueueHandle pxQueue )
 		/* See if data was added to the queue while it was locked. */
 		while( pxQueue->xTxLock > queueLOCKED_UNMODIFIED )
 		{
+			#if ( configUSE_QUEUE_SETS == 1 )
+			{
+				if( pxQueue->pxQueueSetContainer != NULL )
+				{
+					/* Data was posted to a member of a queue set while it was
+					locked, so tell the set now.  The item is always added to
+					the back of the set. */
+					if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) == pdTRUE )
+					{
+						vTaskMissedYield();
+					}
+
+					--( pxQueue->xTxLock );
+					continue;
+				}
+			}
+			#endif /* configUSE_QUEUE_SETS */
+
 			/* Data was posted while the queue was locked.  Are any tasks
 			blocked waiting for data to become available? */
 			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
@@ -1582,6 +2137,88 @@ signed portBASE_TYPE xReturn;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	unsigned portBASE_TYPE uxQueueGetLockProfile( xLockProfileType *pxLockProfileArray, unsigned portBASE_TYPE uxArraySize, unsigned portBASE_TYPE *puxNotProfiled )
+	{
+	unsigned portBASE_TYPE ux, uxCount = ( unsigned portBASE_TYPE ) 0U;
+
+		/* Copy the records in one go so every figure in each is from the same
+		moment. */
+		taskENTER_CRITICAL();
+		{
+			for( ux = ( unsigned portBASE_TYPE ) 0U; ux < ( unsigned portBASE_TYPE ) configLOCK_PROFILER_SIZE; ux++ )
+			{
+				if( ( xLockProfiles[ ux ].pvLock != NULL ) && ( uxCount < uxArraySize ) )
+				{
+					pxLockProfileArray[ uxCount ] = xLockProfiles[ ux ];
+					uxCount++;
+				}
+			}
+
+			if( puxNotProfiled != NULL )
+			{
+				*puxNotProfiled = uxLocksNotProfiled;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Names come from the queue registry, outside the critical section. */
+		for( ux = ( unsigned portBASE_TYPE ) 0U; ux < uxCount; ux++ )
+		{
+			pxLockProfileArray[ ux ].pcLockName = NULL;
+
+			#if configQUEUE_REGISTRY_SIZE > 0
+			{
+			unsigned portBASE_TYPE uxEntry;
+
+				for( uxEntry = ( unsigned portBASE_TYPE ) 0U; uxEntry < ( unsigned portBASE_TYPE ) configQUEUE_REGISTRY_SIZE; uxEntry++ )
+				{
+					if( ( xQueueRegistry[ uxEntry ].pcQueueName != NULL ) && ( ( void * ) xQueueRegistry[ uxEntry ].xHandle == pxLockProfileArray[ ux ].pvLock ) )
+					{
+						pxLockProfileArray[ ux ].pcLockName = xQueueRegistry[ uxEntry ].pcQueueName;
+						break;
+					}
+				}
+			}
+			#endif
+		}
+
+		return uxCount;
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LOCK_PROFILER == 1 )
+
+	void vQueueResetLockProfile( void )
+	{
+	unsigned portBASE_TYPE ux;
+
+		/* Which lock each record is for, and any hold in progress, are kept. */
+		taskENTER_CRITICAL();
+		{
+			for( ux = ( unsigned portBASE_TYPE ) 0U; ux < ( unsigned portBASE_TYPE ) configLOCK_PROFILER_SIZE; ux++ )
+			{
+				xLockProfiles[ ux ].pvLongestHolder = NULL;
+				xLockProfiles[ ux ].pvLongestWaiter = NULL;
+				xLockProfiles[ ux ].ulTakes = 0UL;
+				xLockProfiles[ ux ].ulContentions = 0UL;
+				xLockProfiles[ ux ].ulTimeouts = 0UL;
+				xLockProfiles[ ux ].ulInversions = 0UL;
+				xLockProfiles[ ux ].ulWaitTotal = 0UL;
+				xLockProfiles[ ux ].ulWaitMax = 0UL;
+				xLockProfiles[ ux ].ulHoldTotal = 0UL;
+				xLockProfiles[ ux ].ulHoldMax = 0UL;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_LOCK_PROFILER */
+/*-----------------------------------------------------------*/
+
 #if configUSE_TIMERS == 1
 
 	void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait )
@@ -1611,3 +2248,168 @@ signed portBASE_TYPE xReturn;
 
 #endif
 
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength )
+	{
+	xQueueSetHandle pxQueue;
+
+		pxQueue = xQueueGenericCreate( uxEventQueueLength, sizeof( xQUEUE * ), queueQUEUE_TYPE_SET );
+
+		return pxQueue;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet )
+	{
+	portBASE_TYPE xReturn;
+
+		configASSERT( xQueueOrSemaphore );
+		configASSERT( xQueueSet );
+
+		taskENTER_CRITICAL();
+		{
+			if( ( ( xQUEUE * ) xQueueOrSemaphore )->pxQueueSetContainer != NULL )
+			{
+				/* Cannot add a queue/semaphore to more than one queue set. */
+				xReturn = pdFAIL;
+			}
+			else if( ( ( xQUEUE * ) xQueueOrSemaphore )->uxMessagesWaiting != ( unsigned portBASE_TYPE ) 0 )
+			{
+				/* Cannot add a queue/semaphore to a queue set if there are
+				already items in the queue/semaphore, as the set would not
+				hold a matching entry for them. */
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				( ( xQUEUE * ) xQueueOrSemaphore )->pxQueueSetContainer = ( xQUEUE * ) xQueueSet;
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet )
+	{
+	portBASE_TYPE xReturn;
+	xQUEUE * const pxQueueOrSemaphore = ( xQUEUE * ) xQueueOrSemaphore;
+
+		configASSERT( pxQueueOrSemaphore );
+
+		taskENTER_CRITICAL();
+		{
+			if( pxQueueOrSemaphore->pxQueueSetContainer != ( xQUEUE * ) xQueueSet )
+			{
+				/* The queue was not a member of the set. */
+				xReturn = pdFAIL;
+			}
+			else if( pxQueueOrSemaphore->uxMessagesWaiting != ( unsigned portBASE_TYPE ) 0 )
+			{
+				/* It is dangerous to remove a queue from a set when the queue
+				is not empty because the queue set will still hold pending
+				events for the queue. */
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				/* The queue is no longer contained in the set. */
+				pxQueueOrSemaphore->pxQueueSetContainer = NULL;
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks )
+	{
+	xQueueSetMemberHandle xReturn = NULL;
+
+		( void ) xQueueGenericReceive( ( xQueueHandle ) xQueueSet, &xReturn, xBlockTimeTicks, pdFALSE );
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet )
+	{
+	xQueueSetMemberHandle xReturn = NULL;
+	signed portBASE_TYPE xTaskWoken = pdFALSE;
+
+		/* Nothing ever blocks sending to a queue set, so reading one cannot
+		unblock a task and xTaskWoken can be ignored. */
+		( void ) xQueueReceiveFromISR( ( xQueueHandle ) xQueueSet, &xReturn, &xTaskWoken );
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	static portBASE_TYPE prvNotifyQueueSetContainer( const xQUEUE * const pxQueue, portBASE_TYPE xCopyPosition )
+	{
+	xQUEUE *pxQueueSetContainer = pxQueue->pxQueueSetContainer;
+	portBASE_TYPE xReturn = pdFALSE;
+
+		/* This function must be called from a critical section. */
+
+		configASSERT( pxQueueSetContainer );
+
+		/* The set is sized to hold an entry for every item its members can
+		hold, so it can never be full here. */
+		configASSERT( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength );
+
+		if( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength )
+		{
+			traceQUEUE_SET_SEND( pxQueueSetContainer );
+
+			/* The data copied is the handle of the queue that contains data. */
+			prvCopyDataToQueue( pxQueueSetContainer, &pxQueue, xCopyPosition );
+
+			if( pxQueueSetContainer->xTxLock == queueUNLOCKED )
+			{
+				if( listLIST_IS_EMPTY( &( pxQueueSetContainer->xTasksWaitingToReceive ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueueSetContainer->xTasksWaitingToReceive ) ) != pdFALSE )
+					{
+						/* The task waiting has a higher priority. */
+						xReturn = pdTRUE;
+					}
+				}
+			}
+			else
+			{
+				/* A task is part way through reading the set.  It will look at
+				the event list when it unlocks the set. */
+				++( pxQueueSetContainer->xTxLock );
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
@@ -91,7 +91,7 @@ volatile uint16_t usJunkIt;
 	{
 		/* Polled mode is used by default.  Create the structure used to
 		transfer SSP data in polled mode. */
-		pxSSPTransferDefinition = ( SSP_DATA_SETUP_Type * ) pvPortMalloc( sizeof( SSP_DATA_SETUP_Type ) );
+		pxSSPTransferDefinition = ( SSP_DATA_SETUP_Type * ) pvIOUtilsAlloc( sizeof( SSP_DATA_SETUP_Type ) );
 
 		if( pxSSPTransferDefinition != NULL )
 		{
@@ -138,17 +138,17 @@ volatile uint16_t usJunkIt;
 				exiting. */
 				if( pxPeripheralControl->pxTxControl != NULL )
 				{
-					vPortFree( pxPeripheralControl->pxTxControl );
+					vIOUtilsFree( pxPeripheralControl->pxTxControl );
 					pxPeripheralControl->pxTxControl = NULL;
 				}
 
 				if( pxPeripheralControl->pxRxControl != NULL )
 				{
-					vPortFree( pxPeripheralControl->pxRxControl );
+					vIOUtilsFree( pxPeripheralControl->pxRxControl );
 					pxPeripheralControl->pxRxControl = NULL;
 				}
 
-				vPortFree( pxSSPTransferDefinition );
+				vIOUtilsFree( pxSSPTransferDefinition );
 			}
 		}
 	}
@@ -250,6 +250,30 @@ const uint32_t ulPeripheralNumber = ( uint32_t ) diGET_PERIPHERAL_NUMBER( ( ( Pe
 			break;
 
 
+		case ioctlUSE_STREAM_BUFFER_TX :
+
+			#if ioconfigUSE_SSP_TX_STREAM_BUFFER == 1
+			{
+				/* The Rx interrupt reads the stream buffer when it refills the
+				Tx FIFO, so it is disabled while this task tops the FIFO up.
+				Only one task may write at a time.  A NULL pvBuffer sends 0xff,
+				which is how a read generates its clock. */
+				ioutilsBLOCKING_SEND_TO_TX_STREAM_BUFFER
+					(
+						pxPeripheralControl,
+						SSP_IntConfig( pxSSP, sspRX_DATA_AVAILABLE_INTERRUPTS, DISABLE ),	/* Disable Rx interrupt. */
+						SSP_IntConfig( pxSSP, sspRX_DATA_AVAILABLE_INTERRUPTS, ENABLE ),	/* Enable Rx interrupt. */
+						sspMAX_FIFO_DEPTH,													/* Bytes to write to the FIFO. */
+						( pxSSP->SR & SSP_STAT_TXFIFO_NOTFULL ) != 0UL,						/* FIFO not full. */
+						pxSSP->DR = SSP_DR_BITMASK( ( uint16_t ) ucChar ),					/* Tx function. */
+						( ( const uint8_t * ) pvBuffer ),									/* Data source. */
+						xBytes,																/* Number of bytes to be written. */
+						xReturn );
+			}
+			#endif /* ioconfigUSE_SSP_TX_STREAM_BUFFER */
+			break;
+
+
 		default :
 
 			/* Other methods can be implemented here.  For now, set the stored
@@ -395,6 +419,37 @@ const int8_t cPeripheralNumber = diGET_PERIPHERAL_NUMBER( ( ( Peripheral_Control
 			break;
 
 
+		case ioctlUSE_STREAM_BUFFER_RX :
+
+			/* Only one task may read at a time, as a stream buffer has a
+			single reader.  This relies on Tx also being configured to use a
+			stream buffer. */
+			#if ioconfigUSE_SSP_RX_STREAM_BUFFER == 1
+			{
+				/* Ensure the last Tx has completed. */
+				xIOUtilsWaitTxStreamBufferEmpty( pxPeripheralControl, boardDEFAULT_READ_MUTEX_TIMEOUT );
+
+				/* Clear any residual data - there shouldn't be any! */
+				vIOUtilsClearRxStreamBuffer( pxPeripheralControl );
+
+				/* Data should be received during the following write. */
+				ulReceiveActive[ cPeripheralNumber ] = pdTRUE;
+
+				/* Write to solicit received data. */
+				FreeRTOS_SSP_write( pxPeripheralControl, NULL, xBytes );
+
+				/* Read the received data placed in the stream buffer by the
+				interrupt. */
+				xReturn = xIOUtilsReceiveFromRxStreamBuffer( pxPeripheralControl, ( uint8_t * ) pvBuffer, xBytes );
+
+				/* Not expecting any more Rx data now, so just junk anything
+				that is received until the next explicit read is performed. */
+				ulReceiveActive[ cPeripheralNumber ] = pdFALSE;
+			}
+			#endif
+			break;
+
+
 		default :
 
 			/* Other methods can be implemented here. */
@@ -573,6 +628,8 @@ portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 const unsigned portBASE_TYPE uxSSPNumber = 1UL;
 Transfer_Control_t *pxTxTransferStruct, *pxRxTransferStruct;
 
+	traceISR_ENTER( SSP1_IRQn );
+
 	/* Determine the interrupt source. */
 	ulInterruptSource = LPC_SSP1->MIS;
 
@@ -648,6 +705,16 @@ Transfer_Control_t *pxTxTransferStruct, *pxRxTransferStruct;
 						break;
 
 
+					case ioctlUSE_STREAM_BUFFER_RX :
+
+						#if ioconfigUSE_SSP_RX_STREAM_BUFFER == 1
+						{
+							ioutilsRX_CHARS_INTO_STREAM_BUFFER_FROM_ISR( pxRxTransferStruct, ( ( LPC_SSP1->SR & SSP_SR_RNE ) != 0 ), ( LPC_SSP1->DR ), ulReceived, xHigherPriorityTaskWoken );
+						}
+						#endif /* ioconfigUSE_SSP_RX_STREAM_BUFFER */
+						break;
+
+
 					default :
 
 						/* This must be an error.  Force an assert. */
@@ -680,6 +747,17 @@ Transfer_Control_t *pxTxTransferStruct, *pxRxTransferStruct;
 					break;
 
 
+				case ioctlUSE_STREAM_BUFFER_TX:
+
+					#if ioconfigUSE_SSP_TX_STREAM_BUFFER == 1
+					{
+						/* One byte can be sent for each byte received. */
+						ioutilsTX_CHARS_FROM_STREAM_BUFFER_FROM_ISR( pxTxTransferStruct, ulReceived, ( LPC_SSP1->DR = SSP_DR_BITMASK( ( uint16_t ) ucChar ) ), xHigherPriorityTaskWoken );
+					}
+					#endif /* ioconfigUSE_SSP_TX_STREAM_BUFFER */
+					break;
+
+
 				default :
 
 					/* Should not get here.  Set the saved transfer control
@@ -697,5 +775,6 @@ Transfer_Control_t *pxTxTransferStruct, *pxRxTransferStruct;
 	/* If lHigherPriorityTaskWoken is now equal to pdTRUE, then a context
 	switch should be performed before the interrupt exists.  That ensures the
 	unblocked (higher priority) task is returned to immediately. */
+	traceISR_EXIT( SSP1_IRQn );
 	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
 }
@@ -0,0 +1,713 @@
+/**************************************************************************//**
+ *
+ * @file        StreamBuffer.c
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_StreamBuffer.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if configUSE_TASK_NOTIFICATIONS != 1
+	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build FreeRTOS_StreamBuffer.c
+#endif
+
+/* Bits used in the ucFlags member. */
+#define sbFLAGS_IS_MESSAGE_BUFFER			( ( unsigned char ) 1 )
+#define sbFLAGS_IS_STATICALLY_ALLOCATED		( ( unsigned char ) 2 )
+
+/* Bytes taken by the length stored in front of each message. */
+#define sbBYTES_TO_STORE_MESSAGE_LENGTH		( sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) )
+
+/* Stops the compiler moving the copy of the data past the store that publishes
+the new head or tail index to the other side.  The Cortex-M3 is single core and
+does not reorder its own stores, so nothing stronger is needed. */
+#define sbCOMPILER_BARRIER()				__asm volatile( "" ::: "memory" )
+
+/*
+ * Definition of the stream buffer.  The writer only ever changes xHead and the
+ * reader only ever changes xTail, which is what allows the data to be moved
+ * without a critical section.  The storage is one byte longer than the
+ * capacity so that xHead == xTail always means empty.
+ */
+typedef struct xSTREAM_BUFFER
+{
+	volatile size_t xTail;						/*< Index of the next byte to read. */
+	volatile size_t xHead;						/*< Index of the next byte to write. */
+	size_t xLength;								/*< Size of the storage area, one more than the capacity. */
+	size_t xTriggerLevelBytes;					/*< Bytes that must be in the buffer before a blocked reader is woken. */
+	volatile xTaskHandle xTaskWaitingToReceive;	/*< The task blocked reading, if any. */
+	volatile xTaskHandle xTaskWaitingToSend;	/*< The task blocked writing, if any. */
+	unsigned char *pucBuffer;					/*< The storage area. */
+	unsigned char ucFlags;						/*< sbFLAGS_... bits. */
+} xSTREAM_BUFFER;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	/* xStaticStreamBufferType in FreeRTOS_StreamBuffer.h must be exactly the
+	same size as an xSTREAM_BUFFER.  This fails to compile if the two have
+	drifted apart. */
+	typedef char xStaticStreamBufferTypeSizeCheck[ ( sizeof( xStaticStreamBufferType ) == sizeof( xSTREAM_BUFFER ) ) ? 1 : -1 ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Fill in a new stream buffer structure.
+ */
+static void prvInitialiseNewStreamBuffer( xSTREAM_BUFFER * const pxStreamBuffer, unsigned char * const pucBuffer, size_t xBufferSizeBytes, size_t xTriggerLevelBytes, unsigned char ucFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * The number of bytes in, or the free space left in, the buffer.
+ */
+static size_t prvBytesInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+static size_t prvSpaceInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy xCount bytes into the storage area starting at xHead, wrapping at the
+ * end, and return the index after the last byte written.  Does not publish the
+ * new index.
+ */
+static size_t prvWriteBytesToBuffer( xSTREAM_BUFFER * const pxStreamBuffer, const unsigned char *pucData, size_t xCount, size_t xHead ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy xCount bytes out of the storage area starting at xTail, wrapping at
+ * the end, and return the index after the last byte read.  Does not publish
+ * the new index.
+ */
+static size_t prvReadBytesFromBuffer( xSTREAM_BUFFER * const pxStreamBuffer, unsigned char *pucData, size_t xCount, size_t xTail ) PRIVILEGED_FUNCTION;
+
+/*
+ * Write a whole message, or as much of a stream as fits in xSpace bytes.
+ * Returns the number of data bytes written, not counting a message length.
+ */
+static size_t prvWriteMessageToBuffer( xSTREAM_BUFFER * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, size_t xSpace ) PRIVILEGED_FUNCTION;
+
+/*
+ * Read one whole message, or as much of a stream as is available and fits.
+ * Returns the number of data bytes read.
+ */
+static size_t prvReadMessageFromBuffer( xSTREAM_BUFFER * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+
+	xStreamBufferHandle xStreamBufferGenericCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, portBASE_TYPE xIsMessageBuffer )
+	{
+	xSTREAM_BUFFER *pxStreamBuffer;
+
+		configASSERT( xBufferSizeBytes > 0 );
+		configASSERT( xTriggerLevelBytes <= xBufferSizeBytes );
+
+		/* The structure and the storage area are allocated together, the
+		storage area directly follows the structure. */
+		pxStreamBuffer = ( xSTREAM_BUFFER * ) pvPortMalloc( sizeof( xSTREAM_BUFFER ) + xBufferSizeBytes + ( size_t ) 1 );
+
+		if( pxStreamBuffer != NULL )
+		{
+			prvInitialiseNewStreamBuffer( pxStreamBuffer, ( unsigned char * ) ( pxStreamBuffer + 1 ), xBufferSizeBytes, xTriggerLevelBytes, ( xIsMessageBuffer != pdFALSE ) ? sbFLAGS_IS_MESSAGE_BUFFER : ( unsigned char ) 0 );
+		}
+
+		return ( xStreamBufferHandle ) pxStreamBuffer;
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+
+	xStreamBufferHandle xStreamBufferGenericCreateStatic( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, portBASE_TYPE xIsMessageBuffer, unsigned char * const pucStreamBufferStorageArea, xStaticStreamBufferType * const pxStaticStreamBuffer )
+	{
+	xSTREAM_BUFFER *pxStreamBuffer = ( xSTREAM_BUFFER * ) pxStaticStreamBuffer;
+	unsigned char ucFlags = sbFLAGS_IS_STATICALLY_ALLOCATED;
+
+		configASSERT( pucStreamBufferStorageArea );
+		configASSERT( pxStaticStreamBuffer );
+		configASSERT( xBufferSizeBytes > 0 );
+		configASSERT( xTriggerLevelBytes <= xBufferSizeBytes );
+
+		if( xIsMessageBuffer != pdFALSE )
+		{
+			ucFlags |= sbFLAGS_IS_MESSAGE_BUFFER;
+		}
+
+		prvInitialiseNewStreamBuffer( pxStreamBuffer, pucStreamBufferStorageArea, xBufferSizeBytes, xTriggerLevelBytes, ucFlags );
+
+		return ( xStreamBufferHandle ) pxStreamBuffer;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+	configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_STATICALLY_ALLOCATED ) == ( unsigned char ) 0 )
+	{
+		#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+		{
+			vPortFree( ( void * ) pxStreamBuffer );
+		}
+		#endif
+	}
+	else
+	{
+		/* The memory belongs to the application, just stop it looking like a
+		valid stream buffer. */
+		memset( ( void * ) pxStreamBuffer, 0x00, sizeof( xSTREAM_BUFFER ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferReset( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+portBASE_TYPE xReturn = pdFAIL;
+
+	configASSERT( pxStreamBuffer );
+
+	taskENTER_CRITICAL();
+	{
+		/* Can only reset a buffer nobody is waiting on. */
+		if( ( pxStreamBuffer->xTaskWaitingToReceive == NULL ) && ( pxStreamBuffer->xTaskWaitingToSend == NULL ) )
+		{
+			pxStreamBuffer->xHead = ( size_t ) 0;
+			pxStreamBuffer->xTail = ( size_t ) 0;
+			xReturn = pdPASS;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevel )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+portBASE_TYPE xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	/* A trigger level of 0 would wake the reader with nothing to read. */
+	if( xTriggerLevel == ( size_t ) 0 )
+	{
+		xTriggerLevel = ( size_t ) 1;
+	}
+
+	if( xTriggerLevel < pxStreamBuffer->xLength )
+	{
+		pxStreamBuffer->xTriggerLevelBytes = xTriggerLevel;
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer )
+{
+	configASSERT( xStreamBuffer );
+	return prvSpaceInBuffer( ( xSTREAM_BUFFER * ) xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer )
+{
+	configASSERT( xStreamBuffer );
+	return prvBytesInBuffer( ( xSTREAM_BUFFER * ) xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferIsEmpty( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+	return ( pxStreamBuffer->xHead == pxStreamBuffer->xTail ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferIsFull( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xBytesToStoreMessageLength;
+
+	configASSERT( pxStreamBuffer );
+
+	/* A message buffer that cannot take even a zero length message is full. */
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xBytesToStoreMessageLength = 0;
+	}
+
+	return ( prvSpaceInBuffer( pxStreamBuffer ) <= xBytesToStoreMessageLength ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferNextMessageLengthBytes( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+configMESSAGE_BUFFER_LENGTH_TYPE xTempLength;
+size_t xReturn = 0;
+
+	configASSERT( pxStreamBuffer );
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		if( prvBytesInBuffer( pxStreamBuffer ) > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+		{
+			/* Peek at the length without moving the tail. */
+			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( unsigned char * ) &xTempLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xTail );
+			xReturn = ( size_t ) xTempLength;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReturn, xSpace = 0, xRequiredSpace = xDataLengthBytes;
+xTimeOutType xTimeOut;
+
+	configASSERT( pvTxData );
+	configASSERT( pxStreamBuffer );
+
+	/* A message also needs room for its length. */
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		configASSERT( xRequiredSpace < pxStreamBuffer->xLength );
+	}
+
+	if( xTicksToWait != ( portTickType ) 0 )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+
+		do
+		{
+			/* Wait until the required space is available.  The notification
+			state is cleared first so a notification left over from an earlier
+			wait cannot end this one early. */
+			taskENTER_CRITICAL();
+			{
+				xSpace = prvSpaceInBuffer( pxStreamBuffer );
+
+				if( xSpace < xRequiredSpace )
+				{
+					( void ) xTaskNotifyStateClear( NULL );
+
+					/* Only one writer may block at a time. */
+					configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+					pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+				}
+				else
+				{
+					taskEXIT_CRITICAL();
+					break;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			( void ) xTaskNotifyWait( 0UL, 0UL, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToSend = NULL;
+
+		} while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+	}
+
+	if( xSpace == ( size_t ) 0 )
+	{
+		xSpace = prvSpaceInBuffer( pxStreamBuffer );
+	}
+
+	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, xSpace );
+
+	if( xReturn > ( size_t ) 0 )
+	{
+		/* Wake the reader if it is waiting and enough is now there for it. */
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		{
+			taskENTER_CRITICAL();
+			{
+				if( pxStreamBuffer->xTaskWaitingToReceive != NULL )
+				{
+					( void ) xTaskNotify( pxStreamBuffer->xTaskWaitingToReceive, 0UL, eNoAction );
+					pxStreamBuffer->xTaskWaitingToReceive = NULL;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE * const pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReturn;
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	configASSERT( pvTxData );
+	configASSERT( pxStreamBuffer );
+
+	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, prvSpaceInBuffer( pxStreamBuffer ) );
+
+	if( xReturn > ( size_t ) 0 )
+	{
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		{
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			{
+				if( pxStreamBuffer->xTaskWaitingToReceive != NULL )
+				{
+					( void ) xTaskNotifyFromISR( pxStreamBuffer->xTaskWaitingToReceive, 0UL, eNoAction, pxHigherPriorityTaskWoken );
+					pxStreamBuffer->xTaskWaitingToReceive = NULL;
+				}
+			}
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+
+	configASSERT( pvRxData );
+	configASSERT( pxStreamBuffer );
+
+	/* A message buffer holding no more than a length holds no message. */
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xBytesToStoreMessageLength = 0;
+	}
+
+	if( xTicksToWait != ( portTickType ) 0 )
+	{
+		/* Checking the buffer and registering as the waiting task must be
+		atomic, otherwise a write between the two could be missed. */
+		taskENTER_CRITICAL();
+		{
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+			if( xBytesAvailable <= xBytesToStoreMessageLength )
+			{
+				( void ) xTaskNotifyStateClear( NULL );
+
+				/* Only one reader may block at a time. */
+				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xBytesAvailable <= xBytesToStoreMessageLength )
+		{
+			/* Wait for the writer to reach the trigger level. */
+			( void ) xTaskNotifyWait( 0UL, 0UL, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+		}
+	}
+	else
+	{
+		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+	}
+
+	if( xBytesAvailable > xBytesToStoreMessageLength )
+	{
+		xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xBytesAvailable );
+
+		if( xReceivedLength != ( size_t ) 0 )
+		{
+			/* Space was freed, wake the writer if it is waiting for some. */
+			taskENTER_CRITICAL();
+			{
+				if( pxStreamBuffer->xTaskWaitingToSend != NULL )
+				{
+					( void ) xTaskNotify( pxStreamBuffer->xTaskWaitingToSend, 0UL, eNoAction );
+					pxStreamBuffer->xTaskWaitingToSend = NULL;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+
+	return xReceivedLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE * const pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	configASSERT( pvRxData );
+	configASSERT( pxStreamBuffer );
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xBytesToStoreMessageLength = 0;
+	}
+
+	xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+	if( xBytesAvailable > xBytesToStoreMessageLength )
+	{
+		xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xBytesAvailable );
+
+		if( xReceivedLength != ( size_t ) 0 )
+		{
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			{
+				if( pxStreamBuffer->xTaskWaitingToSend != NULL )
+				{
+					( void ) xTaskNotifyFromISR( pxStreamBuffer->xTaskWaitingToSend, 0UL, eNoAction, pxHigherPriorityTaskWoken );
+					pxStreamBuffer->xTaskWaitingToSend = NULL;
+				}
+			}
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+	}
+
+	return xReceivedLength;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteMessageToBuffer( xSTREAM_BUFFER * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, size_t xSpace )
+{
+size_t xHead = pxStreamBuffer->xHead;
+configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+portBASE_TYPE xWrite;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		/* A message is written whole or not at all. */
+		if( xSpace >= ( xDataLengthBytes + sbBYTES_TO_STORE_MESSAGE_LENGTH ) )
+		{
+			xMessageLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes;
+			xHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const unsigned char * ) &xMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xHead );
+			xWrite = pdTRUE;
+		}
+		else
+		{
+			xDataLengthBytes = 0;
+			xWrite = pdFALSE;
+		}
+	}
+	else
+	{
+		/* A stream takes as much as fits. */
+		if( xDataLengthBytes > xSpace )
+		{
+			xDataLengthBytes = xSpace;
+		}
+
+		xWrite = ( xDataLengthBytes != ( size_t ) 0 ) ? pdTRUE : pdFALSE;
+	}
+
+	if( xWrite != pdFALSE )
+	{
+		xHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const unsigned char * ) pvTxData, xDataLengthBytes, xHead );
+
+		/* Only now let the reader see the new data. */
+		sbCOMPILER_BARRIER();
+		pxStreamBuffer->xHead = xHead;
+	}
+
+	return xDataLengthBytes;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadMessageFromBuffer( xSTREAM_BUFFER * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, size_t xBytesAvailable )
+{
+size_t xTail = pxStreamBuffer->xTail, xCount;
+configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+portBASE_TYPE xRead;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		/* Read the length, but only consume it if the whole message fits in
+		the caller's buffer, otherwise it stays for a later, larger read. */
+		xTail = prvReadBytesFromBuffer( pxStreamBuffer, ( unsigned char * ) &xMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xTail );
+		xCount = ( size_t ) xMessageLength;
+
+		if( xCount > xBufferLengthBytes )
+		{
+			xCount = 0;
+			xRead = pdFALSE;
+		}
+		else
+		{
+			xRead = pdTRUE;
+		}
+	}
+	else
+	{
+		xCount = ( xBytesAvailable < xBufferLengthBytes ) ? xBytesAvailable : xBufferLengthBytes;
+		xRead = ( xCount != ( size_t ) 0 ) ? pdTRUE : pdFALSE;
+	}
+
+	if( xRead != pdFALSE )
+	{
+		xTail = prvReadBytesFromBuffer( pxStreamBuffer, ( unsigned char * ) pvRxData, xCount, xTail );
+
+		/* Only now hand the space back to the writer. */
+		sbCOMPILER_BARRIER();
+		pxStreamBuffer->xTail = xTail;
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteBytesToBuffer( xSTREAM_BUFFER * const pxStreamBuffer, const unsigned char *pucData, size_t xCount, size_t xHead )
+{
+size_t xFirstLength;
+
+	/* At most two copies, one up to the end of the storage area and one from
+	its start. */
+	xFirstLength = pxStreamBuffer->xLength - xHead;
+	if( xFirstLength > xCount )
+	{
+		xFirstLength = xCount;
+	}
+
+	memcpy( ( void * ) &( pxStreamBuffer->pucBuffer[ xHead ] ), ( const void * ) pucData, xFirstLength );
+
+	if( xCount > xFirstLength )
+	{
+		memcpy( ( void * ) pxStreamBuffer->pucBuffer, ( const void * ) &( pucData[ xFirstLength ] ), xCount - xFirstLength );
+	}
+
+	xHead += xCount;
+	if( xHead >= pxStreamBuffer->xLength )
+	{
+		xHead -= pxStreamBuffer->xLength;
+	}
+
+	return xHead;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadBytesFromBuffer( xSTREAM_BUFFER * const pxStreamBuffer, unsigned char *pucData, size_t xCount, size_t xTail )
+{
+size_t xFirstLength;
+
+	xFirstLength = pxStreamBuffer->xLength - xTail;
+	if( xFirstLength > xCount )
+	{
+		xFirstLength = xCount;
+	}
+
+	memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xTail ] ), xFirstLength );
+
+	if( xCount > xFirstLength )
+	{
+		memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( const void * ) pxStreamBuffer->pucBuffer, xCount - xFirstLength );
+	}
+
+	xTail += xCount;
+	if( xTail >= pxStreamBuffer->xLength )
+	{
+		xTail -= pxStreamBuffer->xLength;
+	}
+
+	return xTail;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvBytesInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer )
+{
+size_t xCount;
+
+	xCount = pxStreamBuffer->xLength + pxStreamBuffer->xHead;
+	xCount -= pxStreamBuffer->xTail;
+	if( xCount >= pxStreamBuffer->xLength )
+	{
+		xCount -= pxStreamBuffer->xLength;
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvSpaceInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer )
+{
+size_t xSpace;
+
+	xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
+	xSpace -= pxStreamBuffer->xHead;
+	xSpace -= ( size_t ) 1;
+	if( xSpace >= pxStreamBuffer->xLength )
+	{
+		xSpace -= pxStreamBuffer->xLength;
+	}
+
+	return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewStreamBuffer( xSTREAM_BUFFER * const pxStreamBuffer, unsigned char * const pucBuffer, size_t xBufferSizeBytes, size_t xTriggerLevelBytes, unsigned char ucFlags )
+{
+	/* A trigger level of 0 would wake the reader with nothing to read. */
+	if( xTriggerLevelBytes == ( size_t ) 0 )
+	{
+		xTriggerLevelBytes = ( size_t ) 1;
+	}
+
+	memset( ( void * ) pxStreamBuffer, 0x00, sizeof( xSTREAM_BUFFER ) );
+	pxStreamBuffer->pucBuffer = pucBuffer;
+	pxStreamBuffer->xLength = xBufferSizeBytes + ( size_t ) 1;
+	pxStreamBuffer->xTriggerLevelBytes = xTriggerLevelBytes;
+	pxStreamBuffer->ucFlags = ucFlags;
+}
+/*-----------------------------------------------------------*/
@@ -32,6 +32,26 @@ task.h is included from an application file. */
  */
 #define tskIDLE_STACK_SIZE	configMINIMAL_STACK_SIZE
 
+/*
+ * Where a task is with its direct to task notification.
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	typedef enum
+	{
+		eNotWaitingNotification = 0,
+		eWaitingNotification,
+		eNotified
+	} eNotifyValue;
+#endif
+
+/*
+ * Which parts of a task's memory came from the heap, so deleting it frees only
+ * those.  Only needed if tasks can be created both ways.
+ */
+#define tskDYNAMICALLY_ALLOCATED_STACK_AND_TCB	( ( unsigned char ) 0U )
+#define tskSTATICALLY_ALLOCATED_STACK_ONLY		( ( unsigned char ) 1U )
+#define tskSTATICALLY_ALLOCATED_STACK_AND_TCB	( ( unsigned char ) 2U )
+
 /*
  * Task control block.  A task control block (TCB) is allocated to each task,
  * and stores the context of the task.
@@ -61,6 +81,7 @@ typedef struct tskTaskControlBlock
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		unsigned portBASE_TYPE	uxTCBNumber;	/*< This stores a number that increments each time a TCB is created.  It allows debuggers to determine when a task has been deleted and then recreated. */
 		unsigned portBASE_TYPE  uxTaskNumber;	/*< This stores a number specifically for use by third party trace code. */
+		unsigned short			usStackDepth;	/*< The stack size the task was created with, in words, so a high water mark can be compared with it. */
 	#endif
 
 	#if ( configUSE_MUTEXES == 1 )
@@ -75,8 +96,27 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;	/*< Value sent by the last xTaskNotify(), or the count of notify gives. */
+		volatile eNotifyValue eNotifyState;		/*< Whether the task is waiting for, or has been sent, a notification. */
+	#endif
+
+	#if ( configUSE_PERIODIC_TASKS == 1 )
+		xPeriodicTaskType xPeriodic;			/*< Period, deadline and budget of a periodic task, and how its activations have gone.  xPeriod is 0 for any other task. */
+	#endif
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< One of the tskxxx_ALLOCATED values, so the right memory is freed when the task is deleted. */
+	#endif
+
 } tskTCB;
 
+/*
+ * xStaticTaskType in task.h must be exactly the same size as a TCB.  This
+ * fails to compile if the two have drifted apart.
+ */
+typedef char xStaticTaskTypeSizeCheck[ ( sizeof( xStaticTaskType ) == sizeof( tskTCB ) ) ? 1 : -1 ];
+
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -119,7 +159,7 @@ PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been r
 
 /* File private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxCurrentNumberOfTasks 	= ( unsigned portBASE_TYPE ) 0U;
-PRIVILEGED_DATA static volatile portTickType xTickCount 						= ( portTickType ) 0U;
+PRIVILEGED_DATA static volatile portTickType xTickCount 						= ( portTickType ) configINITIAL_TICK_COUNT;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTopUsedPriority	 				= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile signed portBASE_TYPE xSchedulerRunning 			= pdFALSE;
@@ -128,7 +168,9 @@ PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxMissedTicks 			= ( unsi
 PRIVILEGED_DATA static volatile portBASE_TYPE xMissedYield 						= ( portBASE_TYPE ) pdFALSE;
 PRIVILEGED_DATA static volatile portBASE_TYPE xNumOfOverflows 					= ( portBASE_TYPE ) 0;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTCBNumber 						= ( unsigned portBASE_TYPE ) 0U;
-PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType ) portMAX_DELAY;
+/* Volatile as the tick interrupt moves it.  Otherwise the idle task may use the
+value it read before suspending the scheduler in the tickless test below. */
+PRIVILEGED_DATA static volatile portTickType xNextTaskUnblockTime				= ( portTickType ) portMAX_DELAY;
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
@@ -138,6 +180,17 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 
 #endif
 
+/*
+ * Set in a task's event list item value while the item holds the bits the
+ * task is waiting for in an event group, rather than the task's priority.
+ * Priority changes must leave such a value alone.
+ */
+#if configUSE_16_BIT_TICKS == 1
+	#define taskEVENT_LIST_ITEM_VALUE_IN_USE	0x8000U
+#else
+	#define taskEVENT_LIST_ITEM_VALUE_IN_USE	0x80000000UL
+#endif
+
 /* Debugging and trace facilities private variables and macros. ------------*/
 
 /*
@@ -162,13 +215,155 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
  * that if the task being inserted is at the same priority as the currently
  * executing task, then it will only be rescheduled after the currently
  * executing task has been rescheduled.
+ *
+ * With configUSE_EDF_SCHEDULER the ready list at configEDF_PRIORITY is kept in
+ * order of absolute deadline instead, using the value of the generic list
+ * item, which is not otherwise used while the task is ready.  A periodic task
+ * is due at the deadline of its current activation.  Any other task that finds
+ * itself at that priority, by being created there or by inheriting it, is
+ * treated as due now.  Tasks due on the same tick keep the order they were
+ * made ready in.  See prvInsertByDeadline() for the tick count wrapping.
+ */
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+	/* Fails to compile if configEDF_PRIORITY is not a valid priority. */
+	typedef char xEDFPriorityCheck[ ( configEDF_PRIORITY < configMAX_PRIORITIES ) ? 1 : -1 ];
+
+	#define prvAddTaskToReadyQueue( pxTCB )																				\
+		taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );																\
+		if( ( pxTCB )->uxPriority == ( unsigned portBASE_TYPE ) configEDF_PRIORITY )									\
+		{																												\
+			if( ( pxTCB )->xPeriodic.xPeriod != ( portTickType ) 0U )													\
+			{																											\
+				listSET_LIST_ITEM_VALUE( &( ( pxTCB )->xGenericListItem ), ( pxTCB )->xPeriodic.xRelease + ( pxTCB )->xPeriodic.xDeadline );	\
+			}																											\
+			else																										\
+			{																											\
+				listSET_LIST_ITEM_VALUE( &( ( pxTCB )->xGenericListItem ), xTickCount );								\
+			}																											\
+			prvInsertByDeadline( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) );	\
+		}																												\
+		else																											\
+		{																												\
+			vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) );	\
+		}
+
+	/* The head of the ready list at configEDF_PRIORITY is the task with the
+	earliest deadline.  Every other priority shares the processor round robin
+	as normal. */
+	#define taskSELECT_FROM_READY_LIST( uxPriority )																	\
+		if( ( uxPriority ) == ( unsigned portBASE_TYPE ) configEDF_PRIORITY )											\
+		{																												\
+			pxCurrentTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxReadyTasksLists[ ( uxPriority ) ] ) );		\
+		}																												\
+		else																											\
+		{																												\
+			listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ ( uxPriority ) ] ) );						\
+		}
+
+#else
+
+	#define prvAddTaskToReadyQueue( pxTCB )																				\
+		taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );																\
+		vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) )
+
+	/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
+	same priority get an equal share of the processor time. */
+	#define taskSELECT_FROM_READY_LIST( uxPriority )																	\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ ( uxPriority ) ] ) )
+
+#endif /* configUSE_EDF_SCHEDULER */
+/*-----------------------------------------------------------*/
+
+/*
+ * Called as the tick moves a task off the delayed list.  If it is a periodic
+ * task waiting for its next release, the time it was made ready is noted so
+ * the jitter to it starting can be measured.  Anything else that wakes it
+ * early, a vTaskResume() say, is not a release and is not noted.
  */
-#define prvAddTaskToReadyQueue( pxTCB )																					\
-	if( ( pxTCB )->uxPriority > uxTopReadyPriority )																	\
+#if ( configUSE_PERIODIC_TASKS == 1 )
+	#define prvRecordRelease( pxTCB )																					\
+		if( ( pxTCB )->xPeriodic.xWaitingForRelease != pdFALSE )														\
+		{																												\
+			( pxTCB )->xPeriodic.ulReleasedAt = portGET_RUN_TIME_COUNTER_VALUE();										\
+		}
+#else
+	#define prvRecordRelease( pxTCB )
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+
+	/* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
+	performed in a generic way that is not optimised to any particular
+	microcontroller architecture.  uxTopReadyPriority holds the priority of the
+	highest priority ready state task, or one above it, and is walked down
+	over the empty ready lists when the next task is selected. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )																		\
+	{																													\
+		if( ( uxPriority ) > uxTopReadyPriority )																		\
+		{																												\
+			uxTopReadyPriority = ( uxPriority );																		\
+		}																												\
+	}
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()																			\
+	{																													\
+		/* Find the highest priority queue that contains ready tasks. */												\
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )										\
+		{																												\
+			configASSERT( uxTopReadyPriority );																			\
+			--uxTopReadyPriority;																						\
+		}																												\
+																														\
+		taskSELECT_FROM_READY_LIST( uxTopReadyPriority );																\
+	}
+
+	/* The scan above copes with uxTopReadyPriority being too high, so there is
+	nothing to do when a ready list empties. */
+	#define taskRESET_READY_PRIORITY( uxPriority )
+
+	/* True if a task of higher priority than the idle task is ready. */
+	#define taskHIGHER_THAN_IDLE_READY() ( uxTopReadyPriority > tskIDLE_PRIORITY )
+
+#else /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+	/* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 1 then task selection is
+	performed in a way that is tailored to the particular microcontroller
+	architecture being used.  uxTopReadyPriority is a bitmap with one bit set
+	for each priority that has a ready task, kept exact by the port macros. */
+	/* The bitmap has one bit per priority.  This fails to compile if
+	configMAX_PRIORITIES is more than 32. */
+	typedef char xReadyPriorityBitmapCheck[ ( configMAX_PRIORITIES <= 32 ) ? 1 : -1 ];
+
+	#define taskRECORD_READY_PRIORITY( uxPriority )	portRECORD_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority )
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()																			\
+	{																													\
+	unsigned portBASE_TYPE uxTopPriority;																				\
+																														\
+		/* Find the highest priority queue that contains ready tasks. */												\
+		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );													\
+		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );						\
+		taskSELECT_FROM_READY_LIST( uxTopPriority );																	\
+	}
+
+	/* Called after a task's generic list item has been removed from a list.
+	The bit is cleared only if that left the ready list at uxPriority empty,
+	so it is safe to call whichever list the item was removed from. */
+	#define taskRESET_READY_PRIORITY( uxPriority )																		\
 	{																													\
-		uxTopReadyPriority = ( pxTCB )->uxPriority;																		\
-	}																													\
-	vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) )
+		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == ( unsigned portBASE_TYPE ) 0 )	\
+		{																												\
+			portRESET_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority );												\
+		}																												\
+	}
+
+	/* The idle task's bit is always set, any other bit means a higher priority
+	task is ready. */
+	#define taskHIGHER_THAN_IDLE_READY() ( uxTopReadyPriority > ( 1UL << tskIDLE_PRIORITY ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 /*-----------------------------------------------------------*/
 
 /*
@@ -225,6 +420,7 @@ portTickType xItemValue;																\
 				{																		\
 					vListRemove( &( pxTCB->xEventListItem ) );							\
 				}																		\
+				prvRecordRelease( pxTCB );												\
 				prvAddTaskToReadyQueue( pxTCB );										\
 			}																			\
 		}																				\
@@ -243,6 +439,7 @@ portTickType xItemValue;																\
 /* Callback function prototypes. --------------------------*/
 extern void vApplicationStackOverflowHook( xTaskHandle *pxTask, signed char *pcTaskName );
 extern void vApplicationTickHook( void );
+extern void vApplicationDeadlineMissedHook( xTaskHandle xTask, signed char *pcTaskName );
 		
 /* File private functions. --------------------------------*/
 
@@ -271,6 +468,21 @@ static void prvInitialiseTaskLists( void ) PRIVILEGED_FUNCTION;
  */
 static portTASK_FUNCTION_PROTO( prvIdleTask, pvParameters );
 
+/*
+ * Return the amount of time, in ticks, that will pass before the kernel will
+ * next move a task from the Blocked state to the Running state.
+ *
+ * This conditional compilation should use inequality to 0, not equality to 1.
+ * This is to ensure portSUPPRESS_TICKS_AND_SLEEP() can be called when user
+ * defined low power mode implementations require configUSE_TICKLESS_IDLE to
+ * be set to a value other than 1.
+ */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Utility to free all memory allocated by the scheduler to hold a TCB,
  * including the stack pointed to by the TCB.
@@ -297,11 +509,71 @@ static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
  */
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake ) PRIVILEGED_FUNCTION;
 
+/*
+ * Take the calling task off the ready list and block it for xTicksToWait
+ * without putting it on any event list, as waiting for a notification does.
+ * Must be called from a critical section.
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvBlockCurrentTaskForNotification( portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
  * allocation was successful.
  */
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Sets up a TCB whose memory has already been found, however it was found,
+ * and adds the task to a ready list.  pxNewTCB being NULL is taken to mean
+ * the memory could not be found.
+ */
+static signed portBASE_TYPE prvAddNewTask( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, tskTCB *pxNewTCB, const xMemoryRegion * const xRegions ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sets up a TCB whose memory was supplied by the application and adds the
+ * task to a ready list.  xTaskCreateStatic() and xTaskCreatePeriodicStatic()
+ * differ only in the timing given, which is all zero for a task that is not
+ * periodic.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	static xTaskHandle prvCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer, portTickType xPeriod, portTickType xDeadline, unsigned long ulBudget ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Sets the period, deadline and budget of a task that has not been added to
+ * a ready list yet, and clears its activation figures.  The first activation
+ * is released now.  This has to be done before the task can first run, so it
+ * is done by the creation functions rather than prvInitialiseTCBVariables().
+ */
+#if ( configUSE_PERIODIC_TASKS == 1 )
+
+	static void prvInitialisePeriodic( tskTCB *pxTCB, portTickType xPeriod, portTickType xDeadline, unsigned long ulBudget ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Insert a task into the EDF ready list behind every task due before or on
+ * the same tick as it.  vListInsert() cannot be used as it compares the
+ * absolute deadlines, so a deadline just after the tick count wraps would
+ * sort behind those just before it.  Deadlines are compared by their
+ * difference instead, which holds while every ready deadline is within half
+ * the range of the tick count of the others.
+ */
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+	static void prvInsertByDeadline( xList *pxList, xListItem *pxNewListItem ) PRIVILEGED_FUNCTION;
+
+#endif
 
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
@@ -318,6 +590,16 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
 
 #endif
 
+/*
+ * Called from uxTaskGetSystemState().  Fills one xTaskStatusType for each
+ * task in pxList and returns how many were filled.
+ */
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	static unsigned portBASE_TYPE prvListTaskStatusWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList, signed char cStatus ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * When a task is created, the stack of the task is filled with a known value.
  * This function determines the 'high water mark' of the task stack by
@@ -338,18 +620,131 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  * TASK CREATION API documented in task.h
  *----------------------------------------------------------*/
 
-signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+	{
+	tskTCB * pxNewTCB;
+
+		/* Allocate the memory required by the TCB and stack for the new task,
+		checking that the allocation was successful. */
+		pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
+
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			if( pxNewTCB != NULL )
+			{
+				if( puxStackBuffer == NULL )
+				{
+					pxNewTCB->ucStaticallyAllocated = tskDYNAMICALLY_ALLOCATED_STACK_AND_TCB;
+				}
+				else
+				{
+					pxNewTCB->ucStaticallyAllocated = tskSTATICALLY_ALLOCATED_STACK_ONLY;
+				}
+			}
+		}
+		#endif
+
+		#if ( configUSE_PERIODIC_TASKS == 1 )
+		{
+			if( pxNewTCB != NULL )
+			{
+				prvInitialisePeriodic( pxNewTCB, ( portTickType ) 0U, ( portTickType ) 0U, 0UL );
+			}
+		}
+		#endif
+
+		return prvAddNewTask( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, pxNewTCB, xRegions );
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTaskHandle xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer )
+	{
+		return prvCreateStatic( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, puxStackBuffer, pxTaskBuffer, ( portTickType ) 0U, ( portTickType ) 0U, 0UL );
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PERIODIC_TASKS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTaskHandle xTaskCreatePeriodicStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer, portTickType xPeriod, portTickType xDeadline, unsigned long ulBudget )
+	{
+		configASSERT( ( xPeriod > 0U ) );
+
+		/* A deadline of 0 means the end of the period. */
+		if( xDeadline == ( portTickType ) 0U )
+		{
+			xDeadline = xPeriod;
+		}
+
+		return prvCreateStatic( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, puxStackBuffer, pxTaskBuffer, xPeriod, xDeadline, ulBudget );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	static xTaskHandle prvCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, portSTACK_TYPE *puxStackBuffer, xStaticTaskType *pxTaskBuffer, portTickType xPeriod, portTickType xDeadline, unsigned long ulBudget )
+	{
+	tskTCB *pxNewTCB;
+	xTaskHandle xReturn = NULL;
+
+		configASSERT( puxStackBuffer != NULL );
+		configASSERT( pxTaskBuffer != NULL );
+
+		if( ( puxStackBuffer != NULL ) && ( pxTaskBuffer != NULL ) )
+		{
+			/* The TCB lives in the buffer supplied, which is the same size. */
+			pxNewTCB = ( tskTCB * ) pxTaskBuffer;
+			pxNewTCB->pxStack = puxStackBuffer;
+
+			/* Just to help debugging, and so the high water mark works. */
+			memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) usStackDepth * sizeof( portSTACK_TYPE ) );
+
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+			{
+				pxNewTCB->ucStaticallyAllocated = tskSTATICALLY_ALLOCATED_STACK_AND_TCB;
+			}
+			#endif
+
+			#if ( configUSE_PERIODIC_TASKS == 1 )
+			{
+				prvInitialisePeriodic( pxNewTCB, xPeriod, xDeadline, ulBudget );
+			}
+			#else
+			{
+				( void ) xPeriod;
+				( void ) xDeadline;
+				( void ) ulBudget;
+			}
+			#endif
+
+			if( prvAddNewTask( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, &xReturn, pxNewTCB, NULL ) != pdPASS )
+			{
+				xReturn = NULL;
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static signed portBASE_TYPE prvAddNewTask( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, tskTCB *pxNewTCB, const xMemoryRegion * const xRegions )
 {
 signed portBASE_TYPE xReturn;
-tskTCB * pxNewTCB;
 
 	configASSERT( pxTaskCode );
 	configASSERT( ( uxPriority < configMAX_PRIORITIES ) );
 
-	/* Allocate the memory required by the TCB and stack for the new task,
-	checking that the allocation was successful. */
-	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
-
 	if( pxNewTCB != NULL )
 	{
 		portSTACK_TYPE *pxTopOfStack;
@@ -523,6 +918,7 @@ tskTCB * pxNewTCB;
 			the termination list and free up any memory allocated by the
 			scheduler for the TCB and stack. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -615,6 +1011,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 		}
@@ -631,6 +1028,154 @@ tskTCB * pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PERIODIC_TASKS == 1 )
+
+	void vTaskWaitForNextPeriod( void )
+	{
+	xPeriodicTaskType *pxPeriodic;
+	portTickType xElapsed, xTimeToWake;
+	unsigned long ulNow, ulExecution;
+	portBASE_TYPE xAlreadyYielded, xMissed = pdFALSE;
+
+		pxPeriodic = &( pxCurrentTCB->xPeriodic );
+		configASSERT( ( pxPeriodic->xPeriod > 0U ) );
+
+		vTaskSuspendAll();
+		{
+			/* The task cannot be switched out while the scheduler is suspended,
+			so the time since it was switched in is all its own.  Adding that
+			to its total gives what it has run for up to now. */
+			ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			ulExecution = ( pxCurrentTCB->ulRunTimeCounter + ( ulNow - ulTaskSwitchedInTime ) ) - pxPeriodic->ulStartRunTime;
+
+			pxPeriodic->ulActivations++;
+			pxPeriodic->ulExecutionLast = ulExecution;
+			pxPeriodic->ulExecutionTotal += ulExecution;
+			if( ulExecution > pxPeriodic->ulExecutionMax )
+			{
+				pxPeriodic->ulExecutionMax = ulExecution;
+			}
+			if( ( pxPeriodic->ulBudget != 0UL ) && ( ulExecution > pxPeriodic->ulBudget ) )
+			{
+				pxPeriodic->ulBudgetOverruns++;
+			}
+
+			/* Finishing on the deadline tick is already too late, as that tick
+			marks the start of the deadline rather than the end.  The unsigned
+			subtraction copes with the tick count overflowing. */
+			xElapsed = xTickCount - pxPeriodic->xRelease;
+			if( xElapsed >= pxPeriodic->xDeadline )
+			{
+				pxPeriodic->ulDeadlineMisses++;
+				xMissed = pdTRUE;
+			}
+
+			/* The next release is a whole period after this one, however late
+			this one ran, so the releases keep to the same ticks.  If it has
+			already passed the next activation starts straight away, as with
+			vTaskDelayUntil(). */
+			xTimeToWake = pxPeriodic->xRelease + pxPeriodic->xPeriod;
+			pxPeriodic->xRelease = xTimeToWake;
+
+			if( xElapsed < pxPeriodic->xPeriod )
+			{
+				traceTASK_DELAY_UNTIL();
+
+				pxPeriodic->xWaitingForRelease = pdTRUE;
+
+				/* We must remove ourselves from the ready list before adding
+				ourselves to the blocked list as the same list item is used for
+				both lists. */
+				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+				prvAddCurrentTaskToDelayedList( xTimeToWake );
+			}
+			else
+			{
+				pxPeriodic->ulReleasedAt = ulNow;
+
+				#if ( configUSE_EDF_SCHEDULER == 1 )
+				{
+					/* Going straight on to the next activation moves the
+					deadline on, so the task has to go back into the ready list
+					behind anything that is now due before it. */
+					if( pxCurrentTCB->uxPriority == ( unsigned portBASE_TYPE ) configEDF_PRIORITY )
+					{
+						vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+						prvAddTaskToReadyQueue( pxCurrentTCB );
+					}
+				}
+				#endif
+			}
+		}
+		xAlreadyYielded = xTaskResumeAll();
+
+		if( xAlreadyYielded == pdFALSE )
+		{
+			portYIELD_WITHIN_API();
+		}
+
+		/* Running again, so the next activation starts here.  A critical
+		section rather than suspending the scheduler, as the tick interrupt
+		writes ulReleasedAt while xWaitingForRelease is set. */
+		taskENTER_CRITICAL();
+		{
+			ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			pxPeriodic->xWaitingForRelease = pdFALSE;
+			pxPeriodic->ulStartRunTime = pxCurrentTCB->ulRunTimeCounter + ( ulNow - ulTaskSwitchedInTime );
+
+			ulNow -= pxPeriodic->ulReleasedAt;
+			pxPeriodic->ulJitterTotal += ulNow;
+			if( ulNow > pxPeriodic->ulJitterMax )
+			{
+				pxPeriodic->ulJitterMax = ulNow;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		#if ( configUSE_DEADLINE_MISSED_HOOK == 1 )
+		{
+			if( xMissed != pdFALSE )
+			{
+				vApplicationDeadlineMissedHook( ( xTaskHandle ) pxCurrentTCB, pxCurrentTCB->pcTaskName );
+			}
+		}
+		#else
+		{
+			( void ) xMissed;
+		}
+		#endif
+	}
+
+#endif /* configUSE_PERIODIC_TASKS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PERIODIC_TASKS == 1 )
+
+	portBASE_TYPE xTaskGetPeriodicStatus( xTaskHandle xTask, xPeriodicTaskType *pxStatus )
+	{
+	tskTCB *pxTCB;
+	portBASE_TYPE xReturn = pdFALSE;
+
+		configASSERT( pxStatus );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			if( pxTCB->xPeriodic.xPeriod != ( portTickType ) 0U )
+			{
+				*pxStatus = pxTCB->xPeriodic;
+				xReturn = pdTRUE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_PERIODIC_TASKS */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskDelay == 1 )
 
 	void vTaskDelay( portTickType xTicksToDelay )
@@ -661,6 +1206,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 			xAlreadyYielded = xTaskResumeAll();
@@ -780,7 +1326,12 @@ tskTCB * pxNewTCB;
 				}
 				#endif
 
-				listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( configMAX_PRIORITIES - ( portTickType ) uxNewPriority ) );
+				/* Only reset the event list item value if the value is not
+				being used for anything else. */
+				if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+				{
+					listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( configMAX_PRIORITIES - ( portTickType ) uxNewPriority ) );
+				}
 
 				/* If the task is in the blocked or suspended list we need do
 				nothing more than change it's priority variable. However, if
@@ -792,6 +1343,7 @@ tskTCB * pxNewTCB;
 					it to it's new ready list.  As we are in a critical section we
 					can do this even if the scheduler is suspended. */
 					vListRemove( &( pxTCB->xGenericListItem ) );
+					taskRESET_READY_PRIORITY( uxCurrentPriority );
 					prvAddTaskToReadyQueue( pxTCB );
 				}
 
@@ -829,6 +1381,7 @@ tskTCB * pxNewTCB;
 
 			/* Remove task from the ready/delayed list and place in the	suspended list. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer != NULL )
@@ -895,6 +1448,17 @@ tskTCB * pxNewTCB;
 				if( listIS_CONTAINED_WITHIN( NULL, &( pxTCB->xEventListItem ) ) == pdTRUE )
 				{
 					xReturn = pdTRUE;
+
+					#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+					{
+						/* Waiting for a notification with no timeout also
+						uses the suspended list without an event list. */
+						if( pxTCB->eNotifyState == eWaitingNotification )
+						{
+							xReturn = pdFALSE;
+						}
+					}
+					#endif
 				}
 			}
 		}
@@ -1003,15 +1567,42 @@ void vTaskStartScheduler( void )
 portBASE_TYPE xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
-	{
-		/* Create the idle task, storing its handle in xIdleTaskHandle so it can
-		be returned by the xTaskGetIdleTaskHandle() function. */
-		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), &xIdleTaskHandle );
-	}
-	#else
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
 	{
-		/* Create the idle task without storing its handle. */
+	xStaticTaskType *pxIdleTaskTCBBuffer = NULL;
+	portSTACK_TYPE *pxIdleTaskStackBuffer = NULL;
+	unsigned short usIdleTaskStackSize = tskIDLE_STACK_SIZE;
+	xTaskHandle xIdle;
+
+		/* The application supplies the idle task's memory, so starting the
+		scheduler needs nothing from the heap. */
+		vApplicationGetIdleTaskMemory( &pxIdleTaskTCBBuffer, &pxIdleTaskStackBuffer, &usIdleTaskStackSize );
+		xIdle = xTaskCreateStatic( prvIdleTask, ( signed char * ) "IDLE", usIdleTaskStackSize, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), pxIdleTaskStackBuffer, pxIdleTaskTCBBuffer );
+
+		#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+		{
+			xIdleTaskHandle = xIdle;
+		}
+		#endif
+
+		if( xIdle != NULL )
+		{
+			xReturn = pdPASS;
+		}
+		else
+		{
+			xReturn = pdFAIL;
+		}
+	}
+	#elif ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	{
+		/* Create the idle task, storing its handle in xIdleTaskHandle so it can
+		be returned by the xTaskGetIdleTaskHandle() function. */
+		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), &xIdleTaskHandle );
+	}
+	#else
+	{
+		/* Create the idle task without storing its handle. */
 		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), NULL );
 	}
 	#endif
@@ -1038,12 +1629,20 @@ portBASE_TYPE xReturn;
 		portDISABLE_INTERRUPTS();
 
 		xSchedulerRunning = pdTRUE;
-		xTickCount = ( portTickType ) 0U;
+		xTickCount = ( portTickType ) configINITIAL_TICK_COUNT;
 
 		/* If configGENERATE_RUN_TIME_STATS is defined then the following
 		macro must be defined to configure the timer/counter used to generate
 		the run time counter time base. */
-		//portCONFIGURE_TIMER_FOR_RUN_TIME_STATS();
+		portCONFIGURE_TIMER_FOR_RUN_TIME_STATS();
+
+		/* Guard the stack of the task that runs first, the port turns the
+		MPU on. */
+		#if ( configUSE_MPU_STACK_GUARD == 1 )
+		{
+			portSET_STACK_GUARD( pxCurrentTCB->pxStack );
+		}
+		#endif
 		
 		/* Setting up the timer tick is hardware specific and thus in the
 		portable interface. */
@@ -1283,6 +1882,73 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 #endif
 /*----------------------------------------------------------*/
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime )
+	{
+	unsigned portBASE_TYPE uxTask = 0, uxQueue = configMAX_PRIORITIES;
+
+		vTaskSuspendAll();
+		{
+			/* Is there a space in the array for each task in the system? */
+			if( uxArraySize >= uxCurrentNumberOfTasks )
+			{
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Ready state. */
+				do
+				{
+					uxQueue--;
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), tskREADY_CHAR );
+
+				} while( uxQueue > ( unsigned portBASE_TYPE ) tskIDLE_PRIORITY );
+
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Blocked state. */
+				uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxDelayedTaskList, tskBLOCKED_CHAR );
+				uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxOverflowDelayedTaskList, tskBLOCKED_CHAR );
+
+				#if( INCLUDE_vTaskDelete == 1 )
+				{
+					/* Fill in an xTaskStatusType structure with information on
+					each task that has been deleted but not yet cleaned up. */
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xTasksWaitingTermination, tskDELETED_CHAR );
+				}
+				#endif
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					/* Fill in an xTaskStatusType structure with information on
+					each task in the Suspended state. */
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xSuspendedTaskList, tskSUSPENDED_CHAR );
+				}
+				#endif
+
+				if( pulTotalRunTime != NULL )
+				{
+					#if ( configGENERATE_RUN_TIME_STATS == 1 )
+					{
+						#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+							portALT_GET_RUN_TIME_COUNTER_VALUE( ( *pulTotalRunTime ) );
+						#else
+							*pulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+						#endif
+					}
+					#else
+					{
+						*pulTotalRunTime = 0UL;
+					}
+					#endif
+				}
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return uxTask;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	void vTaskGetRunTimeStats( signed char *pcWriteBuffer )
@@ -1450,6 +2116,77 @@ tskTCB * pxTCB;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  Note this does *not* call the tick hook function for
+		each stepped tick. */
+		configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
+		xTickCount += xTicksToJump;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( taskHIGHER_THAN_IDLE_READY() )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > 1 )
+		{
+			/* There are other idle priority tasks in the ready state.  If
+			time slicing is used then the very next tick interrupt must be
+			processed. */
+			xReturn = 0;
+		}
+		else
+		{
+			xReturn = xNextTaskUnblockTime - xTickCount;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != 0 )
+		{
+			/* A task was made ready while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A yield was pended while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( uxMissedTicks != ( unsigned portBASE_TYPE ) 0U )
+		{
+			/* A tick came in after the expected idle time was worked out,
+			so the tick count it was based on is already out of date. */
+			eReturn = eAbortSleep;
+		}
+
+		return eReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 
 	void vTaskSetApplicationTaskTag( xTaskHandle xTask, pdTASK_HOOK_CODE pxHookFunction )
@@ -1556,7 +2293,7 @@ void vTaskSwitchContext( void )
 				#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
 					portALT_GET_RUN_TIME_COUNTER_VALUE( ulTempCounter );
 				#else
-					//ulTempCounter = portGET_RUN_TIME_COUNTER_VALUE();
+					ulTempCounter = portGET_RUN_TIME_COUNTER_VALUE();
 				#endif
 	
 				/* Add the amount of time the task has been running to the accumulated
@@ -1572,16 +2309,17 @@ void vTaskSwitchContext( void )
 		taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 	
-		/* Find the highest priority queue that contains ready tasks. */
-		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
+		/* Select a new task to run using either the generic C or port
+		optimised code. */
+		taskSELECT_HIGHEST_PRIORITY_TASK();
+
+		/* Move the MPU guard to the bottom of the new task's stack, in place
+		of the pattern checks above. */
+		#if ( configUSE_MPU_STACK_GUARD == 1 )
 		{
-			configASSERT( uxTopReadyPriority );
-			--uxTopReadyPriority;
+			portSET_STACK_GUARD( pxCurrentTCB->pxStack );
 		}
-	
-		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
-		same priority get an equal share of the processor time. */
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+		#endif
 	
 		traceTASK_SWITCHED_IN();
 	}
@@ -1606,6 +2344,7 @@ portTickType xTimeToWake;
 	to the blocked list as the same list item is used for both lists.  We have
 	exclusive access to the ready lists as the scheduler is locked. */
 	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 
 	#if ( INCLUDE_vTaskSuspend == 1 )
@@ -1660,6 +2399,7 @@ portTickType xTimeToWake;
 		blocked list as the same list item is used for both lists.  This
 		function is called form a critical section. */
 		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 		/* Calculate the time at which the task should be woken if the event does
 		not occur.  This may overflow but this doesn't matter. */
@@ -1721,6 +2461,119 @@ portBASE_TYPE xReturn;
 }
 /*-----------------------------------------------------------*/
 
+void vTaskPlaceOnUnorderedEventList( xList * pxEventList, portTickType xItemValue, portTickType xTicksToWait )
+{
+portTickType xTimeToWake;
+
+	configASSERT( pxEventList );
+
+	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.  It is used
+	by the event groups implementation. */
+	configASSERT( uxSchedulerSuspended != ( unsigned portBASE_TYPE ) 0U );
+
+	/* Store the item value in the event list item.  It is safe to access the
+	event list item here as interrupts won't access the event list item of a
+	task that is not in the Blocked state. */
+	listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xEventListItem ), xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
+
+	/* Place the event list item of the TCB at the end of the appropriate event
+	list.  It is safe to access the event list here because it is part of an
+	event group implementation - and interrupts don't access event groups
+	directly (instead they access them indirectly by pending function calls to
+	the task level). */
+	vListInsertEnd( pxEventList, &( pxCurrentTCB->xEventListItem ) );
+
+	/* The task must be removed from the ready list before it is added to the
+	blocked list.  Exclusive access can be assured to the ready list as the
+	scheduler is locked. */
+	vListRemove( &( pxCurrentTCB->xGenericListItem ) );
+	taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+
+	#if ( INCLUDE_vTaskSuspend == 1 )
+	{
+		if( xTicksToWait == portMAX_DELAY )
+		{
+			/* Add the task to the suspended task list instead of a delayed task
+			list to ensure it is not woken by a timing event.  It will block
+			indefinitely. */
+			vListInsertEnd( ( xList * ) &xSuspendedTaskList, &( pxCurrentTCB->xGenericListItem ) );
+		}
+		else
+		{
+			/* Calculate the time at which the task should be woken if the event
+			does not occur.  This may overflow but this doesn't matter. */
+			xTimeToWake = xTickCount + xTicksToWait;
+			prvAddCurrentTaskToDelayedList( xTimeToWake );
+		}
+	}
+	#else
+	{
+			/* Calculate the time at which the task should be woken if the event
+			does not occur.  This may overflow but this doesn't matter. */
+			xTimeToWake = xTickCount + xTicksToWait;
+			prvAddCurrentTaskToDelayedList( xTimeToWake );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+signed portBASE_TYPE xTaskRemoveFromUnorderedEventList( xListItem * pxEventListItem, portTickType xItemValue )
+{
+tskTCB *pxUnblockedTCB;
+portBASE_TYPE xReturn;
+
+	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.  It is used by
+	the event flags implementation. */
+	configASSERT( uxSchedulerSuspended != ( unsigned portBASE_TYPE ) pdFALSE );
+
+	/* Store the new item value in the event list. */
+	listSET_LIST_ITEM_VALUE( pxEventListItem, xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
+
+	/* Remove the event list form the event flag.  Interrupts do not access
+	event flags. */
+	pxUnblockedTCB = ( tskTCB * ) listGET_LIST_ITEM_OWNER( pxEventListItem );
+	configASSERT( pxUnblockedTCB );
+	vListRemove( pxEventListItem );
+
+	/* Remove the task from the delayed list and add it to the ready list.  The
+	scheduler is suspended so interrupts will not be accessing the ready
+	lists. */
+	vListRemove( &( pxUnblockedTCB->xGenericListItem ) );
+	prvAddTaskToReadyQueue( pxUnblockedTCB );
+
+	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+	{
+		/* Return true if the task removed from the event list has
+		a higher priority than the calling task.  This allows
+		the calling task to know if it should force a context
+		switch now.  xTaskResumeAll() only sees tasks that went through
+		the pending ready list, so mark the yield as missed too. */
+		xReturn = pdTRUE;
+		xMissedYield = pdTRUE;
+	}
+	else
+	{
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+portTickType uxTaskResetEventItemValue( void )
+{
+portTickType uxReturn;
+
+	uxReturn = listGET_LIST_ITEM_VALUE( &( pxCurrentTCB->xEventListItem ) );
+
+	/* Reset the event list item to its normal value - so it can be used with
+	queues and semaphores. */
+	listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xEventListItem ), ( ( portTickType ) configMAX_PRIORITIES - ( portTickType ) pxCurrentTCB->uxPriority ) );
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
 void vTaskSetTimeOutState( xTimeOutType * const pxTimeOut )
 {
 	configASSERT( pxTimeOut );
@@ -1781,6 +2634,18 @@ void vTaskMissedYield( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MPU_STACK_GUARD == 1 )
+
+	void vTaskStackGuardFault( void )
+	{
+		/* The guard only ever covers the running task's stack, so that is
+		the task that overflowed. */
+		vApplicationStackOverflowHook( ( xTaskHandle ) pxCurrentTCB, pxCurrentTCB->pcTaskName );
+	}
+
+#endif /* configUSE_MPU_STACK_GUARD */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_TRACE_FACILITY == 1 )
 	unsigned portBASE_TYPE uxTaskGetTaskNumber( xTaskHandle xTask )
 	{
@@ -1877,6 +2742,43 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			vApplicationIdleHook();
 		}
 		#endif
+
+		/* This conditional compilation should use inequality to 0, not equality
+		to 1.  This is to ensure portSUPPRESS_TICKS_AND_SLEEP() is called when
+		user defined low power mode	implementations require
+		configUSE_TICKLESS_IDLE to be set to a value other than 1. */
+		#if ( configUSE_TICKLESS_IDLE != 0 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* It is not desirable to suspend then resume the scheduler on
+			each iteration of the idle task.  Therefore, a preliminary
+			test of the expected idle time is performed without the
+			scheduler suspended.  The result here is not necessarily
+			valid. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* Now the scheduler is suspended, the expected idle
+					time can be sampled again, and this time its value can
+					be used. */
+					configASSERT( xNextTaskUnblockTime >= xTickCount );
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						traceLOW_POWER_IDLE_BEGIN();
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+						traceLOW_POWER_IDLE_END();
+					}
+				}
+				( void ) xTaskResumeAll();
+			}
+		}
+		#endif
 	}
 } /*lint !e715 pvParameters is not accessed but all task functions require the same prototype. */
 
@@ -1917,6 +2819,12 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( configUSE_TRACE_FACILITY == 1 )
+	{
+		pxTCB->usStackDepth = usStackDepth;
+	}
+	#endif
+
 	vListInitialiseItem( &( pxTCB->xGenericListItem ) );
 	vListInitialiseItem( &( pxTCB->xEventListItem ) );
 
@@ -1946,6 +2854,13 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->eNotifyState = eNotWaitingNotification;
+	}
+	#endif
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, pxTCB->pxStack, usStackDepth );
@@ -1959,6 +2874,23 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PERIODIC_TASKS == 1 )
+
+	static void prvInitialisePeriodic( tskTCB *pxTCB, portTickType xPeriod, portTickType xDeadline, unsigned long ulBudget )
+	{
+		memset( ( void * ) &( pxTCB->xPeriodic ), 0x00, sizeof( xPeriodicTaskType ) );
+		pxTCB->xPeriodic.xPeriod = xPeriod;
+		pxTCB->xPeriodic.xDeadline = xDeadline;
+		pxTCB->xPeriodic.ulBudget = ulBudget;
+
+		/* The first activation starts when the task first runs, from a run
+		time of 0.  Its start is not seen, so it counts as having no jitter. */
+		pxTCB->xPeriodic.xRelease = xTickCount;
+	}
+
+#endif /* configUSE_PERIODIC_TASKS */
+/*-----------------------------------------------------------*/
+
 #if ( portUSING_MPU_WRAPPERS == 1 )
 
 	void vTaskAllocateMPURegions( xTaskHandle xTaskToModify, const xMemoryRegion * const xRegions )
@@ -1978,6 +2910,38 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	/*-----------------------------------------------------------*/
 #endif
 
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+	static void prvInsertByDeadline( xList *pxList, xListItem *pxNewListItem )
+	{
+	volatile xListItem *pxIterator;
+	portTickType xDeadline, xLater;
+
+		xDeadline = listGET_LIST_ITEM_VALUE( pxNewListItem );
+
+		/* Stop in front of the first task due strictly after this one.  The
+		end marker stops the walk as well, whatever its value. */
+		for( pxIterator = ( xListItem * ) &( pxList->xListEnd ); pxIterator->pxNext != ( xListItem * ) &( pxList->xListEnd ); pxIterator = pxIterator->pxNext )
+		{
+			xLater = ( portTickType ) ( pxIterator->pxNext->xItemValue - xDeadline );
+			if( ( xLater != ( portTickType ) 0U ) && ( xLater <= ( portMAX_DELAY >> 1 ) ) )
+			{
+				break;
+			}
+		}
+
+		pxNewListItem->pxNext = pxIterator->pxNext;
+		pxNewListItem->pxNext->pxPrevious = ( volatile xListItem * ) pxNewListItem;
+		pxNewListItem->pxPrevious = pxIterator;
+		pxIterator->pxNext = ( volatile xListItem * ) pxNewListItem;
+		pxNewListItem->pvContainer = ( void * ) pxList;
+
+		( pxList->uxNumberOfItems )++;
+	}
+
+#endif /* configUSE_EDF_SCHEDULER */
+/*-----------------------------------------------------------*/
+
 static void prvInitialiseTaskLists( void )
 {
 unsigned portBASE_TYPE uxPriority;
@@ -2071,36 +3035,40 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 }
 /*-----------------------------------------------------------*/
 
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
-{
-tskTCB *pxNewTCB;
-
-	/* Allocate space for the TCB.  Where the memory comes from depends on
-	the implementation of the port malloc function. */
-	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 
-	if( pxNewTCB != NULL )
+	static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
 	{
-		/* Allocate space for the stack used by the task being created.
-		The base of the stack memory stored in the TCB so the task can
-		be deleted later if required. */
-		pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
+	tskTCB *pxNewTCB;
 
-		if( pxNewTCB->pxStack == NULL )
-		{
-			/* Could not allocate the stack.  Delete the allocated TCB. */
-			vPortFree( pxNewTCB );
-			pxNewTCB = NULL;
-		}
-		else
+		/* Allocate space for the TCB.  Where the memory comes from depends on
+		the implementation of the port malloc function. */
+		pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+
+		if( pxNewTCB != NULL )
 		{
-			/* Just to help debugging. */
-			memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) usStackDepth * sizeof( portSTACK_TYPE ) );
+			/* Allocate space for the stack used by the task being created.
+			The base of the stack memory stored in the TCB so the task can
+			be deleted later if required. */
+			pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
+
+			if( pxNewTCB->pxStack == NULL )
+			{
+				/* Could not allocate the stack.  Delete the allocated TCB. */
+				vPortFree( pxNewTCB );
+				pxNewTCB = NULL;
+			}
+			else
+			{
+				/* Just to help debugging. */
+				memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) usStackDepth * sizeof( portSTACK_TYPE ) );
+			}
 		}
+
+		return pxNewTCB;
 	}
 
-	return pxNewTCB;
-}
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
 #if ( configUSE_TRACE_FACILITY == 1 )
@@ -2135,6 +3103,62 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	static unsigned portBASE_TYPE prvListTaskStatusWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList, signed char cStatus )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+	unsigned portBASE_TYPE uxTask = 0;
+
+		if( listCURRENT_LIST_LENGTH( pxList ) > ( unsigned portBASE_TYPE ) 0 )
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+
+			/* Populate an xTaskStatusType structure within the
+			pxTaskStatusArray array for each task that is referenced from
+			pxList. */
+			do
+			{
+				listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+				pxTaskStatusArray[ uxTask ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxTaskStatusArray[ uxTask ].pcTaskName = ( const signed char * ) &( pxNextTCB->pcTaskName[ 0 ] );
+				pxTaskStatusArray[ uxTask ].xTaskNumber = pxNextTCB->uxTCBNumber;
+				pxTaskStatusArray[ uxTask ].cStatus = cStatus;
+				pxTaskStatusArray[ uxTask ].uxCurrentPriority = pxNextTCB->uxPriority;
+				pxTaskStatusArray[ uxTask ].usStackDepth = pxNextTCB->usStackDepth;
+
+				#if ( configGENERATE_RUN_TIME_STATS == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = pxNextTCB->ulRunTimeCounter;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = 0UL;
+				}
+				#endif
+
+				#if ( portSTACK_GROWTH > 0 )
+				{
+					pxTaskStatusArray[ uxTask ].usStackHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxEndOfStack );
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].usStackHighWaterMark = usTaskCheckFreeStackSpace( ( unsigned char * ) pxNextTCB->pxStack );
+				}
+				#endif
+
+				uxTask++;
+
+			} while( pxNextTCB != pxFirstTCB );
+		}
+
+		return uxTask;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
@@ -2263,9 +3287,30 @@ tskTCB *pxNewTCB;
 		portCLEAN_UP_TCB( pxTCB );
 
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
-		the task to free any memory allocated at the application level. */
-		vPortFreeAligned( pxTCB->pxStack );
-		vPortFree( pxTCB );
+		the task to free any memory allocated at the application level.  Memory
+		the application supplied is left alone. */
+		#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
+		{
+			vPortFreeAligned( pxTCB->pxStack );
+			vPortFree( pxTCB );
+		}
+		#elif ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		{
+			if( pxTCB->ucStaticallyAllocated == tskDYNAMICALLY_ALLOCATED_STACK_AND_TCB )
+			{
+				vPortFreeAligned( pxTCB->pxStack );
+				vPortFree( pxTCB );
+			}
+			else if( pxTCB->ucStaticallyAllocated == tskSTATICALLY_ALLOCATED_STACK_ONLY )
+			{
+				vPortFree( pxTCB );
+			}
+		}
+		#else
+		{
+			( void ) pxTCB;
+		}
+		#endif
 	}
 
 #endif
@@ -2329,14 +3374,20 @@ tskTCB *pxNewTCB;
 
 		if( pxTCB->uxPriority < pxCurrentTCB->uxPriority )
 		{
-			/* Adjust the mutex holder state to account for its new priority. */
-			listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), configMAX_PRIORITIES - ( portTickType ) pxCurrentTCB->uxPriority );
+			/* Adjust the mutex holder state to account for its new priority.
+			Only reset the event list item value if the value is not being
+			used for anything else. */
+			if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+			{
+				listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), configMAX_PRIORITIES - ( portTickType ) pxCurrentTCB->uxPriority );
+			}
 
 			/* If the task being modified is in the ready state it will need to
 			be moved in to a new list. */
 			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) != pdFALSE )
 			{
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Inherit the priority before being moved into the new list. */
 				pxTCB->uxPriority = pxCurrentTCB->uxPriority;
@@ -2368,12 +3419,19 @@ tskTCB *pxNewTCB;
 				/* We must be the running task to be able to give the mutex back.
 				Remove ourselves from the ready list we currently appear in. */
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Disinherit the priority before adding the task into the new
 				ready list. */
 				traceTASK_PRIORITY_DISINHERIT( pxTCB, pxTCB->uxBasePriority );
 				pxTCB->uxPriority = pxTCB->uxBasePriority;
-				listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), configMAX_PRIORITIES - ( portTickType ) pxTCB->uxPriority );
+
+				/* Only reset the event list item value if the value is not
+				being used for anything else. */
+				if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+				{
+					listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), configMAX_PRIORITIES - ( portTickType ) pxTCB->uxPriority );
+				}
 				prvAddTaskToReadyQueue( pxTCB );
 			}
 		}
@@ -2418,6 +3476,314 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvBlockCurrentTaskForNotification( portTickType xTicksToWait )
+	{
+	portTickType xTimeToWake;
+
+		/* The same list item is used for the ready and blocked lists. */
+		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+
+		#if ( INCLUDE_vTaskSuspend == 1 )
+		{
+			if( xTicksToWait == portMAX_DELAY )
+			{
+				/* Add the task to the suspended task list instead of a delayed
+				task list to ensure the task is not woken by a timing event.  It
+				will block indefinitely. */
+				vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				/* Calculate the time at which the task should be woken if no
+				notification is pending.  This may overflow but this doesn't
+				matter. */
+				xTimeToWake = xTickCount + xTicksToWait;
+				prvAddCurrentTaskToDelayedList( xTimeToWake );
+			}
+		}
+		#else
+		{
+				xTimeToWake = xTickCount + xTicksToWait;
+				prvAddCurrentTaskToDelayedList( xTimeToWake );
+		}
+		#endif
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if the notification count is not already non-zero. */
+			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			{
+				/* Mark this task as waiting for a notification. */
+				pxCurrentTCB->eNotifyState = eWaitingNotification;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					prvBlockCurrentTaskForNotification( xTicksToWait );
+
+					/* All ports are written to allow a yield in a critical
+					section (some will yield immediately, others wait until the
+					critical section exits) - but it is not something that
+					application code should ever do. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					( pxCurrentTCB->ulNotifiedValue )--;
+				}
+			}
+
+			pxCurrentTCB->eNotifyState = eNotWaitingNotification;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	portBASE_TYPE xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if a notification is not already pending. */
+			if( pxCurrentTCB->eNotifyState != eNotified )
+			{
+				/* Clear bits in the task's notification value as bits may get
+				set	by the notifying task or interrupt.  This can be used to
+				clear the value to zero. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+
+				/* Mark this task as waiting for a notification. */
+				pxCurrentTCB->eNotifyState = eWaitingNotification;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					prvBlockCurrentTaskForNotification( xTicksToWait );
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			if( pulNotificationValue != NULL )
+			{
+				/* Output the current notification value, which may or may not
+				have changed. */
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+			}
+
+			/* If eNotifyValue is set then either the task never entered the
+			blocked state (because a notification was already pending) or the
+			task unblocked because of a notification.  Otherwise the task
+			unblocked because of a timeout. */
+			if( pxCurrentTCB->eNotifyState == eWaitingNotification )
+			{
+				/* A notification was not received. */
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				/* A notification was already pending or a notification was
+				received while the task was waiting. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				xReturn = pdTRUE;
+			}
+
+			pxCurrentTCB->eNotifyState = eNotWaitingNotification;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	/*
+	 * Update the value of a task that is being notified, returns what state
+	 * the task was in beforehand, or eNotified with *pxValueSet pdFALSE if
+	 * eSetValueWithoutOverwrite found a value already pending.
+	 */
+	static eNotifyValue prvNotifyUpdate( tskTCB *pxTCB, unsigned long ulValue, eNotifyAction eAction, portBASE_TYPE *pxValueSet )
+	{
+	eNotifyValue eOriginalNotifyState;
+
+		*pxValueSet = pdPASS;
+		eOriginalNotifyState = pxTCB->eNotifyState;
+		pxTCB->eNotifyState = eNotified;
+
+		switch( eAction )
+		{
+			case eSetBits	:
+				pxTCB->ulNotifiedValue |= ulValue;
+				break;
+
+			case eIncrement	:
+				( pxTCB->ulNotifiedValue )++;
+				break;
+
+			case eSetValueWithOverwrite	:
+				pxTCB->ulNotifiedValue = ulValue;
+				break;
+
+			case eSetValueWithoutOverwrite :
+				if( eOriginalNotifyState != eNotified )
+				{
+					pxTCB->ulNotifiedValue = ulValue;
+				}
+				else
+				{
+					/* The value could not be written to the task. */
+					*pxValueSet = pdFAIL;
+				}
+				break;
+
+			case eNoAction :
+			default :
+				/* The task is being notified without its notify value being
+				updated. */
+				break;
+		}
+
+		return eOriginalNotifyState;
+	}
+
+	portBASE_TYPE xTaskNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction )
+	{
+	tskTCB * pxTCB;
+	portBASE_TYPE xReturn;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		taskENTER_CRITICAL();
+		{
+			/* If the task is in the blocked state specifically to wait for a
+			notification then unblock it now. */
+			if( prvNotifyUpdate( pxTCB, ulValue, eAction, &xReturn ) == eWaitingNotification )
+			{
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
 
+		return xReturn;
+	}
 
+	portBASE_TYPE xTaskNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB * pxTCB;
+	portBASE_TYPE xReturn;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
 
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			/* If the task is in the blocked state specifically to wait for a
+			notification then unblock it now. */
+			if( prvNotifyUpdate( pxTCB, ulValue, eAction, &xReturn ) == eWaitingNotification )
+			{
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* The delayed and ready lists cannot be accessed, so hold
+					this task pending until the scheduler is resumed. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( ( pxTCB->uxPriority > pxCurrentTCB->uxPriority ) && ( pxHigherPriorityTaskWoken != NULL ) )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					*pxHigherPriorityTaskWoken = pdTRUE;
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return xReturn;
+	}
+
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+		( void ) xTaskNotifyFromISR( xTaskToNotify, 0UL, eIncrement, pxHigherPriorityTaskWoken );
+	}
+
+	portBASE_TYPE xTaskNotifyStateClear( xTaskHandle xTask )
+	{
+	tskTCB *pxTCB;
+	portBASE_TYPE xReturn;
+
+		/* If null is passed in here then it is the calling task that is having
+		its notification state cleared. */
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		taskENTER_CRITICAL();
+		{
+			if( pxTCB->eNotifyState == eNotified )
+			{
+				pxTCB->eNotifyState = eNotWaitingNotification;
+				xReturn = pdPASS;
+			}
+			else
+			{
+				xReturn = pdFAIL;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
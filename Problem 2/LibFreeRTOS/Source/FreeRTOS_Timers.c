@@ -41,25 +41,85 @@ typedef struct tmrTimerControl
 	unsigned portBASE_TYPE	uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	tmrTIMER_CALLBACK		pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		unsigned char		ucStaticallyAllocated;	/*<< Set to pdTRUE if the memory was supplied by the application, so is not freed when the timer is deleted. */
+	#endif
 } xTIMER;
 
+/* xStaticTimerType in FreeRTOS.h must be exactly the same size as an xTIMER.
+This fails to compile if the two have drifted apart. */
+typedef char xStaticTimerTypeSizeCheck[ ( sizeof( xStaticTimerType ) == sizeof( xTIMER ) ) ? 1 : -1 ];
+
 /* The definition of messages that can be sent and received on the timer
-queue. */
-typedef struct tmrTimerQueueMessage
+queue.  Two types of message can be queued - messages that manipulate a
+software timer, and messages that request the execution of a non-timer related
+callback.  The two message types are defined in two separate structures,
+xTIMER_PARAMETERS and xCALLBACK_PARAMETERS respectively, and share the queue
+item through a union. */
+typedef struct tmrTimerParameters
 {
-	portBASE_TYPE			xMessageID;			/*<< The command being sent to the timer service task. */
 	portTickType			xMessageValue;		/*<< An optional value used by a subset of commands, for example, when changing the period of a timer. */
 	xTIMER *				pxTimer;			/*<< The timer to which the command will be applied. */
+} xTIMER_PARAMETERS;
+
+typedef struct tmrCallbackParameters
+{
+	tmrPENDED_FUNCTION		pxCallbackFunction;	/*<< The callback function to execute. */
+	void *					pvParameter1;		/*<< The value that will be used as the callback functions first parameter. */
+	unsigned long			ulParameter2;		/*<< The value that will be used as the callback functions second parameter. */
+} xCALLBACK_PARAMETERS;
+
+typedef struct tmrTimerQueueMessage
+{
+	portBASE_TYPE			xMessageID;			/*<< The command being sent to the timer service task.  Negative for commands that are not applied to a timer. */
+	union
+	{
+		xTIMER_PARAMETERS xTimerParameters;
+
+		/* Don't include xCallbackParameters if it is not going to be used as
+		it makes the structure (and therefore the timer queue) larger. */
+		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+			xCALLBACK_PARAMETERS xCallbackParameters;
+		#endif /* INCLUDE_xTimerPendFunctionCall */
+	} u;
 } xTIMER_MESSAGE;
 
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access xActiveTimerList. */
-PRIVILEGED_DATA static xList xActiveTimerList1;
-PRIVILEGED_DATA static xList xActiveTimerList2;
-PRIVILEGED_DATA static xList *pxCurrentTimerList;
-PRIVILEGED_DATA static xList *pxOverflowTimerList;
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	/* Active timers are stored in a hierarchical timing wheel.  Each level is
+	tmrWHEEL_SLOTS lists, and each slot on a level covers as many ticks as the
+	whole of the level below, so tmrWHEEL_LEVELS levels cover the full tick
+	count.  Reading the expiry time and xWheelTime as tmrWHEEL_BITS bit
+	digits, a timer is stored on the level of the highest digit in which the
+	two differ, in the slot for its own digit there.  When the wheel reaches
+	the start of that slot the timer moves down to a lower level, and when it
+	reaches a level 0 slot the timers in it expire.  Starting, stopping or
+	expiring a timer therefore never looks at any other timer.  Timers that
+	expire after the tick count next overflows wait in xWheelOverflowList.
+	Only the timer service task is allowed to access the wheel. */
+	#define tmrWHEEL_BITS		( 4U )
+	#define tmrWHEEL_SLOTS		( 1U << tmrWHEEL_BITS )
+	#define tmrWHEEL_MASK		( tmrWHEEL_SLOTS - 1U )
+	#define tmrWHEEL_LEVELS		( ( sizeof( portTickType ) * 8U ) / tmrWHEEL_BITS )
+
+	PRIVILEGED_DATA static xList xTimerWheel[ tmrWHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static xList xWheelOverflowList;
+
+	/* The tick up to which the wheel has been processed. */
+	PRIVILEGED_DATA static portTickType xWheelTime = ( portTickType ) 0U;
+
+#else
+
+	/* The list in which active timers are stored.  Timers are referenced in expire
+	time order, with the nearest expiry time at the front of the list.  Only the
+	timer service task is allowed to access xActiveTimerList. */
+	PRIVILEGED_DATA static xList xActiveTimerList1;
+	PRIVILEGED_DATA static xList xActiveTimerList2;
+	PRIVILEGED_DATA static xList *pxCurrentTimerList;
+	PRIVILEGED_DATA static xList *pxOverflowTimerList;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
@@ -70,6 +130,17 @@ PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
 	
 #endif
 
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+
+	/* Depth and loss figures reported by vTimerGetPendStats().  Only the
+	failure count is written from an interrupt, and then only when the queue
+	was full, so a successful pend costs the interrupt nothing extra. */
+	PRIVILEGED_DATA static unsigned portBASE_TYPE uxMaximumEverWaiting = ( unsigned portBASE_TYPE ) 0U;
+	PRIVILEGED_DATA static unsigned long ulFunctionCallsRun = 0UL;
+	PRIVILEGED_DATA static unsigned long ulFunctionCallsFailed = 0UL;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -93,10 +164,30 @@ static void	prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * depending on if the expire time causes a timer counter overflow.  With
+ * configUSE_TIMER_WHEEL the two are the wheel and xWheelOverflowList.
  */
 static portBASE_TYPE prvInsertTimerInActiveList( xTIMER *pxTimer, portTickType xNextExpiryTime, portTickType xTimeNow, portTickType xCommandTime ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	/*
+	 * Place a timer that expires after xWheelTime, but before the tick count
+	 * next overflows, in the wheel.
+	 */
+	static void prvInsertTimerInWheel( xTIMER *pxTimer, portTickType xExpiryTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move the wheel on to xTime, which must be the time returned by
+	 * prvGetNextExpireTime().  Timers in slots that start at xTime move down
+	 * the wheel, then those in the level 0 slot expire.  xEndOfTickCount is
+	 * pdTRUE when the wheel is being emptied because the tick count has
+	 * overflowed.
+	 */
+	static void prvProcessWheelTime( portTickType xTime, portTickType xTimeNow, portBASE_TYPE xEndOfTickCount ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
+
 /*
  * An active timer has reached its expire time.  Reload the timer if it is an
  * auto reload timer, then call its callback.
@@ -129,6 +220,11 @@ static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty ) PRIVIL
  */
 static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty ) PRIVILEGED_FUNCTION;
 
+/*
+ * Sets up a timer whose memory has already been found, however it was found.
+ */
+static void prvInitialiseNewTimer( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xTIMER *pxNewTimer ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------*/
 
 portBASE_TYPE xTimerCreateTimerTask( void )
@@ -143,7 +239,30 @@ portBASE_TYPE xReturn = pdFAIL;
 
 	if( xTimerQueue != NULL )
 	{
-		#if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+		xStaticTaskType *pxTimerTaskTCBBuffer = NULL;
+		portSTACK_TYPE *pxTimerTaskStackBuffer = NULL;
+		unsigned short usTimerTaskStackSize = ( unsigned short ) configTIMER_TASK_STACK_DEPTH;
+		xTaskHandle xTimerTask;
+
+			/* The application supplies the timer task's memory, as it does the
+			idle task's. */
+			vApplicationGetTimerTaskMemory( &pxTimerTaskTCBBuffer, &pxTimerTaskStackBuffer, &usTimerTaskStackSize );
+			xTimerTask = xTaskCreateStatic( prvTimerTask, ( const signed char * ) "Tmr Svc", usTimerTaskStackSize, NULL, ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY, pxTimerTaskStackBuffer, pxTimerTaskTCBBuffer );
+
+			#if ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
+			{
+				xTimerTaskHandle = xTimerTask;
+			}
+			#endif
+
+			if( xTimerTask != NULL )
+			{
+				xReturn = pdPASS;
+			}
+		}
+		#elif ( INCLUDE_xTimerGetTimerDaemonTaskHandle == 1 )
 		{
 			/* Create the timer task, storing its handle in xTimerTaskHandle so
 			it can be returned by the xTimerGetTimerDaemonTaskHandle() function. */
@@ -162,43 +281,92 @@ portBASE_TYPE xReturn = pdFAIL;
 }
 /*-----------------------------------------------------------*/
 
-xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
+static void prvInitialiseNewTimer( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xTIMER *pxNewTimer )
 {
-xTIMER *pxNewTimer;
+	/* Ensure the infrastructure used by the timer service task has been
+	created/initialised. */
+	prvCheckForValidListAndQueue();
+
+	/* Initialise the timer structure members using the function parameters. */
+	pxNewTimer->pcTimerName = pcTimerName;
+	pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
+	pxNewTimer->uxAutoReload = uxAutoReload;
+	pxNewTimer->pvTimerID = pvTimerID;
+	pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+	vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
 
-	/* Allocate the timer structure. */
-	if( xTimerPeriodInTicks == ( portTickType ) 0U )
+	traceTIMER_CREATE( pxNewTimer );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
 	{
-		pxNewTimer = NULL;
-		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+	xTIMER *pxNewTimer;
+
+		/* Allocate the timer structure. */
+		if( xTimerPeriodInTicks == ( portTickType ) 0U )
+		{
+			pxNewTimer = NULL;
+			configASSERT( ( xTimerPeriodInTicks > 0 ) );
+		}
+		else
+		{
+			pxNewTimer = ( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) );
+			if( pxNewTimer != NULL )
+			{
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+				{
+					pxNewTimer->ucStaticallyAllocated = pdFALSE;
+				}
+				#endif
+
+				prvInitialiseNewTimer( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pxNewTimer );
+			}
+			else
+			{
+				traceTIMER_CREATE_FAILED();
+			}
+		}
+
+		return ( xTimerHandle ) pxNewTimer;
 	}
-	else
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimerType *pxTimerBuffer )
 	{
-		pxNewTimer = ( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) );
-		if( pxNewTimer != NULL )
+	xTIMER *pxNewTimer = NULL;
+
+		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+		configASSERT( pxTimerBuffer != NULL );
+
+		if( ( xTimerPeriodInTicks != ( portTickType ) 0U ) && ( pxTimerBuffer != NULL ) )
 		{
-			/* Ensure the infrastructure used by the timer service task has been
-			created/initialised. */
-			prvCheckForValidListAndQueue();
-	
-			/* Initialise the timer structure members using the function parameters. */
-			pxNewTimer->pcTimerName = pcTimerName;
-			pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
-			pxNewTimer->uxAutoReload = uxAutoReload;
-			pxNewTimer->pvTimerID = pvTimerID;
-			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
-			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
-			
-			traceTIMER_CREATE( pxNewTimer );
+			/* The timer lives in the buffer supplied, which is the same size. */
+			pxNewTimer = ( xTIMER * ) pxTimerBuffer;
+
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+			{
+				pxNewTimer->ucStaticallyAllocated = pdTRUE;
+			}
+			#endif
+
+			prvInitialiseNewTimer( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pxNewTimer );
 		}
 		else
 		{
 			traceTIMER_CREATE_FAILED();
 		}
+
+		return ( xTimerHandle ) pxNewTimer;
 	}
-	
-	return ( xTimerHandle ) pxNewTimer;
-}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime )
@@ -212,8 +380,8 @@ xTIMER_MESSAGE xMessage;
 	{
 		/* Send a command to the timer service task to start the xTimer timer. */
 		xMessage.xMessageID = xCommandID;
-		xMessage.xMessageValue = xOptionalValue;
-		xMessage.pxTimer = ( xTIMER * ) xTimer;
+		xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
+		xMessage.u.xTimerParameters.pxTimer = ( xTIMER * ) xTimer;
 
 		if( pxHigherPriorityTaskWoken == NULL )
 		{
@@ -251,6 +419,17 @@ xTIMER_MESSAGE xMessage;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType xTimeNow )
+	{
+		/* xNextExpireTime is the next slot that needs attention, which is not
+		always an expiry.  Everything in it is dealt with in one go. */
+		prvProcessWheelTime( xNextExpireTime, xTimeNow, pdFALSE );
+	}
+
+#else
+
 static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType xTimeNow )
 {
 xTIMER *pxTimer;
@@ -285,6 +464,8 @@ portBASE_TYPE xResult;
 	/* Call the timer callback. */
 	pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvTimerTask( void *pvParameters )
@@ -360,6 +541,56 @@ portBASE_TYPE xTimerListsWereSwitched;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty )
+	{
+	portTickType xNextExpireTime = ( portTickType ) 0U, xBelow, xDigit;
+	unsigned portBASE_TYPE uxLevel, uxShift, uxSlot;
+
+		/* The first occupied slot on the lowest occupied level is the next
+		one the wheel must reach.  On level 0 that is when the timers in it
+		expire, above it when they move down a level, which is never later
+		than they expire.  Every slot on a level starts after every slot on
+		the level below, and a slot behind the wheel's digit on its level is
+		always empty, so the search looks at no more than tmrWHEEL_LEVELS *
+		tmrWHEEL_SLOTS lists however many timers are active.  If the wheel
+		is empty then 0 is returned, so the task unblocks when the tick count
+		overflows, just as it does when the list is empty. */
+		*pxListWasEmpty = pdTRUE;
+
+		for( uxLevel = 0U; ( uxLevel < tmrWHEEL_LEVELS ) && ( *pxListWasEmpty != pdFALSE ); uxLevel++ )
+		{
+			uxShift = uxLevel * tmrWHEEL_BITS;
+			uxSlot = ( unsigned portBASE_TYPE ) ( xWheelTime >> uxShift ) & tmrWHEEL_MASK;
+
+			/* The slot under the wheel is only worth looking at on level 0,
+			where a timer that has moved out of the overflow list may be due
+			already.  On the levels above it has already been emptied. */
+			if( uxLevel != 0U )
+			{
+				uxSlot++;
+			}
+
+			for( ; ( uxSlot < tmrWHEEL_SLOTS ) && ( *pxListWasEmpty != pdFALSE ); uxSlot++ )
+			{
+				if( listLIST_IS_EMPTY( &( xTimerWheel[ uxLevel ][ uxSlot ] ) ) == pdFALSE )
+				{
+					/* The wheel time with this slot's digit in place and the
+					digits below it cleared. */
+					xBelow = ( ( portTickType ) 1U << uxShift ) - ( portTickType ) 1U;
+					xDigit = ( portTickType ) tmrWHEEL_MASK << uxShift;
+					xNextExpireTime = ( xWheelTime & ~( xDigit | xBelow ) ) | ( ( portTickType ) uxSlot << uxShift );
+					*pxListWasEmpty = pdFALSE;
+				}
+			}
+		}
+
+		return xNextExpireTime;
+	}
+
+#else
+
 static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty )
 {
 portTickType xNextExpireTime;
@@ -384,6 +615,8 @@ portTickType xNextExpireTime;
 
 	return xNextExpireTime;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static portTickType prvSampleTimeNow( portBASE_TYPE *pxTimerListsWereSwitched )
@@ -428,7 +661,15 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 		}
 		else
 		{
-			vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			#if ( configUSE_TIMER_WHEEL == 1 )
+			{
+				vListInsertEnd( &xWheelOverflowList, &( pxTimer->xTimerListItem ) );
+			}
+			#else
+			{
+				vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			}
+			#endif
 		}
 	}
 	else
@@ -442,7 +683,15 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 		}
 		else
 		{
-			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			#if ( configUSE_TIMER_WHEEL == 1 )
+			{
+				prvInsertTimerInWheel( pxTimer, xNextExpiryTime );
+			}
+			#else
+			{
+				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			}
+			#endif
 		}
 	}
 
@@ -450,12 +699,118 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvInsertTimerInWheel( xTIMER *pxTimer, portTickType xExpiryTime )
+	{
+	portTickType xDifference;
+	unsigned portBASE_TYPE uxLevel = 0U;
+
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+		/* Find the highest digit in which the expiry time differs from the
+		wheel time.  The expiry time is the later of the two, so its digit
+		there is ahead of the wheel's and the slot is reached before it
+		expires. */
+		xDifference = ( xExpiryTime ^ xWheelTime ) >> tmrWHEEL_BITS;
+		while( xDifference != ( portTickType ) 0U )
+		{
+			uxLevel++;
+			xDifference >>= tmrWHEEL_BITS;
+		}
+
+		/* Slots are not sorted, so the timer just goes on the end. */
+		vListInsertEnd( &( xTimerWheel[ uxLevel ][ ( xExpiryTime >> ( uxLevel * tmrWHEEL_BITS ) ) & tmrWHEEL_MASK ] ), &( pxTimer->xTimerListItem ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvProcessWheelTime( portTickType xTime, portTickType xTimeNow, portBASE_TYPE xEndOfTickCount )
+	{
+	xList *pxSlot;
+	xTIMER *pxTimer;
+	unsigned portBASE_TYPE uxLevel, uxShift;
+	portTickType xReloadTime;
+	portBASE_TYPE xResult;
+
+		xWheelTime = xTime;
+
+		/* Timers in a slot that starts now move down the wheel.  Going from
+		the top level down lets a timer fall through more than one level, as
+		far as level 0 if it expires now. */
+		for( uxLevel = tmrWHEEL_LEVELS - 1U; uxLevel > 0U; uxLevel-- )
+		{
+			uxShift = uxLevel * tmrWHEEL_BITS;
+			if( ( xTime & ( ( ( portTickType ) 1U << uxShift ) - ( portTickType ) 1U ) ) == ( portTickType ) 0U )
+			{
+				pxSlot = &( xTimerWheel[ uxLevel ][ ( xTime >> uxShift ) & tmrWHEEL_MASK ] );
+				while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+				{
+					pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+					vListRemove( &( pxTimer->xTimerListItem ) );
+					prvInsertTimerInWheel( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
+				}
+			}
+		}
+
+		/* Everything in the level 0 slot expires now. */
+		pxSlot = &( xTimerWheel[ 0 ][ xTime & tmrWHEEL_MASK ] );
+		while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+		{
+			pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+			vListRemove( &( pxTimer->xTimerListItem ) );
+			traceTIMER_EXPIRED( pxTimer );
+
+			if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
+			{
+				if( xEndOfTickCount == pdFALSE )
+				{
+					/* As prvProcessExpiredTimer() for the lists.  The new
+					expiry time is later than xTime, so the timer never goes
+					back into the slot being emptied. */
+					if( prvInsertTimerInActiveList( pxTimer, ( xTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTime ) == pdTRUE )
+					{
+						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xTime, NULL, tmrNO_DELAY );
+						configASSERT( xResult );
+						( void ) xResult;
+					}
+				}
+				else
+				{
+					/* As prvSwitchTimerLists() for the lists.  A reload
+					before the overflow is dealt with as the wheel is
+					emptied, one after it by a command once it has been. */
+					xReloadTime = ( xTime + pxTimer->xTimerPeriodInTicks );
+					if( xReloadTime > xTime )
+					{
+						prvInsertTimerInWheel( pxTimer, xReloadTime );
+					}
+					else
+					{
+						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xTime, NULL, tmrNO_DELAY );
+						configASSERT( xResult );
+						( void ) xResult;
+					}
+				}
+			}
+
+			pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
 static void	prvProcessReceivedCommands( void )
 {
 xTIMER_MESSAGE xMessage;
 xTIMER *pxTimer;
 portBASE_TYPE xTimerListsWereSwitched, xResult;
 portTickType xTimeNow;
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+	unsigned portBASE_TYPE uxWaiting;
+	xCALLBACK_PARAMETERS *pxCallback;
+#endif
 
 	/* In this case the xTimerListsWereSwitched parameter is not used, but it
 	must be present in the function call. */
@@ -463,7 +818,37 @@ portTickType xTimeNow;
 
 	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL )
 	{
-		pxTimer = xMessage.pxTimer;
+		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+		{
+			/* The queue only gets shorter when a command is taken from it, so
+			its depth just before each receive is the peak since the previous
+			one.  Sampling it here keeps the cost out of the senders. */
+			uxWaiting = uxQueueMessagesWaiting( xTimerQueue ) + ( unsigned portBASE_TYPE ) 1U;
+			if( uxWaiting > uxMaximumEverWaiting )
+			{
+				uxMaximumEverWaiting = uxWaiting;
+			}
+
+			/* Negative commands are not timer related. */
+			if( xMessage.xMessageID < ( portBASE_TYPE ) 0 )
+			{
+				pxCallback = &( xMessage.u.xCallbackParameters );
+
+				/* The xCallbackParameters member requests a callback be
+				executed.  Check the callback is not NULL. */
+				configASSERT( pxCallback->pxCallbackFunction );
+
+				/* Call the function. */
+				pxCallback->pxCallbackFunction( pxCallback->pvParameter1, pxCallback->ulParameter2 );
+				ulFunctionCallsRun++;
+
+				/* Nothing else to do for this command. */
+				continue;
+			}
+		}
+		#endif /* INCLUDE_xTimerPendFunctionCall */
+
+		pxTimer = xMessage.u.xTimerParameters.pxTimer;
 
 		/* Is the timer already in a list of active timers?  When the command
 		is trmCOMMAND_PROCESS_TIMER_OVERFLOW, the timer will be NULL as the
@@ -477,13 +862,13 @@ portTickType xTimeNow;
 			}
 		}
 
-		traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.xMessageValue );
+		traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
 		
 		switch( xMessage.xMessageID )
 		{
 			case tmrCOMMAND_START :	
 				/* Start or restart a timer. */
-				if( prvInsertTimerInActiveList( pxTimer,  xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.xMessageValue ) == pdTRUE )
+				if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) == pdTRUE )
 				{
 					/* The timer expired before it was added to the active timer
 					list.  Process it now. */
@@ -491,7 +876,7 @@ portTickType xTimeNow;
 
 					if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
 					{
-						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xMessage.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
+						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
 						configASSERT( xResult );
 						( void ) xResult;
 					}
@@ -504,15 +889,27 @@ portTickType xTimeNow;
 				break;
 
 			case tmrCOMMAND_CHANGE_PERIOD :
-				pxTimer->xTimerPeriodInTicks = xMessage.xMessageValue;
+				pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
 				configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
 				prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
 				break;
 
 			case tmrCOMMAND_DELETE :
 				/* The timer has already been removed from the active list,
-				just free up the memory. */
-				vPortFree( pxTimer );
+				just free up the memory, unless the application supplied
+				it. */
+				#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
+				{
+					vPortFree( pxTimer );
+				}
+				#elif ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+				{
+					if( pxTimer->ucStaticallyAllocated == pdFALSE )
+					{
+						vPortFree( pxTimer );
+					}
+				}
+				#endif
 				break;
 
 			default	:			
@@ -523,6 +920,41 @@ portTickType xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvSwitchTimerLists( portTickType xLastTime )
+	{
+	portTickType xNextExpireTime;
+	portBASE_TYPE xWheelWasEmpty;
+	xTIMER *pxTimer;
+
+		/* Remove compiler warnings if configASSERT() is not defined. */
+		( void ) xLastTime;
+
+		/* The tick count has overflowed.  Any timers still in the wheel
+		expired before it did, so run the wheel on to the end of the old
+		count first.  Each step is only as far as the next occupied slot. */
+		xNextExpireTime = prvGetNextExpireTime( &xWheelWasEmpty );
+		while( xWheelWasEmpty == pdFALSE )
+		{
+			prvProcessWheelTime( xNextExpireTime, xNextExpireTime, pdTRUE );
+			xNextExpireTime = prvGetNextExpireTime( &xWheelWasEmpty );
+		}
+
+		/* Then start the wheel again from 0 with the timers that were waiting
+		for the overflow.  One due at 0 itself goes in the level 0 slot under
+		the wheel, which prvGetNextExpireTime() still checks. */
+		xWheelTime = ( portTickType ) 0U;
+		while( listLIST_IS_EMPTY( &xWheelOverflowList ) == pdFALSE )
+		{
+			pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( &xWheelOverflowList );
+			vListRemove( &( pxTimer->xTimerListItem ) );
+			prvInsertTimerInWheel( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
+		}
+	}
+
+#else
+
 static void prvSwitchTimerLists( portTickType xLastTime )
 {
 portTickType xNextExpireTime, xReloadTime;
@@ -578,6 +1010,8 @@ portBASE_TYPE xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -589,11 +1023,41 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
-			xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
+			#if ( configUSE_TIMER_WHEEL == 1 )
+			{
+			unsigned portBASE_TYPE uxLevel, uxSlot;
+
+				for( uxLevel = 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+				vListInitialise( &xWheelOverflowList );
+			}
+			#else
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+			/* The command queue is always static if it can be, so the timers
+			need nothing from the heap. */
+			static xStaticQueueType xStaticTimerQueue;
+			static unsigned char ucStaticTimerQueueStorage[ configTIMER_QUEUE_LENGTH * sizeof( xTIMER_MESSAGE ) ];
+
+				xTimerQueue = xQueueCreateStatic( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ), ucStaticTimerQueueStorage, &xStaticTimerQueue );
+			}
+			#else
+			{
+				xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
+			}
+			#endif
 		}
 	}
 	taskEXIT_CRITICAL();
@@ -627,6 +1091,119 @@ xTIMER *pxTimer = ( xTIMER * ) xTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+
+	portBASE_TYPE xTimerPendFunctionCallFromISR( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	xTIMER_MESSAGE xMessage;
+	portBASE_TYPE xReturn = pdFAIL;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		/* Complete the message with the function parameters and post it to the
+		daemon task.  This one queue write is all the interrupt pays for. */
+		xMessage.xMessageID = tmrCOMMAND_EXECUTE_CALLBACK;
+		xMessage.u.xCallbackParameters.pxCallbackFunction = xFunctionToPend;
+		xMessage.u.xCallbackParameters.pvParameter1 = pvParameter1;
+		xMessage.u.xCallbackParameters.ulParameter2 = ulParameter2;
+
+		/* The queue does not exist until a timer has been created or the
+		scheduler started.  An interrupt that fires before then loses the call,
+		which is counted as a failure. */
+		if( xTimerQueue != NULL )
+		{
+			xReturn = xQueueSendFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+		}
+
+		if( xReturn != pdPASS )
+		{
+			/* Interrupts of a higher priority may also be pending calls. */
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			{
+				ulFunctionCallsFailed++;
+			}
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+
+		tracePEND_FUNC_CALL_FROM_ISR( xFunctionToPend, pvParameter1, ulParameter2, xReturn );
+
+		return xReturn;
+	}
+
+#endif /* INCLUDE_xTimerPendFunctionCall */
+/*-----------------------------------------------------------*/
+
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+
+	portBASE_TYPE xTimerPendFunctionCall( tmrPENDED_FUNCTION xFunctionToPend, void *pvParameter1, unsigned long ulParameter2, portTickType xTicksToWait )
+	{
+	xTIMER_MESSAGE xMessage;
+	portBASE_TYPE xReturn;
+
+		/* This function can only be called after a timer has been created or
+		after the scheduler has been started because, until then, the timer
+		queue does not exist. */
+		configASSERT( xTimerQueue );
+
+		/* Complete the message with the function parameters and post it to the
+		daemon task. */
+		xMessage.xMessageID = tmrCOMMAND_EXECUTE_CALLBACK;
+		xMessage.u.xCallbackParameters.pxCallbackFunction = xFunctionToPend;
+		xMessage.u.xCallbackParameters.pvParameter1 = pvParameter1;
+		xMessage.u.xCallbackParameters.ulParameter2 = ulParameter2;
+
+		xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+
+		if( xReturn != pdPASS )
+		{
+			taskENTER_CRITICAL();
+			{
+				ulFunctionCallsFailed++;
+			}
+			taskEXIT_CRITICAL();
+		}
+
+		tracePEND_FUNC_CALL( xFunctionToPend, pvParameter1, ulParameter2, xReturn );
+
+		return xReturn;
+	}
+
+#endif /* INCLUDE_xTimerPendFunctionCall */
+/*-----------------------------------------------------------*/
+
+#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+
+	void vTimerGetPendStats( xTimerPendStatsType *pxPendStats )
+	{
+		configASSERT( pxPendStats );
+
+		taskENTER_CRITICAL();
+		{
+			if( xTimerQueue != NULL )
+			{
+				pxPendStats->uxCommandsWaiting = uxQueueMessagesWaiting( xTimerQueue );
+			}
+			else
+			{
+				pxPendStats->uxCommandsWaiting = ( unsigned portBASE_TYPE ) 0U;
+			}
+
+			/* The timer service task only samples the depth when it runs, so
+			include what is waiting now. */
+			pxPendStats->uxMaximumEverWaiting = uxMaximumEverWaiting;
+			if( pxPendStats->uxCommandsWaiting > pxPendStats->uxMaximumEverWaiting )
+			{
+				pxPendStats->uxMaximumEverWaiting = pxPendStats->uxCommandsWaiting;
+			}
+
+			pxPendStats->ulFunctionCallsRun = ulFunctionCallsRun;
+			pxPendStats->ulFunctionCallsFailed = ulFunctionCallsFailed;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* INCLUDE_xTimerPendFunctionCall */
+/*-----------------------------------------------------------*/
+
 /* This entire source file will be skipped if the application is not configured
 to include software timer functionality.  If you want to include software timer
 functionality then ensure configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
@@ -0,0 +1,231 @@
+/**************************************************************************//**
+ *
+ * @file        TraceRecorder.c
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+#if ( configGENERATE_RUN_TIME_STATS != 1 )
+	#error The trace recorder timestamps events with the run time stats counter, so configGENERATE_RUN_TIME_STATS must be 1.
+#endif
+
+/* Bytes of image sent on each line of a hex dump. */
+#define traceDUMP_BYTES_PER_LINE	( 32U )
+
+/* The image is the only state, so a raw copy of it is a complete dump. */
+PRIVILEGED_DATA xTraceImageType xTraceImage configTRACE_RECORDER_SECTION;
+
+/* The task vTraceTaskSwitchedOut() was told about.  Only used by the
+scheduler, so needs no protection. */
+PRIVILEGED_DATA static uint8_t ucTraceSwitchedOutTask = 0U;
+PRIVILEGED_DATA static portBASE_TYPE xTraceSwitchPending = pdFALSE;
+
+/* The number given to the next queue created. */
+PRIVILEGED_DATA static uint8_t ucTraceNextQueueNumber = 1U;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Writes ucByte as two hex digits at pcOut.
+ */
+static void prvTraceHex( uint8_t ucByte, uint8_t *pcOut ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+void vTraceEnable( void )
+{
+	xTraceImage.ulMagic = traceMAGIC;
+	xTraceImage.usVersion = ( uint16_t ) traceVERSION;
+	xTraceImage.usRecordSize = ( uint16_t ) sizeof( xTraceRecordType );
+	xTraceImage.ulTimerHz = configTRACE_RECORDER_TIMER_HZ;
+	xTraceImage.ulLength = ( uint32_t ) configTRACE_RECORDER_LENGTH;
+	xTraceImage.usMaxTaskNames = ( uint16_t ) traceMAX_TASK_NAMES;
+	xTraceImage.usNameLength = ( uint16_t ) configMAX_TASK_NAME_LEN;
+	xTraceImage.ulHead = 0UL;
+	xTraceImage.ulRecording = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceStop( void )
+{
+	xTraceImage.ulRecording = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceStart( void )
+{
+	if( xTraceImage.ulMagic == traceMAGIC )
+	{
+		xTraceImage.ulRecording = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecord( uint8_t ucEvent, uint8_t ucObject, uint16_t usParameter )
+{
+unsigned long ulSavedInterruptMask;
+xTraceRecordType *pxRecord;
+
+	if( xTraceImage.ulRecording != pdFALSE )
+	{
+		/* The mask is raised rather than set so this can be called from
+		inside a critical section or an interrupt without ending either.
+		Interrupts above configMAX_SYSCALL_INTERRUPT_PRIORITY are not masked,
+		so must not record events. */
+		ulSavedInterruptMask = portRAISE_INTERRUPT_MASK();
+		{
+			pxRecord = &( xTraceImage.xRecords[ xTraceImage.ulHead & ( configTRACE_RECORDER_LENGTH - 1UL ) ] );
+			xTraceImage.ulHead++;
+
+			pxRecord->ulTime = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+			pxRecord->ucEvent = ucEvent;
+			pxRecord->ucObject = ucObject;
+			pxRecord->usParameter = usParameter;
+		}
+		portRESTORE_INTERRUPT_MASK( ulSavedInterruptMask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vTraceTaskSwitchedOut( uint8_t ucTask )
+{
+	/* Only remembered.  vTaskSwitchContext() often selects the task that was
+	already running, in which case neither event is worth a record. */
+	ucTraceSwitchedOutTask = ucTask;
+	xTraceSwitchPending = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceTaskSwitchedIn( uint8_t ucTask, uint16_t usPriority )
+{
+	if( xTraceSwitchPending == pdFALSE )
+	{
+		/* The first task to run, there is nothing to switch out. */
+		vTraceRecord( traceEVENT_TASK_SWITCHED_IN, ucTask, usPriority );
+	}
+	else if( ucTask != ucTraceSwitchedOutTask )
+	{
+		vTraceRecord( traceEVENT_TASK_SWITCHED_OUT, ucTraceSwitchedOutTask, 0U );
+		vTraceRecord( traceEVENT_TASK_SWITCHED_IN, ucTask, usPriority );
+	}
+
+	xTraceSwitchPending = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceTaskCreate( uint32_t ulTask, const signed char *pcName, uint16_t usPriority )
+{
+xTraceTaskNameType *pxName = &( xTraceImage.xTaskNames[ ulTask % traceMAX_TASK_NAMES ] );
+
+	/* Names are kept whether or not recording is on, so a task created while
+	stopped is still named in a later dump. */
+	pxName->ulNumber = ulTask;
+	strncpy( ( char * ) pxName->pcName, ( const char * ) pcName, configMAX_TASK_NAME_LEN );
+	pxName->pcName[ configMAX_TASK_NAME_LEN - 1 ] = ( int8_t ) '\0';
+
+	vTraceRecord( traceEVENT_TASK_CREATE, ( uint8_t ) ulTask, usPriority );
+}
+/*-----------------------------------------------------------*/
+
+uint8_t ucTraceQueueCreate( uint8_t ucQueueType )
+{
+uint8_t ucNumber;
+
+	taskENTER_CRITICAL();
+	{
+		/* Number 0 is left for queues created before the recorder saw them. */
+		ucNumber = ucTraceNextQueueNumber;
+		ucTraceNextQueueNumber++;
+		if( ucTraceNextQueueNumber == 0U )
+		{
+			ucTraceNextQueueNumber = 1U;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	xTraceImage.ucQueueTypes[ ucNumber ] = ucQueueType;
+	vTraceRecord( traceEVENT_QUEUE_CREATE, ucNumber, ( uint16_t ) ucQueueType );
+
+	return ucNumber;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceUserEvent( uint8_t ucChannel, uint16_t usValue )
+{
+	vTraceRecord( traceEVENT_USER, ucChannel, usValue );
+}
+/*-----------------------------------------------------------*/
+
+void vTraceDump( traceWRITE_FUNCTION pxWrite )
+{
+static const uint8_t ucBegin[] = "TRACE BEGIN\r\n";
+static const uint8_t ucEnd[] = "TRACE END\r\n";
+uint8_t ucLine[ ( traceDUMP_BYTES_PER_LINE * 2U ) + 2U ];
+const uint8_t *pucImage = ( const uint8_t * ) &xTraceImage;
+uint32_t ulOffset, ulByte, ulCount;
+uint32_t ulSize = ( uint32_t ) sizeof( xTraceImage );
+uint32_t ulUsed;
+
+	vTraceStop();
+
+	/* Records past the head have never been written since the ring was
+	cleared, so are left off the end. */
+	ulUsed = xTraceImage.ulHead;
+	if( ulUsed < ( uint32_t ) configTRACE_RECORDER_LENGTH )
+	{
+		ulSize -= ( ( uint32_t ) configTRACE_RECORDER_LENGTH - ulUsed ) * ( uint32_t ) sizeof( xTraceRecordType );
+	}
+
+	pxWrite( ucBegin, ( uint32_t ) ( sizeof( ucBegin ) - 1U ) );
+
+	for( ulOffset = 0UL; ulOffset < ulSize; ulOffset += ulCount )
+	{
+		ulCount = ulSize - ulOffset;
+		if( ulCount > traceDUMP_BYTES_PER_LINE )
+		{
+			ulCount = traceDUMP_BYTES_PER_LINE;
+		}
+
+		for( ulByte = 0UL; ulByte < ulCount; ulByte++ )
+		{
+			prvTraceHex( pucImage[ ulOffset + ulByte ], &( ucLine[ ulByte * 2UL ] ) );
+		}
+		ucLine[ ulCount * 2UL ] = ( uint8_t ) '\r';
+		ucLine[ ( ulCount * 2UL ) + 1UL ] = ( uint8_t ) '\n';
+
+		pxWrite( ucLine, ( ulCount * 2UL ) + 2UL );
+	}
+
+	pxWrite( ucEnd, ( uint32_t ) ( sizeof( ucEnd ) - 1U ) );
+
+	/* The next dump covers the time from here on. */
+	xTraceImage.ulHead = 0UL;
+	vTraceStart();
+}
+/*-----------------------------------------------------------*/
+
+static void prvTraceHex( uint8_t ucByte, uint8_t *pcOut )
+{
+static const uint8_t ucDigits[] = "0123456789abcdef";
+
+	pcOut[ 0 ] = ucDigits[ ucByte >> 4 ];
+	pcOut[ 1 ] = ucDigits[ ucByte & 0x0fU ];
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TRACE_RECORDER */
@@ -187,6 +187,31 @@ int8_t cPeripheralNumber;
 				break;
 
 
+			case ioctlUSE_STREAM_BUFFER_TX :
+
+				#if ioconfigUSE_UART_TX_STREAM_BUFFER == 1
+				{
+					/* A stream buffer has a single reader and a single writer.
+					The Tx interrupt is the reader, so the Tx interrupt is
+					disabled while this task tops up the FIFO.  Only one task
+					may write at a time - the application must ensure mutual
+					exclusion if more than one task writes to the port. */
+					ioutilsBLOCKING_SEND_TO_TX_STREAM_BUFFER
+						(
+							pxPeripheralControl,
+							UART_IntConfig( pxUART, UART_INTCFG_THRE, DISABLE ),	/* Disable Tx interrupt. */
+							UART_IntConfig( pxUART, UART_INTCFG_THRE, ENABLE ),		/* Enable Tx interrupt. */
+							UART_TX_FIFO_SIZE,										/* Bytes to write to the FIFO. */
+							( pxUART->FIFOLVL & uartTX_FIFO_LEVEL_MASK ) != uartTX_FIFO_LEVEL_MASK,	/* FIFO not full. */
+							pxUART->THR = ucChar,									/* Peripheral write function. */
+							( ( const uint8_t * ) pvBuffer ),						/* Data source. */
+							xBytes,													/* Number of bytes to be written. */
+							xReturn );
+				}
+				#endif /* ioconfigUSE_UART_TX_STREAM_BUFFER */
+				break;
+
+
 			default :
 
 				/* Other methods can be implemented here.  For now set the
@@ -274,6 +299,21 @@ LPC_UART_TypeDef * const pxUART = ( LPC_UART_TypeDef * const ) diGET_PERIPHERAL_
 				break;
 
 
+			case ioctlUSE_STREAM_BUFFER_RX :
+
+				#if ioconfigUSE_UART_RX_STREAM_BUFFER == 1
+				{
+					/* The Rx interrupt is the only writer to the stream buffer
+					and this task must be the only reader, so only one task may
+					read from the port at a time.  The task is only woken once
+					the trigger level set by ioctlSET_RX_TRIGGER_LEVEL has been
+					reached, rather than once per character. */
+					xReturn = xIOUtilsReceiveFromRxStreamBuffer( pxPeripheralControl, ( uint8_t * ) pvBuffer, xBytes );
+				}
+				#endif /* ioconfigUSE_UART_RX_STREAM_BUFFER */
+				break;
+
+
 			default :
 
 				/* Other methods can be implemented here. */
@@ -410,6 +450,8 @@ portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 const unsigned portBASE_TYPE uxUARTNumber = 3UL;
 Transfer_Control_t *pxTransferStruct;
 
+	traceISR_ENTER( UART3_IRQn );
+
 	/* Determine the interrupt source. */
 	ulInterruptSource = UART_GetIntId( LPC_UART3 );
 
@@ -446,6 +488,16 @@ Transfer_Control_t *pxTransferStruct;
 					break;
 
 
+				case ioctlUSE_STREAM_BUFFER_RX :
+
+					#if ioconfigUSE_UART_RX_STREAM_BUFFER == 1
+					{
+						ioutilsRX_CHARS_INTO_STREAM_BUFFER_FROM_ISR( pxTransferStruct, ( ( LPC_UART3->LSR & UART_LSR_RDR ) != 0 ), LPC_UART3->RBR, ulReceived, xHigherPriorityTaskWoken );
+					}
+					#endif /* ioconfigUSE_UART_RX_STREAM_BUFFER */
+					break;
+
+
 				default :
 
 					/* This must be an error.  Force an assert. */
@@ -484,6 +536,16 @@ Transfer_Control_t *pxTransferStruct;
 					break;
 
 
+				case ioctlUSE_STREAM_BUFFER_TX:
+
+					#if ioconfigUSE_UART_TX_STREAM_BUFFER == 1
+					{
+						ioutilsTX_CHARS_FROM_STREAM_BUFFER_FROM_ISR( pxTransferStruct, ( UART_TX_FIFO_SIZE - UART_FIFOLVL_TXFIFOLVL( LPC_UART3->FIFOLVL ) ), ( LPC_UART3->THR = ucChar ), xHigherPriorityTaskWoken );
+					}
+					#endif /* ioconfigUSE_UART_TX_STREAM_BUFFER */
+					break;
+
+
 				default :
 
 					/* This must be an error.  Force an assert. */
@@ -499,5 +561,6 @@ Transfer_Control_t *pxTransferStruct;
 	/* If lHigherPriorityTaskWoken is now equal to pdTRUE, then a context
 	switch should be performed before the interrupt exists.  That ensures the
 	unblocked (higher priority) task is returned to immediately. */
+	traceISR_EXIT( UART3_IRQn );
 	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
 }
@@ -0,0 +1,35 @@
+/*****************************************************************************
+ *   CpuLoad.h:  Header file for the per task CPU load figures
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __CPULOAD_H
+#define __CPULOAD_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#define CPU_MAX_TASKS	16		// Tasks that can be tracked at once
+#define CPU_WINDOW		5		// Samples the load is averaged over
+
+// Load of one task over the window, in hundredths of a percent
+typedef struct
+{
+	char Name[configMAX_TASK_NAME_LEN];
+	unsigned portBASE_TYPE Priority;
+	uint16_t Load;
+} CPU_TaskLoad;
+
+void CPU_Sample(void);
+uint8_t CPU_GetLoads(CPU_TaskLoad *loads, uint8_t max);
+uint16_t CPU_GetTotalLoad(void);
+void CPU_GetTickRate(uint16_t *taken, uint16_t *slept);
+
+#endif /* end __CPULOAD_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,30 @@
+/*****************************************************************************
+ *   KernelBench.h:  Header file for the kernel benchmarks
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __KERNELBENCH_H
+#define __KERNELBENCH_H
+
+#include <stdint.h>
+
+#define BCH_RUNS		1000	// Samples per figure
+
+// Cycle counts (nanoseconds on the host) for one figure
+typedef struct
+{
+	uint32_t Min;
+	uint32_t Max;
+	uint32_t Sum;
+	uint32_t Count;
+} BCH_Stat;
+
+void BCH_Start(void (*Write)(const uint8_t *data, uint32_t length));
+void BCH_Run(void (*Write)(const uint8_t *data, uint32_t length));
+
+#endif /* end __KERNELBENCH_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
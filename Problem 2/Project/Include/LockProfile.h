@@ -0,0 +1,23 @@
+/*****************************************************************************
+ *   LockProfile.h:  Header file for the semaphore and mutex contention report
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __LOCKPROFILE_H
+#define __LOCKPROFILE_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#define LCK_MAX_TASKS	16		// Tasks whose names can be looked up
+#define LCK_HOT_PERCENT	10		// A lock is a hot spot if more of its takes wait
+
+void LCK_Report(void (*Write)(const uint8_t *data, uint32_t length));
+
+#endif /* end __LOCKPROFILE_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,56 @@
+/*****************************************************************************
+ *   Mapping.h:  Header file for the range finder occupancy grid
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __MAPPING_H
+#define __MAPPING_H
+
+#include <stdint.h>
+
+#include "dfrobot.h"
+
+// Grid is (1 << MAP_GRID_BITS) square with the start position in the middle
+// cell. Cells are one WEEE grid square, so map cell (x, y) is the same place
+// as navigation position (x, y). 7 bits is 128 cells, 6.5m a side.
+#ifndef MAP_GRID_BITS
+#define MAP_GRID_BITS	7
+#endif
+#define MAP_GRID_SIZE	(1 << MAP_GRID_BITS)
+#define MAP_GRID_MIN	(-(MAP_GRID_SIZE / 2))
+#define MAP_GRID_MAX	((MAP_GRID_SIZE / 2) - 1)
+#define MAP_CELL_UM		(5 * DFR_TICK_UM)
+
+// Cell values are 4 bit log-odds offset by 8, so 8 is unknown
+#define MAP_UNKNOWN		8
+#define MAP_OCCUPIED	12		// At or above this is an obstacle
+#define MAP_FREE		5		// At or below this is clear
+
+// Export header, followed by the cells packed two to a byte (low nibble is
+// the even x) one row at a time from the lowest y, then a 16 bit sum of
+// every byte before it. All fields little endian.
+typedef struct
+{
+	uint8_t Magic[4];			// "OGM1"
+	uint16_t Size;				// Cells a side
+	uint16_t Reserved;
+	uint32_t CellUm;
+	int32_t X;					// Pose in um and 1/65536ths of a turn
+	int32_t Y;
+	uint16_t Heading;
+	uint16_t Updates;			// Range readings applied, wraps
+} MAP_Header;
+
+void MAP_Init(void);
+void MAP_Odometry(int32_t right, int32_t left);
+void MAP_Update(uint16_t range);
+uint8_t MAP_GetCell(int x, int y);
+void MAP_GetPose(int32_t *x, int32_t *y, uint16_t *heading);
+void MAP_Export(void (*Write)(const uint8_t *data, uint32_t length));
+
+#endif /* end __MAPPING_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,25 @@
+/*****************************************************************************
+ *   Navigation.h:  Header file for the WEEE grid navigation state machine
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __NAVIGATION_H
+#define __NAVIGATION_H
+
+// Grid positions. Destination is set by the joystick, current is updated
+// as each leg of the move completes.
+extern signed dx, dy, cx, cy;
+
+// Set to start moving towards the destination, cleared once started
+extern int centrePressed;
+
+void NAV_Reset(void);
+void NAV_Step(void);
+uint8_t NAV_IsIdle(void);
+
+#endif /* end __NAVIGATION_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,34 @@
+/*****************************************************************************
+ *   Planner.h:  Header file for the WEEE grid path planner
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __PLANNER_H
+#define __PLANNER_H
+
+#include <stdint.h>
+
+// Grid is (1 << PLN_GRID_BITS) square with the origin in the middle, so the
+// default covers -16..15 in x and y. At most 5, one row is a 32 bit word.
+#ifndef PLN_GRID_BITS
+#define PLN_GRID_BITS	5
+#endif
+#define PLN_GRID_SIZE	(1 << PLN_GRID_BITS)
+#define PLN_GRID_MIN	(-(PLN_GRID_SIZE / 2))
+#define PLN_GRID_MAX	((PLN_GRID_SIZE / 2) - 1)
+
+void PLN_Init(void);
+void PLN_SetBlocked(int x, int y, uint8_t blocked);
+uint8_t PLN_IsBlocked(int x, int y);
+int PLN_Plan(int sx, int sy, int gx, int gy);
+int PLN_Replan(void);
+void PLN_MoveStart(int x, int y);
+int PLN_NextWaypoint(int *x, int *y);
+uint32_t PLN_GetExpansions(void);
+
+#endif /* end __PLANNER_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
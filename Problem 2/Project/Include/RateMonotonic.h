@@ -0,0 +1,34 @@
+/*****************************************************************************
+ *   RateMonotonic.h:  Header file for the periodic task schedulability check
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __RATEMONOTONIC_H
+#define __RATEMONOTONIC_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#define RMA_MAX_TASKS		16								// Tasks that can be checked at once
+#define RMA_US_PER_TICK		(1000000UL / configTICK_RATE_HZ)	// Run time counter is 1MHz
+
+// Outcome of a check, utilisations in parts per million
+typedef struct
+{
+	uint8_t Tasks;				// Periodic tasks counted
+	uint8_t Unbudgeted;			// Periodic tasks with no budget, left out
+	uint8_t OutOfOrder;			// Pairs with the shorter period at the lower priority
+	uint32_t Utilisation;		// Sum of budget over the shorter of deadline and period
+	uint32_t Bound;				// n(2^(1/n) - 1) for n tasks, 100% if all are EDF
+} RMA_Result;
+
+uint8_t RMA_Check(RMA_Result *result);
+void RMA_Report(void (*Write)(const uint8_t *data, uint32_t length));
+
+#endif /* end __RATEMONOTONIC_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,47 @@
+/*****************************************************************************
+ *   StackUsage.h:  Header file for the task stack high water mark report
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __STACKUSAGE_H
+#define __STACKUSAGE_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#define STK_MAX_TASKS	16		// Tasks that can be reported at once
+#define STK_MARGIN		25		// Suggested size is the peak plus this percent
+#define STK_HEADROOM	16		// but never less than this many words over it
+#define STK_ROUND		8		// and rounded up to a multiple of this
+
+// Words at the bottom of a stack the task can't use, the MPU guard. Declare
+// stacks STK_ALIGNED so the guard is exactly their bottom 8 words.
+#if configUSE_MPU_STACK_GUARD == 1
+#define STK_GUARD		8
+#define STK_ALIGNED		__attribute__((aligned(portSTACK_GUARD_SIZE)))
+#else
+#define STK_GUARD		0
+#define STK_ALIGNED
+#endif
+
+// Stack use of one task, in words
+typedef struct
+{
+	char Name[configMAX_TASK_NAME_LEN];
+	uint16_t Depth;				// What it was created with
+	uint16_t Peak;				// Most it has ever used
+	uint16_t Suggested;			// Peak with margin, see STK_Suggest()
+} STK_TaskStack;
+
+uint8_t STK_GetUsage(STK_TaskStack *stacks, uint8_t max);
+uint16_t STK_Suggest(uint16_t peak);
+void STK_Report(void (*Write)(const uint8_t *data, uint32_t length));
+
+#endif /* end __STACKUSAGE_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -37,5 +37,10 @@ void WavPlayer_Play(const uint8_t *WavArray, const uint32_t Length);
 /// @warning	Initialize the wav file player before running this function
 uint8_t WavPlayer_IsPlaying(void);
 
+/// @brief 		Give a semaphore from the timer interrupt each time a song finishes
+/// @param[in]  Semaphore - Binary semaphore to give, NULL to stop notifying
+/// @warning	TIMER0 runs below configMAX_LIBRARY_INTERRUPT_PRIORITY so it may give it
+void WavPlayer_NotifyOnStop(xSemaphoreHandle Semaphore);
+
 
 #endif
@@ -17,6 +17,10 @@
 #define DFR_25		0x40
 #define DFR_0		0x00
 
+// Chassis geometry for DFR_SetVelocity() and odometry. Measure these on the robot.
+#define DFR_TRACK_MM			130		// Distance between wheel centres
+#define DFR_TICK_UM				10210	// Wheel travel per encoder count
+
 void DFR_PWMInit (void);
 
 int DFR_SetPWM (int right, int left);
@@ -26,6 +30,10 @@ int DFR_SetLeftPWM (int left);
 int DFR_ScalePWM(int value);
 
 void DFR_ADCInit (void);
+void DFR_RangeUpdate (void);
+uint16_t DFR_GetRange (void);
+void DFR_Govern (void);
+uint16_t DFR_GetSpeedLimit (void);
 
 void DFR_RobotInit (void);
 void DFR_DriveForward(int speed);
@@ -37,6 +45,8 @@ void DFR_SkidLeft(int speed);
 void DFR_DriveStop(void);
 void DFR_SetRightDrive(uint8_t direction, int speed);
 void DFR_SetLeftDrive(uint8_t direction, int speed);
+int DFR_SetVelocity(int v, int omega);
+void DFR_CalibrateFeedforward(void (*Delay)(uint32_t ms));
 void DFR_IncLeftWheelDestination (void);
 void DFR_IncRightWheelDestination (void);
 void DFR_DecLeftWheelDestination (void);
@@ -56,6 +66,8 @@ uint8_t DFR_DecLeftWheelCount(void);
 void DFR_SetLeftWheelDestination(uint8_t distance);
 uint8_t DFR_GetLeftWheelDestination(void);
 void DFR_ClearWheelCounts(void);
+void DFR_EncoderIRQHandler(void);
+void DFR_GetOdometer(int32_t *right, int32_t *left);
 
 void DFR_IncGear(void);
 void DFR_DecGear(void);
@@ -0,0 +1,262 @@
+/*****************************************************************************
+ *   CpuLoad.c:  Per task CPU load over a sliding window
+ *
+ *   Notes: -> TIMER1 free runs at 1MHz as the kernel's run time stats
+ *             counter. The kernel adds each task's time on to its total at
+ *             every context switch.
+ *          -> CPU_Sample() snapshots every task's total. The load is the
+ *             growth over the last CPU_WINDOW samples, so call it at a
+ *             fixed rate (the 1s software timer does) and a figure covers
+ *             the last few seconds rather than everything since reset.
+ *          -> Tasks are told apart by their TCB number, so one deleted and
+ *             created again starts from scratch.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#include "LPC17xx.h"
+#include "LPC17xx_Timer.h"
+#include "CpuLoad.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define CPU_SLOTS		(CPU_WINDOW + 1)	// Newest sample plus the window
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+// Scratch for CPU_Sample(), too big for the timer task's stack
+static xTaskStatusType CPU_Status[CPU_MAX_TASKS];
+static uint16_t CPU_StatusLoad[CPU_MAX_TASKS];
+static uint8_t CPU_Seen[CPU_MAX_TASKS];
+
+// One column per tracked task, one row per sample. Row 0 and the totals
+// start at zero, which is where the counters were when the scheduler started.
+static unsigned portBASE_TYPE CPU_Number[CPU_MAX_TASKS];
+static uint8_t CPU_Used[CPU_MAX_TASKS];
+static uint32_t CPU_Counts[CPU_SLOTS][CPU_MAX_TASKS];
+static uint32_t CPU_Totals[CPU_SLOTS];
+static uint32_t CPU_Ticks[CPU_SLOTS];
+static uint32_t CPU_Slept[CPU_SLOTS];
+static uint8_t CPU_Head = 0;
+
+// Results of the last sample, copied out by CPU_GetLoads()
+static CPU_TaskLoad CPU_Loads[CPU_MAX_TASKS];
+static uint8_t CPU_LoadCount = 0;
+static uint16_t CPU_IdleLoad = 10000;
+static uint16_t CPU_TicksTaken = 0;
+static uint16_t CPU_TicksSlept = 0;
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Column for a task, claiming a free one the first time it's seen.
+ *    Returns CPU_MAX_TASKS if they're all taken.
+ *****************************************************************************/
+static uint8_t CPU_Slot (unsigned portBASE_TYPE number)
+{
+	uint8_t i, row, spare = CPU_MAX_TASKS;
+
+	for(i = 0; i < CPU_MAX_TASKS; i++)
+	{
+		if(CPU_Used[i] && (CPU_Number[i] == number))
+		{
+			return i;
+		}
+		if(!CPU_Used[i] && (spare == CPU_MAX_TASKS))
+		{
+			spare = i;
+		}
+	}
+
+	if(spare < CPU_MAX_TASKS)
+	{
+		// A new task's counter started at zero, so that's its history too
+		CPU_Used[spare] = 1;
+		CPU_Number[spare] = number;
+		for(row = 0; row < CPU_SLOTS; row++)
+		{
+			CPU_Counts[row][spare] = 0;
+		}
+	}
+	return spare;
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Run time stats time base, called by the kernel as the scheduler starts
+ *****************************************************************************/
+void vConfigureTimerForRunTimeStats (void)
+{
+	TIM_TIMERCFG_Type TimerConfig;
+
+	TimerConfig.PrescaleOption = TIM_PRESCALE_USVAL;
+	TimerConfig.PrescaleValue = 1;
+	TIM_Init(LPC_TIM1, TIM_TIMER_MODE, &TimerConfig);
+	TIM_Cmd(LPC_TIM1, ENABLE);
+}
+
+/******************************************************************************
+ * Description:
+ *    Take a snapshot of every task's run time and work out the loads over
+ *    the window. Call at a fixed rate from a task or timer callback.
+ *****************************************************************************/
+void CPU_Sample (void)
+{
+	unsigned long total, ticks, slept;
+	unsigned portBASE_TYPE count, i;
+	uint8_t slot, oldest, loads = 0;
+	uint32_t span, ms, load;
+	uint16_t idle = 0, taken, asleep;
+
+	count = uxTaskGetSystemState(CPU_Status, CPU_MAX_TASKS, &total);
+	if(count == 0)
+	{
+		// More tasks than CPU_MAX_TASKS
+		return;
+	}
+
+	CPU_Head = (CPU_Head + 1) % CPU_SLOTS;
+	oldest = (CPU_Head + 1) % CPU_SLOTS;
+	CPU_Totals[CPU_Head] = total;
+	vPortGetTickStats(&ticks, &slept);
+	CPU_Ticks[CPU_Head] = ticks;
+	CPU_Slept[CPU_Head] = slept;
+
+	// Divide by 10000 first so the sums fit in 32 bits. Over a 5s window
+	// at 1MHz that still leaves 500 counts per hundredth of a percent.
+	span = (CPU_Totals[CPU_Head] - CPU_Totals[oldest]) / 10000UL;
+	if(span == 0)
+	{
+		span = 1;
+	}
+
+	// Tick interrupts and slept through ticks per second of the window
+	ms = (CPU_Totals[CPU_Head] - CPU_Totals[oldest]) / 1000UL;
+	if(ms == 0)
+	{
+		ms = 1;
+	}
+	taken = ((CPU_Ticks[CPU_Head] - CPU_Ticks[oldest]) * 1000UL) / ms;
+	asleep = ((CPU_Slept[CPU_Head] - CPU_Slept[oldest]) * 1000UL) / ms;
+
+	memset(CPU_Seen, 0, sizeof(CPU_Seen));
+	for(i = 0; i < count; i++)
+	{
+		slot = CPU_Slot(CPU_Status[i].xTaskNumber);
+		if(slot == CPU_MAX_TASKS)
+		{
+			CPU_StatusLoad[i] = 0xFFFF;
+			continue;
+		}
+		CPU_Seen[slot] = 1;
+		CPU_Counts[CPU_Head][slot] = CPU_Status[i].ulRunTimeCounter;
+
+		// Clamp before narrowing, a slot with no earlier count can come out
+		// at many times 100%
+		load = (CPU_Counts[CPU_Head][slot] - CPU_Counts[oldest][slot]) / span;
+		if(load > 10000)
+		{
+			load = 10000;
+		}
+		CPU_StatusLoad[i] = (uint16_t)load;
+		if(strcmp((const char *)CPU_Status[i].pcTaskName, "IDLE") == 0)
+		{
+			idle = CPU_StatusLoad[i];
+		}
+	}
+
+	// Anything that wasn't there has been deleted
+	for(slot = 0; slot < CPU_MAX_TASKS; slot++)
+	{
+		if(!CPU_Seen[slot])
+		{
+			CPU_Used[slot] = 0;
+		}
+	}
+
+	// Publish in one go so CPU_GetLoads() never sees half a sample
+	taskENTER_CRITICAL();
+	for(i = 0; i < count; i++)
+	{
+		if(CPU_StatusLoad[i] == 0xFFFF)
+		{
+			continue;
+		}
+		strncpy(CPU_Loads[loads].Name, (const char *)CPU_Status[i].pcTaskName, configMAX_TASK_NAME_LEN);
+		CPU_Loads[loads].Name[configMAX_TASK_NAME_LEN - 1] = '\0';
+		CPU_Loads[loads].Priority = CPU_Status[i].uxCurrentPriority;
+		CPU_Loads[loads].Load = CPU_StatusLoad[i];
+		loads++;
+	}
+	CPU_LoadCount = loads;
+	CPU_IdleLoad = idle;
+	CPU_TicksTaken = taken;
+	CPU_TicksSlept = asleep;
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Description:
+ *    Copy out up to max task loads from the last sample, returns how many.
+ *    Loads are in hundredths of a percent of the window.
+ *****************************************************************************/
+uint8_t CPU_GetLoads (CPU_TaskLoad *loads, uint8_t max)
+{
+	uint8_t count;
+
+	taskENTER_CRITICAL();
+	count = (CPU_LoadCount < max) ? CPU_LoadCount : max;
+	memcpy(loads, CPU_Loads, count * sizeof(CPU_TaskLoad));
+	taskEXIT_CRITICAL();
+
+	return count;
+}
+
+/******************************************************************************
+ * Description:
+ *    Everything but the idle task over the window, in hundredths of a
+ *    percent
+ *****************************************************************************/
+uint16_t CPU_GetTotalLoad (void)
+{
+	return 10000 - CPU_IdleLoad;
+}
+
+/******************************************************************************
+ * Description:
+ *    Tick interrupts taken per second over the window, and ticks per second
+ *    that went by asleep without one. With tickless idle off slept is 0 and
+ *    taken is the tick rate.
+ *****************************************************************************/
+void CPU_GetTickRate (uint16_t *taken, uint16_t *slept)
+{
+	taskENTER_CRITICAL();
+	*taken = CPU_TicksTaken;
+	*slept = CPU_TicksSlept;
+	taskEXIT_CRITICAL();
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,1088 @@
+/*****************************************************************************
+ *   KernelBench.c:  Kernel benchmarks, on target or on the POSIX port
+ *
+ *   Notes: -> Times interrupt to task signalling with the DWT cycle
+ *             counter, once through a binary semaphore and once through a
+ *             direct to task notification.
+ *          -> A trigger task notes the cycle count and pends the spare
+ *             EINT0 interrupt from software. The handler gives to a
+ *             waiting task of higher priority, which notes the cycle count
+ *             again as soon as it runs. Both the give inside the handler
+ *             and the whole trip are recorded.
+ *          -> "pend_call" has the handler defer its work to the timer
+ *             service task with xTimerPendFunctionCallFromISR. The trigger
+ *             drops below the service task for these runs, so the trip ends
+ *             when the pended function starts. The deepest the timer queue
+ *             got and any calls lost to a full queue are printed after.
+ *          -> RAM is the heap a binary semaphore takes. A notification
+ *             takes none, it's 8 bytes in every TCB.
+ *          -> Bulk transfer runs the same trip with BCH_CHUNK bytes, a full
+ *             UART FIFO. The handler sends them one at a time into a
+ *             character queue, or with one call into a stream buffer whose
+ *             trigger level is the whole chunk. The waiter reads until it
+ *             has them all. Bytes per second and cycles per byte come from
+ *             the trip time, as the CPU does nothing else in between.
+ *          -> Context switch time, with whichever ready task selection
+ *             FreeRTOS_Config.h picks. "yield" is two tasks at the same
+ *             priority handing over with taskYIELD. "block_to_low" is a top
+ *             priority task suspending itself so the bench task, dropped
+ *             to just above idle, runs; the generic selection walks every
+ *             empty priority in between, the CLZ one doesn't.
+ *          -> "isr_preempt" is the switch half of the notify trip, from
+ *             portEND_SWITCHING_ISR at the end of the handler to the woken
+ *             task running.
+ *          -> Task side costs, with nothing blocked so nothing switches:
+ *             queue send and receive for each of BCH_ITEM_SIZES, binary
+ *             semaphore give and take, and mutex take and give.
+ *          -> "mutex,handover" is priority inheritance at work. A holder
+ *             just above idle takes the mutex, the bench task blocks on it
+ *             and lends the holder its priority, and the trip is from the
+ *             holder's give to the bench task running again. "inherited"
+ *             counts the runs where the holder really was raised.
+ *          -> Timer start and stop run with the bench task below the timer
+ *             service task, so each call includes the command being
+ *             carried out. BCH_TIMERS other timers are running and the one
+ *             timed lands half way down the active list.
+ *          -> "dl_fast" and "dl_slow" are two periodic tasks, 1.8ms of
+ *             work every 5ms and 3.6ms every 7ms, released together and run
+ *             for BCH_DL_HYPERPERIODS of 35ms. That is 87% of the CPU,
+ *             which rate monotonic priorities can't fit (dl_slow misses its
+ *             first deadline) and earliest deadline first can. With
+ *             configUSE_EDF_SCHEDULER both go to configEDF_PRIORITY,
+ *             otherwise dl_fast is above dl_slow. Each figure is a single
+ *             value: activations and deadline misses, and the longest start
+ *             jitter and execution time in us of the run time counter, from
+ *             xTaskGetPeriodicStatus(). Build once each way and compare,
+ *             on the host with SimBench on virtual time.
+ *          -> Results go out through the Write callback as CSV once the
+ *             runs are done, then the benchmark tasks delete themselves.
+ *             The units are on the first line: CPU cycles from the DWT
+ *             counter on the target, nanoseconds from clock_gettime() on
+ *             the POSIX port. Diff two tables to see what a change to
+ *             FreeRTOS_Config.h or the kernel cost.
+ *          -> On the host, Simulator/Source/SimBench.c runs the lot with
+ *             the handler on a simulated interrupt. The figures there are
+ *             host thread switches, only good for comparing host runs.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Queue.h"
+#include "FreeRTOS_Semaphore.h"
+#include "FreeRTOS_StreamBuffer.h"
+#include "FreeRTOS_Timers.h"
+
+#include "KernelBench.h"
+
+#ifdef FREERTOS_POSIX_PORT
+	#include <time.h>
+#else
+	#include "LPC17xx.h"
+#endif
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define BCH_WAITER_PRIORITY	(configMAX_PRIORITIES - 1)
+#define BCH_TRIGGER_PRIORITY	(configMAX_PRIORITIES - 2)
+
+#ifdef FREERTOS_POSIX_PORT
+	#define BCH_IRQ				2UL				// Simulated interrupt number
+	#define BCH_UNITS			"ns"
+	#define BCH_CLOCK_HZ		1000000000UL
+	#define BCH_NOW()			BCH_HostNow()
+	#define BCH_PEND_IRQ()		vPortGenerateSimulatedInterrupt(BCH_IRQ)
+	#define BCH_ENABLE_IRQ()	vPortSetInterruptHandler(BCH_IRQ, BCH_IRQHandler)
+	#define BCH_DISABLE_IRQ()	vPortSetInterruptHandler(BCH_IRQ, NULL)
+	#define BCH_START_CLOCK()
+
+	void BCH_IRQHandler (void);
+#else
+	#define BCH_IRQ				EINT0_IRQn		// Not wired to anything, pended from software
+	#define BCH_IRQ_PRIORITY	(configMAX_LIBRARY_INTERRUPT_PRIORITY + 1)
+	#define BCH_IRQHandler		EINT0_IRQHandler
+
+	// DWT cycle counter, not in this version of the CMSIS headers
+	#define BCH_DWT_CTRL		(*(volatile uint32_t *)0xE0001000UL)
+	#define BCH_DWT_CYCCNT		(*(volatile uint32_t *)0xE0001004UL)
+	#define BCH_DWT_CYCCNTENA	0x00000001UL
+
+	#define BCH_UNITS			"cycles"
+	#define BCH_CLOCK_HZ		SystemCoreClock
+	#define BCH_NOW()			BCH_DWT_CYCCNT
+	#define BCH_PEND_IRQ()		NVIC_SetPendingIRQ(BCH_IRQ)
+	#define BCH_ENABLE_IRQ()	do { NVIC_SetPriority(BCH_IRQ, BCH_IRQ_PRIORITY); NVIC_EnableIRQ(BCH_IRQ); } while(0)
+	#define BCH_DISABLE_IRQ()	NVIC_DisableIRQ(BCH_IRQ)
+	#define BCH_START_CLOCK()	do { CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; BCH_DWT_CYCCNT = 0; BCH_DWT_CTRL |= BCH_DWT_CYCCNTENA; } while(0)
+#endif
+
+#define BCH_CHUNK			16				// Bytes per interrupt in the transfer modes
+#define BCH_STREAM_SIZE		(BCH_CHUNK * 2)
+
+#define BCH_ITEM_SIZES		4				// Queue item sizes timed, see BCH_ItemSizes
+#define BCH_MAX_ITEM		64
+#define BCH_TIMERS			8				// Timers left running while one is timed
+#define BCH_TIMER_STEP		1000			// Ticks between their periods, none expire during the runs
+
+#define BCH_DEADLINES		((configUSE_PERIODIC_TASKS == 1) && (configSUPPORT_STATIC_ALLOCATION == 1))
+#define BCH_DL_TASKS		2
+#define BCH_DL_HYPERPERIOD	35				// Ticks, lowest common multiple of the periods
+#define BCH_DL_HYPERPERIODS	20
+#define BCH_DL_GAP_US		50				// A longer gap between counter reads is another task running
+#define BCH_US_PER_TICK		(1000000UL / configTICK_RATE_HZ)	// Run time counter is 1MHz
+
+#if configUSE_EDF_SCHEDULER == 1
+	#define BCH_SCHEDULING		"edf"
+	#define BCH_DL_FAST_PRIORITY	configEDF_PRIORITY
+	#define BCH_DL_SLOW_PRIORITY	configEDF_PRIORITY
+#else
+	#define BCH_SCHEDULING		"fixed priority"
+	#define BCH_DL_FAST_PRIORITY	BCH_WAITER_PRIORITY		// Rate monotonic
+	#define BCH_DL_SLOW_PRIORITY	BCH_TRIGGER_PRIORITY
+#endif
+
+// One task of the deadline workload, its work in us of its own run time
+typedef struct
+{
+	const char *Name;
+	portTickType Period;
+	uint32_t Work;
+	unsigned portBASE_TYPE Priority;
+} BCH_Load;
+
+typedef enum
+{
+	BCH_SEMAPHORE = 0,
+	BCH_NOTIFY,
+	BCH_PEND_CALL,		// Runs in the timer service task, no waiter
+	BCH_CHAR_QUEUE,		// Transfer modes from here on
+	BCH_STREAM_BUFFER,
+	BCH_MODES
+} BCH_Mode;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static void (*BCH_Write)(const uint8_t *data, uint32_t length);
+
+static volatile BCH_Mode BCH_CurrentMode;
+static volatile uint32_t BCH_Begin;
+static xSemaphoreHandle BCH_Semaphore = NULL;
+static xQueueHandle BCH_Queue = NULL;
+static xStreamBufferHandle BCH_Stream = NULL;
+static xTaskHandle BCH_Waiter = NULL;
+
+static BCH_Stat BCH_Give[BCH_MODES];
+static BCH_Stat BCH_Wake[BCH_MODES];
+static size_t BCH_HeapBytes[BCH_MODES];
+static volatile uint32_t BCH_Corrupt;
+
+static const char * const BCH_Names[BCH_MODES] = {"semaphore", "notify", "pend_call", "char_queue", "stream_buffer"};
+
+typedef enum
+{
+	BCH_SWITCH_YIELD = 0,
+	BCH_SWITCH_DOWN,
+	BCH_SWITCH_ISR,		// Recorded by the waiter in BCH_NOTIFY mode
+	BCH_SWITCHES
+} BCH_Switch;
+
+static BCH_Stat BCH_SwitchStat[BCH_SWITCHES];
+static xTaskHandle BCH_Yielders[2];
+static const char * const BCH_SwitchNames[BCH_SWITCHES] = {"yield", "block_to_low", "isr_preempt"};
+static volatile uint32_t BCH_IrqExit;
+
+// Task side calls, each timed on its own
+typedef enum
+{
+	BCH_OP_SEM_GIVE = 0,
+	BCH_OP_SEM_TAKE,
+	BCH_OP_MUTEX_TAKE,
+	BCH_OP_MUTEX_GIVE,
+	BCH_OP_MUTEX_HANDOVER,
+	BCH_OP_TIMER_START,
+	BCH_OP_TIMER_STOP,
+	BCH_OPS
+} BCH_Op;
+
+static BCH_Stat BCH_OpStat[BCH_OPS];
+static const char * const BCH_OpNames[BCH_OPS][2] =
+{
+	{"semaphore", "give"}, {"semaphore", "take"},
+	{"mutex", "take"}, {"mutex", "give"}, {"mutex", "handover"},
+	{"timer", "start"}, {"timer", "stop"}
+};
+
+static const uint8_t BCH_ItemSizes[BCH_ITEM_SIZES] = {1, 4, 16, BCH_MAX_ITEM};
+static BCH_Stat BCH_SendStat[BCH_ITEM_SIZES];
+static BCH_Stat BCH_ReceiveStat[BCH_ITEM_SIZES];
+static uint8_t BCH_Item[BCH_MAX_ITEM];
+static uint8_t BCH_ItemOut[BCH_MAX_ITEM];
+
+static xSemaphoreHandle BCH_Mutex = NULL;
+static xTaskHandle BCH_Bench = NULL;
+static volatile uint32_t BCH_Inherited;
+
+static xStaticTimerType BCH_TimerBuffers[BCH_TIMERS + 1];
+static xTimerHandle BCH_Timers[BCH_TIMERS + 1];		// The last one is timed
+static const uint8_t BCH_Data[BCH_CHUNK] =
+{
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+static char BCH_Line[128];
+
+#if BCH_DEADLINES
+static const BCH_Load BCH_Loads[BCH_DL_TASKS] =
+{
+	{"dl_fast", 5, 18 * BCH_US_PER_TICK / 10, BCH_DL_FAST_PRIORITY},
+	{"dl_slow", 7, 36 * BCH_US_PER_TICK / 10, BCH_DL_SLOW_PRIORITY}
+};
+static xStaticTaskType BCH_DeadlineBuffers[BCH_DL_TASKS];
+static portSTACK_TYPE BCH_DeadlineStacks[BCH_DL_TASKS][configMINIMAL_STACK_SIZE];
+static xPeriodicTaskType BCH_DeadlineStatus[BCH_DL_TASKS];
+#endif
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+#ifdef FREERTOS_POSIX_PORT
+// Wraps every 4.3s, which the unsigned differences don't mind
+static uint32_t BCH_HostNow (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec);
+}
+#endif
+
+static void BCH_Record (BCH_Stat *stat, uint32_t cycles)
+{
+	if(stat->Count == 0 || cycles < stat->Min) stat->Min = cycles;
+	if(cycles > stat->Max) stat->Max = cycles;
+	stat->Sum += cycles;
+	stat->Count++;
+}
+
+static void BCH_Print (const char *name, const char *what, const BCH_Stat *stat)
+{
+	int length;
+
+	length = sprintf(BCH_Line, "%s,%s,%lu,%lu,%lu,%lu\r\n", name, what,
+			(unsigned long)stat->Count, (unsigned long)stat->Min,
+			(unsigned long)(stat->Count ? stat->Sum / stat->Count : 0),
+			(unsigned long)stat->Max);
+	BCH_Write((const uint8_t *)BCH_Line, (uint32_t)length);
+}
+
+/******************************************************************************
+ * Description:
+ *    Turns chunk trip times into bytes per second and cycles per byte.
+ *    The slowest trip gives the lowest rate, so min and max swap over.
+ *****************************************************************************/
+static void BCH_PrintRate (const char *name, const BCH_Stat *stat)
+{
+	uint32_t mean;
+	int length;
+
+	if(stat->Count == 0 || stat->Min == 0)
+	{
+		return;
+	}
+	mean = stat->Sum / stat->Count;
+
+	length = sprintf(BCH_Line, "%s,bytes_per_s,%lu,%lu,%lu,%lu\r\n", name,
+			(unsigned long)stat->Count,
+			(unsigned long)((uint64_t)BCH_CHUNK * BCH_CLOCK_HZ / stat->Max),
+			(unsigned long)((uint64_t)BCH_CHUNK * BCH_CLOCK_HZ / mean),
+			(unsigned long)((uint64_t)BCH_CHUNK * BCH_CLOCK_HZ / stat->Min));
+	BCH_Write((const uint8_t *)BCH_Line, (uint32_t)length);
+
+	length = sprintf(BCH_Line, "%s,%s_per_byte,%lu,%lu,%lu,%lu\r\n", name, BCH_UNITS,
+			(unsigned long)stat->Count, (unsigned long)(stat->Min / BCH_CHUNK),
+			(unsigned long)(mean / BCH_CHUNK), (unsigned long)(stat->Max / BCH_CHUNK));
+	BCH_Write((const uint8_t *)BCH_Line, (uint32_t)length);
+}
+
+/******************************************************************************
+ * Description:
+ *    Reads one chunk in whichever transfer mode is under test and checks it
+ *****************************************************************************/
+static void BCH_ReadChunk (void)
+{
+	uint8_t data[BCH_CHUNK];
+	size_t got = 0;
+
+	while(got < BCH_CHUNK)
+	{
+		if(BCH_CurrentMode == BCH_CHAR_QUEUE)
+		{
+			if(xQueueReceive(BCH_Queue, &data[got], portMAX_DELAY) == pdPASS)
+			{
+				got++;
+			}
+		}
+		else
+		{
+			got += xStreamBufferReceive(BCH_Stream, &data[got], BCH_CHUNK - got, portMAX_DELAY);
+		}
+	}
+
+	if(memcmp(data, BCH_Data, BCH_CHUNK) != 0)
+	{
+		BCH_Corrupt++;
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Blocks on whichever primitive is under test and times the wake up
+ *****************************************************************************/
+static void BCH_WaiterTask (void *pvParameters)
+{
+	uint32_t end;
+	(void)pvParameters;
+
+	for(;;)
+	{
+		if(BCH_CurrentMode == BCH_SEMAPHORE)
+		{
+			xSemaphoreTake(BCH_Semaphore, portMAX_DELAY);
+		}
+		else if(BCH_CurrentMode == BCH_NOTIFY)
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+		else
+		{
+			BCH_ReadChunk();
+		}
+		end = BCH_NOW();
+		BCH_Record(&BCH_Wake[BCH_CurrentMode], end - BCH_Begin);
+		if(BCH_CurrentMode == BCH_NOTIFY)
+		{
+			BCH_Record(&BCH_SwitchStat[BCH_SWITCH_ISR], end - BCH_IrqExit);
+		}
+
+		// Not blocked on anything when it's deleted, which the stream buffer insists on
+		if(BCH_Wake[BCH_CurrentMode].Count >= BCH_RUNS)
+		{
+			vTaskSuspend(NULL);
+		}
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Pended from BCH_IRQHandler, times the trip into the timer service
+ *    task
+ *****************************************************************************/
+static void BCH_Deferred (void *Unused, unsigned long Mode)
+{
+	uint32_t end;
+	(void)Unused;
+
+	end = BCH_NOW();
+	BCH_Record(&BCH_Wake[Mode], end - BCH_Begin);
+}
+
+/******************************************************************************
+ * Description:
+ *    Writes one row for a figure that is a single value
+ *****************************************************************************/
+static void BCH_PrintValue (const char *name, const char *what, unsigned long value)
+{
+	int length;
+
+	length = sprintf(BCH_Line, "%s,%s,1,%lu,%lu,%lu\r\n", name, what, value, value, value);
+	BCH_Write((const uint8_t *)BCH_Line, (uint32_t)length);
+}
+
+/******************************************************************************
+ * Description:
+ *    One of a pair at the same priority. Each switch is timed from the
+ *    other task's BCH_Begin to the return from taskYIELD.
+ *****************************************************************************/
+static void BCH_YieldTask (void *pvParameters)
+{
+	uint32_t end;
+	(void)pvParameters;
+
+	// Held until both exist, so the first yield has somewhere to go
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	for(;;)
+	{
+		BCH_Begin = BCH_NOW();
+		taskYIELD();
+		end = BCH_NOW();
+		BCH_Record(&BCH_SwitchStat[BCH_SWITCH_YIELD], end - BCH_Begin);
+
+		if(BCH_SwitchStat[BCH_SWITCH_YIELD].Count >= BCH_RUNS)
+		{
+			vTaskSuspend(NULL);
+		}
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Top priority task that notes the time and suspends straight away
+ *****************************************************************************/
+static void BCH_HighTask (void *pvParameters)
+{
+	(void)pvParameters;
+
+	for(;;)
+	{
+		BCH_Begin = BCH_NOW();
+		vTaskSuspend(NULL);
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Times both kinds of context switch. The bench task only runs again
+ *    once the tasks it makes have suspended themselves.
+ *****************************************************************************/
+static uint8_t BCH_MeasureSwitch (void)
+{
+	uint32_t run, end;
+	uint8_t i, ok = 1;
+
+	// Same priority hand over
+	BCH_Yielders[0] = BCH_Yielders[1] = NULL;
+	for(i = 0; i < 2; i++)
+	{
+		if(xTaskCreate(BCH_YieldTask, (const int8_t* const)"BchYld", configMINIMAL_STACK_SIZE,
+				NULL, BCH_WAITER_PRIORITY, &BCH_Yielders[i]) != pdPASS)
+		{
+			ok = 0;
+		}
+	}
+	if(ok)
+	{
+		vTaskSuspendAll();
+		xTaskNotifyGive(BCH_Yielders[0]);
+		xTaskNotifyGive(BCH_Yielders[1]);
+		xTaskResumeAll();
+	}
+	for(i = 0; i < 2; i++)
+	{
+		if(BCH_Yielders[i] != NULL)
+		{
+			vTaskDelete(BCH_Yielders[i]);
+			BCH_Yielders[i] = NULL;
+		}
+	}
+	if(!ok)
+	{
+		return 0;
+	}
+
+	// Top priority down to just above idle. The high task runs and
+	// suspends once as it is made, before this carries on.
+	if(xTaskCreate(BCH_HighTask, (const int8_t* const)"BchHigh", configMINIMAL_STACK_SIZE,
+			NULL, configMAX_PRIORITIES - 1, &BCH_Waiter) != pdPASS)
+	{
+		return 0;
+	}
+	vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 1);
+	for(run = 0; run < BCH_RUNS; run++)
+	{
+		vTaskResume(BCH_Waiter);
+		end = BCH_NOW();
+		BCH_Record(&BCH_SwitchStat[BCH_SWITCH_DOWN], end - BCH_Begin);
+
+		if((run & 0x3F) == 0x3F)
+		{
+			vTaskDelay(1);
+		}
+	}
+	vTaskPrioritySet(NULL, BCH_TRIGGER_PRIORITY);
+
+	vTaskDelete(BCH_Waiter);
+	BCH_Waiter = NULL;
+	return 1;
+}
+
+/******************************************************************************
+ * Description:
+ *    Makes the queue or stream buffer a transfer mode reads from, noting
+ *    the heap it takes. The queue holds one chunk, the same as the FIFO.
+ *****************************************************************************/
+static uint8_t BCH_CreateTransfer (BCH_Mode mode)
+{
+	size_t before;
+
+	before = xPortGetFreeHeapSize();
+	if(mode == BCH_CHAR_QUEUE)
+	{
+		BCH_Queue = xQueueCreate(BCH_CHUNK, sizeof(uint8_t));
+		if(BCH_Queue == NULL) return 0;
+	}
+	else if(mode == BCH_STREAM_BUFFER)
+	{
+		BCH_Stream = xStreamBufferCreate(BCH_STREAM_SIZE, BCH_CHUNK);
+		if(BCH_Stream == NULL) return 0;
+	}
+	BCH_HeapBytes[mode] = before - xPortGetFreeHeapSize();
+	return 1;
+}
+
+static void BCH_DeleteTransfer (void)
+{
+	if(BCH_Queue != NULL)
+	{
+		vQueueDelete(BCH_Queue);
+		BCH_Queue = NULL;
+	}
+	if(BCH_Stream != NULL)
+	{
+		vStreamBufferDelete(BCH_Stream);
+		BCH_Stream = NULL;
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    One set of runs in one mode. The waiter is made fresh each time so it
+ *    is already blocked on the right primitive. Pended calls have no
+ *    waiter, the trigger drops below the timer service task instead.
+ *****************************************************************************/
+static uint8_t BCH_Measure (BCH_Mode mode)
+{
+	uint32_t run;
+
+	BCH_CurrentMode = mode;
+	if(mode >= BCH_CHAR_QUEUE && !BCH_CreateTransfer(mode))
+	{
+		return 0;
+	}
+	if(mode == BCH_PEND_CALL)
+	{
+		vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 1);
+	}
+	else if(xTaskCreate(BCH_WaiterTask, (const int8_t* const)"BchWait", configMINIMAL_STACK_SIZE,
+			NULL, BCH_WAITER_PRIORITY, &BCH_Waiter) != pdPASS)
+	{
+		BCH_DeleteTransfer();
+		return 0;
+	}
+
+	for(run = 0; run < BCH_RUNS; run++)
+	{
+		// The waiter has run and blocked again by the time this returns
+		BCH_Begin = BCH_NOW();
+		BCH_PEND_IRQ();
+
+		// Let the tick in now and then so the rest of the system keeps time
+		if((run & 0x3F) == 0x3F)
+		{
+			vTaskDelay(1);
+		}
+	}
+
+	if(mode == BCH_PEND_CALL)
+	{
+		vTaskPrioritySet(NULL, BCH_TRIGGER_PRIORITY);
+	}
+	else
+	{
+		vTaskDelete(BCH_Waiter);
+		BCH_Waiter = NULL;
+	}
+	BCH_DeleteTransfer();
+	return 1;
+}
+
+/******************************************************************************
+ * Description:
+ *    Task side queue, semaphore and mutex calls that never block. Runs
+ *    after the interrupt modes, so nothing is waiting on any of them.
+ *****************************************************************************/
+static uint8_t BCH_MeasureCalls (void)
+{
+	xQueueHandle queue;
+	uint32_t run, t0, t1, t2;
+	uint8_t size;
+
+	for(run = 0; run < BCH_MAX_ITEM; run++)
+	{
+		BCH_Item[run] = (uint8_t)(run * 37 + 1);
+	}
+
+	// One slot each, so every send finds it empty and every receive full
+	for(size = 0; size < BCH_ITEM_SIZES; size++)
+	{
+		queue = xQueueCreate(1, BCH_ItemSizes[size]);
+		if(queue == NULL)
+		{
+			return 0;
+		}
+		for(run = 0; run < BCH_RUNS; run++)
+		{
+			t0 = BCH_NOW();
+			xQueueSend(queue, BCH_Item, 0);
+			t1 = BCH_NOW();
+			xQueueReceive(queue, BCH_ItemOut, 0);
+			t2 = BCH_NOW();
+			BCH_Record(&BCH_SendStat[size], t1 - t0);
+			BCH_Record(&BCH_ReceiveStat[size], t2 - t1);
+
+			if(memcmp(BCH_ItemOut, BCH_Item, BCH_ItemSizes[size]) != 0)
+			{
+				BCH_Corrupt++;
+			}
+		}
+		vQueueDelete(queue);
+	}
+
+	// BCH_Semaphore is taken when the interrupt modes finish
+	for(run = 0; run < BCH_RUNS; run++)
+	{
+		t0 = BCH_NOW();
+		xSemaphoreGive(BCH_Semaphore);
+		t1 = BCH_NOW();
+		xSemaphoreTake(BCH_Semaphore, 0);
+		t2 = BCH_NOW();
+		BCH_Record(&BCH_OpStat[BCH_OP_SEM_GIVE], t1 - t0);
+		BCH_Record(&BCH_OpStat[BCH_OP_SEM_TAKE], t2 - t1);
+	}
+
+	for(run = 0; run < BCH_RUNS; run++)
+	{
+		t0 = BCH_NOW();
+		xSemaphoreTake(BCH_Mutex, 0);
+		t1 = BCH_NOW();
+		xSemaphoreGive(BCH_Mutex);
+		t2 = BCH_NOW();
+		BCH_Record(&BCH_OpStat[BCH_OP_MUTEX_TAKE], t1 - t0);
+		BCH_Record(&BCH_OpStat[BCH_OP_MUTEX_GIVE], t2 - t1);
+	}
+
+	return 1;
+}
+
+/******************************************************************************
+ * Description:
+ *    Just above idle. Takes the mutex when told to, lets the bench task
+ *    block on it, then hands it back.
+ *****************************************************************************/
+static void BCH_HolderTask (void *pvParameters)
+{
+	(void)pvParameters;
+
+	for(;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xSemaphoreTake(BCH_Mutex, portMAX_DELAY);
+
+		// The bench task runs and blocks on the mutex before this returns
+		xTaskNotifyGive(BCH_Bench);
+
+		if(uxTaskPriorityGet(NULL) == BCH_TRIGGER_PRIORITY)
+		{
+			BCH_Inherited++;
+		}
+		BCH_Begin = BCH_NOW();
+		xSemaphoreGive(BCH_Mutex);
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Times the mutex going from a low priority holder, raised by
+ *    inheritance, to the bench task waiting on it
+ *****************************************************************************/
+static uint8_t BCH_MeasureInheritance (void)
+{
+	xTaskHandle holder;
+	uint32_t run, end;
+
+	BCH_Bench = xTaskGetCurrentTaskHandle();
+	if(xTaskCreate(BCH_HolderTask, (const int8_t* const)"BchHold", configMINIMAL_STACK_SIZE,
+			NULL, tskIDLE_PRIORITY + 1, &holder) != pdPASS)
+	{
+		return 0;
+	}
+
+	for(run = 0; run < BCH_RUNS; run++)
+	{
+		xTaskNotifyGive(holder);
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);	// The holder has it
+		xSemaphoreTake(BCH_Mutex, portMAX_DELAY);
+		end = BCH_NOW();
+		BCH_Record(&BCH_OpStat[BCH_OP_MUTEX_HANDOVER], end - BCH_Begin);
+		xSemaphoreGive(BCH_Mutex);
+
+		if((run & 0x3F) == 0x3F)
+		{
+			vTaskDelay(1);
+		}
+	}
+
+	vTaskDelete(holder);
+	return 1;
+}
+
+static void BCH_TimerCallback (xTimerHandle timer)
+{
+	(void)timer;
+}
+
+/******************************************************************************
+ * Description:
+ *    Times start and stop with the bench task below the timer service
+ *    task, so the command has been carried out when each call returns
+ *****************************************************************************/
+static void BCH_MeasureTimers (void)
+{
+	uint32_t run, t0, t1;
+	uint8_t i;
+
+	vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 1);
+
+	for(i = 0; i < BCH_TIMERS; i++)
+	{
+		BCH_Timers[i] = xTimerCreateStatic((const signed char *)"BchTmr",
+				(portTickType)(i + 1) * BCH_TIMER_STEP, pdFALSE, NULL, BCH_TimerCallback, &BCH_TimerBuffers[i]);
+		xTimerStart(BCH_Timers[i], 0);
+	}
+
+	// Expires between the middle two of the others
+	BCH_Timers[BCH_TIMERS] = xTimerCreateStatic((const signed char *)"BchTmr",
+			(portTickType)(BCH_TIMERS / 2) * BCH_TIMER_STEP + BCH_TIMER_STEP / 2, pdFALSE, NULL,
+			BCH_TimerCallback, &BCH_TimerBuffers[BCH_TIMERS]);
+
+	for(run = 0; run < BCH_RUNS; run++)
+	{
+		t0 = BCH_NOW();
+		xTimerStart(BCH_Timers[BCH_TIMERS], 0);
+		t1 = BCH_NOW();
+		BCH_Record(&BCH_OpStat[BCH_OP_TIMER_START], t1 - t0);
+
+		t0 = BCH_NOW();
+		xTimerStop(BCH_Timers[BCH_TIMERS], 0);
+		t1 = BCH_NOW();
+		BCH_Record(&BCH_OpStat[BCH_OP_TIMER_STOP], t1 - t0);
+	}
+
+	for(i = 0; i <= BCH_TIMERS; i++)
+	{
+		xTimerDelete(BCH_Timers[i], 0);
+		BCH_Timers[i] = NULL;
+	}
+
+	vTaskPrioritySet(NULL, BCH_TRIGGER_PRIORITY);
+}
+
+#if BCH_DEADLINES
+/******************************************************************************
+ * Description:
+ *    Runs for us of the calling task's own time. A jump in the run time
+ *    counter longer than BCH_DL_GAP_US is taken to be another task, and
+ *    left out.
+ *****************************************************************************/
+static void BCH_Spin (uint32_t us)
+{
+	unsigned long last, now, step;
+
+	last = portGET_RUN_TIME_COUNTER_VALUE();
+	while(us > 0)
+	{
+		now = portGET_RUN_TIME_COUNTER_VALUE();
+		step = now - last;
+		last = now;
+		if(step <= BCH_DL_GAP_US)
+		{
+			us = (step < us) ? us - step : 0;
+		}
+	}
+}
+
+static void BCH_DeadlineTask (void *pvParameters)
+{
+	const BCH_Load *load = (const BCH_Load *)pvParameters;
+
+	for(;;)
+	{
+		BCH_Spin(load->Work);
+		vTaskWaitForNextPeriod();
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Runs the deadline workload and keeps what the kernel counted. The
+ *    bench task is above both while it makes them, so they are released on
+ *    the same tick, and just above idle while they run.
+ *****************************************************************************/
+static uint8_t BCH_MeasureDeadlines (void)
+{
+	xTaskHandle tasks[BCH_DL_TASKS];
+	uint8_t i, ok = 1;
+
+	vTaskPrioritySet(NULL, BCH_WAITER_PRIORITY);
+	for(i = 0; i < BCH_DL_TASKS; i++)
+	{
+		tasks[i] = xTaskCreatePeriodicStatic(BCH_DeadlineTask, (const int8_t* const)"BchDl", configMINIMAL_STACK_SIZE,
+				(void *)&BCH_Loads[i], BCH_Loads[i].Priority, BCH_DeadlineStacks[i], &BCH_DeadlineBuffers[i],
+				BCH_Loads[i].Period, 0, BCH_Loads[i].Work);
+	}
+
+	vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 1);
+	vTaskDelay(BCH_DL_HYPERPERIOD * BCH_DL_HYPERPERIODS);
+
+	memset(BCH_DeadlineStatus, 0, sizeof(BCH_DeadlineStatus));
+	for(i = 0; i < BCH_DL_TASKS; i++)
+	{
+		if(tasks[i] == NULL || xTaskGetPeriodicStatus(tasks[i], &BCH_DeadlineStatus[i]) != pdTRUE)
+		{
+			ok = 0;
+		}
+	}
+	for(i = 0; i < BCH_DL_TASKS; i++)
+	{
+		if(tasks[i] != NULL)
+		{
+			vTaskDelete(tasks[i]);
+		}
+	}
+
+	vTaskPrioritySet(NULL, BCH_TRIGGER_PRIORITY);
+	return ok;
+}
+#endif
+
+/******************************************************************************
+ * Description:
+ *    Writes the whole table
+ *****************************************************************************/
+static void BCH_Report (uint8_t ok)
+{
+	uint8_t mode;
+	int length;
+	char name[16];
+	xTimerPendStatsType pend;
+
+	length = sprintf(BCH_Line, "# kernel bench, %s at %lu Hz, %s task selection, %s%s\r\nprimitive,figure,runs,min,mean,max\r\n",
+			BCH_UNITS, (unsigned long)BCH_CLOCK_HZ, configUSE_PORT_OPTIMISED_TASK_SELECTION ? "clz" : "generic",
+			BCH_SCHEDULING, ok ? "" : ", out of heap");
+	BCH_Write((const uint8_t *)BCH_Line, (uint32_t)length);
+	for(mode = 0; mode < BCH_MODES; mode++)
+	{
+		if(mode < BCH_CHAR_QUEUE)
+		{
+			BCH_Print(BCH_Names[mode], "give_in_isr", &BCH_Give[mode]);
+			BCH_Print(BCH_Names[mode], "isr_to_task", &BCH_Wake[mode]);
+		}
+		else
+		{
+			BCH_Print(BCH_Names[mode], "send_in_isr", &BCH_Give[mode]);
+			BCH_Print(BCH_Names[mode], "chunk_to_task", &BCH_Wake[mode]);
+			BCH_PrintRate(BCH_Names[mode], &BCH_Wake[mode]);
+		}
+	}
+	for(mode = 0; mode < BCH_MODES; mode++)
+	{
+		BCH_PrintValue(BCH_Names[mode], "heap_bytes", (unsigned long)BCH_HeapBytes[mode]);
+	}
+	vTimerGetPendStats(&pend);
+	BCH_PrintValue(BCH_Names[BCH_PEND_CALL], "max_queued", (unsigned long)pend.uxMaximumEverWaiting);
+	BCH_PrintValue(BCH_Names[BCH_PEND_CALL], "lost", pend.ulFunctionCallsFailed);
+	for(mode = 0; mode < BCH_SWITCHES; mode++)
+	{
+		BCH_Print("switch", BCH_SwitchNames[mode], &BCH_SwitchStat[mode]);
+	}
+	for(mode = 0; mode < BCH_ITEM_SIZES; mode++)
+	{
+		sprintf(name, "queue_%u", (unsigned)BCH_ItemSizes[mode]);
+		BCH_Print(name, "send", &BCH_SendStat[mode]);
+		BCH_Print(name, "receive", &BCH_ReceiveStat[mode]);
+	}
+	for(mode = 0; mode < BCH_OPS; mode++)
+	{
+		BCH_Print(BCH_OpNames[mode][0], BCH_OpNames[mode][1], &BCH_OpStat[mode]);
+	}
+	BCH_PrintValue("mutex", "inherited", (unsigned long)BCH_Inherited);
+	BCH_PrintValue("transfer", "corrupt_chunks", (unsigned long)BCH_Corrupt);
+#if BCH_DEADLINES
+	for(mode = 0; mode < BCH_DL_TASKS; mode++)
+	{
+		BCH_PrintValue(BCH_Loads[mode].Name, "activations", BCH_DeadlineStatus[mode].ulActivations);
+		BCH_PrintValue(BCH_Loads[mode].Name, "misses", BCH_DeadlineStatus[mode].ulDeadlineMisses);
+		BCH_PrintValue(BCH_Loads[mode].Name, "jitter_max_us", BCH_DeadlineStatus[mode].ulJitterMax);
+		BCH_PrintValue(BCH_Loads[mode].Name, "exec_max_us", BCH_DeadlineStatus[mode].ulExecutionMax);
+	}
+#endif
+}
+
+static void BCH_StartTask (void *pvParameters)
+{
+	(void)pvParameters;
+
+	BCH_Run(BCH_Write);
+	vTaskDelete(NULL);
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Gives to the waiter, or sends it a chunk, in whichever way is under test
+ *****************************************************************************/
+void BCH_IRQHandler (void)
+{
+	signed portBASE_TYPE woken = pdFALSE;
+	uint32_t start, i;
+
+	start = BCH_NOW();
+	if(BCH_CurrentMode == BCH_SEMAPHORE)
+	{
+		xSemaphoreGiveFromISR(BCH_Semaphore, &woken);
+	}
+	else if(BCH_CurrentMode == BCH_NOTIFY)
+	{
+		vTaskNotifyGiveFromISR(BCH_Waiter, &woken);
+	}
+	else if(BCH_CurrentMode == BCH_PEND_CALL)
+	{
+		xTimerPendFunctionCallFromISR(BCH_Deferred, NULL, BCH_PEND_CALL, &woken);
+	}
+	else if(BCH_CurrentMode == BCH_CHAR_QUEUE)
+	{
+		// One call per byte, as a character queue driver does
+		for(i = 0; i < BCH_CHUNK; i++)
+		{
+			xQueueSendFromISR(BCH_Queue, &BCH_Data[i], &woken);
+		}
+	}
+	else
+	{
+		xStreamBufferSendFromISR(BCH_Stream, BCH_Data, BCH_CHUNK, &woken);
+	}
+	BCH_Record(&BCH_Give[BCH_CurrentMode], BCH_NOW() - start);
+
+	BCH_IrqExit = BCH_NOW();
+	portEND_SWITCHING_ISR(woken);
+}
+
+/******************************************************************************
+ * Description:
+ *    Runs every benchmark once in the calling task and writes the table
+ *    through Write. Takes the task to BCH_TRIGGER_PRIORITY and back.
+ *****************************************************************************/
+void BCH_Run (void (*Write)(const uint8_t *data, uint32_t length))
+{
+	unsigned portBASE_TYPE priority;
+	size_t before;
+	uint8_t mode, ok = 1;
+
+	BCH_Write = Write;
+	memset(BCH_Give, 0, sizeof(BCH_Give));
+	memset(BCH_Wake, 0, sizeof(BCH_Wake));
+	memset(BCH_HeapBytes, 0, sizeof(BCH_HeapBytes));
+	memset(BCH_SwitchStat, 0, sizeof(BCH_SwitchStat));
+	memset(BCH_OpStat, 0, sizeof(BCH_OpStat));
+	memset(BCH_SendStat, 0, sizeof(BCH_SendStat));
+	memset(BCH_ReceiveStat, 0, sizeof(BCH_ReceiveStat));
+	BCH_Corrupt = 0;
+	BCH_Inherited = 0;
+
+	BCH_START_CLOCK();
+	priority = uxTaskPriorityGet(NULL);
+	vTaskPrioritySet(NULL, BCH_TRIGGER_PRIORITY);
+
+	// Heap taken by one binary semaphore, which starts out given
+	before = xPortGetFreeHeapSize();
+	vSemaphoreCreateBinary(BCH_Semaphore);
+	BCH_HeapBytes[BCH_SEMAPHORE] = before - xPortGetFreeHeapSize();
+	BCH_Mutex = xSemaphoreCreateMutex();
+	if(BCH_Semaphore == NULL || BCH_Mutex == NULL)
+	{
+		ok = 0;
+	}
+	else
+	{
+		xSemaphoreTake(BCH_Semaphore, 0);
+	}
+
+	BCH_ENABLE_IRQ();
+
+	for(mode = 0; ok && mode < BCH_MODES; mode++)
+	{
+		ok = BCH_Measure((BCH_Mode)mode);
+	}
+
+	BCH_DISABLE_IRQ();
+
+	if(ok)
+	{
+		ok = BCH_MeasureSwitch();
+	}
+	if(ok)
+	{
+		ok = BCH_MeasureCalls();
+	}
+	if(ok)
+	{
+		ok = BCH_MeasureInheritance();
+	}
+	if(ok)
+	{
+		BCH_MeasureTimers();
+	}
+#if BCH_DEADLINES
+	if(ok)
+	{
+		ok = BCH_MeasureDeadlines();
+	}
+#endif
+
+	BCH_Report(ok);
+
+	if(BCH_Semaphore != NULL)
+	{
+		vQueueDelete(BCH_Semaphore);
+		BCH_Semaphore = NULL;
+	}
+	if(BCH_Mutex != NULL)
+	{
+		vQueueDelete(BCH_Mutex);
+		BCH_Mutex = NULL;
+	}
+	vTaskPrioritySet(NULL, priority);
+}
+
+/******************************************************************************
+ * Description:
+ *    Create a task that runs the benchmarks once, then deletes itself.
+ *    Results are written through Write when it finishes.
+ *****************************************************************************/
+void BCH_Start (void (*Write)(const uint8_t *data, uint32_t length))
+{
+	BCH_Write = Write;
+
+	xTaskCreate(BCH_StartTask, (const int8_t* const)"Bench", configMINIMAL_STACK_SIZE * 2,
+			NULL, BCH_TRIGGER_PRIORITY, NULL);
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
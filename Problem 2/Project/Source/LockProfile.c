@@ -0,0 +1,181 @@
+/*****************************************************************************
+ *   LockProfile.c:  Semaphore and mutex contention report
+ *
+ *   Notes: -> The kernel keeps the figures, see uxQueueGetLockProfile().
+ *             This only turns them into CSV with task names in. Register a
+ *             lock with vQueueAddToRegistry() to get its name in too,
+ *             otherwise it's shown by address.
+ *          -> Times are microseconds of the run time stats counter. A wait
+ *             is from when a take first blocks, so an uncontended take
+ *             adds nothing to it.
+ *          -> Hold times only mean something for a semaphore used as a
+ *             lock (OLED, a mutex). For one given by an interrupt or
+ *             another task as a signal it's how long the taker ran before
+ *             the next signal came.
+ *          -> An inversion is a take that blocked while a lower priority
+ *             task held the lock. A mutex lends the holder the waiter's
+ *             priority, so the wait is bounded by the hold. A binary
+ *             semaphore doesn't, so any medium priority task can stretch
+ *             it, which is what the hot spot lines point out.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Queue.h"
+
+#include "LockProfile.h"
+
+#if configUSE_LOCK_PROFILER != 1
+	#error LockProfile.c needs configUSE_LOCK_PROFILER for the kernel to keep the figures
+#endif
+#if configUSE_TRACE_FACILITY != 1
+	#error LockProfile.c needs configUSE_TRACE_FACILITY for uxTaskGetSystemState() and the task names
+#endif
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+// Scratch for LCK_Report(), too big for a task's stack
+static xLockProfileType LCK_Locks[configLOCK_PROFILER_SIZE];
+static xTaskStatusType LCK_Status[LCK_MAX_TASKS];
+static unsigned portBASE_TYPE LCK_TaskCount;
+static char LCK_Name[16];
+static char LCK_Line[160];
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Name of a task from the last uxTaskGetSystemState(). "-" for none,
+ *    "?" for one that has since been deleted.
+ *****************************************************************************/
+static const char *LCK_TaskName (void *task)
+{
+	unsigned portBASE_TYPE i;
+
+	if(task == NULL)
+	{
+		return "-";
+	}
+
+	for(i = 0; i < LCK_TaskCount; i++)
+	{
+		if((void *)LCK_Status[i].xHandle == task)
+		{
+			return (const char *)LCK_Status[i].pcTaskName;
+		}
+	}
+
+	return "?";
+}
+
+static const char *LCK_TypeName (unsigned char type)
+{
+	if(type == queueQUEUE_TYPE_MUTEX)
+	{
+		return "mutex";
+	}
+	else if(type == queueQUEUE_TYPE_RECURSIVE_MUTEX)
+	{
+		return "recursive";
+	}
+	else if(type == queueQUEUE_TYPE_COUNTING_SEMAPHORE)
+	{
+		return "counting";
+	}
+	else
+	{
+		return "binary";
+	}
+}
+
+// The registry name, or the address if it was never registered
+static const char *LCK_LockName (const xLockProfileType *lock)
+{
+	if(lock->pcLockName != NULL)
+	{
+		return (const char *)lock->pcLockName;
+	}
+
+	sprintf(LCK_Name, "0x%08lx", (unsigned long)lock->pvLock);
+	return LCK_Name;
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Send the contention figures of every semaphore and mutex as CSV, then
+ *    a line for each lock that's worth looking at. Lines starting with #
+ *    are comments.
+ *****************************************************************************/
+void LCK_Report (void (*Write)(const uint8_t *data, uint32_t length))
+{
+	unsigned portBASE_TYPE count, notProfiled, i;
+	int length;
+
+	count = uxQueueGetLockProfile(LCK_Locks, configLOCK_PROFILER_SIZE, &notProfiled);
+	LCK_TaskCount = uxTaskGetSystemState(LCK_Status, LCK_MAX_TASKS, NULL);
+
+	length = sprintf(LCK_Line, "# locks, times in us\r\n");
+	Write((const uint8_t *)LCK_Line, (uint32_t)length);
+	length = sprintf(LCK_Line, "lock,type,takes,contended,timeouts,inversions,wait_total,wait_max,longest_waiter,hold_total,hold_max,longest_holder,holder\r\n");
+	Write((const uint8_t *)LCK_Line, (uint32_t)length);
+
+	for(i = 0; i < count; i++)
+	{
+		length = sprintf(LCK_Line, "%s,%s,%lu,%lu,%lu,%lu,%lu,%lu,%s,", LCK_LockName(&LCK_Locks[i]),
+				LCK_TypeName(LCK_Locks[i].ucQueueType), LCK_Locks[i].ulTakes,
+				LCK_Locks[i].ulContentions, LCK_Locks[i].ulTimeouts, LCK_Locks[i].ulInversions,
+				LCK_Locks[i].ulWaitTotal, LCK_Locks[i].ulWaitMax, LCK_TaskName(LCK_Locks[i].pvLongestWaiter));
+		length += sprintf(LCK_Line + length, "%lu,%lu,%s,%s\r\n",
+				LCK_Locks[i].ulHoldTotal, LCK_Locks[i].ulHoldMax,
+				LCK_TaskName(LCK_Locks[i].pvLongestHolder), LCK_TaskName(LCK_Locks[i].pvHolder));
+		Write((const uint8_t *)LCK_Line, (uint32_t)length);
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		if(LCK_Locks[i].ulContentions * 100 > LCK_Locks[i].ulTakes * LCK_HOT_PERCENT)
+		{
+			length = sprintf(LCK_Line, "# %s: %lu of %lu takes waited, %lu us at most for %s, held %lu us at most by %s\r\n",
+					LCK_LockName(&LCK_Locks[i]), LCK_Locks[i].ulContentions, LCK_Locks[i].ulTakes,
+					LCK_Locks[i].ulWaitMax, LCK_TaskName(LCK_Locks[i].pvLongestWaiter),
+					LCK_Locks[i].ulHoldMax, LCK_TaskName(LCK_Locks[i].pvLongestHolder));
+			Write((const uint8_t *)LCK_Line, (uint32_t)length);
+		}
+		if(LCK_Locks[i].ulInversions != 0 && LCK_Locks[i].ucQueueType != queueQUEUE_TYPE_MUTEX
+				&& LCK_Locks[i].ucQueueType != queueQUEUE_TYPE_RECURSIVE_MUTEX)
+		{
+			length = sprintf(LCK_Line, "# %s: %lu inversions and no priority inheritance, make it a mutex\r\n",
+					LCK_LockName(&LCK_Locks[i]), LCK_Locks[i].ulInversions);
+			Write((const uint8_t *)LCK_Line, (uint32_t)length);
+		}
+	}
+
+	if(notProfiled != 0)
+	{
+		length = sprintf(LCK_Line, "# %u more locks, raise configLOCK_PROFILER_SIZE to see them\r\n", (unsigned)notProfiled);
+		Write((const uint8_t *)LCK_Line, (uint32_t)length);
+	}
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
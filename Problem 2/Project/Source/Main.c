@@ -21,6 +21,7 @@
 #include "FreeRTOS_Queue.h"
 #include "FreeRTOS_Timers.h"
 #include "FreeRTOS_Semaphore.h"
+#include "FreeRTOS_EventGroups.h"
 
 /******************************************************************************
  * Library includes.
@@ -37,12 +38,79 @@
 #define WAVPLAYER_INCLUDE_SAMPLESONGS						// Include the sample in WavPlayer_Sample.h
 //#define PutStringOLED PutStringOLED1						// Select which to use
 #define PutStringOLED PutStringOLED2						// Select which to use
+#define MAP_UART_PORT ( const int8_t * const ) "/UART3/"	// USB serial on the base board
+#define MAP_EXPORT_PERIOD_MS (5000UL / portTICK_RATE_MS)	// How often the map is sent to the host
+#define KERNEL_BENCH 0										// 1 to run KernelBench.c at startup, results on MAP_UART_PORT
+#define TRACE_DUMP 0										// 1 to send the scheduler trace after each map export, decode with TraceDecode.c
+#define TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE*2)		// Stack depth (words) an application task starts with
+#define STACK_REPORT 0										// 1 to send stack use and suggested sizes after each map export
+#define LOCK_REPORT 0										// 1 to send semaphore waits, holds and inversions after each map export
+#define PERIODIC_REPORT 0									// 1 to send the jitter, run times and misses of the periodic tasks after each map export
+#define TASK_COUNT 11										// Number of application tasks created in main()
+#define JOYSTICK_PORT2_SHIFT 24								// Where EINT3_IRQHandler packs the port 2 edges for JoystickDeferred
+#define APP_EVENT_CENTRE (1 << 0)							// AppEvents bit set when the joystick centre is pressed
+#define TUNE_SET_LENGTH 2									// TuneButton and TuneStopped, one event each
+
+// Stack depth (words) of each task, with STK_GUARD words on top for the MPU
+// guard. Trim one to the suggested column of the STACK_REPORT output once the
+// workload has been through everything, that already includes the guard.
+#define STACK_7SEG		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_OLED1		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_OLED2		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_OLED3		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_OLED4		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_OLED5		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_TUNE		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_DISPLAY	(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_OUTPUT	(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_RANGE		(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_MAPOUT	(TASK_STACK_DEPTH + STK_GUARD)
+#define STACK_IDLE		(configMINIMAL_STACK_SIZE + STK_GUARD)
+#define STACK_TIMER		(configTIMER_TASK_STACK_DEPTH + STK_GUARD)
+
+// Period, deadline (ticks) and budget (us of run time) of each periodic task.
+// The budgets are what RMA_Check() adds up at startup, set one a little over
+// the exec_max column of the PERIODIC_REPORT output.
+#define PERIOD_7SEG		(1200UL / portTICK_RATE_MS)
+#define DEADLINE_7SEG	PERIOD_7SEG
+#define BUDGET_7SEG		500UL
+#define PERIOD_OLED1	(1000UL / portTICK_RATE_MS)
+#define DEADLINE_OLED1	PERIOD_OLED1
+#define BUDGET_OLED1	2000UL
+#define PERIOD_RANGE	(20UL / portTICK_RATE_MS)
+#define DEADLINE_RANGE	PERIOD_RANGE
+#define BUDGET_RANGE	2000UL
+#define PERIOD_MAPOUT	MAP_EXPORT_PERIOD_MS
+#define DEADLINE_MAPOUT	PERIOD_MAPOUT
+#define BUDGET_MAPOUT	1000000UL						// Polled UART, most of a second
+
+// Priorities of the periodic tasks. Rate monotonic, or with
+// configUSE_EDF_SCHEDULER the seven segment, OLED1 and range tasks share the
+// one level and run earliest deadline first. MapOut stays at the bottom, its
+// polled UART would hold them up.
+#if configUSE_EDF_SCHEDULER == 1
+#define PRIORITY_7SEG	configEDF_PRIORITY
+#define PRIORITY_OLED1	configEDF_PRIORITY
+#define PRIORITY_RANGE	configEDF_PRIORITY
+#else
+#define PRIORITY_7SEG	3U
+#define PRIORITY_OLED1	4U
+#define PRIORITY_RANGE	7U
+#endif
+#define PRIORITY_MAPOUT	0U
 
 /******************************************************************************
  * Library includes.
  *****************************************************************************/
+#include "CpuLoad.h"
 #include "dfrobot.h"
+#include "KernelBench.h"
+#include "LockProfile.h"
+#include "Mapping.h"
+#include "Navigation.h"
 #include "pca9532.h"
+#include "RateMonotonic.h"
+#include "StackUsage.h"
 #include "joystick.h"
 #include "OLED.h"
 #include "WavPlayer.h"
@@ -53,27 +121,66 @@
 // Variable defining the SPI port, used by the OLED and 7 segment display
 Peripheral_Descriptor_t SPIPort;
 
+// UART the occupancy grid is exported on
+Peripheral_Descriptor_t UARTPort;
+
 // Fixed Seven segment values. Encoded to be upside down.
 static const uint8_t SevenSegmentDecoder[] = {0x24, 0x7D, 0xE0, 0x70, 0x39, 0x32, 0x22, 0x7C, 0x20, 0x30};
 
 // Variables associated with the software timer
 static xTimerHandle SoftwareTimer = NULL;
+static xStaticTimerType SoftwareTimerBuffer;
 uint8_t Seconds, Minutes, Hours;
 int i = 0;
 // Variables associated with the WEEE navigation
-signed dx = 0, dy = 0, cx = 0, cy = 0;
 char c[1] ={0};
-int centrePressed = 0;
 int drivingRight = 0;
 int drivingleft = 0;
 char direction = '0';
-int joyStickCentre = 0;
+// Wakes WEEEOutputTask when the robot is idle and the centre is pressed
+static xEventGroupHandle AppEvents;
+static xStaticEventGroupType AppEventsBuffer;
+// Whether the periodic task budgets passed the rate monotonic check, for the debugger
+uint8_t Schedulable;
+// The task that overflowed its stack, for the debugger
+signed char *OverflowedTask;
 /******************************************************************************
  * Semaphores
  *****************************************************************************/
 xSemaphoreHandle distances;
 xSemaphoreHandle OLED;
 //xSemaphoreHandle GPIO;
+static xStaticQueueType DistancesBuffer;
+static xStaticQueueType OLEDBuffer;
+// TuneTask sleeps on both of these at once through TuneSet
+static xSemaphoreHandle TuneButton;							// Given on SW3 going down
+static xSemaphoreHandle TuneStopped;						// Given by WavPlayer at the end of a song
+static xStaticQueueType TuneButtonBuffer;
+static xStaticQueueType TuneStoppedBuffer;
+static xQueueSetHandle TuneSet;
+static xStaticQueueType TuneSetBuffer;
+static uint8_t TuneSetStorage[TUNE_SET_LENGTH * sizeof(void *)];
+
+/******************************************************************************
+ * Task memory, placed in .bss so the footprint is known at link time. The
+ * stacks are aligned so the MPU guard is exactly their bottom STK_GUARD words.
+ *****************************************************************************/
+static xStaticTaskType TaskBuffers[TASK_COUNT];
+static portSTACK_TYPE SevenSegStack[STACK_7SEG] STK_ALIGNED;
+static portSTACK_TYPE OLED1Stack[STACK_OLED1] STK_ALIGNED;
+static portSTACK_TYPE OLED2Stack[STACK_OLED2] STK_ALIGNED;
+static portSTACK_TYPE OLED3Stack[STACK_OLED3] STK_ALIGNED;
+static portSTACK_TYPE OLED4Stack[STACK_OLED4] STK_ALIGNED;
+static portSTACK_TYPE OLED5Stack[STACK_OLED5] STK_ALIGNED;
+static portSTACK_TYPE TuneStack[STACK_TUNE] STK_ALIGNED;
+static portSTACK_TYPE DisplayStack[STACK_DISPLAY] STK_ALIGNED;
+static portSTACK_TYPE OutputStack[STACK_OUTPUT] STK_ALIGNED;
+static portSTACK_TYPE RangeStack[STACK_RANGE] STK_ALIGNED;
+static portSTACK_TYPE MapOutStack[STACK_MAPOUT] STK_ALIGNED;
+static xStaticTaskType IdleTaskBuffer;
+static portSTACK_TYPE IdleTaskStack[STACK_IDLE] STK_ALIGNED;
+static xStaticTaskType TimerTaskBuffer;
+static portSTACK_TYPE TimerTaskStack[STACK_TIMER] STK_ALIGNED;
 
 
 
@@ -94,6 +201,9 @@ static void SoftwareTimerCallback(xTimerHandle xTimer)
 	if (Seconds == 60) { Seconds = 0; ++Minutes; }
 	if (Minutes == 60) { Minutes = 0; ++Hours; }
 	taskEXIT_CRITICAL();
+
+	// Once a second so the loads cover the last CPU_WINDOW seconds
+	CPU_Sample();
 }
 
 
@@ -140,15 +250,10 @@ void PutStringOLED2(uint8_t* String, uint8_t Line)
  *****************************************************************************/
 static void SevenSegmentTask(void *pvParameters)
 {
-	const portTickType TaskPeriodms = 1200UL / portTICK_RATE_MS;
-	portTickType LastExecutionTime;
 	uint8_t i = 0;
 	(void)pvParameters;
 
-	// Initialise LastExecutionTime prior to the first call to vTaskDelayUntil().
-	// This only needs to be done once, as after this call, LastExectionTime is updated inside vTaskDelayUntil.
-	LastExecutionTime = xTaskGetTickCount();
-
+	// Periodic, PERIOD_7SEG is given when the task is created
 	for(;;)
 	{
 		for(i = 0; i < 10; ++i)
@@ -162,7 +267,7 @@ static void SevenSegmentTask(void *pvParameters)
 				xSemaphoreGive(OLED);
 			}
 			// Delay until it is time to update the display with a new digit.
-			vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
+			vTaskWaitForNextPeriod();
 		}
 	}
 }
@@ -174,10 +279,7 @@ static void SevenSegmentTask(void *pvParameters)
  *****************************************************************************/
 static void OLEDTask1(void *pvParameters)
 {
-	const portTickType TaskPeriodms = 1000UL / portTICK_RATE_MS;
-	portTickType LastExecutionTime;
 	(void)pvParameters;
-	LastExecutionTime = xTaskGetTickCount();
 
 	for(;;)
 	{
@@ -187,7 +289,7 @@ static void OLEDTask1(void *pvParameters)
 			PutStringOLED((uint8_t*)"", 1);
 			PutStringOLED((uint8_t*)"", 2);
 
-			vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
+			vTaskWaitForNextPeriod();
 		}
 	}
 }
@@ -312,61 +414,37 @@ static void OLEDTask5(void *pvParameters)
 
 /******************************************************************************
  * Description:	This task starts the tune playing, and displays its
- * 				current state on the OLED
+ * 				current state on the OLED. Sleeps until SW3 is pressed or
+ * 				the song ends.
  *****************************************************************************/
 static void TuneTask(void *pvParameters)
 {
-	const portTickType TaskPeriodms =10UL / portTICK_RATE_MS;
-	uint8_t SongStarted = 1;
+	xQueueSetMemberHandle Activated;
 	(void)pvParameters;
 
+	PutStringOLED((uint8_t*)" Tune: Stopped  ", 4);
+
 	for(;;)
 	{
-		if ((((GPIO_ReadValue(0) >> 4) & 0x01) == 0) && (((GPIO_ReadValue(1) >> 31) & 0x01) == 0) && (WavPlayer_IsPlaying() == 0))
+		Activated = xQueueSelectFromSet(TuneSet, portMAX_DELAY);
+
+		if (Activated == TuneButton)
 		{
+			xSemaphoreTake(TuneButton, 0);
+
+			// P1.31 can't interrupt, so it has to be held when SW3 goes down
+			if ((((GPIO_ReadValue(1) >> 31) & 0x01) == 0) && (WavPlayer_IsPlaying() == 0))
 			{
 				PutStringOLED((uint8_t*)" Tune: Playing  ", 4);
-				SongStarted = 1;
 				// Play tune
 				WavPlayer_Play(WavPlayer_Sample, WavPlayer_SampleLength);
 			}
-
-		} else if ((WavPlayer_IsPlaying() == 0) && (SongStarted == 1)) {
-			PutStringOLED((uint8_t*)" Tune: Stopped  ", 4);
-			SongStarted = 0;
 		}
-
-		vTaskDelay(TaskPeriodms);
-	}
-}
-
-
-/******************************************************************************
- * Description: Read User Input
- ##################
- ##NOT BEING USED##
- ##################
- *****************************************************************************/
-static void WEEEInputTask(void *pvParameters)
-{
-	const portTickType TaskPeriodms =5UL / portTICK_RATE_MS;
-	(void)pvParameters;
-
-	//long test;
-
-	for(;;)
-	{
-		if(xSemaphoreTake(distances, portMAX_ DELAY))
+		else if (Activated == TuneStopped)
 		{
-			if(joyStickCentre == 1)
-			{
-				centrePressed = 1;
-				joyStickCentre = 0;
-			}
-			xSemaphoreGive(distances);
-
+			xSemaphoreTake(TuneStopped, 0);
+			PutStringOLED((uint8_t*)" Tune: Stopped  ", 4);
 		}
-		vTaskDelay(TaskPeriodms);
 	}
 }
 
@@ -398,126 +476,116 @@ static void WEEEDisplayTask(void *pvParameters)
  *****************************************************************************/
 
 
+/******************************************************************************
+ * Description: Filter the range finder samples the DMA has collected so
+ *				there is a fresh distance every period, and let the speed
+ *				governor act on it straight away. Then move the map pose on
+ *				and trace the reading into the occupancy grid.
+ *****************************************************************************/
+static void RangeTask(void *pvParameters)
+{
+	int32_t Right, Left;
+	(void)pvParameters;
+
+	for(;;)
+	{
+		DFR_RangeUpdate();
+		DFR_Govern();
+		DFR_GetOdometer(&Right, &Left);
+		MAP_Odometry(Right, Left);
+		MAP_Update(DFR_GetRange());
+		vTaskWaitForNextPeriod();
+	}
+}
+
 
 /******************************************************************************
- * Description: Move the Robot Around
+ * Description: Blocking write handed to the map export
  *
  *****************************************************************************/
-static void WEEEOutputTask(void *pvParameters)
+static void MapWrite(const uint8_t *Data, uint32_t Length)
+{
+	FreeRTOS_write(UARTPort, Data, (size_t)Length);
+}
+
+
+/******************************************************************************
+ * Description: Send the occupancy grid to the host every few seconds.
+ *				Lowest priority, the polled UART takes most of a second.
+ *				With TRACE_DUMP the scheduler trace follows each map,
+ *				with STACK_REPORT the stack use of every task, with
+ *				LOCK_REPORT the contention on every semaphore, with
+ *				PERIODIC_REPORT the timing of the periodic tasks.
+ *****************************************************************************/
+static void MapExportTask(void *pvParameters)
 {
-	const portTickType TaskPeriodms =50UL / portTICK_RATE_MS;
 	(void)pvParameters;
 
-	//long test;
-	int state = 0;
-	int sx,sy = 0; //Distances to travel
-	int spin = 0; //Spinning right or left
 	for(;;)
 	{
-		if (state == 0) //IDLE
-		{
-			DFR_DriveStop();
-			if(centrePressed == 1)
-			{
-				sy = dy - cy;
-				sx = dx - cx;
-				DFR_ClearWheelCounts();
-				state  = 1;
-				centrePressed = 0;
-			}
-		}
-		else if(state == 1) //DRIVE FORWARD OR BACKWARD
-		{
+		MAP_Export(MapWrite);
+#if STACK_REPORT
+		STK_Report(MapWrite);
+#endif
+#if LOCK_REPORT && (configUSE_LOCK_PROFILER == 1)
+		LCK_Report(MapWrite);
+#endif
+#if PERIODIC_REPORT
+		RMA_Report(MapWrite);
+#endif
+#if TRACE_DUMP && (configUSE_TRACE_RECORDER == 1)
+		// Everything recorded since the last dump, ring permitting
+		vTraceDump(MapWrite);
+#endif
+		vTaskWaitForNextPeriod();
+	}
+}
 
-			if (spin == 0)
-			{
-				if(DFR_GetRightWheelCount() >= (abs(sy)*5) && DFR_GetLeftWheelCount() >= (abs(sy)*5))
-				{
-					DFR_ClearWheelCounts();
-					cy = dy;
-					if(sx == 0)
-					{
-						state = 0;
-					}
-					else
-					{
-						state = 2;
-					}
-				}
-				if(cy < dy)
-				{
-					DFR_DriveForward(80);
-				}
-				else if(cy > dy)
-				{
-					DFR_DriveBackward(80);
-				}
 
-			}
-			else if (spin != 0)
-			{
-				DFR_DriveForward(80);
-				if(DFR_GetRightWheelCount() >= (abs(sx)*5) && DFR_GetLeftWheelCount() >= (abs(sx)*5))
-				{
-					state = 3;
-					DFR_ClearWheelCounts();
-				}
-			}
-		}
 
-		else if(state == 2) //SPIN
-		{
-			if(dx > cx)
-			{
-				DFR_DriveRight(80);
-				spin = 1;
-				if(DFR_GetLeftWheelCount() >= 4 && DFR_GetRightWheelCount() >= 4)
-				{
-					state = 1;
-					DFR_ClearWheelCounts();
-				}
-			}
-			else if(dx < cx)
-			{
-				DFR_DriveLeft(80);
-				spin = 2;
-				if(DFR_GetLeftWheelCount() >= 4 && DFR_GetRightWheelCount() >= 4)
-				{
-					state = 1;
-					DFR_ClearWheelCounts();
-				}
-			}
+/******************************************************************************
+ * Description: Blocking delay handed to the chassis calibration routine
+ *
+ *****************************************************************************/
+static void CalibrateDelay(uint32_t ms)
+{
+	vTaskDelay((portTickType)(ms / portTICK_RATE_MS));
+}
 
 
-		}
-		else if(state == 3) //SPIN Correction
-		{
-			if(spin == 1)
-			{
-				DFR_DriveLeft(80);
-				if(DFR_GetLeftWheelCount() >= 3 && DFR_GetRightWheelCount() >= 3)
-				{
-					DFR_ClearWheelCounts();
-					state = 0;
-					cx = dx;
-					spin = 0;
-				}
-			}
-			else if(spin == 2)
-			{
-				DFR_DriveRight(80);
-				if(DFR_GetLeftWheelCount() >= 3 && DFR_GetRightWheelCount() >= 3)
-				{
-					DFR_ClearWheelCounts();
-					state = 0;
-					cx = dx;
-					spin = 0;
-				}
-			}
+/******************************************************************************
+ * Description: Measure the wheel speed against duty tables for
+ *				DFR_SetVelocity() once, then get out of the way.
+ *				Robot must be on blocks, enable it in main() when needed.
+ *****************************************************************************/
+static void CalibrateTask(void *pvParameters)
+{
+	(void)pvParameters;
 
-		}
+	DFR_CalibrateFeedforward(CalibrateDelay);
+	vTaskDelete(NULL);
+}
 
-		vTaskDelay(TaskPeriodms);
+
+/******************************************************************************
+ * Description: Move the Robot Around
+ *
+ *****************************************************************************/
+static void WEEEOutputTask(void *pvParameters)
+{
+	const portTickType TaskPeriodms =50UL / portTICK_RATE_MS;
+	(void)pvParameters;
+
+	for(;;)
+	{
+		NAV_Step();
+
+		// Only step every 50ms while moving, an idle robot sleeps until the
+		// centre is pressed. A press made while moving leaves the bit set.
+		if (NAV_IsIdle())
+			xEventGroupWaitBits(AppEvents, APP_EVENT_CENTRE, pdTRUE, pdFALSE, portMAX_DELAY);
+		else
+			vTaskDelay(TaskPeriodms);
 	}
 
 }
@@ -536,6 +604,11 @@ int main(void)
 
 	NVIC_SetPriorityGrouping(0UL);
 
+#if configUSE_TRACE_RECORDER == 1
+	// Before any task or queue exists, so all of them are named in the trace
+	vTraceEnable();
+#endif
+
 	// Init SPI...
 	SPIPort = FreeRTOS_open(board_SSP_PORT, (uint32_t)((void*)0));
 
@@ -559,45 +632,88 @@ int main(void)
 	// Init Chassis Driver
 	DFR_RobotInit();
 
+	// Init the occupancy grid and the UART it's exported on
+	MAP_Init();
+	UARTPort = FreeRTOS_open(MAP_UART_PORT, (uint32_t)((void*)0));
+
 	//Initialise Semaphore
-	vSemaphoreCreateBinary(distances);
-	vSemaphoreCreateBinary(OLED); //Semaphore for the OLED screen and the 7 segment
+	vSemaphoreCreateBinaryStatic(distances, &DistancesBuffer);
+	vSemaphoreCreateBinaryStatic(OLED, &OLEDBuffer); //Semaphore for the OLED screen and the 7 segment
+
+	// Tune semaphores start empty, as only empty members can join a set
+	vSemaphoreCreateBinaryStatic(TuneButton, &TuneButtonBuffer);
+	vSemaphoreCreateBinaryStatic(TuneStopped, &TuneStoppedBuffer);
+	xSemaphoreTake(TuneButton, 0);
+	xSemaphoreTake(TuneStopped, 0);
+	TuneSet = xQueueCreateSetStatic(TUNE_SET_LENGTH, TuneSetStorage, &TuneSetBuffer);
+	xQueueAddToSet(TuneButton, TuneSet);
+	xQueueAddToSet(TuneStopped, TuneSet);
+	WavPlayer_NotifyOnStop(TuneStopped);
+
+	// Names for the debugger and the LOCK_REPORT output
+	vQueueAddToRegistry(distances, (signed char *)"distances");
+	vQueueAddToRegistry(OLED, (signed char *)"OLED");
+	vQueueAddToRegistry(TuneButton, (signed char *)"TuneButton");
+	vQueueAddToRegistry(TuneStopped, (signed char *)"TuneStopped");
+
+	AppEvents = xEventGroupCreateStatic(&AppEventsBuffer);
 
 
 
 
 	// Enable GPIO Interrupts
 
-	GPIO_IntCmd(0,1 << 4 | 1 << 16| 1 << 15 | 1 << 24 | 1 << 25 | 1 << 17, 0);
+	GPIO_IntCmd(0,1 << 16| 1 << 15 | 1 << 24 | 1 << 25 | 1 << 17, 0);
 	GPIO_IntCmd(2,1 << 3 | 1 << 4 | 1 << 11 | 1<< 12, 0);
+	// SW3 is active low, so interrupt when it goes down
+	GPIO_IntCmd(0,1 << 4, 1);
+	// Most urgent priority that may still call the FreeRTOS ISR API, which
+	// EINT3_IRQHandler does to defer the joystick
+	NVIC_SetPriority(EINT3_IRQn, configMAX_LIBRARY_INTERRUPT_PRIORITY);
 	NVIC_EnableIRQ(EINT3_IRQn);
 
 	// Create a software timer
-	SoftwareTimer = xTimerCreate((const int8_t*)"TIMER",   // Just a text name to associate with the timer, useful for debugging, but not used by the kernel.
+	SoftwareTimer = xTimerCreateStatic((const int8_t*)"TIMER",   // Just a text name to associate with the timer, useful for debugging, but not used by the kernel.
 			SOFTWARE_TIMER_PERIOD_MS, // The period of the timer.
 			pdTRUE,                   // This timer will autoreload, so uxAutoReload is set to pdTRUE.
 			NULL,                     // The timer ID is not used, so can be set to NULL.
-			SoftwareTimerCallback);   // The callback function executed each time the timer expires.
+			SoftwareTimerCallback,    // The callback function executed each time the timer expires.
+			&SoftwareTimerBuffer);    // Memory holding the timer, so none is taken from the heap.
 	xTimerStart(SoftwareTimer, portMAX_DELAY);
 
 	// Create the Seven Segment task
-	xTaskCreate(SevenSegmentTask,               // The task that uses the SPI peripheral and seven segment display.
+	xTaskCreatePeriodicStatic(SevenSegmentTask, // The task that uses the SPI peripheral and seven segment display.
 			(const int8_t* const)"7SEG",    // Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself.
-			configMINIMAL_STACK_SIZE*2,     // The size of the stack allocated to the task.
+			STACK_7SEG,                     // The size of the stack allocated to the task.
 			NULL,                           // The parameter is not used, so NULL is passed.
-			3U,                             // The priority allocated to the task.
-			NULL);                          // A handle to the task being created is not required, so just pass in NULL.
+			PRIORITY_7SEG,                  // The priority allocated to the task.
+			SevenSegStack,                  // The stack, sized STACK_7SEG words.
+			&TaskBuffers[0],                // Memory holding the task control block.
+			PERIOD_7SEG,                    // Ticks between one digit and the next.
+			DEADLINE_7SEG,                  // Ticks after the start of a period it must be done by.
+			BUDGET_7SEG);                   // Run time it should need each period, in us.
 
 	// Create the tasks
-	xTaskCreate(OLEDTask1, 			(const int8_t* const)"OLED1", 		configMINIMAL_STACK_SIZE*2, NULL, 4U, NULL);
-	xTaskCreate(OLEDTask2, 			(const int8_t* const)"OLED2", 		configMINIMAL_STACK_SIZE*2, NULL, 2U, NULL);
-	xTaskCreate(OLEDTask3, 			(const int8_t* const)"OLED3", 		configMINIMAL_STACK_SIZE*2, NULL, 1U, NULL);
-	xTaskCreate(OLEDTask4, 			(const int8_t* const)"OLED4", 		configMINIMAL_STACK_SIZE*2, NULL, 5U, NULL);
-	xTaskCreate(OLEDTask5, 		(const int8_t* const)"OLED5", 		configMINIMAL_STACK_SIZE*2, NULL, 0U, NULL);
-	xTaskCreate(TuneTask,  			(const int8_t* const)"TUNE",  		configMINIMAL_STACK_SIZE*2, NULL, 8U, NULL);
-	//xTaskCreate(WEEEInputTask,		(const int8_t* const)"Input",		configMINIMAL_STACK_SIZE*2, NULL, 5U, NULL);
-	xTaskCreate(WEEEDisplayTask,	(const int8_t* const)"Display",		configMINIMAL_STACK_SIZE*2, NULL, 6U, NULL);
-	xTaskCreate(WEEEOutputTask,		(const int8_t* const)"Output",		configMINIMAL_STACK_SIZE*2, NULL, 7U, NULL);
+	xTaskCreatePeriodicStatic(OLEDTask1,	(const int8_t* const)"OLED1", 		STACK_OLED1, NULL, PRIORITY_OLED1, OLED1Stack, &TaskBuffers[1], PERIOD_OLED1, DEADLINE_OLED1, BUDGET_OLED1);
+	xTaskCreateStatic(OLEDTask2, 		(const int8_t* const)"OLED2", 		STACK_OLED2, NULL, 2U, OLED2Stack, &TaskBuffers[2]);
+	xTaskCreateStatic(OLEDTask3, 		(const int8_t* const)"OLED3", 		STACK_OLED3, NULL, 1U, OLED3Stack, &TaskBuffers[3]);
+	xTaskCreateStatic(OLEDTask4, 		(const int8_t* const)"OLED4", 		STACK_OLED4, NULL, 5U, OLED4Stack, &TaskBuffers[4]);
+	xTaskCreateStatic(OLEDTask5, 		(const int8_t* const)"OLED5", 		STACK_OLED5, NULL, 0U, OLED5Stack, &TaskBuffers[5]);
+	xTaskCreateStatic(TuneTask,  		(const int8_t* const)"TUNE",  		STACK_TUNE, NULL, 8U, TuneStack, &TaskBuffers[6]);
+	xTaskCreateStatic(WEEEDisplayTask,	(const int8_t* const)"Display",		STACK_DISPLAY, NULL, 6U, DisplayStack, &TaskBuffers[7]);
+	xTaskCreateStatic(WEEEOutputTask,	(const int8_t* const)"Output",		STACK_OUTPUT, NULL, 7U, OutputStack, &TaskBuffers[8]);
+	//xTaskCreate(CalibrateTask,		(const int8_t* const)"Calib",		configMINIMAL_STACK_SIZE*2, NULL, 8U, NULL);
+	xTaskCreatePeriodicStatic(RangeTask,	(const int8_t* const)"Range",		STACK_RANGE, NULL, PRIORITY_RANGE, RangeStack, &TaskBuffers[9], PERIOD_RANGE, DEADLINE_RANGE, BUDGET_RANGE);
+	xTaskCreatePeriodicStatic(MapExportTask,(const int8_t* const)"MapOut",		STACK_MAPOUT, NULL, PRIORITY_MAPOUT, MapOutStack, &TaskBuffers[10], PERIOD_MAPOUT, DEADLINE_MAPOUT, BUDGET_MAPOUT);
+
+	// Rate monotonic (or EDF) check of the periodic tasks' budgets before any
+	// of them runs. Failing it isn't proof they'll miss, PERIODIC_REPORT shows both
+	// this and what they've really taken.
+	Schedulable = RMA_Check(NULL);
+
+#if KERNEL_BENCH
+	BCH_Start(MapWrite);
+#endif
 
 	//DFR_IncGear ();
 	DFR_IncGear ();
@@ -615,62 +731,116 @@ int main(void)
 /******************************************************************************
  * Interrupt Service Routines
  *****************************************************************************/
-void EINT3_IRQHandler (void)
+/******************************************************************************
+ * Description:	Bottom half of EINT3_IRQHandler, run by the timer service
+ *				task. Decodes the joystick from the rising edges the
+ *				interrupt captured, port 0 in the low bits of Status and
+ *				port 2 above JOYSTICK_PORT2_SHIFT. Bit 4 is the SW3
+ *				falling edge.
+ *****************************************************************************/
+static void JoystickDeferred(void *Unused, unsigned long Status)
 {
+	uint32_t Port0 = Status;
+	uint32_t Port2 = Status >> JOYSTICK_PORT2_SHIFT;
 
+	(void)Unused;
 
-
-	// Encoder input 1 (Left)
-	if ((((LPC_GPIOINT->IO2IntStatR) >> 11)& 0x1) == ENABLE)
-	{
-		DFR_IncLeftWheelCount();
-	}
-
-	// Encoder input 2 (Right)
-	if ((((LPC_GPIOINT->IO2IntStatR) >> 12)& 0x1) == ENABLE)
-	{
-		DFR_IncRightWheelCount();
-	}
-
-	if ((((LPC_GPIOINT->IO0IntStatR) >> 17)& 0x1) == ENABLE) //CENTRE
+	if (((Port0 >> 17)& 0x1) == ENABLE) //CENTRE
 	{
 		centrePressed = 1;
-		//joyStickCentre = 1;
+		xEventGroupSetBits(AppEvents, APP_EVENT_CENTRE);
 	}
 	// Joystick UP
-	else if ((((LPC_GPIOINT->IO2IntStatR) >> 3)& 0x1) == ENABLE)
+	else if (((Port2 >> 3)& 0x1) == ENABLE)
 	{
 		dy++;
-		//xTaskWoken = xSemaphoreGiveFromISR(up, &xTaskWoken);
 	}
 	// Joystick DOWN
-	else if ((((LPC_GPIOINT->IO0IntStatR) >> 15)& 0x1) == ENABLE)
+	else if (((Port0 >> 15)& 0x1) == ENABLE)
 	{
 		dy--;
 	}
 	// Joystick RIGHT
-	else if ((((LPC_GPIOINT->IO0IntStatR) >> 16)& 0x1) == ENABLE)
+	else if (((Port0 >> 16)& 0x1) == ENABLE)
 	{
 		dx++;
 	}
 	// Joystick LEFT
-	else if ((((LPC_GPIOINT->IO2IntStatR) >> 4)& 0x1) == ENABLE)
+	else if (((Port2 >> 4)& 0x1) == ENABLE)
 	{
 		dx--;
 	}
-	// Left Button
-	else if ((((LPC_GPIOINT->IO0IntStatR) >> 4)& 0x1) == ENABLE)
-	{
 
+	// Left Button (SW3)
+	if (((Port0 >> 4)& 0x1) == ENABLE)
+	{
+		xSemaphoreGive(TuneButton);
 	}
-	//Centre press
+}
+
+
+/******************************************************************************
+ * Description:	GPIO interrupt. Encoder edges are counted here as the pin
+ *				level has to be read at the edge, everything else is handed
+ *				to JoystickDeferred with a single timer queue write.
+ *****************************************************************************/
+void EINT3_IRQHandler (void)
+{
+	signed portBASE_TYPE xTaskWoken = pdFALSE;
+	uint32_t Status;
+
+	traceISR_ENTER(EINT3_IRQn);
+
+	// Wheel encoders
+	DFR_EncoderIRQHandler();
 
+	// Snapshot the joystick and button edges
+	Status = LPC_GPIOINT->IO0IntStatR & (1 << 15 | 1 << 16 | 1 << 17);
+	Status |= LPC_GPIOINT->IO0IntStatF & (1 << 4);
+	Status |= (LPC_GPIOINT->IO2IntStatR & (1 << 3 | 1 << 4)) << JOYSTICK_PORT2_SHIFT;
 
 	// Clear GPIO Interrupt Flags
 	// SW3
 	GPIO_ClearInt(0,1 << 4 | 1 << 15| 1 << 16| 1 << 17 );
 	// Joystick | Encoder | Encoder
 	GPIO_ClearInt(2,1 << 3 | 1 << 11 | 1 << 12 | 1 << 4 );
+
+	// Encoder only interrupts have nothing to defer. A lost call is a lost
+	// key press, counted in vTimerGetPendStats().
+	if (Status != 0)
+	{
+		xTimerPendFunctionCallFromISR(JoystickDeferred, NULL, Status, &xTaskWoken);
+	}
+
+	traceISR_EXIT(EINT3_IRQn);
+	portEND_SWITCHING_ISR(xTaskWoken);
+}
+
+
+/******************************************************************************
+ * Static allocation callbacks
+ *****************************************************************************/
+/******************************************************************************
+ * Description:	Supplies the memory for the idle task, which the kernel
+ *				creates in vTaskStartScheduler().
+ *****************************************************************************/
+void vApplicationGetIdleTaskMemory(xStaticTaskType **ppxIdleTaskTCBBuffer, portSTACK_TYPE **ppxIdleTaskStackBuffer, unsigned short *pusIdleTaskStackSize)
+{
+	*ppxIdleTaskTCBBuffer = &IdleTaskBuffer;
+	*ppxIdleTaskStackBuffer = IdleTaskStack;
+	*pusIdleTaskStackSize = STACK_IDLE;
+}
+
+
+/******************************************************************************
+ * Description:	Supplies the memory for the timer service task, which the
+ *				kernel creates in vTaskStartScheduler().
+ *****************************************************************************/
+void vApplicationGetTimerTaskMemory(xStaticTaskType **ppxTimerTaskTCBBuffer, portSTACK_TYPE **ppxTimerTaskStackBuffer, unsigned short *pusTimerTaskStackSize)
+{
+	*ppxTimerTaskTCBBuffer = &TimerTaskBuffer;
+	*ppxTimerTaskStackBuffer = TimerTaskStack;
+	*pusTimerTaskStackSize = STACK_TIMER;
 }
 
 
@@ -680,12 +850,13 @@ void EINT3_IRQHandler (void)
 void vApplicationStackOverflowHook(xTaskHandle pxTask, signed char *pcTaskName)
 {
 	// Unused variables
-	(void)pcTaskName;
 	(void)pxTask;
 
-	/* Run time stack overflow checking is performed if
-	configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
-	function is called if a stack overflow is detected. */
+	/* Called from the MemManage fault when a task writes into the MPU guard
+	at the bottom of its stack (configUSE_MPU_STACK_GUARD), or on a context
+	switch if configCHECK_FOR_STACK_OVERFLOW is 1 or 2.  Either way the
+	task's stack can't be trusted, so only note which task it was. */
+	OverflowedTask = pcTaskName;
 	taskDISABLE_INTERRUPTS();
 	for(;;);
 }
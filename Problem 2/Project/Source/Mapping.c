@@ -0,0 +1,350 @@
+/*****************************************************************************
+ *   Mapping.c:  Occupancy grid built from the range finder and odometry
+ *
+ *   Notes: -> Dead reckons the pose from the signed encoder totals, then
+ *             traces each range reading through the grid with an integer
+ *             Bresenham line. Cells the beam crossed get less likely to be
+ *             occupied, the cell it stopped in more likely.
+ *          -> Each cell is a 4 bit log-odds value, two to a byte. 128x128
+ *             cells is 8KB, kept in the AHB SRAM bank with the planner.
+ *          -> The sensor only reaches 800mm, so one update touches at most
+ *             MAP_RAY_CELLS cells whatever the reading.
+ *          -> Pose is in um with the heading in 1/2^32 turns, anticlockwise
+ *             from +y. Forward is (-sin, cos) like the simulator.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "dfrobot.h"
+#include "Mapping.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define MAP_CELLS			(MAP_GRID_SIZE * MAP_GRID_SIZE)
+#define MAP_HIT				3		// Log-odds added where the beam stopped
+#define MAP_MISS			1		// Log-odds taken off where it passed
+
+// Sharp sensor limits, readings are clamped to these by the lookup table
+#define MAP_MIN_RANGE_MM	80
+#define MAP_MAX_RANGE_MM	800
+#define MAP_SENSOR_UM		60000	// Sensor is this far ahead of the axle
+
+// Longest ray in cells, start cell included
+#define MAP_RAY_CELLS		(((MAP_MAX_RANGE_MM * 1000 + MAP_SENSOR_UM) / MAP_CELL_UM) + 2)
+
+// Heading change per encoder count of difference between the wheels, in
+// 1/2^32 turns. tick / (2 pi track).
+#define MAP_TURN_PER_TICK	((uint32_t)(((uint64_t)DFR_TICK_UM << 32) / (6283185ULL * DFR_TRACK_MM / 1000)))
+
+// Put the grid in the second RAM bank on the target
+#if defined(__arm__)
+#define MAP_AHB				__attribute__ ((section(".bss.$RAM2")))
+#else
+#define MAP_AHB
+#endif
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static uint8_t MAP_Grid[MAP_CELLS / 2] MAP_AHB;
+
+static int32_t MAP_X = 0;
+static int32_t MAP_Y = 0;
+static uint32_t MAP_Heading = 0;
+static int32_t MAP_LastRight = 0;
+static int32_t MAP_LastLeft = 0;
+static uint8_t MAP_HaveOdometer = 0;
+static uint16_t MAP_Updates = 0;
+
+// First quadrant of sin in Q15, 64 steps
+static const int16_t MAP_Sine[65] =
+{
+	    0,   804,  1608,  2410,  3212,  4011,  4808,  5602,  6393,
+	 7179,  7962,  8739,  9512, 10278, 11039, 11793, 12539, 13279,
+	14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519,
+	20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+	25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898,
+	29268, 29621, 29956, 30273, 30571, 30852, 31113, 31356, 31580,
+	31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728,
+	32757, 32767
+};
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    sin of a 16 bit angle (65536 a turn) in Q15, table plus interpolation
+ *****************************************************************************/
+static int32_t MAP_Sin (uint16_t angle)
+{
+	uint16_t part = angle & 0x3FFF;
+	uint16_t index;
+	int32_t value;
+
+	// Second and fourth quadrants run the table backwards
+	if(angle & 0x4000)
+	{
+		part = 0x4000 - part;
+	}
+
+	index = part >> 8;
+	value = MAP_Sine[index];
+	if(index < 64)
+	{
+		value += ((MAP_Sine[index + 1] - value) * (int32_t)(part & 0xFF)) >> 8;
+	}
+
+	return (angle & 0x8000) ? -value : value;
+}
+
+static int32_t MAP_Cos (uint16_t angle)
+{
+	return MAP_Sin(angle + 0x4000);
+}
+
+/******************************************************************************
+ * Description:
+ *    um to a grid index, 0 at the lowest cell. Cells are centred on the
+ *    multiples of MAP_CELL_UM. Can be off the grid, check before use.
+ *****************************************************************************/
+static int32_t MAP_Index (int32_t um)
+{
+	int32_t shifted = um + (MAP_CELL_UM / 2);
+
+	if(shifted >= 0)
+	{
+		return (shifted / MAP_CELL_UM) - MAP_GRID_MIN;
+	}
+	return -((-shifted + MAP_CELL_UM - 1) / MAP_CELL_UM) - MAP_GRID_MIN;
+}
+
+static uint8_t MAP_OnGrid (int32_t x, int32_t y)
+{
+	return (x >= 0) && (x < MAP_GRID_SIZE) && (y >= 0) && (y < MAP_GRID_SIZE);
+}
+
+/******************************************************************************
+ * Description:
+ *    Add to one cell's log-odds, clamped to the 4 bits
+ *****************************************************************************/
+static void MAP_Adjust (int32_t x, int32_t y, int8_t delta)
+{
+	uint8_t *byte = &MAP_Grid[((y << MAP_GRID_BITS) | x) >> 1];
+	uint8_t shift = (x & 1) ? 4 : 0;
+	int8_t value = (*byte >> shift) & 0x0F;
+
+	value += delta;
+	if(value < 0) value = 0;
+	if(value > 15) value = 15;
+
+	*byte = (*byte & ~(0x0F << shift)) | (value << shift);
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Everything unknown, robot at the middle of the grid facing +y
+ *****************************************************************************/
+void MAP_Init (void)
+{
+	memset(MAP_Grid, (MAP_UNKNOWN << 4) | MAP_UNKNOWN, sizeof(MAP_Grid));
+	MAP_X = 0;
+	MAP_Y = 0;
+	MAP_Heading = 0;
+	MAP_HaveOdometer = 0;
+	MAP_Updates = 0;
+}
+
+/******************************************************************************
+ * Description:
+ *    Move the pose on by the encoder counts since last time. Takes the
+ *    running totals from DFR_GetOdometer(), the first call only latches
+ *    them. Uses the heading half way through the move.
+ *****************************************************************************/
+void MAP_Odometry (int32_t right, int32_t left)
+{
+	int32_t dRight, dLeft, distance;
+	uint16_t middle;
+
+	if(!MAP_HaveOdometer)
+	{
+		MAP_LastRight = right;
+		MAP_LastLeft = left;
+		MAP_HaveOdometer = 1;
+		return;
+	}
+
+	dRight = right - MAP_LastRight;
+	dLeft = left - MAP_LastLeft;
+	MAP_LastRight = right;
+	MAP_LastLeft = left;
+
+	// Unsigned multiply so the angle wraps round on its own
+	middle = (MAP_Heading + (uint32_t)(dRight - dLeft) * (MAP_TURN_PER_TICK / 2)) >> 16;
+	distance = ((dRight + dLeft) * DFR_TICK_UM) / 2;
+
+	MAP_X -= (int32_t)(((int64_t)distance * MAP_Sin(middle)) >> 15);
+	MAP_Y += (int32_t)(((int64_t)distance * MAP_Cos(middle)) >> 15);
+	MAP_Heading += (uint32_t)(dRight - dLeft) * MAP_TURN_PER_TICK;
+}
+
+/******************************************************************************
+ * Description:
+ *    Apply one range reading in mm from the current pose. 0 is ignored.
+ *    Readings at the far end of the sensor's range only clear cells.
+ *****************************************************************************/
+void MAP_Update (uint16_t range)
+{
+	uint16_t angle = MAP_Heading >> 16;
+	int32_t sine = MAP_Sin(angle);
+	int32_t cosine = MAP_Cos(angle);
+	int32_t x0, y0, x1, y1, dx, dy, stepX, stepY, error, doubled;
+	int32_t um;
+	uint8_t hit = 1;
+	uint8_t n;
+
+	if(range == 0)
+	{
+		return;
+	}
+	if(range >= MAP_MAX_RANGE_MM)
+	{
+		range = MAP_MAX_RANGE_MM;
+		hit = 0;
+	}
+
+	// Sensor cell and the cell the beam stopped in
+	x0 = MAP_Index(MAP_X - ((MAP_SENSOR_UM * sine) >> 15));
+	y0 = MAP_Index(MAP_Y + ((MAP_SENSOR_UM * cosine) >> 15));
+	um = MAP_SENSOR_UM + range * 1000;
+	x1 = MAP_Index(MAP_X - (int32_t)(((int64_t)um * sine) >> 15));
+	y1 = MAP_Index(MAP_Y + (int32_t)(((int64_t)um * cosine) >> 15));
+
+	dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+	dy = (y1 > y0) ? y0 - y1 : y1 - y0;
+	stepX = (x0 < x1) ? 1 : -1;
+	stepY = (y0 < y1) ? 1 : -1;
+	error = dx + dy;
+
+	// dy is negative here, the usual all-octant integer Bresenham
+	for(n = 0; n < MAP_RAY_CELLS; n++)
+	{
+		if(!MAP_OnGrid(x0, y0))
+		{
+			// Left the map, nothing further along can be on it either
+			break;
+		}
+		if((x0 == x1) && (y0 == y1))
+		{
+			MAP_Adjust(x0, y0, hit ? MAP_HIT : -MAP_MISS);
+			break;
+		}
+		MAP_Adjust(x0, y0, -MAP_MISS);
+
+		doubled = error * 2;
+		if(doubled >= dy)
+		{
+			error += dy;
+			x0 += stepX;
+		}
+		if(doubled <= dx)
+		{
+			error += dx;
+			y0 += stepY;
+		}
+	}
+
+	MAP_Updates++;
+}
+
+/******************************************************************************
+ * Description:
+ *    Log-odds of a cell in navigation grid coordinates, 0 (clear) to 15
+ *    (occupied). Off the map is MAP_UNKNOWN.
+ *****************************************************************************/
+uint8_t MAP_GetCell (int x, int y)
+{
+	x -= MAP_GRID_MIN;
+	y -= MAP_GRID_MIN;
+
+	if(!MAP_OnGrid(x, y))
+	{
+		return MAP_UNKNOWN;
+	}
+	return (MAP_Grid[((y << MAP_GRID_BITS) | x) >> 1] >> ((x & 1) ? 4 : 0)) & 0x0F;
+}
+
+/******************************************************************************
+ * Description:
+ *    Dead reckoned pose, um from the start and 1/65536ths of a turn
+ *****************************************************************************/
+void MAP_GetPose (int32_t *x, int32_t *y, uint16_t *heading)
+{
+	*x = MAP_X;
+	*y = MAP_Y;
+	*heading = MAP_Heading >> 16;
+}
+
+/******************************************************************************
+ * Description:
+ *    Send the map through Write a row at a time, see MAP_Header for the
+ *    layout. Write can block, e.g. a FreeRTOS_write to a polled UART. The
+ *    map isn't locked, so a frame can mix readings from either side of an
+ *    update that lands part way through.
+ *****************************************************************************/
+void MAP_Export (void (*Write)(const uint8_t *data, uint32_t length))
+{
+	MAP_Header header;
+	const uint8_t *byte;
+	uint16_t sum = 0;
+	uint8_t trailer[2];
+	uint32_t i, row;
+
+	memcpy(header.Magic, "OGM1", 4);
+	header.Size = MAP_GRID_SIZE;
+	header.Reserved = 0;
+	header.CellUm = MAP_CELL_UM;
+	MAP_GetPose(&header.X, &header.Y, &header.Heading);
+	header.Updates = MAP_Updates;
+
+	byte = (const uint8_t *)&header;
+	for(i = 0; i < sizeof(header); i++)
+	{
+		sum += byte[i];
+	}
+	Write(byte, sizeof(header));
+
+	for(row = 0; row < MAP_GRID_SIZE; row++)
+	{
+		byte = &MAP_Grid[row * (MAP_GRID_SIZE / 2)];
+		for(i = 0; i < MAP_GRID_SIZE / 2; i++)
+		{
+			sum += byte[i];
+		}
+		Write(byte, MAP_GRID_SIZE / 2);
+	}
+
+	trailer[0] = sum & 0xFF;
+	trailer[1] = sum >> 8;
+	Write(trailer, 2);
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,259 @@
+/*****************************************************************************
+ *   Navigation.c:  WEEE grid navigation state machine
+ *
+ *   Notes: -> Moved out of WEEEOutputTask so that it can be stepped by the
+ *             host simulator as well as the task.
+ *          -> Drives Y first, then spins, drives X and spins back.
+ *          -> The move is split into straight legs by the planner. Each leg
+ *             goes to the next corner (tx, ty) and the plan is repaired
+ *             from where the robot ended up before the next one. With no
+ *             obstacles that's the same Y then X move as before.
+ *          -> Obstacles come from the occupancy grid, copied into the
+ *             planner before each plan.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "dfrobot.h"
+#include "Mapping.h"
+#include "Navigation.h"
+#include "Planner.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * External global variables
+ *****************************************************************************/
+signed dx = 0, dy = 0, cx = 0, cy = 0;
+int centrePressed = 0;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static int state = 0;
+static int sx, sy = 0; //Distances to travel
+static int spin = 0; //Spinning right or left
+static int tx, ty = 0; //Corner the current leg is heading for
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Block every planner cell the map thinks is occupied. The robot's own
+ *    cell and the destination are left open so there's always something
+ *    to plan between.
+ *****************************************************************************/
+static void NAV_SyncMap (void)
+{
+	int x, y;
+
+	for(y = PLN_GRID_MIN; y <= PLN_GRID_MAX; y++)
+	{
+		for(x = PLN_GRID_MIN; x <= PLN_GRID_MAX; x++)
+		{
+			PLN_SetBlocked(x, y, (MAP_GetCell(x, y) >= MAP_OCCUPIED)
+					&& !(x == cx && y == cy) && !(x == dx && y == dy));
+		}
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Pick the next corner off the plan. Falls back to driving straight at
+ *    the destination if the planner can't find a way there.
+ *****************************************************************************/
+static void NAV_NextLeg (void)
+{
+	if(PLN_NextWaypoint(&tx, &ty) != 1)
+	{
+		tx = dx;
+		ty = dy;
+	}
+	sy = ty - cy;
+	sx = tx - cx;
+}
+
+/******************************************************************************
+ * Description:
+ *    Current leg is finished. Go idle at the destination, otherwise replan
+ *    from here and carry straight on with the next leg.
+ *****************************************************************************/
+static void NAV_LegDone (void)
+{
+	if((cx == dx && cy == dy) || (tx == dx && ty == dy))
+	{
+		// Stop now, the caller may sleep until the next move is asked for
+		DFR_DriveStop();
+		state = 0;
+		return;
+	}
+
+	PLN_MoveStart(cx, cy);
+	NAV_SyncMap();
+	PLN_Replan();
+	NAV_NextLeg();
+
+	// Already facing along y, so an x only leg can go straight to the spin
+	state = (sy != 0) ? 1 : 2;
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Put the state machine back to idle at the origin
+ *****************************************************************************/
+void NAV_Reset (void)
+{
+	state = 0;
+	sx = 0;
+	sy = 0;
+	spin = 0;
+	tx = 0;
+	ty = 0;
+	dx = 0;
+	dy = 0;
+	cx = 0;
+	cy = 0;
+	centrePressed = 0;
+	PLN_Init();
+}
+
+/******************************************************************************
+ * Description:
+ *    Run one step of the state machine. Call every 50ms while moving,
+ *    idle steps only need to follow a centre press.
+ *****************************************************************************/
+void NAV_Step (void)
+{
+	if (state == 0) //IDLE
+	{
+		DFR_DriveStop();
+		if(centrePressed == 1)
+		{
+			NAV_SyncMap();
+			PLN_Plan(cx, cy, dx, dy);
+			NAV_NextLeg();
+			DFR_ClearWheelCounts();
+			state  = 1;
+			centrePressed = 0;
+		}
+	}
+	else if(state == 1) //DRIVE FORWARD OR BACKWARD
+	{
+
+		if (spin == 0)
+		{
+			if(DFR_GetRightWheelCount() >= (abs(sy)*5) && DFR_GetLeftWheelCount() >= (abs(sy)*5))
+			{
+				DFR_ClearWheelCounts();
+				cy = ty;
+				if(sx == 0)
+				{
+					NAV_LegDone();
+				}
+				else
+				{
+					state = 2;
+				}
+			}
+			if(cy < ty)
+			{
+				DFR_DriveForward(80);
+			}
+			else if(cy > ty)
+			{
+				DFR_DriveBackward(80);
+			}
+
+		}
+		else if (spin != 0)
+		{
+			DFR_DriveForward(80);
+			if(DFR_GetRightWheelCount() >= (abs(sx)*5) && DFR_GetLeftWheelCount() >= (abs(sx)*5))
+			{
+				state = 3;
+				DFR_ClearWheelCounts();
+			}
+		}
+	}
+
+	else if(state == 2) //SPIN
+	{
+		if(tx > cx)
+		{
+			DFR_DriveRight(80);
+			spin = 1;
+			if(DFR_GetLeftWheelCount() >= 4 && DFR_GetRightWheelCount() >= 4)
+			{
+				state = 1;
+				DFR_ClearWheelCounts();
+			}
+		}
+		else if(tx < cx)
+		{
+			DFR_DriveLeft(80);
+			spin = 2;
+			if(DFR_GetLeftWheelCount() >= 4 && DFR_GetRightWheelCount() >= 4)
+			{
+				state = 1;
+				DFR_ClearWheelCounts();
+			}
+		}
+
+
+	}
+	else if(state == 3) //SPIN Correction
+	{
+		if(spin == 1)
+		{
+			DFR_DriveLeft(80);
+			if(DFR_GetLeftWheelCount() >= 3 && DFR_GetRightWheelCount() >= 3)
+			{
+				DFR_ClearWheelCounts();
+				cx = tx;
+				spin = 0;
+				NAV_LegDone();
+			}
+		}
+		else if(spin == 2)
+		{
+			DFR_DriveRight(80);
+			if(DFR_GetLeftWheelCount() >= 3 && DFR_GetRightWheelCount() >= 3)
+			{
+				DFR_ClearWheelCounts();
+				cx = tx;
+				spin = 0;
+				NAV_LegDone();
+			}
+		}
+
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Return 1 when not part way through a move
+ *****************************************************************************/
+uint8_t NAV_IsIdle (void)
+{
+	return (state == 0);
+}
@@ -0,0 +1,581 @@
+/*****************************************************************************
+ *   Planner.c:  Grid path planner for the WEEE navigation
+ *
+ *   Notes: -> D* Lite over a 4-connected occupancy grid. The first search is
+ *             a plain A* (backwards from the goal). When cells change only
+ *             the ones affected get recomputed, and PLN_MoveStart() lets
+ *             the start follow the robot without starting over.
+ *          -> All storage is static and sized by PLN_GRID_BITS. At 32x32
+ *             that's 12KB of planner state, which goes in the AHB SRAM bank
+ *             so it doesn't come out of the 32KB the kernel heap lives in.
+ *          -> Not thread safe. Use it from one task.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+
+#include "Planner.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define PLN_CELLS		(PLN_GRID_SIZE * PLN_GRID_SIZE)
+#define PLN_MASK		(PLN_GRID_SIZE - 1)
+#define PLN_INF			0xFFFF
+#define PLN_NONE		0xFFFF
+
+// Put the big arrays in the second RAM bank on the target
+#if defined(__arm__)
+#define PLN_AHB			__attribute__ ((section(".bss.$RAM2")))
+#else
+#define PLN_AHB
+#endif
+
+#if PLN_GRID_BITS > 5
+#error "PLN_GRID_BITS must be 5 or less, a grid row is one 32 bit word"
+#endif
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+// One bit per cell, set when blocked. Bit x of row y.
+static uint32_t PLN_Rows[PLN_GRID_SIZE];
+
+// Cost to goal estimate and one step lookahead for each cell
+static uint16_t PLN_G[PLN_CELLS] PLN_AHB;
+static uint16_t PLN_Rhs[PLN_CELLS] PLN_AHB;
+
+// Binary heap of cells ordered by key. Key is k1 in the top half, k2 in the
+// bottom, so one compare does the lexicographic ordering.
+static uint32_t PLN_Key[PLN_CELLS] PLN_AHB;
+static uint16_t PLN_Heap[PLN_CELLS] PLN_AHB;
+static uint16_t PLN_HeapPos[PLN_CELLS] PLN_AHB;	// Heap index + 1, 0 if not queued
+static uint16_t PLN_HeapSize = 0;
+
+static uint16_t PLN_Start = PLN_NONE;
+static uint16_t PLN_Last = PLN_NONE;
+static uint16_t PLN_Goal = PLN_NONE;
+static uint16_t PLN_Km = 0;
+static uint32_t PLN_Expansions = 0;
+
+// +y, -y, +x, -x. Y comes first so ties drive Y before X like before.
+static const int8_t PLN_StepX[4] = {0, 0, 1, -1};
+static const int8_t PLN_StepY[4] = {1, -1, 0, 0};
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Grid coordinates to cell number, PLN_NONE if off the grid
+ *****************************************************************************/
+static uint16_t PLN_Cell (int x, int y)
+{
+	if((x < PLN_GRID_MIN) || (x > PLN_GRID_MAX) || (y < PLN_GRID_MIN) || (y > PLN_GRID_MAX))
+	{
+		return PLN_NONE;
+	}
+	return ((y - PLN_GRID_MIN) << PLN_GRID_BITS) | (x - PLN_GRID_MIN);
+}
+
+/******************************************************************************
+ * Description:
+ *    Neighbour of a cell in direction dir, PLN_NONE off the edge
+ *****************************************************************************/
+static uint16_t PLN_Neighbour (uint16_t cell, uint8_t dir)
+{
+	int x = (cell & PLN_MASK) + PLN_StepX[dir];
+	int y = (cell >> PLN_GRID_BITS) + PLN_StepY[dir];
+
+	if((x < 0) || (x > PLN_MASK) || (y < 0) || (y > PLN_MASK))
+	{
+		return PLN_NONE;
+	}
+	return (y << PLN_GRID_BITS) | x;
+}
+
+static uint8_t PLN_Blocked (uint16_t cell)
+{
+	return (PLN_Rows[cell >> PLN_GRID_BITS] >> (cell & PLN_MASK)) & 1;
+}
+
+/******************************************************************************
+ * Description:
+ *    Manhattan distance, which never overestimates on a 4-connected grid
+ *****************************************************************************/
+static uint16_t PLN_Heuristic (uint16_t a, uint16_t b)
+{
+	int x = (int)(a & PLN_MASK) - (int)(b & PLN_MASK);
+	int y = (int)(a >> PLN_GRID_BITS) - (int)(b >> PLN_GRID_BITS);
+
+	return (x < 0 ? -x : x) + (y < 0 ? -y : y);
+}
+
+/******************************************************************************
+ * Description:
+ *    Saturating add that keeps PLN_INF as infinity
+ *****************************************************************************/
+static uint16_t PLN_Add (uint32_t a, uint32_t b)
+{
+	if((a >= PLN_INF) || (b >= PLN_INF) || (a + b >= PLN_INF))
+	{
+		return PLN_INF;
+	}
+	return a + b;
+}
+
+/******************************************************************************
+ * Description:
+ *    Cost of moving between two adjacent cells
+ *****************************************************************************/
+static uint16_t PLN_Cost (uint16_t a, uint16_t b)
+{
+	return (PLN_Blocked(a) || PLN_Blocked(b)) ? PLN_INF : 1;
+}
+
+static uint32_t PLN_CalculateKey (uint16_t cell)
+{
+	uint16_t m = (PLN_G[cell] < PLN_Rhs[cell]) ? PLN_G[cell] : PLN_Rhs[cell];
+
+	return ((uint32_t)PLN_Add(PLN_Add(m, PLN_Heuristic(PLN_Start, cell)), PLN_Km) << 16) | m;
+}
+
+/******************************************************************************
+ * Description:
+ *    Heap helpers. PLN_HeapPos is kept in step so any cell can be found,
+ *    re-keyed or removed in O(log n).
+ *****************************************************************************/
+static void PLN_HeapSet (uint16_t index, uint16_t cell)
+{
+	PLN_Heap[index] = cell;
+	PLN_HeapPos[cell] = index + 1;
+}
+
+static void PLN_HeapUp (uint16_t index)
+{
+	uint16_t cell = PLN_Heap[index];
+	uint16_t parent;
+
+	while(index > 0)
+	{
+		parent = (index - 1) >> 1;
+		if(PLN_Key[PLN_Heap[parent]] <= PLN_Key[cell])
+		{
+			break;
+		}
+		PLN_HeapSet(index, PLN_Heap[parent]);
+		index = parent;
+	}
+	PLN_HeapSet(index, cell);
+}
+
+static void PLN_HeapDown (uint16_t index)
+{
+	uint16_t cell = PLN_Heap[index];
+	uint16_t child;
+
+	for(;;)
+	{
+		child = (index << 1) + 1;
+		if(child >= PLN_HeapSize)
+		{
+			break;
+		}
+		if((child + 1 < PLN_HeapSize) && (PLN_Key[PLN_Heap[child + 1]] < PLN_Key[PLN_Heap[child]]))
+		{
+			child++;
+		}
+		if(PLN_Key[PLN_Heap[child]] >= PLN_Key[cell])
+		{
+			break;
+		}
+		PLN_HeapSet(index, PLN_Heap[child]);
+		index = child;
+	}
+	PLN_HeapSet(index, cell);
+}
+
+static void PLN_HeapInsert (uint16_t cell, uint32_t key)
+{
+	PLN_Key[cell] = key;
+	PLN_HeapSet(PLN_HeapSize, cell);
+	PLN_HeapUp(PLN_HeapSize++);
+}
+
+static void PLN_HeapUpdate (uint16_t cell, uint32_t key)
+{
+	uint16_t index = PLN_HeapPos[cell] - 1;
+	uint32_t old = PLN_Key[cell];
+
+	PLN_Key[cell] = key;
+	if(key < old)
+	{
+		PLN_HeapUp(index);
+	}
+	else
+	{
+		PLN_HeapDown(index);
+	}
+}
+
+static void PLN_HeapRemove (uint16_t cell)
+{
+	uint16_t index = PLN_HeapPos[cell] - 1;
+	uint16_t last = PLN_Heap[--PLN_HeapSize];
+
+	PLN_HeapPos[cell] = 0;
+	if(last == cell)
+	{
+		return;
+	}
+
+	PLN_HeapSet(index, last);
+	PLN_HeapUp(index);
+	PLN_HeapDown(PLN_HeapPos[last] - 1);
+}
+
+/******************************************************************************
+ * Description:
+ *    Best one step lookahead from a cell over its neighbours
+ *****************************************************************************/
+static uint16_t PLN_Lookahead (uint16_t cell)
+{
+	uint16_t best = PLN_INF;
+	uint16_t next, cost;
+	uint8_t dir;
+
+	for(dir = 0; dir < 4; dir++)
+	{
+		next = PLN_Neighbour(cell, dir);
+		if(next == PLN_NONE)
+		{
+			continue;
+		}
+		cost = PLN_Add(PLN_Cost(cell, next), PLN_G[next]);
+		if(cost < best)
+		{
+			best = cost;
+		}
+	}
+	return best;
+}
+
+/******************************************************************************
+ * Description:
+ *    Put a cell in the queue if it's inconsistent, take it out if not
+ *****************************************************************************/
+static void PLN_UpdateVertex (uint16_t cell)
+{
+	if(PLN_G[cell] != PLN_Rhs[cell])
+	{
+		if(PLN_HeapPos[cell])
+		{
+			PLN_HeapUpdate(cell, PLN_CalculateKey(cell));
+		}
+		else
+		{
+			PLN_HeapInsert(cell, PLN_CalculateKey(cell));
+		}
+	}
+	else if(PLN_HeapPos[cell])
+	{
+		PLN_HeapRemove(cell);
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Expand cells until the start is consistent and nothing queued could
+ *    still improve it
+ *****************************************************************************/
+static void PLN_ComputeShortestPath (void)
+{
+	uint16_t cell, next, old;
+	uint32_t keyOld, keyNew;
+	uint8_t dir;
+
+	while((PLN_HeapSize > 0)
+		&& ((PLN_Key[PLN_Heap[0]] < PLN_CalculateKey(PLN_Start))
+			|| (PLN_Rhs[PLN_Start] != PLN_G[PLN_Start])))
+	{
+		cell = PLN_Heap[0];
+		keyOld = PLN_Key[cell];
+		keyNew = PLN_CalculateKey(cell);
+		PLN_Expansions++;
+
+		if(keyOld < keyNew)
+		{
+			// Queued before the start moved, just re-key it
+			PLN_HeapUpdate(cell, keyNew);
+		}
+		else if(PLN_G[cell] > PLN_Rhs[cell])
+		{
+			// Overconsistent, settle it and tell the neighbours
+			PLN_G[cell] = PLN_Rhs[cell];
+			PLN_HeapRemove(cell);
+			for(dir = 0; dir < 4; dir++)
+			{
+				next = PLN_Neighbour(cell, dir);
+				if((next == PLN_NONE) || (next == PLN_Goal))
+				{
+					continue;
+				}
+				old = PLN_Add(PLN_Cost(next, cell), PLN_G[cell]);
+				if(old < PLN_Rhs[next])
+				{
+					PLN_Rhs[next] = old;
+				}
+				PLN_UpdateVertex(next);
+			}
+		}
+		else
+		{
+			// Underconsistent, something got worse. Raise it and redo
+			// anything that was relying on it.
+			old = PLN_G[cell];
+			PLN_G[cell] = PLN_INF;
+			if(cell != PLN_Goal)
+			{
+				PLN_Rhs[cell] = PLN_Lookahead(cell);
+			}
+			PLN_UpdateVertex(cell);
+			for(dir = 0; dir < 4; dir++)
+			{
+				next = PLN_Neighbour(cell, dir);
+				if((next == PLN_NONE) || (next == PLN_Goal))
+				{
+					continue;
+				}
+				if(PLN_Rhs[next] == PLN_Add(PLN_Cost(next, cell), old))
+				{
+					PLN_Rhs[next] = PLN_Lookahead(next);
+				}
+				PLN_UpdateVertex(next);
+			}
+		}
+	}
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Clear the map and forget any plan
+ *****************************************************************************/
+void PLN_Init (void)
+{
+	memset(PLN_Rows, 0, sizeof(PLN_Rows));
+	PLN_Start = PLN_NONE;
+	PLN_Last = PLN_NONE;
+	PLN_Goal = PLN_NONE;
+	PLN_HeapSize = 0;
+}
+
+/******************************************************************************
+ * Description:
+ *    Mark a cell blocked or free. If there's a plan the affected cells are
+ *    queued for repair, call PLN_Replan() once all the changes are in.
+ *****************************************************************************/
+void PLN_SetBlocked (int x, int y, uint8_t blocked)
+{
+	uint16_t cell = PLN_Cell(x, y);
+	uint16_t next;
+	uint8_t dir;
+
+	if((cell == PLN_NONE) || (PLN_Blocked(cell) == (blocked ? 1 : 0)))
+	{
+		return;
+	}
+
+	PLN_Rows[cell >> PLN_GRID_BITS] ^= 1UL << (cell & PLN_MASK);
+
+	if(PLN_Goal == PLN_NONE)
+	{
+		return;
+	}
+
+	// Keys queued so far were worked out from the old start, catch up
+	if(PLN_Start != PLN_Last)
+	{
+		PLN_Km = PLN_Add(PLN_Km, PLN_Heuristic(PLN_Last, PLN_Start));
+		PLN_Last = PLN_Start;
+	}
+
+	// Every edge touching the cell changed, so its own lookahead and its
+	// neighbours' lookaheads are the only ones that can be wrong
+	if(cell != PLN_Goal)
+	{
+		PLN_Rhs[cell] = PLN_Lookahead(cell);
+	}
+	PLN_UpdateVertex(cell);
+	for(dir = 0; dir < 4; dir++)
+	{
+		next = PLN_Neighbour(cell, dir);
+		if((next == PLN_NONE) || (next == PLN_Goal))
+		{
+			continue;
+		}
+		PLN_Rhs[next] = PLN_Lookahead(next);
+		PLN_UpdateVertex(next);
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Return 1 if the cell is blocked. Off the grid counts as blocked.
+ *****************************************************************************/
+uint8_t PLN_IsBlocked (int x, int y)
+{
+	uint16_t cell = PLN_Cell(x, y);
+
+	return (cell == PLN_NONE) ? 1 : PLN_Blocked(cell);
+}
+
+/******************************************************************************
+ * Description:
+ *    Plan from scratch. Returns the path length in cells, or -1 if the
+ *    goal can't be reached or either end is off the grid.
+ *****************************************************************************/
+int PLN_Plan (int sx, int sy, int gx, int gy)
+{
+	uint16_t start = PLN_Cell(sx, sy);
+	uint16_t goal = PLN_Cell(gx, gy);
+
+	if((start == PLN_NONE) || (goal == PLN_NONE))
+	{
+		PLN_Goal = PLN_NONE;
+		return -1;
+	}
+
+	memset(PLN_G, 0xFF, sizeof(PLN_G));
+	memset(PLN_Rhs, 0xFF, sizeof(PLN_Rhs));
+	memset(PLN_HeapPos, 0, sizeof(PLN_HeapPos));
+	PLN_HeapSize = 0;
+	PLN_Km = 0;
+	PLN_Start = start;
+	PLN_Last = start;
+	PLN_Goal = goal;
+
+	PLN_Rhs[goal] = 0;
+	PLN_HeapInsert(goal, PLN_CalculateKey(goal));
+
+	return PLN_Replan();
+}
+
+/******************************************************************************
+ * Description:
+ *    Repair the plan after PLN_SetBlocked() and PLN_MoveStart(). Only the
+ *    cells whose cost to goal changed get expanded. Same return as
+ *    PLN_Plan().
+ *****************************************************************************/
+int PLN_Replan (void)
+{
+	if(PLN_Goal == PLN_NONE)
+	{
+		return -1;
+	}
+
+	PLN_ComputeShortestPath();
+
+	return (PLN_G[PLN_Start] == PLN_INF) ? -1 : PLN_G[PLN_Start];
+}
+
+/******************************************************************************
+ * Description:
+ *    The robot has moved, plan from here from now on
+ *****************************************************************************/
+void PLN_MoveStart (int x, int y)
+{
+	uint16_t cell = PLN_Cell(x, y);
+
+	if(cell != PLN_NONE)
+	{
+		PLN_Start = cell;
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Follow the plan from the start to the first corner. That's one
+ *    straight leg for the navigation state machine. Returns 1 with the
+ *    corner, 0 if already at the goal, -1 if there's no path.
+ *****************************************************************************/
+int PLN_NextWaypoint (int *x, int *y)
+{
+	uint16_t cell = PLN_Start;
+	uint16_t next, best, bestCost, cost;
+	uint16_t steps;
+	uint8_t dir, bestDir;
+	int8_t heading = -1;
+
+	if((PLN_Goal == PLN_NONE) || (PLN_G[cell] == PLN_INF))
+	{
+		return -1;
+	}
+	if(cell == PLN_Goal)
+	{
+		return 0;
+	}
+
+	for(steps = 0; (steps < PLN_CELLS) && (cell != PLN_Goal); steps++)
+	{
+		best = PLN_NONE;
+		bestCost = PLN_INF;
+		bestDir = 0;
+		for(dir = 0; dir < 4; dir++)
+		{
+			next = PLN_Neighbour(cell, dir);
+			if(next == PLN_NONE)
+			{
+				continue;
+			}
+			// Keep going straight on a tie, turns cost the robot time
+			cost = PLN_Add(PLN_Cost(cell, next), PLN_G[next]);
+			if((cost < bestCost) || ((cost == bestCost) && (dir == heading)))
+			{
+				best = next;
+				bestCost = cost;
+				bestDir = dir;
+			}
+		}
+
+		if(best == PLN_NONE || bestCost == PLN_INF)
+		{
+			return -1;
+		}
+		if((heading >= 0) && (bestDir != heading))
+		{
+			break;
+		}
+		heading = bestDir;
+		cell = best;
+	}
+
+	*x = (int)(cell & PLN_MASK) + PLN_GRID_MIN;
+	*y = (int)(cell >> PLN_GRID_BITS) + PLN_GRID_MIN;
+	return 1;
+}
+
+/******************************************************************************
+ * Description:
+ *    Cells expanded since power up, for profiling
+ *****************************************************************************/
+uint32_t PLN_GetExpansions (void)
+{
+	return PLN_Expansions;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
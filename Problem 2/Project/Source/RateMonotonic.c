@@ -0,0 +1,296 @@
+/*****************************************************************************
+ *   RateMonotonic.c:  Periodic task schedulability check and timing report
+ *
+ *   Notes: -> The kernel keeps the figures for every task made with
+ *             xTaskCreatePeriodicStatic(), see xTaskGetPeriodicStatus().
+ *             This adds them up and turns them into CSV.
+ *          -> The check is Liu and Layland's. With priorities in rate
+ *             monotonic order (shorter period, higher priority) n periodic
+ *             tasks always meet their deadlines if their utilisation comes
+ *             to no more than n(2^(1/n) - 1), 100% for one task falling
+ *             towards 69.3%. Over the bound they may still make it, it only
+ *             says the bound can't show it.
+ *          -> The bound assumes each deadline is the end of the period. A
+ *             task with a shorter deadline is counted as if its period was
+ *             its deadline, which is safe but pessimistic.
+ *          -> With configUSE_EDF_SCHEDULER the tasks at configEDF_PRIORITY
+ *             have no order among themselves, and earliest deadline first
+ *             meets every deadline up to 100% utilisation. If all the
+ *             periodic tasks are at that level that is the bound, otherwise
+ *             it stays the rate monotonic one, which EDF within the level can
+ *             only do better than, and the order is still checked between
+ *             levels.
+ *          -> Tasks that aren't periodic (the tune, the display, the timer
+ *             task) are left out, so keep them short or low priority.
+ *          -> Budgets, jitter and execution times are microseconds of the
+ *             run time stats counter. RMA_Check() uses the budgets the
+ *             tasks were given, the report also runs it on the longest
+ *             activation each task has had, which is what to set the
+ *             budgets from.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#include "RateMonotonic.h"
+
+#if configUSE_PERIODIC_TASKS != 1
+	#error RateMonotonic.c needs configUSE_PERIODIC_TASKS for the kernel to keep the figures
+#endif
+#if configUSE_TRACE_FACILITY != 1
+	#error RateMonotonic.c needs configUSE_TRACE_FACILITY for uxTaskGetSystemState() and the task names
+#endif
+
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define RMA_PPM			1000000UL
+#define RMA_LN2_PPM		693147UL		// The bound as n grows
+
+// Whether periodic task i is scheduled by deadline rather than priority
+#if configUSE_EDF_SCHEDULER == 1
+#define RMA_EDF(i)		(RMA_Status[RMA_Index[i]].uxCurrentPriority == configEDF_PRIORITY)
+#else
+#define RMA_EDF(i)		0
+#endif
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+// n(2^(1/n) - 1) in parts per million, for n = 1 upwards
+static const uint32_t RMA_Bounds[] = {1000000, 828427, 779763, 756828, 743492, 734772, 728627, 724062,
+		720538, 717735, 715452, 713557, 711959, 710593, 709412, 708381};
+
+// Scratch for RMA_Check() and RMA_Report(), too big for a task's stack
+static xTaskStatusType RMA_Status[RMA_MAX_TASKS];
+static xPeriodicTaskType RMA_Timing[RMA_MAX_TASKS];
+static uint8_t RMA_Index[RMA_MAX_TASKS];		// Where each periodic task is in RMA_Status
+static uint8_t RMA_Count;
+static char RMA_Line[160];
+
+// What the first RMA_Check() found, kept for the report
+static RMA_Result RMA_Startup;
+static uint8_t RMA_Checked = 0;
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Take the timing of every periodic task, returns how many there are.
+ *****************************************************************************/
+static uint8_t RMA_Collect (void)
+{
+	unsigned portBASE_TYPE count, i;
+
+	count = uxTaskGetSystemState(RMA_Status, RMA_MAX_TASKS, NULL);
+
+	RMA_Count = 0;
+	for(i = 0; i < count; i++)
+	{
+		if(xTaskGetPeriodicStatus(RMA_Status[i].xHandle, &RMA_Timing[RMA_Count]) == pdTRUE)
+		{
+			RMA_Index[RMA_Count] = (uint8_t)i;
+			RMA_Count++;
+		}
+	}
+
+	return RMA_Count;
+}
+
+/******************************************************************************
+ * Description:
+ *    Run the bound test on the last RMA_Collect(), with either the budgets
+ *    or the longest activations as the execution times.
+ *****************************************************************************/
+static void RMA_Analyse (RMA_Result *result, uint8_t measured)
+{
+	uint64_t window;
+	unsigned long time;
+	uint8_t i, j, edf = 0;
+
+	memset(result, 0, sizeof(RMA_Result));
+
+	for(i = 0; i < RMA_Count; i++)
+	{
+		time = measured ? RMA_Timing[i].ulExecutionMax : RMA_Timing[i].ulBudget;
+		if(time == 0 && !measured)
+		{
+			result->Unbudgeted++;
+			continue;
+		}
+
+		window = (RMA_Timing[i].xDeadline < RMA_Timing[i].xPeriod) ? RMA_Timing[i].xDeadline : RMA_Timing[i].xPeriod;
+		window *= RMA_US_PER_TICK;
+		result->Utilisation += (uint32_t)(((uint64_t)time * RMA_PPM + window - 1) / window);
+		result->Tasks++;
+
+		if(RMA_EDF(i))
+		{
+			edf++;
+		}
+
+		// Each pair once, the one with the shorter period should be the higher priority
+		for(j = i + 1; j < RMA_Count; j++)
+		{
+			if(RMA_EDF(i) && RMA_EDF(j))
+			{
+				continue;
+			}
+			if((RMA_Timing[i].xPeriod < RMA_Timing[j].xPeriod
+					&& RMA_Status[RMA_Index[i]].uxCurrentPriority < RMA_Status[RMA_Index[j]].uxCurrentPriority)
+				|| (RMA_Timing[j].xPeriod < RMA_Timing[i].xPeriod
+					&& RMA_Status[RMA_Index[j]].uxCurrentPriority < RMA_Status[RMA_Index[i]].uxCurrentPriority))
+			{
+				result->OutOfOrder++;
+			}
+		}
+	}
+
+	if(result->Tasks == 0 || edf == result->Tasks)
+	{
+		result->Bound = RMA_PPM;
+	}
+	else if(result->Tasks <= sizeof(RMA_Bounds) / sizeof(RMA_Bounds[0]))
+	{
+		result->Bound = RMA_Bounds[result->Tasks - 1];
+	}
+	else
+	{
+		result->Bound = RMA_LN2_PPM;
+	}
+}
+
+static uint8_t RMA_Passed (const RMA_Result *result)
+{
+	return (result->Utilisation <= result->Bound && result->OutOfOrder == 0 && result->Unbudgeted == 0) ? 1 : 0;
+}
+
+static void RMA_Summary (void (*Write)(const uint8_t *data, uint32_t length), const char *what, const RMA_Result *result)
+{
+	int length;
+
+	length = sprintf(RMA_Line, "# %s: %lu.%lu%% of a %lu.%lu%% bound for %u tasks, %s\r\n", what,
+			(unsigned long)(result->Utilisation / 10000), (unsigned long)(result->Utilisation / 1000 % 10),
+			(unsigned long)(result->Bound / 10000), (unsigned long)(result->Bound / 1000 % 10),
+			(unsigned)result->Tasks, RMA_Passed(result) ? "schedulable" : "not shown schedulable");
+	Write((const uint8_t *)RMA_Line, (uint32_t)length);
+
+	if(result->Unbudgeted != 0)
+	{
+		length = sprintf(RMA_Line, "# %s: %u tasks have no budget\r\n", what, (unsigned)result->Unbudgeted);
+		Write((const uint8_t *)RMA_Line, (uint32_t)length);
+	}
+	if(result->OutOfOrder != 0)
+	{
+		length = sprintf(RMA_Line, "# %s: %u pairs of tasks not in rate monotonic priority order\r\n", what, (unsigned)result->OutOfOrder);
+		Write((const uint8_t *)RMA_Line, (uint32_t)length);
+	}
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Check the budgets of the periodic tasks against the rate monotonic
+ *    bound. Call it once all of them are made, before the scheduler starts,
+ *    and it's also what the report shows as the startup check. Returns 1
+ *    if the bound shows they will all meet their deadlines. result can be
+ *    NULL.
+ *****************************************************************************/
+uint8_t RMA_Check (RMA_Result *result)
+{
+	RMA_Result check;
+
+	RMA_Collect();
+	RMA_Analyse(&check, 0);
+
+	if(!RMA_Checked)
+	{
+		RMA_Startup = check;
+		RMA_Checked = 1;
+	}
+	if(result != NULL)
+	{
+		*result = check;
+	}
+
+	return RMA_Passed(&check);
+}
+
+/******************************************************************************
+ * Description:
+ *    Send the timing of every periodic task as CSV, then the bound test on
+ *    the budgets at startup and on the longest activations so far, and a
+ *    line for each task that has missed a deadline or overrun its budget.
+ *    Lines starting with # are comments.
+ *****************************************************************************/
+void RMA_Report (void (*Write)(const uint8_t *data, uint32_t length))
+{
+	RMA_Result measured;
+	const xPeriodicTaskType *timing;
+	unsigned long activations;
+	uint8_t i;
+	int length;
+
+	RMA_Collect();
+
+	length = sprintf(RMA_Line, "# periodic tasks, periods and deadlines in ticks, times in us\r\n");
+	Write((const uint8_t *)RMA_Line, (uint32_t)length);
+	length = sprintf(RMA_Line, "task,priority,period,deadline,budget,activations,misses,overruns,jitter_mean,jitter_max,exec_mean,exec_max,exec_last\r\n");
+	Write((const uint8_t *)RMA_Line, (uint32_t)length);
+
+	for(i = 0; i < RMA_Count; i++)
+	{
+		timing = &RMA_Timing[i];
+		activations = (timing->ulActivations != 0) ? timing->ulActivations : 1;
+
+		length = sprintf(RMA_Line, "%s,%u,%lu,%lu,%lu,%lu,%lu,%lu,", (const char *)RMA_Status[RMA_Index[i]].pcTaskName,
+				(unsigned)RMA_Status[RMA_Index[i]].uxCurrentPriority, (unsigned long)timing->xPeriod,
+				(unsigned long)timing->xDeadline, timing->ulBudget, timing->ulActivations,
+				timing->ulDeadlineMisses, timing->ulBudgetOverruns);
+		length += sprintf(RMA_Line + length, "%lu,%lu,%lu,%lu,%lu\r\n",
+				timing->ulJitterTotal / activations, timing->ulJitterMax,
+				timing->ulExecutionTotal / activations, timing->ulExecutionMax, timing->ulExecutionLast);
+		Write((const uint8_t *)RMA_Line, (uint32_t)length);
+	}
+
+	if(RMA_Checked)
+	{
+		RMA_Summary(Write, "budgets at startup", &RMA_Startup);
+	}
+	RMA_Analyse(&measured, 1);
+	RMA_Summary(Write, "longest activations", &measured);
+
+	for(i = 0; i < RMA_Count; i++)
+	{
+		timing = &RMA_Timing[i];
+		if(timing->ulDeadlineMisses != 0 || timing->ulBudgetOverruns != 0)
+		{
+			length = sprintf(RMA_Line, "# %s: %lu of %lu activations missed the deadline, %lu overran the budget, longest %lu us of %lu\r\n",
+					(const char *)RMA_Status[RMA_Index[i]].pcTaskName, timing->ulDeadlineMisses, timing->ulActivations,
+					timing->ulBudgetOverruns, timing->ulExecutionMax, timing->ulBudget);
+			Write((const uint8_t *)RMA_Line, (uint32_t)length);
+		}
+	}
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,158 @@
+/*****************************************************************************
+ *   StackUsage.c:  Task stack high water marks and suggested stack sizes
+ *
+ *   Notes: -> The kernel fills every stack with 0xA5 when the task is
+ *             created. The high water mark is how much of that fill is
+ *             still there, so it's the least free stack the task has ever
+ *             had, not just what it's using now.
+ *          -> A suggestion is only as good as the run behind it. Let the
+ *             workload go through everything (drive, plan, play a tune,
+ *             press the buttons) before trusting one, and put the margin
+ *             back if a code change adds locals or deeper calls.
+ *          -> Interrupts run on the main stack on the Cortex-M3, so a task
+ *             only ever needs room for its own calls and the 16 words of
+ *             a context switch. Both are in the peak once it has been
+ *             switched out.
+ *          -> With configUSE_MPU_STACK_GUARD the bottom 8 words of each
+ *             stack are the guard and can't be used, so the suggestions
+ *             leave STK_GUARD words for it. That needs the stack to be
+ *             STK_ALIGNED, otherwise the guard sits up to 7 words higher.
+ *             The guard is read only, which keeps the fill readable there.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#include "StackUsage.h"
+
+#if configUSE_TRACE_FACILITY != 1
+	#error StackUsage.c needs configUSE_TRACE_FACILITY for uxTaskGetSystemState() and the stack depths
+#endif
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+// Scratch for STK_GetUsage() and STK_Report(), too big for a task's stack
+static xTaskStatusType STK_Status[STK_MAX_TASKS];
+static STK_TaskStack STK_Stacks[STK_MAX_TASKS];
+static char STK_Line[64];
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Copy out the stack use of up to max tasks, returns how many. Returns 0
+ *    if there are more than STK_MAX_TASKS tasks.
+ *****************************************************************************/
+uint8_t STK_GetUsage (STK_TaskStack *stacks, uint8_t max)
+{
+	unsigned portBASE_TYPE count, i;
+	uint16_t free;
+
+	// Walks every stack with the scheduler suspended, a few hundred words each
+	count = uxTaskGetSystemState(STK_Status, STK_MAX_TASKS, NULL);
+	if(count > max)
+	{
+		count = max;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		strncpy(stacks[i].Name, (const char *)STK_Status[i].pcTaskName, configMAX_TASK_NAME_LEN);
+		stacks[i].Name[configMAX_TASK_NAME_LEN - 1] = '\0';
+		stacks[i].Depth = STK_Status[i].usStackDepth;
+
+		free = STK_Status[i].usStackHighWaterMark;
+		stacks[i].Peak = (free < stacks[i].Depth) ? stacks[i].Depth - free : 0;
+		stacks[i].Suggested = STK_Suggest(stacks[i].Peak);
+	}
+
+	return (uint8_t)count;
+}
+
+/******************************************************************************
+ * Description:
+ *    Stack depth to give a task that has used at most peak words: the peak
+ *    plus STK_MARGIN percent, at least STK_HEADROOM words more, rounded up
+ *    to STK_ROUND words so the stack stays 8 byte aligned, and STK_GUARD
+ *    words more for the MPU guard.
+ *****************************************************************************/
+uint16_t STK_Suggest (uint16_t peak)
+{
+	uint32_t margin = ((uint32_t)peak * STK_MARGIN + 99) / 100;
+	uint32_t size;
+
+	if(margin < STK_HEADROOM)
+	{
+		margin = STK_HEADROOM;
+	}
+	size = peak + margin + STK_GUARD;
+	size = ((size + STK_ROUND - 1) / STK_ROUND) * STK_ROUND;
+
+	return (size > 0xFFFF) ? 0xFFFF : (uint16_t)size;
+}
+
+/******************************************************************************
+ * Description:
+ *    Send every task's stack use as CSV, then what trimming each stack to
+ *    its suggestion would save. Lines starting with # are comments.
+ *****************************************************************************/
+void STK_Report (void (*Write)(const uint8_t *data, uint32_t length))
+{
+	uint8_t count, i, grow = 0;
+	uint32_t depth = 0, suggested = 0, reclaim = 0;
+	int length;
+
+	count = STK_GetUsage(STK_Stacks, STK_MAX_TASKS);
+
+	length = sprintf(STK_Line, "# stack words, suggested is peak +%u%% (+%u min)\r\n", STK_MARGIN, STK_HEADROOM);
+	Write((const uint8_t *)STK_Line, (uint32_t)length);
+	length = sprintf(STK_Line, "task,depth,peak,free,suggested\r\n");
+	Write((const uint8_t *)STK_Line, (uint32_t)length);
+
+	for(i = 0; i < count; i++)
+	{
+		length = sprintf(STK_Line, "%s,%u,%u,%u,%u\r\n", STK_Stacks[i].Name,
+				(unsigned)STK_Stacks[i].Depth, (unsigned)STK_Stacks[i].Peak,
+				(unsigned)(STK_Stacks[i].Depth - STK_Stacks[i].Peak),
+				(unsigned)STK_Stacks[i].Suggested);
+		Write((const uint8_t *)STK_Line, (uint32_t)length);
+
+		depth += STK_Stacks[i].Depth;
+		suggested += STK_Stacks[i].Suggested;
+		if(STK_Stacks[i].Suggested > STK_Stacks[i].Depth)
+		{
+			grow++;
+		}
+		else
+		{
+			reclaim += STK_Stacks[i].Depth - STK_Stacks[i].Suggested;
+		}
+	}
+
+	length = sprintf(STK_Line, "# %lu words given, %lu suggested, %lu bytes spare\r\n",
+			(unsigned long)depth, (unsigned long)suggested, (unsigned long)(reclaim * sizeof(portSTACK_TYPE)));
+	Write((const uint8_t *)STK_Line, (uint32_t)length);
+	if(grow != 0)
+	{
+		length = sprintf(STK_Line, "# %u tasks are inside the margin, make them bigger\r\n", grow);
+		Write((const uint8_t *)STK_Line, (uint32_t)length);
+	}
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
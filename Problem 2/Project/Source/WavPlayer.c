@@ -41,7 +41,7 @@
 //------------------------------------------------------------------------------
 
 // Local variables
-//...
+static xSemaphoreHandle StopSemaphore = NULL;	// Given when a song finishes, see WavPlayer_NotifyOnStop
 
 //------------------------------------------------------------------------------
 
@@ -180,6 +180,8 @@ void WavPlayer_Play(const uint8_t *WavArray, const uint32_t Length)
 }
 
 void TIMER0_IRQHandler(void) {
+	signed portBASE_TYPE xTaskWoken = pdFALSE;
+
 	if (SongPosition < SongLength)
 	{
 		DAC_UpdateValue(LPC_DAC, (uint32_t)(SongPointer[SongPosition++])*4);
@@ -191,8 +193,11 @@ void TIMER0_IRQHandler(void) {
 		SongPosition = 0;
 		SongLength = 0;
 		SongPointer = 0;
+		if (StopSemaphore != NULL)
+			xSemaphoreGiveFromISR(StopSemaphore, &xTaskWoken);
 	}
 	TIM_ClearIntPending(LPC_TIM0, TIM_MR0_INT);
+	portEND_SWITCHING_ISR(xTaskWoken);
 }
 
 uint8_t WavPlayer_IsPlaying(void) {
@@ -201,3 +206,6 @@ uint8_t WavPlayer_IsPlaying(void) {
 	return 0;
 }
 
+void WavPlayer_NotifyOnStop(xSemaphoreHandle Semaphore) {
+	StopSemaphore = Semaphore;
+}
@@ -1,8 +1,14 @@
 /*****************************************************************************
  *   dfrobot.c:  Driver for the DF Robot chassis with wheel encoders
  *
- *   Notes: -> I'd like to say this is thread safe but it's not.
+ *   Notes: -> I'd like to say this is thread safe but it's not. The drive
+ *             commands and DFR_Govern() are, as they run in two tasks: each
+ *             sets its direction pins, runs the governor and latches the
+ *             duties in one critical section, so a stop can't be written
+ *             over by a governor pass that read the command before it.
  *          -> Possible clash on ADC configuration.
+ *          -> AD0.3 shares P0.26 with AOUT, so the range finder and the
+ *             wav player can't both have the pin. Last one to init wins.
  *
  *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
  *   All rights reserved.
@@ -16,8 +22,20 @@
 #include "lpc17xx_pwm.h"
 #include "dfrobot.h"
 
+#include <stdlib.h>
+
+#ifndef SIM_NO_KERNEL
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#else
+// The chassis simulators have one thread and nothing to lock against
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#endif
+
 #include "LPC17xx_PinSelect.h"
 #include "LPC17xx_ADC.h"
+#include "LPC17xx_GPDMA.h"
 
 /******************************************************************************
  * Defines and typedefs
@@ -31,6 +49,27 @@
 #define DFR_25		0x40
 #define DFR_0		0x00
 
+// Range finder acquisition. The ADC free runs in burst mode and the DMA
+// copies every AD0.3 result into a ring, so nothing interrupts per sample.
+#define DFR_RANGE_ADC_RATE		4000	// Conversions per second
+#define DFR_RANGE_DMA_CHANNEL	7		// Lowest priority DMA channel
+#define DFR_RANGE_RING_SIZE		32		// Must be a power of two
+#define DFR_RANGE_WINDOW		9		// Samples in the median, must be odd
+#define DFR_RANGE_IIR_SHIFT		2		// IIR weight of 1/4 per update
+#define DFR_RANGE_LUT_SIZE		11
+
+// Feedforward tables map raw PWM duty to measured wheel speed in mm/s
+#define DFR_FF_POINTS			11
+#define DFR_FF_DEFAULT_MAX		500		// mm/s at full duty until calibrated
+#define DFR_CAL_SETTLE_MS		300		// Let the wheel spin up at each step
+#define DFR_CAL_SAMPLE_MS		1000	// Count encoder edges over this long
+
+// Speed governor. Forward motion is limited to what can stop before the
+// hard stop distance at DFR_GOV_DECEL_MM, and cut dead inside it.
+#define DFR_GOV_STOP_MM			150		// Hard stop, above the sensor fold back
+#define DFR_GOV_DECEL_MM		800		// mm/s/s braking we're allowed to assume
+#define DFR_GOV_NO_LIMIT		0xFFFF
+
 
 /******************************************************************************
  * External global variables
@@ -49,10 +88,51 @@ uint8_t RightWheelDestination = 0;
 uint8_t LeftWheelCount = 0;
 uint8_t LeftWheelDestination = 0;
 
+// Signed encoder totals for odometry, never cleared. The sign comes from
+// the direction output the wheel was driven with when the edge arrived.
+static volatile int32_t DFR_RightOdometer = 0;
+static volatile int32_t DFR_LeftOdometer = 0;
+
+// Written by the DMA only. Each word is a raw copy of ADDR3.
+static volatile uint32_t DFR_RangeRing[DFR_RANGE_RING_SIZE];
+// Single LLI pointing back at itself so the DMA never stops.
+static GPDMA_LLI_Type DFR_RangeLLI;
+// Filtered ADC counts with 4 fractional bits, 0 until the first update.
+static int32_t DFR_RangeFiltered = 0;
+static uint16_t DFR_RangeDistance = 0;
+// Unfiltered median, so the hard stop doesn't wait for the IIR
+static uint16_t DFR_RangeMedian = 0;
+
+// Duty last asked for by the drive functions, before the governor
+static int DFR_CmdRight = 0;
+static int DFR_CmdLeft = 0;
+static uint16_t DFR_SpeedLimit = DFR_GOV_NO_LIMIT;
+// Set while DFR_CalibrateFeedforward() owns the PWM, the governor stays off it
+static volatile uint8_t DFR_Calibrating = 0;
+
+// Calibration for the Sharp IR range finder on a 3V3 reference. ADC counts
+// must be ascending. Distances in mm. Re-measure these for a new sensor.
+static const uint16_t DFR_RangeCounts[DFR_RANGE_LUT_SIZE] =
+	{ 496,  558,  620,  745,  931, 1142, 1303, 1613, 2048, 2854, 3413};
+static const uint16_t DFR_RangeMillimetres[DFR_RANGE_LUT_SIZE] =
+	{ 800,  700,  600,  500,  400,  300,  250,  200,  150,  100,   80};
+
+// Raw MRx duty at each feedforward point, the top one must stay below MR0
+static const uint16_t DFR_FFDuty[DFR_FF_POINTS] =
+	{   0,  100,  200,  300,  400,  500,  600,  700,  800,  900,  999};
+
+// Wheel speed in mm/s at each duty point. Starts as a straight line guess,
+// DFR_CalibrateFeedforward() replaces it with what the encoders measured.
+static uint16_t DFR_FFRight[DFR_FF_POINTS] =
+	{   0,   50,  100,  150,  200,  250,  300,  350,  400,  450,  DFR_FF_DEFAULT_MAX};
+static uint16_t DFR_FFLeft[DFR_FF_POINTS] =
+	{   0,   50,  100,  150,  200,  250,  300,  350,  400,  450,  DFR_FF_DEFAULT_MAX};
+
 
 /******************************************************************************
  * Local Functions
  *****************************************************************************/
+static int DFR_FeedforwardDuty (const uint16_t *table, int speed, int *duty);
 
 /******************************************************************************
  * Description:
@@ -87,6 +167,154 @@ void DFR_PWMInit (void)
 	LPC_PWM1->TCR = (1<<0)|(1<<3);				// counter enable, PWM enable
 }
 
+/******************************************************************************
+ * Description:
+ *    Write duty values straight to the match registers and latch them on
+ *    the next MR0 match. Nothing checks or limits them here.
+ *****************************************************************************/
+static void DFR_WritePWM (int right, int left)
+{
+	LPC_PWM1->MR1 = left;
+	LPC_PWM1->MR6 = right;
+
+	// set LER for MR0, MR1 & MR6
+	LPC_PWM1->LER = (1<<0)|(1<<1)|(1<<6);
+}
+
+/******************************************************************************
+ * Description:
+ *    Wheel speed in mm/s for a duty, from the wheel's feedforward table
+ *****************************************************************************/
+static int DFR_FeedforwardSpeed (const uint16_t *table, int duty)
+{
+	uint8_t i;
+
+	if(duty <= 0)
+	{
+		return 0;
+	}
+	if(duty >= DFR_FFDuty[DFR_FF_POINTS - 1])
+	{
+		return table[DFR_FF_POINTS - 1];
+	}
+
+	for(i = 1; duty > DFR_FFDuty[i]; i++);
+
+	return table[i - 1] + (duty - DFR_FFDuty[i - 1]) * (table[i] - table[i - 1])
+		/ (DFR_FFDuty[i] - DFR_FFDuty[i - 1]);
+}
+
+/******************************************************************************
+ * Description:
+ *    Integer square root, 16 rounds whatever the input
+ *****************************************************************************/
+static uint32_t DFR_Sqrt (uint32_t value)
+{
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+
+	while(bit > value)
+	{
+		bit >>= 2;
+	}
+	while(bit != 0)
+	{
+		if(value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+/******************************************************************************
+ * Description:
+ *    Speed governor. Takes the commanded duties and the direction pins,
+ *    and if the robot is moving forward limits it to a speed that can stop
+ *    before DFR_GOV_STOP_MM: v = sqrt(2 * decel * (range - stop)). Both
+ *    wheels are scaled together so curves keep their shape. Turning on the
+ *    spot isn't limited so the robot can always turn away from a wall.
+ *    With no range reading yet nothing is limited. Call it in a critical
+ *    section, with the command and direction pins set in the same one.
+ *    Does nothing while the feedforward is being calibrated.
+ *****************************************************************************/
+static void DFR_Governor (void)
+{
+	int right = DFR_CmdRight;
+	int left = DFR_CmdLeft;
+	int rightSpeed, leftSpeed, forward;
+	uint16_t range;
+	uint32_t limit;
+
+	if(DFR_Calibrating)
+	{
+		return;
+	}
+
+	rightSpeed = DFR_FeedforwardSpeed(DFR_FFRight, right);
+	leftSpeed = DFR_FeedforwardSpeed(DFR_FFLeft, left);
+	if((LPC_GPIO2->FIOPIN & (1 << 10)) == 0) rightSpeed = -rightSpeed;
+	if((LPC_GPIO2->FIOPIN & (1 << 6)) == 0) leftSpeed = -leftSpeed;
+	forward = (rightSpeed + leftSpeed) / 2;
+
+	// Go on whichever of the raw median and the filtered range is closer
+	range = DFR_RangeDistance;
+	if(DFR_RangeMedian < range)
+	{
+		range = DFR_RangeMedian;
+	}
+
+	if(range == 0)
+	{
+		limit = DFR_GOV_NO_LIMIT;
+	}
+	else if(range <= DFR_GOV_STOP_MM)
+	{
+		limit = 0;
+	}
+	else
+	{
+		limit = DFR_Sqrt(2UL * DFR_GOV_DECEL_MM * (range - DFR_GOV_STOP_MM));
+	}
+	DFR_SpeedLimit = (limit < DFR_GOV_NO_LIMIT) ? limit : DFR_GOV_NO_LIMIT;
+
+	if((forward > 0) && ((uint32_t)forward > limit))
+	{
+		if(limit == 0)
+		{
+			right = 0;
+			left = 0;
+		}
+		else
+		{
+			DFR_FeedforwardDuty(DFR_FFRight, abs(rightSpeed) * limit / forward, &right);
+			DFR_FeedforwardDuty(DFR_FFLeft, abs(leftSpeed) * limit / forward, &left);
+		}
+	}
+
+	DFR_WritePWM(right, left);
+}
+
+/******************************************************************************
+ * Description:
+ *    Set raw duty values for both channels, bypassing the gear scaling.
+ *    All drive commands end up here and go through the governor.
+ *****************************************************************************/
+static void DFR_SetRawPWM (int right, int left)
+{
+	taskENTER_CRITICAL();
+	DFR_CmdRight = right;
+	DFR_CmdLeft = left;
+	DFR_Governor();
+	taskEXIT_CRITICAL();
+}
+
 /******************************************************************************
  * Description:
  *    Set duty cycle for both channels and enable latch on next MR0 match.
@@ -98,13 +326,7 @@ int DFR_SetPWM (int right, int left)
 	// Probably worth a try to make sure.
 	if((right < DFR_PWMRate) && (left < DFR_PWMRate))
 	{
-		// set MRx registers
-		LPC_PWM1->MR1 = DFR_ScalePWM(left);
-		LPC_PWM1->MR6 = DFR_ScalePWM(right);
-		
-		// set LER for MR0, MR1 & MR6
-		LPC_PWM1->LER = (1<<0)|(1<<1)|(1<<6);
-	
+		DFR_SetRawPWM(DFR_ScalePWM(right), DFR_ScalePWM(left));
 		return 1;
 	}
 	else 
@@ -122,12 +344,7 @@ int DFR_SetRightPWM (int right)
 {
 	if(right < DFR_PWMRate)
 	{
-		// set MR6
-		LPC_PWM1->MR6 = DFR_ScalePWM(right);
-		
-		// set LER for MR6
-		LPC_PWM1->LER = (1<<6);
-		
+		DFR_SetRawPWM(DFR_ScalePWM(right), DFR_CmdLeft);
 		return 1;
 	}
 	else
@@ -145,12 +362,7 @@ int DFR_SetLeftPWM (int left)
 {
 	if(left < DFR_PWMRate)
 	{
-		// Set MR 1
-		LPC_PWM1->MR1 = DFR_ScalePWM(left);
-		
-		// set LER for MR1
-		LPC_PWM1->LER = (1<<1);
-		
+		DFR_SetRawPWM(DFR_CmdRight, DFR_ScalePWM(left));
 		return 1;
 	}
 	else
@@ -176,49 +388,67 @@ int DFR_ScalePWM (int value)
 	// Gear only really limits top speed but for the same speed demand a higher
 	// gear will result in going faster.
 	
-	int x = value;
-	int in_min = 0;
-	int in_max = 100;
-	int out_min = 0;
-	int out_max = 0;
-	
-	if(DFR_Gear == 1)
-	{
-		out_max = 250;
-	}
-	else if(DFR_Gear == 2)
+	// Each gear adds 250 to the top of the range, so 0-100% maps onto
+	// value * gear * 250 / 100 = value * gear * 5 / 2. No division needed.
+	if((value >= 0) && (value <= 100) && (DFR_Gear >= 1) && (DFR_Gear <= 4))
 	{
-		out_max = 500;
+		return (value * DFR_Gear * 5) >> 1;
 	}
-	else if(DFR_Gear == 3)
+	else
 	{
-		out_max = 750;
+		return 0;
 	}
-	else if(DFR_Gear == 4)
+}
+
+/******************************************************************************
+ * Description:
+ *    Find the duty needed for a wheel speed (mm/s, positive) by searching
+ *    the wheel's feedforward table and interpolating between points.
+ *    Returns -1 along with full duty if the speed can't be reached.
+ *****************************************************************************/
+static int DFR_FeedforwardDuty (const uint16_t *table, int speed, int *duty)
+{
+	uint8_t i;
+
+	if(speed <= 0)
 	{
-		out_max = 1000;
+		*duty = 0;
+		return 1;
 	}
-	else
+	if(speed >= table[DFR_FF_POINTS - 1])
 	{
-		out_max = 0;
+		*duty = DFR_FFDuty[DFR_FF_POINTS - 1];
+		return (speed == table[DFR_FF_POINTS - 1]) ? 1 : -1;
 	}
 
-	if (value <= 100)
+	for(i = 1; speed > table[i]; i++);
+
+	// Flat spots (the dead band at low duty) would divide by zero
+	if(table[i] == table[i - 1])
 	{
-		return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+		*duty = DFR_FFDuty[i];
 	}
 	else
 	{
-		return 0;
+		*duty = DFR_FFDuty[i - 1]
+			+ (speed - table[i - 1]) * (DFR_FFDuty[i] - DFR_FFDuty[i - 1])
+			/ (table[i] - table[i - 1]);
 	}
+
+	return 1;
 }
 
 /******************************************************************************
  * Description:
- *    Initialise the ADC channel needed for the range finder
+ *    Initialise the ADC channel needed for the range finder. AD0.3 runs in
+ *    burst mode and GPDMA copies every result into DFR_RangeRing forever.
+ *    No interrupts are used, DFR_RangeUpdate() picks the data up.
  *****************************************************************************/
 void DFR_ADCInit (void)
 {
+	GPDMA_Channel_CFG_Type DMAConfig;
+	uint32_t DMAControl;
+
 	PINSEL_CFG_Type PinConfig;
 	PinConfig.Funcnum = 1;			// Set first alternative function
 	PinConfig.OpenDrain = 0;
@@ -227,20 +457,81 @@ void DFR_ADCInit (void)
 	PinConfig.Portnum = 0;			// I/O Port 0
     PINSEL_ConfigPin(&PinConfig);
 
-	ADC_Init(LPC_ADC, 200000);
-	ADC_ChannelCmd(LPC_ADC,3,ENABLE);			// This could be wrong
-	ADC_IntConfig(LPC_ADC,ADC_ADINTEN0,SET);	// This could be wrong
-	ADC_BurstCmd(LPC_ADC,1);					// This could be wrong
-	ADC_StartCmd(LPC_ADC,ADC_START_CONTINUOUS);	// This could be wrong
+	ADC_Init(LPC_ADC, DFR_RANGE_ADC_RATE);
+	ADC_ChannelCmd(LPC_ADC, 3, ENABLE);
 
-	// We could be really smart and get information from the range finder
-	// by DMA transfer into memory every time a conversion is done so
-	// there is always a current value irrespective of how broken the 
-	// rest of the code gets. Could be complicated. Sounds like time.
-	
-	// Enabling this breaks the world and/or Google +/- 10%.
-	// Also, it turns on the ADC interrupts and we get stuck in the ISR
-	//NVIC_EnableIRQ(ADC_IRQn);
+	// The old config enabled the global done interrupt (the reset default)
+	// and the channel 0 flag, which is why the ISR got stuck. The DMA request
+	// comes from the channel 3 flag with the global flag off. The ADC IRQ
+	// stays disabled in the NVIC, so the CPU never sees any of it.
+	ADC_IntConfig(LPC_ADC, ADC_ADGINTEN, DISABLE);
+	ADC_IntConfig(LPC_ADC, ADC_ADINTEN3, ENABLE);
+
+	// 32 bit peripheral to memory, destination increments, no terminal
+	// count interrupt. Source is ADDR3 rather than the global register so
+	// that the DMA read clears the channel 3 done flag (and so the request).
+	DMAControl = GPDMA_DMACCxControl_TransferSize(DFR_RANGE_RING_SIZE)
+			| GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1)
+			| GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1)
+			| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD)
+			| GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD)
+			| GPDMA_DMACCxControl_DI;
+
+	DFR_RangeLLI.SrcAddr = (uint32_t)(uintptr_t)&LPC_ADC->ADDR3;
+	DFR_RangeLLI.DstAddr = (uint32_t)(uintptr_t)DFR_RangeRing;
+	DFR_RangeLLI.NextLLI = (uint32_t)(uintptr_t)&DFR_RangeLLI;
+	DFR_RangeLLI.Control = DMAControl;
+
+	GPDMA_Init();
+
+	DMAConfig.ChannelNum = DFR_RANGE_DMA_CHANNEL;
+	DMAConfig.TransferSize = DFR_RANGE_RING_SIZE;
+	DMAConfig.TransferWidth = 0;
+	DMAConfig.SrcMemAddr = 0;
+	DMAConfig.DstMemAddr = (uint32_t)(uintptr_t)DFR_RangeRing;
+	DMAConfig.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	DMAConfig.SrcConn = GPDMA_CONN_ADC;
+	DMAConfig.DstConn = 0;
+	DMAConfig.DMALLI = (uint32_t)(uintptr_t)&DFR_RangeLLI;
+	GPDMA_Setup(&DMAConfig);
+
+	// GPDMA_Setup() assumes ADGDR and a terminal count interrupt, undo both
+	LPC_GPDMACH7->DMACCSrcAddr = (uint32_t)(uintptr_t)&LPC_ADC->ADDR3;
+	LPC_GPDMACH7->DMACCControl = DMAControl;
+	LPC_GPDMACH7->DMACCConfig &= ~GPDMA_DMACCxConfig_ITC;
+
+	GPDMA_ChannelCmd(DFR_RANGE_DMA_CHANNEL, ENABLE);
+
+	// Burst mode converts continuously, START bits must stay at zero
+	ADC_BurstCmd(LPC_ADC, 1);
+}
+
+/******************************************************************************
+ * Description:
+ *    Convert filtered ADC counts into millimetres using the calibration
+ *    table, interpolating linearly between points.
+ *****************************************************************************/
+static uint16_t DFR_RangeLookup (uint16_t counts)
+{
+	uint8_t i;
+
+	// Below the first point nothing is in range, above the last it's too close
+	if(counts <= DFR_RangeCounts[0])
+	{
+		return DFR_RangeMillimetres[0];
+	}
+	if(counts >= DFR_RangeCounts[DFR_RANGE_LUT_SIZE - 1])
+	{
+		return DFR_RangeMillimetres[DFR_RANGE_LUT_SIZE - 1];
+	}
+
+	for(i = 1; counts > DFR_RangeCounts[i]; i++);
+
+	// Distances go down as counts go up so interpolate downwards from i-1
+	return DFR_RangeMillimetres[i - 1]
+		- ((uint32_t)(counts - DFR_RangeCounts[i - 1])
+			* (DFR_RangeMillimetres[i - 1] - DFR_RangeMillimetres[i]))
+		/ (DFR_RangeCounts[i] - DFR_RangeCounts[i - 1]);
 }
 
 
@@ -281,7 +572,7 @@ void DFR_RobotInit (void)
 	DFR_SetPWM(0, 0);
 
 	// Initialise the ADC channel needed for the range finder
-	//DFR_ADCInit();
+	DFR_ADCInit();
 }
 
 /******************************************************************************
@@ -290,8 +581,10 @@ void DFR_RobotInit (void)
  *****************************************************************************/
 void DFR_DriveForward (int speed)
 {
+	taskENTER_CRITICAL();
 	GPIO_SetValue(2, 1 << 6 | 1 << 10); // Set direction outputs high
 	DFR_SetPWM(speed, speed); // set PWM outputs to speed
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -300,8 +593,10 @@ void DFR_DriveForward (int speed)
  *****************************************************************************/
 void DFR_DriveBackward (int speed)
 {
+	taskENTER_CRITICAL();
 	GPIO_ClearValue(2, 1 << 6 | 1 << 10); // Set direction outputs low
 	DFR_SetPWM(speed, speed); // set PWM outputs to speed
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -310,9 +605,11 @@ void DFR_DriveBackward (int speed)
  *****************************************************************************/
 void DFR_DriveRight (int speed)
 {
+	taskENTER_CRITICAL();
 	GPIO_SetValue(2, 1 << 6); // Set left motor forward
 	GPIO_ClearValue(2, 1 << 10); // Set Right motor backward
 	DFR_SetPWM(speed, speed); // set motor outputs to speed
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -321,9 +618,11 @@ void DFR_DriveRight (int speed)
  *****************************************************************************/
 void DFR_DriveLeft (int speed)
 {
+	taskENTER_CRITICAL();
 	GPIO_SetValue(2, 1 << 10); // Set left motor forward
 	GPIO_ClearValue(2, 1 << 6); // Set Right motor backward
 	DFR_SetPWM(speed, speed); // set motor outputs to speed
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -332,9 +631,11 @@ void DFR_DriveLeft (int speed)
  *****************************************************************************/
 void DFR_SkidRight (int speed)
 {
+	taskENTER_CRITICAL();
 	DFR_SetRightPWM(0);
 	GPIO_SetValue(2, 1 << 6); // Set left motor forward
 	DFR_SetLeftPWM(speed); // set left motor output to speed
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -343,9 +644,11 @@ void DFR_SkidRight (int speed)
  *****************************************************************************/
 void DFR_SkidLeft (int speed)
 {
+	taskENTER_CRITICAL();
 	DFR_SetLeftPWM(0);
 	GPIO_SetValue(2, 1 << 10); // Set right motor forward
 	DFR_SetRightPWM(speed); // set right motor output to speed
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -354,8 +657,112 @@ void DFR_SkidLeft (int speed)
  *****************************************************************************/
 void DFR_DriveStop (void)
 {
+	taskENTER_CRITICAL();
 	GPIO_ClearValue(2, 1 << 6 | 1 << 10);
 	DFR_SetPWM(DFR_0, DFR_0); // set motor outputs to zero
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Description:
+ *    Drive at forward speed v (mm/s) while turning at omega (mrad/s,
+ *    positive is anticlockwise/left). Either can be negative. Each wheel
+ *    speed is turned into a duty through its own feedforward table, so the
+ *    gear has no effect here. Returns -1 if a wheel had to be saturated.
+ *****************************************************************************/
+int DFR_SetVelocity (int v, int omega)
+{
+	int right, left;
+	int rightDuty, leftDuty;
+	int result = 1;
+
+	// v +/- omega * track / 2, omega is in mrad so scale back by 1000
+	right = v + (omega * DFR_TRACK_MM) / 2000;
+	left = v - (omega * DFR_TRACK_MM) / 2000;
+
+	if(DFR_FeedforwardDuty(DFR_FFRight, abs(right), &rightDuty) < 0)
+	{
+		result = -1;
+	}
+	if(DFR_FeedforwardDuty(DFR_FFLeft, abs(left), &leftDuty) < 0)
+	{
+		result = -1;
+	}
+
+	// Direction outputs high for forward, set with the duties
+	taskENTER_CRITICAL();
+	if(right >= 0)
+	{
+		GPIO_SetValue(2, 1 << 10);
+	}
+	else
+	{
+		GPIO_ClearValue(2, 1 << 10);
+	}
+	if(left >= 0)
+	{
+		GPIO_SetValue(2, 1 << 6);
+	}
+	else
+	{
+		GPIO_ClearValue(2, 1 << 6);
+	}
+
+	DFR_SetRawPWM(rightDuty, leftDuty);
+	taskEXIT_CRITICAL();
+
+	return result;
+}
+
+/******************************************************************************
+ * Description:
+ *    Build the feedforward tables by stepping both wheels through every duty
+ *    point and measuring the encoder rate. The robot drives forward the
+ *    whole time (about 15 s), so put it on blocks with the wheels free.
+ *    Delay must block for the given number of ms, e.g. a vTaskDelay wrapper.
+ *    Encoder counts are cleared and the motors are stopped afterwards.
+ *****************************************************************************/
+void DFR_CalibrateFeedforward (void (*Delay)(uint32_t ms))
+{
+	uint8_t i;
+	uint32_t right, left;
+
+	// Wheels are off the ground, don't let the governor get involved. It
+	// would otherwise put the PWM back to the last drive command within one
+	// RangeTask period of each step.
+	taskENTER_CRITICAL();
+	DFR_Calibrating = 1;
+	GPIO_SetValue(2, 1 << 6 | 1 << 10);
+	taskEXIT_CRITICAL();
+
+	DFR_FFRight[0] = 0;
+	DFR_FFLeft[0] = 0;
+
+	for(i = 1; i < DFR_FF_POINTS; i++)
+	{
+		taskENTER_CRITICAL();
+		DFR_WritePWM(DFR_FFDuty[i], DFR_FFDuty[i]);
+		taskEXIT_CRITICAL();
+		Delay(DFR_CAL_SETTLE_MS);
+
+		DFR_ClearWheelCounts();
+		Delay(DFR_CAL_SAMPLE_MS);
+		right = DFR_GetRightWheelCount();
+		left = DFR_GetLeftWheelCount();
+
+		// Counts over the sample -> um per ms, which is the same as mm/s
+		right = right * DFR_TICK_UM / DFR_CAL_SAMPLE_MS;
+		left = left * DFR_TICK_UM / DFR_CAL_SAMPLE_MS;
+
+		// Noise can make a step read slower than the one below it, keep the
+		// tables monotonic so the lookup search still works
+		DFR_FFRight[i] = (right > DFR_FFRight[i - 1]) ? right : DFR_FFRight[i - 1];
+		DFR_FFLeft[i] = (left > DFR_FFLeft[i - 1]) ? left : DFR_FFLeft[i - 1];
+	}
+
+	DFR_Calibrating = 0;
+	DFR_DriveStop();
+	DFR_ClearWheelCounts();
 }
 
 /******************************************************************************
@@ -364,6 +771,7 @@ void DFR_DriveStop (void)
  *****************************************************************************/
 void DFR_SetRightDrive (uint8_t direction, int speed)
 {
+	taskENTER_CRITICAL();
 	if(direction == DFR_FORWARD)
 	{
 		GPIO_SetValue(2, 1 << 10); // Set Right motor backward
@@ -378,6 +786,7 @@ void DFR_SetRightDrive (uint8_t direction, int speed)
 	{
 		// It's gone a bit pear shaped if we get here
 	}
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -386,6 +795,7 @@ void DFR_SetRightDrive (uint8_t direction, int speed)
  *****************************************************************************/
 void DFR_SetLeftDrive (uint8_t direction, int speed)
 {
+	taskENTER_CRITICAL();
 	if(direction == DFR_FORWARD)
 	{
 		GPIO_SetValue(2, 1 << 6); // Set left motor backward
@@ -400,6 +810,7 @@ void DFR_SetLeftDrive (uint8_t direction, int speed)
 	{
 		// It's gone a bit pear shaped if we get here
 	}
+	taskEXIT_CRITICAL();
 }
 
 /******************************************************************************
@@ -440,6 +851,39 @@ uint8_t DFR_DecRightWheelCount (void)
 	return RightWheelCount;
 }
 
+/******************************************************************************
+ * Description:
+ *    Count encoder edges. Call from EINT3_IRQHandler, which is shared with
+ *    the joystick and is left to clear the GPIO interrupt flags.
+ *****************************************************************************/
+void DFR_EncoderIRQHandler (void)
+{
+	// Encoder input 1 (Left)
+	if ((((LPC_GPIOINT->IO2IntStatR) >> 11)& 0x1) == ENABLE)
+	{
+		DFR_IncLeftWheelCount();
+		DFR_LeftOdometer += (LPC_GPIO2->FIOPIN & (1 << 6)) ? 1 : -1;
+	}
+
+	// Encoder input 2 (Right)
+	if ((((LPC_GPIOINT->IO2IntStatR) >> 12)& 0x1) == ENABLE)
+	{
+		DFR_IncRightWheelCount();
+		DFR_RightOdometer += (LPC_GPIO2->FIOPIN & (1 << 10)) ? 1 : -1;
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Read the signed encoder totals since power up, forward is positive.
+ *    The two reads aren't atomic together, an edge can land in between.
+ *****************************************************************************/
+void DFR_GetOdometer (int32_t *right, int32_t *left)
+{
+	*right = DFR_RightOdometer;
+	*left = DFR_LeftOdometer;
+}
+
 /******************************************************************************
  * Description:
  *    Set the distance desired in the destination variable
@@ -553,6 +997,99 @@ uint8_t DFR_GetGear (void)
 	return DFR_Gear;
 }
 
+/******************************************************************************
+ * Description:
+ *    Take the newest samples out of the DMA ring, median them, run the result
+ *    through the IIR filter and convert it to a distance. Call this at a
+ *    fixed rate from a task, it costs a few microseconds.
+ *****************************************************************************/
+void DFR_RangeUpdate (void)
+{
+	uint16_t window[DFR_RANGE_WINDOW];
+	uint16_t sample;
+	uint32_t word;
+	uint32_t head;
+	uint8_t valid = 0;
+	uint8_t i, j;
+
+	// The DMA destination address is where the next result will land
+	head = (LPC_GPDMACH7->DMACCDestAddr - (uint32_t)(uintptr_t)DFR_RangeRing) >> 2;
+
+	// Walk back from the newest sample and insertion sort as we go
+	for(i = 0; i < DFR_RANGE_WINDOW; i++)
+	{
+		word = DFR_RangeRing[(head - 1 - i) & (DFR_RANGE_RING_SIZE - 1)];
+
+		// Slots the DMA hasn't reached yet are still zero
+		if((word & ADC_DR_DONE_FLAG) == 0)
+		{
+			continue;
+		}
+
+		sample = ADC_DR_RESULT(word);
+		for(j = valid; (j > 0) && (window[j - 1] > sample); j--)
+		{
+			window[j] = window[j - 1];
+		}
+		window[j] = sample;
+		valid++;
+	}
+
+	if(valid == 0)
+	{
+		return;
+	}
+
+	// Seed the filter with the first median so it doesn't ramp up from 0
+	if(DFR_RangeFiltered == 0)
+	{
+		DFR_RangeFiltered = (int32_t)window[valid / 2] << 4;
+	}
+	else
+	{
+		DFR_RangeFiltered += (((int32_t)window[valid / 2] << 4)
+				- DFR_RangeFiltered) >> DFR_RANGE_IIR_SHIFT;
+	}
+
+	DFR_RangeDistance = DFR_RangeLookup((uint16_t)(DFR_RangeFiltered >> 4));
+	DFR_RangeMedian = DFR_RangeLookup(window[valid / 2]);
+}
+
+/******************************************************************************
+ * Description:
+ *    Return the latest filtered range finder distance in mm. 0 until the
+ *    first call to DFR_RangeUpdate() has found some samples.
+ *****************************************************************************/
+uint16_t DFR_GetRange (void)
+{
+	return DFR_RangeDistance;
+}
+
+/******************************************************************************
+ * Description:
+ *    Re-run the speed governor on the current drive command with the latest
+ *    range. Call straight after DFR_RangeUpdate() so a new obstacle reaches
+ *    the PWM without waiting for the next drive command. Worst case from a
+ *    sample to the PWM latch is then the update period, plus half the
+ *    median window at the ADC rate, plus one 1ms PWM period.
+ *****************************************************************************/
+void DFR_Govern (void)
+{
+	taskENTER_CRITICAL();
+	DFR_Governor();
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Description:
+ *    Forward speed in mm/s the governor allowed last time it ran, 0 when
+ *    it's holding the robot at the hard stop, 0xFFFF for no limit.
+ *****************************************************************************/
+uint16_t DFR_GetSpeedLimit (void)
+{
+	return DFR_SpeedLimit;
+}
+
 void DFR_IncRightWheelDestination (void)
 {
 	RightWheelDestination += 10;
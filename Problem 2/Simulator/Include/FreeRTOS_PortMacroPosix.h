@@ -0,0 +1,183 @@
+/**************************************************************************//**
+ *
+ * @file        PortMacroPosix.h
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions for running the kernel as a Linux process.
+ *
+ * Selected by building with FREERTOS_POSIX_PORT defined and Simulator/Include
+ * on the include path.  Each task is a host thread, and only the thread of
+ * the running task is ever allowed to run.  Interrupts, the tick included,
+ * are delivered as a signal to that thread, so they preempt it just as they
+ * would on the target, and masking interrupts is masking the signal.
+ *
+ * Host library calls that take locks (printf(), malloc() and so on) must
+ * only be made by tasks from inside a critical section, as a task can be
+ * switched out at any instruction and another task may then need the same
+ * lock.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	unsigned portLONG
+#define portBASE_TYPE	long
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef unsigned portSHORT portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffff
+#else
+	/* 32 bits, as on the target, so the tick count wraps at the same point
+	on a 64 bit host. */
+	typedef unsigned int portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffffffff
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_RATE_MS			( ( portTickType ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+/*-----------------------------------------------------------*/
+
+
+/* Scheduler utilities. */
+extern void vPortYieldFromISR( void );
+
+#define portYIELD()					vPortYieldFromISR()
+
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
+/*-----------------------------------------------------------*/
+
+
+/* Critical section management.  There is one mask for the whole simulated
+processor, as there is one basepri on the target, and a yield requested while
+it is set waits until it is cleared, as PendSV would. */
+extern unsigned long ulPortRaiseInterruptMask( void );
+extern void vPortRestoreInterruptMask( unsigned long ulMask );
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()		ulPortRaiseInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortRestoreInterruptMask( x )
+
+#define portRAISE_INTERRUPT_MASK()				ulPortRaiseInterruptMask()
+#define portRESTORE_INTERRUPT_MASK( x )			vPortRestoreInterruptMask( x )
+
+#define portDISABLE_INTERRUPTS()	vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()		vPortEnableInterrupts()
+#define portENTER_CRITICAL()		vPortEnterCritical()
+#define portEXIT_CRITICAL()			vPortExitCritical()
+/*-----------------------------------------------------------*/
+
+/* Architecture specific optimisations. */
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* The same bitmap as the Cortex-M3 port, with the compiler builtin in
+	place of the CLZ instruction.  Only the bottom 32 bits are used, so the
+	limit of 32 priorities is the same too. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	/* The idle task is always ready, so uxReadyPriorities is never 0. */
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31 - __builtin_clz( ( unsigned int ) ( uxReadyPriorities ) ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
+/* Tickless idle.  The idle thread waits for the next interrupt with the tick
+held off until the expected idle time is up, then steps the tick count. */
+#if configUSE_TICKLESS_IDLE == 1
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/* Tick interrupts actually taken and ticks slept through since the scheduler
+started, as on the target. */
+extern void vPortGetTickStats( unsigned long *pulTickInterrupts, unsigned long *pulSuppressedTicks );
+/*-----------------------------------------------------------*/
+
+/* A task's host thread is stopped and freed when the kernel frees its TCB. */
+extern void vPortDeleteThread( void *pxTCB );
+#define portCLEAN_UP_TCB( pxTCB )	vPortDeleteThread( pxTCB )
+/*-----------------------------------------------------------*/
+
+/* Simulated time.
+ *
+ * By default the tick follows the host clock.  vPortUseVirtualTime(), called
+ * before vTaskStartScheduler(), switches to a simulated clock instead: while
+ * a task is running each tick takes ulHostMicrosecondsPerTick of host time,
+ * and while the idle task is asleep the clock jumps straight to the next
+ * tick or scheduled interrupt that is due.  A run that mostly waits finishes
+ * as fast as the host can schedule it.
+ *
+ * ullPortGetSimulatedTime() is microseconds since the scheduler started, on
+ * whichever clock is in use.  The run time stats counter is the same count.
+ */
+extern void vPortUseVirtualTime( unsigned long ulHostMicrosecondsPerTick );
+extern unsigned long long ullPortGetSimulatedTime( void );
+extern unsigned long ulPortGetRunTimeCounterValue( void );
+/*-----------------------------------------------------------*/
+
+/* Simulated interrupts.
+ *
+ * Peripheral models install a handler against an interrupt number, then
+ * raise it straight away with vPortGenerateSimulatedInterrupt() or after a
+ * delay in simulated time with vPortScheduleSimulatedInterrupt().  Both can
+ * be called from tasks, from handlers or from other host threads.  Like an
+ * NVIC pending bit, raising an interrupt that is already pending does
+ * nothing more, and scheduling one again moves its due time.
+ *
+ * Handlers run on the thread of the task they interrupt, with interrupts
+ * masked, so they can use the FromISR API and portEND_SWITCHING_ISR() as on
+ * the target.  They all have the same priority and do not nest.  Number 0
+ * is the tick.
+ */
+#define portINTERRUPT_TICK				( 0UL )
+#define portMAX_INTERRUPTS				( 32UL )
+
+typedef void ( *pdINTERRUPT_HANDLER )( void );
+
+extern void vPortSetInterruptHandler( unsigned long ulInterruptNumber, pdINTERRUPT_HANDLER pxHandler );
+extern void vPortGenerateSimulatedInterrupt( unsigned long ulInterruptNumber );
+extern void vPortScheduleSimulatedInterrupt( unsigned long ulInterruptNumber, unsigned long ulDelayMicroseconds );
+/*-----------------------------------------------------------*/
+
+/* configASSERT() prints where it failed and aborts, so a regression run
+stops with a core and a message rather than hanging. */
+extern void vPortAssertFailed( const char *pcFile, unsigned long ulLine );
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ *   LPC17xx.h:  Simulator stand-in for the CMSIS device header
+ *
+ *   Notes: -> Pulls in the real header for the register layouts, then
+ *             points the peripherals the chassis code uses at plain structs
+ *             in RAM so the drivers can run on the host untouched.
+ *          -> Must come before LibCMSIS/Include on the include path.
+ *          -> The chassis simulators run the drivers in one thread with no
+ *             kernel, SIM_NO_KERNEL tells them so.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __SIM_LPC17XX_H
+#define __SIM_LPC17XX_H
+
+#include "../../LibCMSIS/Include/LPC17xx.h"
+
+#ifndef FREERTOS_POSIX_PORT
+#define SIM_NO_KERNEL
+#endif
+
+extern LPC_SC_TypeDef SIM_SC;
+extern LPC_PINCON_TypeDef SIM_PINCON;
+extern LPC_GPIO_TypeDef SIM_GPIO[5];
+extern LPC_GPIOINT_TypeDef SIM_GPIOINT;
+extern LPC_PWM_TypeDef SIM_PWM1;
+extern LPC_ADC_TypeDef SIM_ADC;
+extern LPC_GPDMA_TypeDef SIM_GPDMA;
+extern LPC_GPDMACH_TypeDef SIM_GPDMACH[8];
+
+#undef LPC_SC
+#undef LPC_PINCON
+#undef LPC_GPIO0
+#undef LPC_GPIO1
+#undef LPC_GPIO2
+#undef LPC_GPIO3
+#undef LPC_GPIO4
+#undef LPC_GPIOINT
+#undef LPC_PWM1
+#undef LPC_ADC
+#undef LPC_GPDMA
+#undef LPC_GPDMACH0
+#undef LPC_GPDMACH1
+#undef LPC_GPDMACH2
+#undef LPC_GPDMACH3
+#undef LPC_GPDMACH4
+#undef LPC_GPDMACH5
+#undef LPC_GPDMACH6
+#undef LPC_GPDMACH7
+
+#define LPC_SC				(&SIM_SC)
+#define LPC_PINCON			(&SIM_PINCON)
+#define LPC_GPIO0			(&SIM_GPIO[0])
+#define LPC_GPIO1			(&SIM_GPIO[1])
+#define LPC_GPIO2			(&SIM_GPIO[2])
+#define LPC_GPIO3			(&SIM_GPIO[3])
+#define LPC_GPIO4			(&SIM_GPIO[4])
+#define LPC_GPIOINT			(&SIM_GPIOINT)
+#define LPC_PWM1			(&SIM_PWM1)
+#define LPC_ADC				(&SIM_ADC)
+#define LPC_GPDMA			(&SIM_GPDMA)
+#define LPC_GPDMACH0		(&SIM_GPDMACH[0])
+#define LPC_GPDMACH1		(&SIM_GPDMACH[1])
+#define LPC_GPDMACH2		(&SIM_GPDMACH[2])
+#define LPC_GPDMACH3		(&SIM_GPDMACH[3])
+#define LPC_GPDMACH4		(&SIM_GPDMACH[4])
+#define LPC_GPDMACH5		(&SIM_GPDMACH[5])
+#define LPC_GPDMACH6		(&SIM_GPDMACH[6])
+#define LPC_GPDMACH7		(&SIM_GPDMACH[7])
+
+#endif /* end __SIM_LPC17XX_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,40 @@
+/*****************************************************************************
+ *   SimChassis.h:  Header file for the host side DF Robot chassis model
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+******************************************************************************/
+#ifndef __SIMCHASSIS_H
+#define __SIMCHASSIS_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	double TrackMm;			// Distance between wheel centres
+	double TickMm;			// Wheel travel per encoder edge
+	double MaxSpeedMm;		// Wheel speed in mm/s at full duty
+	double DeadBand;		// Fraction of duty that doesn't turn the wheel
+	double TimeConstantMs;	// First order motor lag
+	double RightGain;		// Per motor mismatch, 1.0 is nominal
+	double LeftGain;
+	double Slip;			// Fraction of wheel travel lost to the floor
+	double SpeedNoise;		// Random fraction added to wheel speed each ms
+	double WallMm;			// Wall across the y axis at this y, 0 for none
+	double RangeNoise;		// +/- ADC counts on the range finder
+} SIM_Params;
+
+void SIM_DefaultParams(SIM_Params *params);
+void SIM_Reset(const SIM_Params *params, uint32_t seed);
+void SIM_Step(uint32_t ms);
+uint32_t SIM_GetTime(void);
+void SIM_GetPose(double *x, double *y, double *heading);
+void SIM_SetWall(double y);
+void SIM_GetDuty(uint32_t *right, uint32_t *left);
+uint32_t SIM_Random(void);
+
+#endif /* end __SIMCHASSIS_H */
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
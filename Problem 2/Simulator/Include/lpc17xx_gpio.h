@@ -0,0 +1,5 @@
+/*****************************************************************************
+ *   lpc17xx_gpio.h:  Lower case alias for case sensitive host file systems
+ *
+******************************************************************************/
+#include "LPC17xx_GPIO.h"
@@ -0,0 +1,5 @@
+/*****************************************************************************
+ *   lpc17xx_pwm.h:  Lower case alias for case sensitive host file systems
+ *
+******************************************************************************/
+#include "LPC17xx_PWM.h"
@@ -0,0 +1,857 @@
+/**************************************************************************//**
+ *
+ * @file        PortPosix.c
+ * @brief       Part of FreeRTOS
+ * @author      Real Time Engineers Ltd.
+ * @version     7.1.0
+ * @date        25 July. 2012
+ *
+ * Copyright (C) 2011 Real Time Engineers Ltd.
+ * All rights reserved.
+ *
+******************************************************************************/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in Portable.h for running the kernel
+ * as a Linux process.  See FreeRTOS_PortMacroPosix.h for the model.
+ *
+ * One thread per task, and a semaphore per thread that it waits on while it
+ * is not the running task, so the kernel only ever sees one task running.
+ * A clock thread keeps simulated time, and raises the tick and any scheduled
+ * interrupts by marking them pending and sending the process
+ * portINTERRUPT_SIGNAL.  Every thread but the running task's blocks the
+ * signal, so it lands on the running task like an exception would, or waits
+ * for interrupts to be enabled again if they are masked.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#ifndef FREERTOS_POSIX_PORT
+	#error FreeRTOS_PortPosix.c is the host port, build it with FREERTOS_POSIX_PORT defined.
+#endif
+
+/* The signal simulated interrupts arrive on. */
+#define portINTERRUPT_SIGNAL		SIGUSR1
+
+/* Host stack for each task thread.  The stack the kernel allocates for the
+task only holds the pointer to its thread, see pxPortInitialiseStack(). */
+#define portTHREAD_STACK_SIZE		( 256U * 1024U )
+
+/* Microseconds of simulated time per tick. */
+#define portTICK_PERIOD_US			( 1000000ULL / ( unsigned long long ) configTICK_RATE_HZ )
+
+/* The host side of a task. */
+typedef struct xTHREAD
+{
+	pthread_t xThread;
+	sem_t xWake;						/*< Posted to switch the task in. */
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+	volatile portBASE_TYPE xDelete;		/*< Set when the TCB is freed.  The thread exits when it next wakes. */
+} xThreadType;
+
+/* The running task's TCB, from FreeRTOS_Tasks.c.  The first member of a TCB
+is the top of stack pxPortInitialiseStack() returned, which holds the thread. */
+extern void * volatile pxCurrentTCB;
+#define portTHREAD_OF( pxTCB )		( ( xThreadType * ) ( **( ( portSTACK_TYPE ** ) ( pxTCB ) ) ) )
+
+/* The simulated processor.  Only the running task's thread touches these, so
+like the registers they stand in for they need no lock.  xSwitchPending is
+the PendSV pending bit. */
+static unsigned portBASE_TYPE uxCriticalNesting = 0xaaaaaaaa;
+static volatile portBASE_TYPE xInterruptsMasked = pdFALSE;
+static volatile portBASE_TYPE xSwitchPending = pdFALSE;
+static volatile portBASE_TYPE xSchedulerStarted = pdFALSE;
+
+/* Set by vPortEndScheduler(), after which interrupts are ignored. */
+static volatile portBASE_TYPE xSchedulerEnding = pdFALSE;
+static sem_t xSchedulerEnded;
+
+/* Marks the threads that belong to tasks, so a signal that reaches any other
+thread can be handed back. */
+static __thread portBASE_TYPE xIsTaskThread = pdFALSE;
+
+static sigset_t xInterruptSignal;
+static pthread_once_t xInitialised = PTHREAD_ONCE_INIT;
+
+/* The interrupt controller and the clock, shared with the clock thread and
+any peripheral threads.  xClockMutex is only ever taken with the signal
+blocked, so a handler can never find it held by the code it interrupted. */
+static pthread_mutex_t xClockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xClockCondition;		/*< Wakes the clock thread to look again. */
+static pthread_cond_t xIdleCondition;		/*< Wakes the idle task out of a sleep. */
+static pthread_t xClockThread;
+
+static pdINTERRUPT_HANDLER pxInterruptHandlers[ portMAX_INTERRUPTS ];
+static unsigned long ulPendingInterrupts = 0UL;		/*< One bit per interrupt, apart from the tick. */
+static unsigned long ulPendingTicks = 0UL;			/*< Ticks are counted so a slow host never drops one. */
+static unsigned long ulScheduledInterrupts = 0UL;	/*< One bit per interrupt with a due time below. */
+static unsigned long long ullDueTime[ portMAX_INTERRUPTS ];
+
+/* Simulated time is ullSimulatedBase plus the host time since ullHostBase,
+scaled for virtual time.  The clock stands at 0 until the scheduler starts,
+and in virtual time stands still while the idle task sleeps. */
+static unsigned long ulHostMicrosecondsPerTick = 0UL;	/*< 0 for the host clock. */
+static unsigned long long ullSimulatedBase = 0ULL;
+static unsigned long long ullHostBase = 0ULL;
+static unsigned long long ullNextTick = portTICK_PERIOD_US;
+
+/* Tickless idle.  While xSuppressing is set, tick periods before ullWakeTick
+are counted instead of raised. */
+static portBASE_TYPE xIdle = pdFALSE;
+static portBASE_TYPE xSuppressing = pdFALSE;
+static unsigned long long ullWakeTick = 0ULL;
+static unsigned long ulSkippedTicks = 0UL;
+
+/* Tick interrupts actually taken, and ticks that went by while asleep
+without one.  Read with vPortGetTickStats(). */
+static volatile unsigned long ulTickInterrupts = 0UL;
+static unsigned long ulSuppressedTicks = 0UL;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Sets up the signal set, and blocks the signal in the calling thread (the
+ * one that goes on to start the scheduler) so every host thread started
+ * afterwards inherits it blocked.
+ */
+static void prvInitialise( void );
+
+/*
+ * The thread behind each task.
+ */
+static void *prvTaskThread( void *pvThread );
+
+/*
+ * Lets the next task run if it is not this one, and waits until this one is
+ * switched back in.  Called with interrupts masked.
+ */
+static void prvSwitchContext( void );
+static void prvWaitToRun( xThreadType *pxThread );
+
+/*
+ * The interrupt signal handler, and the handlers of everything it finds
+ * pending.
+ */
+static void prvInterruptSignalHandler( int iSignal, siginfo_t *pxInfo, void *pvContext );
+static void prvServiceInterrupts( void );
+static void prvTickInterrupt( void );
+
+/*
+ * The clock thread, and the parts of it the rest of the port shares.  All
+ * but prvLockClock() and prvUnlockClock() need xClockMutex held.
+ */
+static void *prvClockThread( void *pvParameters );
+static void prvLockClock( sigset_t *pxSavedMask );
+static void prvUnlockClock( sigset_t *pxSavedMask );
+static unsigned long long prvHostMicroseconds( void );
+static unsigned long long prvSimulatedNow( void );
+static void prvWaitForClock( unsigned long long ullTime );
+static void prvRaiseInterrupt( unsigned long ulInterruptNumber );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xThreadType *pxThread;
+pthread_attr_t xAttributes;
+sigset_t xSavedMask;
+int iResult;
+
+	( void ) pthread_once( &xInitialised, prvInitialise );
+
+	/* malloc() and pthread_create() take host locks, so must not be
+	interrupted if a running task is creating this one.  The new thread
+	inherits the blocked signal. */
+	( void ) pthread_sigmask( SIG_BLOCK, &xInterruptSignal, &xSavedMask );
+	{
+		pxThread = ( xThreadType * ) malloc( sizeof( xThreadType ) );
+		configASSERT( pxThread );
+
+		pxThread->pxCode = pxCode;
+		pxThread->pvParameters = pvParameters;
+		pxThread->xDelete = pdFALSE;
+		( void ) sem_init( &( pxThread->xWake ), 0, 0U );
+
+		( void ) pthread_attr_init( &xAttributes );
+		( void ) pthread_attr_setstacksize( &xAttributes, portTHREAD_STACK_SIZE );
+		( void ) pthread_attr_setdetachstate( &xAttributes, PTHREAD_CREATE_DETACHED );
+		iResult = pthread_create( &( pxThread->xThread ), &xAttributes, prvTaskThread, ( void * ) pxThread );
+		( void ) pthread_attr_destroy( &xAttributes );
+		configASSERT( iResult == 0 );
+	}
+	( void ) pthread_sigmask( SIG_SETMASK, &xSavedMask, NULL );
+
+	/* Nothing runs on the task's own stack.  The top word says which thread
+	is the task's. */
+	pxTopOfStack--;
+	*pxTopOfStack = ( portSTACK_TYPE ) pxThread;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portBASE_TYPE xPortStartScheduler( void )
+{
+struct sigaction xAction;
+pthread_condattr_t xAttributes;
+int iResult;
+
+	( void ) pthread_once( &xInitialised, prvInitialise );
+
+	/* The handler runs with the signal blocked, so interrupts do not nest. */
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_sigaction = prvInterruptSignalHandler;
+	xAction.sa_flags = SA_SIGINFO | SA_RESTART;
+	( void ) sigemptyset( &xAction.sa_mask );
+	( void ) sigaddset( &xAction.sa_mask, portINTERRUPT_SIGNAL );
+	( void ) sigaction( portINTERRUPT_SIGNAL, &xAction, NULL );
+
+	( void ) pthread_condattr_init( &xAttributes );
+	( void ) pthread_condattr_setclock( &xAttributes, CLOCK_MONOTONIC );
+	( void ) pthread_cond_init( &xClockCondition, &xAttributes );
+	( void ) pthread_cond_init( &xIdleCondition, &xAttributes );
+	( void ) pthread_condattr_destroy( &xAttributes );
+	( void ) sem_init( &xSchedulerEnded, 0, 0U );
+
+	/* Start the clock at 0.  Interrupts are disabled here already, so the
+	clock thread starts with the signal blocked. */
+	( void ) pthread_mutex_lock( &xClockMutex );
+	{
+		ullHostBase = prvHostMicroseconds();
+		ullSimulatedBase = 0ULL;
+		ullNextTick = portTICK_PERIOD_US;
+		xSchedulerStarted = pdTRUE;
+	}
+	( void ) pthread_mutex_unlock( &xClockMutex );
+	iResult = pthread_create( &xClockThread, NULL, prvClockThread, NULL );
+	configASSERT( iResult == 0 );
+
+	/* Initialise the critical nesting count ready for the first task. */
+	uxCriticalNesting = 0;
+
+	/* Start the first task, then wait for a task to call
+	vTaskEndScheduler(). */
+	( void ) sem_post( &( portTHREAD_OF( pxCurrentTCB )->xWake ) );
+	while( sem_wait( &xSchedulerEnded ) != 0 )
+	{
+		/* Interrupted by a signal meant for a task, wait again. */
+	}
+
+	( void ) pthread_join( xClockThread, NULL );
+
+	/* Back in main() with the scheduler stopped. */
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+sigset_t xSavedMask;
+
+	prvLockClock( &xSavedMask );
+	{
+		xSchedulerEnding = pdTRUE;
+		( void ) pthread_cond_signal( &xClockCondition );
+		( void ) pthread_cond_signal( &xIdleCondition );
+	}
+	prvUnlockClock( &xSavedMask );
+
+	( void ) sem_post( &xSchedulerEnded );
+
+	/* The task that ended the scheduler stops here.  The others stay parked
+	until the process exits. */
+	pthread_exit( NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortDeleteThread( void *pxTCB )
+{
+xThreadType *pxThread = portTHREAD_OF( pxTCB );
+
+	/* The task is not running, so its thread is waiting in prvWaitToRun()
+	and will free itself there. */
+	pxThread->xDelete = pdTRUE;
+	( void ) sem_post( &( pxThread->xWake ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	/* Set the PendSV bit.  From a handler or with interrupts masked it is
+	taken when the mask is cleared, otherwise straight away. */
+	xSwitchPending = pdTRUE;
+
+	if( xInterruptsMasked == pdFALSE )
+	{
+		vPortDisableInterrupts();
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortRaiseInterruptMask( void )
+{
+unsigned long ulWasMasked = ( unsigned long ) xInterruptsMasked;
+
+	if( ulWasMasked == pdFALSE )
+	{
+		( void ) pthread_sigmask( SIG_BLOCK, &xInterruptSignal, NULL );
+		xInterruptsMasked = pdTRUE;
+	}
+
+	return ulWasMasked;
+}
+/*-----------------------------------------------------------*/
+
+void vPortRestoreInterruptMask( unsigned long ulMask )
+{
+	if( ulMask == pdFALSE )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	( void ) ulPortRaiseInterruptMask();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	/* A switch requested while masked happens now, as PendSV would.  This
+	task carries on from here when it is switched back in. */
+	while( ( xSwitchPending != pdFALSE ) && ( xSchedulerStarted != pdFALSE ) )
+	{
+		xSwitchPending = pdFALSE;
+		prvSwitchContext();
+	}
+
+	xInterruptsMasked = pdFALSE;
+
+	/* Anything raised while masked is taken here. */
+	( void ) pthread_sigmask( SIG_UNBLOCK, &xInterruptSignal, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	portDISABLE_INTERRUPTS();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		portENABLE_INTERRUPTS();
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if configUSE_TICKLESS_IDLE == 1
+
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+	{
+	unsigned long ulCompleteTickPeriods = 0UL;
+
+		/* Mask interrupts so the one that ends the sleep is not taken until
+		the tick count has been corrected, which the Cortex-M3 port does with
+		cpsid. */
+		portDISABLE_INTERRUPTS();
+
+		/* If a context switch is pending or a task is waiting for the
+		scheduler to be unsuspended then abandon the low power entry. */
+		if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+		{
+			portENABLE_INTERRUPTS();
+			return;
+		}
+
+		( void ) pthread_mutex_lock( &xClockMutex );
+		{
+			/* As wfi, do not sleep with an interrupt already pending. */
+			if( ( ulPendingTicks == 0UL ) && ( ulPendingInterrupts == 0UL ) && ( xSchedulerEnding == pdFALSE ) )
+			{
+				/* Every tick so far has been taken, so ullNextTick is the
+				first of the idle time and the tick that ends it is
+				xExpectedIdleTime - 1 after it. */
+				ullWakeTick = ullNextTick + ( ( unsigned long long ) ( xExpectedIdleTime - 1UL ) * portTICK_PERIOD_US );
+				ulSkippedTicks = 0UL;
+				xSuppressing = pdTRUE;
+
+				/* Virtual time stops here and jumps from now on. */
+				if( ulHostMicrosecondsPerTick != 0UL )
+				{
+					ullSimulatedBase = prvSimulatedNow();
+				}
+				xIdle = pdTRUE;
+				( void ) pthread_cond_signal( &xClockCondition );
+
+				while( ( xIdle != pdFALSE ) && ( xSchedulerEnding == pdFALSE ) )
+				{
+					( void ) pthread_cond_wait( &xIdleCondition, &xClockMutex );
+				}
+
+				xSuppressing = pdFALSE;
+				ulCompleteTickPeriods = ulSkippedTicks;
+			}
+		}
+		( void ) pthread_mutex_unlock( &xClockMutex );
+
+		/* Step over the tick periods that passed without an interrupt.  The
+		tick that ended the sleep, if it was the tick, is still pending and
+		is taken when interrupts are enabled below. */
+		vTaskStepTick( ulCompleteTickPeriods );
+		ulSuppressedTicks += ulCompleteTickPeriods;
+
+		portENABLE_INTERRUPTS();
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+void vPortGetTickStats( unsigned long *pulTickInterrupts, unsigned long *pulSuppressedTicks )
+{
+	portENTER_CRITICAL();
+	{
+		*pulTickInterrupts = ulTickInterrupts;
+		*pulSuppressedTicks = ulSuppressedTicks;
+	}
+	portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vPortUseVirtualTime( unsigned long ulHostMicroseconds )
+{
+	/* Only before the scheduler starts, so there is no clock to adjust. */
+	configASSERT( xSchedulerStarted == pdFALSE );
+	ulHostMicrosecondsPerTick = ( ulHostMicroseconds == 0UL ) ? 1UL : ulHostMicroseconds;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long long ullPortGetSimulatedTime( void )
+{
+unsigned long long ullNow;
+sigset_t xSavedMask;
+
+	prvLockClock( &xSavedMask );
+	{
+		ullNow = prvSimulatedNow();
+	}
+	prvUnlockClock( &xSavedMask );
+
+	return ullNow;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortGetRunTimeCounterValue( void )
+{
+	return ( unsigned long ) ullPortGetSimulatedTime();
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( unsigned long ulInterruptNumber, pdINTERRUPT_HANDLER pxHandler )
+{
+sigset_t xSavedMask;
+
+	/* The tick handler is the port's own. */
+	configASSERT( ( ulInterruptNumber > portINTERRUPT_TICK ) && ( ulInterruptNumber < portMAX_INTERRUPTS ) );
+
+	( void ) pthread_once( &xInitialised, prvInitialise );
+	prvLockClock( &xSavedMask );
+	{
+		pxInterruptHandlers[ ulInterruptNumber ] = pxHandler;
+	}
+	prvUnlockClock( &xSavedMask );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( unsigned long ulInterruptNumber )
+{
+sigset_t xSavedMask;
+
+	configASSERT( ulInterruptNumber < portMAX_INTERRUPTS );
+
+	( void ) pthread_once( &xInitialised, prvInitialise );
+	prvLockClock( &xSavedMask );
+	{
+		prvRaiseInterrupt( ulInterruptNumber );
+	}
+	prvUnlockClock( &xSavedMask );
+}
+/*-----------------------------------------------------------*/
+
+void vPortScheduleSimulatedInterrupt( unsigned long ulInterruptNumber, unsigned long ulDelayMicroseconds )
+{
+sigset_t xSavedMask;
+
+	configASSERT( ( ulInterruptNumber > portINTERRUPT_TICK ) && ( ulInterruptNumber < portMAX_INTERRUPTS ) );
+
+	( void ) pthread_once( &xInitialised, prvInitialise );
+	prvLockClock( &xSavedMask );
+	{
+		ullDueTime[ ulInterruptNumber ] = prvSimulatedNow() + ( unsigned long long ) ulDelayMicroseconds;
+		ulScheduledInterrupts |= ( 1UL << ulInterruptNumber );
+
+		if( xSchedulerStarted != pdFALSE )
+		{
+			( void ) pthread_cond_signal( &xClockCondition );
+		}
+	}
+	prvUnlockClock( &xSavedMask );
+}
+/*-----------------------------------------------------------*/
+
+void vPortAssertFailed( const char *pcFile, unsigned long ulLine )
+{
+	( void ) fprintf( stderr, "configASSERT failed at %s:%lu\n", pcFile, ulLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialise( void )
+{
+	( void ) sigemptyset( &xInterruptSignal );
+	( void ) sigaddset( &xInterruptSignal, portINTERRUPT_SIGNAL );
+	( void ) pthread_sigmask( SIG_BLOCK, &xInterruptSignal, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTaskThread( void *pvThread )
+{
+xThreadType *pxThread = ( xThreadType * ) pvThread;
+
+	xIsTaskThread = pdTRUE;
+
+	/* Wait to be switched in for the first time. */
+	prvWaitToRun( pxThread );
+
+	/* Tasks start with interrupts enabled. */
+	portENABLE_INTERRUPTS();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Task functions must not return, as on the target. */
+	vPortAssertFailed( __FILE__, __LINE__ );
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+xThreadType *pxOld, *pxNew;
+
+	pxOld = portTHREAD_OF( pxCurrentTCB );
+	vTaskSwitchContext();
+	pxNew = portTHREAD_OF( pxCurrentTCB );
+
+	if( pxNew != pxOld )
+	{
+		/* The new task's thread may be running before this one is waiting,
+		but this one touches nothing shared from here on. */
+		( void ) sem_post( &( pxNew->xWake ) );
+		prvWaitToRun( pxOld );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitToRun( xThreadType *pxThread )
+{
+	while( sem_wait( &( pxThread->xWake ) ) != 0 )
+	{
+		/* Only EINTR, wait again. */
+	}
+
+	if( pxThread->xDelete != pdFALSE )
+	{
+		( void ) sem_destroy( &( pxThread->xWake ) );
+		free( pxThread );
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSignalHandler( int iSignal, siginfo_t *pxInfo, void *pvContext )
+{
+int iSavedErrno = errno;
+
+	( void ) iSignal;
+	( void ) pxInfo;
+
+	if( xIsTaskThread == pdFALSE )
+	{
+		/* A host thread that was started before the signal was blocked.
+		Keep it blocked there once the handler returns, and hand it back to
+		the process for the running task to take. */
+		( void ) sigaddset( &( ( ( ucontext_t * ) pvContext )->uc_sigmask ), portINTERRUPT_SIGNAL );
+		( void ) kill( getpid(), portINTERRUPT_SIGNAL );
+	}
+	else if( xSchedulerEnding == pdFALSE )
+	{
+		/* The handlers run masked, as they would with basepri raised to the
+		kernel priority.  A switch any of them asked for is made on the way
+		out, and this task carries on from here when switched back in. */
+		xInterruptsMasked = pdTRUE;
+		prvServiceInterrupts();
+
+		while( xSwitchPending != pdFALSE )
+		{
+			xSwitchPending = pdFALSE;
+			prvSwitchContext();
+		}
+		xInterruptsMasked = pdFALSE;
+	}
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceInterrupts( void )
+{
+unsigned long ulTicks, ulPending, ulInterruptNumber;
+pdINTERRUPT_HANDLER pxHandler;
+sigset_t xSavedMask;
+
+	for( ;; )
+	{
+		prvLockClock( &xSavedMask );
+		{
+			ulTicks = ulPendingTicks;
+			ulPendingTicks = 0UL;
+			ulPending = ulPendingInterrupts;
+			ulPendingInterrupts = 0UL;
+		}
+		prvUnlockClock( &xSavedMask );
+
+		if( ( ulTicks == 0UL ) && ( ulPending == 0UL ) )
+		{
+			break;
+		}
+
+		while( ulTicks > 0UL )
+		{
+			prvTickInterrupt();
+			ulTicks--;
+		}
+
+		for( ulInterruptNumber = 1UL; ulInterruptNumber < portMAX_INTERRUPTS; ulInterruptNumber++ )
+		{
+			if( ( ulPending & ( 1UL << ulInterruptNumber ) ) != 0UL )
+			{
+				pxHandler = pxInterruptHandlers[ ulInterruptNumber ];
+				if( pxHandler != NULL )
+				{
+					pxHandler();
+				}
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickInterrupt( void )
+{
+	/* If using preemption, also force a context switch. */
+	#if configUSE_PREEMPTION == 1
+		xSwitchPending = pdTRUE;
+	#endif
+
+	ulTickInterrupts++;
+	vTaskIncrementTick();
+}
+/*-----------------------------------------------------------*/
+
+static void *prvClockThread( void *pvParameters )
+{
+unsigned long long ullNow, ullNext;
+unsigned long ulInterruptNumber;
+
+	( void ) pvParameters;
+
+	( void ) pthread_mutex_lock( &xClockMutex );
+
+	while( xSchedulerEnding == pdFALSE )
+	{
+		/* The next thing due is the tick, or the tick that ends the idle
+		task's sleep, or a scheduled interrupt if that is sooner. */
+		ullNext = ( xSuppressing != pdFALSE ) ? ullWakeTick : ullNextTick;
+		for( ulInterruptNumber = 1UL; ulInterruptNumber < portMAX_INTERRUPTS; ulInterruptNumber++ )
+		{
+			if( ( ( ulScheduledInterrupts & ( 1UL << ulInterruptNumber ) ) != 0UL ) && ( ullDueTime[ ulInterruptNumber ] < ullNext ) )
+			{
+				ullNext = ullDueTime[ ulInterruptNumber ];
+			}
+		}
+
+		ullNow = prvSimulatedNow();
+		if( ullNext > ullNow )
+		{
+			if( ( ulHostMicrosecondsPerTick != 0UL ) && ( xIdle != pdFALSE ) )
+			{
+				/* Virtual time with nothing running, nothing can happen
+				before then so go straight there. */
+				ullSimulatedBase = ullNext;
+				ullNow = ullNext;
+			}
+			else
+			{
+				/* Look again when it is due or when anything changes. */
+				prvWaitForClock( ullNext );
+				continue;
+			}
+		}
+
+		while( ullNextTick <= ullNow )
+		{
+			if( ( xSuppressing != pdFALSE ) && ( ullNextTick < ullWakeTick ) )
+			{
+				ulSkippedTicks++;
+			}
+			else
+			{
+				/* The tick that ends a sleep ends the suppression too, so
+				the ticks after it are raised while the idle task waits for
+				the mutex. */
+				xSuppressing = pdFALSE;
+				prvRaiseInterrupt( portINTERRUPT_TICK );
+			}
+			ullNextTick += portTICK_PERIOD_US;
+		}
+
+		for( ulInterruptNumber = 1UL; ulInterruptNumber < portMAX_INTERRUPTS; ulInterruptNumber++ )
+		{
+			if( ( ( ulScheduledInterrupts & ( 1UL << ulInterruptNumber ) ) != 0UL ) && ( ullDueTime[ ulInterruptNumber ] <= ullNow ) )
+			{
+				ulScheduledInterrupts &= ~( 1UL << ulInterruptNumber );
+				prvRaiseInterrupt( ulInterruptNumber );
+			}
+		}
+	}
+
+	( void ) pthread_mutex_unlock( &xClockMutex );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLockClock( sigset_t *pxSavedMask )
+{
+	( void ) pthread_sigmask( SIG_BLOCK, &xInterruptSignal, pxSavedMask );
+	( void ) pthread_mutex_lock( &xClockMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlockClock( sigset_t *pxSavedMask )
+{
+	( void ) pthread_mutex_unlock( &xClockMutex );
+	( void ) pthread_sigmask( SIG_SETMASK, pxSavedMask, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvHostMicroseconds( void )
+{
+struct timespec xNow;
+
+	( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( ( unsigned long long ) xNow.tv_sec * 1000000ULL ) + ( ( unsigned long long ) xNow.tv_nsec / 1000ULL );
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long long prvSimulatedNow( void )
+{
+unsigned long long ullHostElapsed;
+
+	if( xSchedulerStarted == pdFALSE )
+	{
+		return 0ULL;
+	}
+
+	if( ulHostMicrosecondsPerTick == 0UL )
+	{
+		ullHostElapsed = prvHostMicroseconds() - ullHostBase;
+		return ullSimulatedBase + ullHostElapsed;
+	}
+
+	if( xIdle != pdFALSE )
+	{
+		/* Virtual time only moves in the clock thread's jumps while asleep. */
+		return ullSimulatedBase;
+	}
+
+	ullHostElapsed = prvHostMicroseconds() - ullHostBase;
+	return ullSimulatedBase + ( ( ullHostElapsed * portTICK_PERIOD_US ) / ulHostMicrosecondsPerTick );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForClock( unsigned long long ullTime )
+{
+unsigned long long ullHost;
+struct timespec xDeadline;
+
+	if( ulHostMicrosecondsPerTick == 0UL )
+	{
+		ullHost = ullHostBase + ( ullTime - ullSimulatedBase );
+	}
+	else
+	{
+		/* Rounded up, waking early would only mean waiting again. */
+		ullHost = ullHostBase + ( ( ( ullTime - ullSimulatedBase ) * ulHostMicrosecondsPerTick ) + ( portTICK_PERIOD_US - 1ULL ) ) / portTICK_PERIOD_US;
+	}
+
+	xDeadline.tv_sec = ( time_t ) ( ullHost / 1000000ULL );
+	xDeadline.tv_nsec = ( long ) ( ( ullHost % 1000000ULL ) * 1000ULL );
+	( void ) pthread_cond_timedwait( &xClockCondition, &xClockMutex, &xDeadline );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRaiseInterrupt( unsigned long ulInterruptNumber )
+{
+	if( ulInterruptNumber == portINTERRUPT_TICK )
+	{
+		ulPendingTicks++;
+	}
+	else
+	{
+		ulPendingInterrupts |= ( 1UL << ulInterruptNumber );
+	}
+
+	/* End the idle task's sleep.  Virtual time runs again from where it
+	stood. */
+	if( xIdle != pdFALSE )
+	{
+		xIdle = pdFALSE;
+		if( ulHostMicrosecondsPerTick != 0UL )
+		{
+			ullHostBase = prvHostMicroseconds();
+		}
+		( void ) pthread_cond_signal( &xIdleCondition );
+	}
+
+	( void ) kill( getpid(), portINTERRUPT_SIGNAL );
+}
+/*-----------------------------------------------------------*/
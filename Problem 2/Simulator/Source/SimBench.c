@@ -0,0 +1,133 @@
+/*****************************************************************************
+ *   SimBench.c:  Runs KernelBench.c on the host POSIX port
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -DFREERTOS_POSIX_PORT -ISimulator/Include \
+ *          -ILibFreeRTOS/Include -IProject/Include \
+ *          Simulator/Source/SimBench.c Project/Source/KernelBench.c \
+ *          Simulator/Source/FreeRTOS_PortPosix.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Tasks.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Queue.c \
+ *          LibFreeRTOS/Source/FreeRTOS_List.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Timers.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Heap.c \
+ *          LibFreeRTOS/Source/FreeRTOS_StreamBuffer.c \
+ *          LibFreeRTOS/Source/FreeRTOS_TraceRecorder.c \
+ *          -lpthread -o bench_sim
+ *
+ *          -> ./bench_sim > bench.csv
+ *             The same table the target sends on MAP_UART_PORT, in
+ *             nanoseconds of host time. A task switch here is two host
+ *             threads handing over through semaphores, so the figures only
+ *             compare host runs with each other, a kernel or config change
+ *             before and after.
+ *          -> Runs on the host clock, not virtual time, so the handler
+ *             and the task switches are timed as they happen.
+ *          -> ./bench_sim [host us per tick]
+ *             runs on virtual time instead, as kernel_sim does. The
+ *             nanosecond figures are still host time, but the deadline
+ *             workload is timed in simulated us, and at 10000 a tick of it
+ *             has ten times the host time, so the host's own overheads
+ *             hardly count. Use that to compare fixed priority with
+ *             configUSE_EDF_SCHEDULER=1, built once each way.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#include "KernelBench.h"
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static xStaticTaskType SIM_IdleTaskBuffer, SIM_TimerTaskBuffer;
+static portSTACK_TYPE SIM_IdleTaskStack[configMINIMAL_STACK_SIZE];
+static portSTACK_TYPE SIM_TimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+// Called from a task, so stdout's lock is taken inside a critical section
+static void SIM_Write (const uint8_t *data, uint32_t length)
+{
+	taskENTER_CRITICAL();
+	fwrite(data, 1, length, stdout);
+	fflush(stdout);
+	taskEXIT_CRITICAL();
+}
+
+static void SIM_BenchTask (void *pvParameters)
+{
+	(void)pvParameters;
+
+	BCH_Run(SIM_Write);
+	vTaskEndScheduler();
+}
+
+
+/******************************************************************************
+ * Kernel hooks
+ *****************************************************************************/
+void vApplicationGetIdleTaskMemory(xStaticTaskType **ppxIdleTaskTCBBuffer, portSTACK_TYPE **ppxIdleTaskStackBuffer, unsigned short *pusIdleTaskStackSize)
+{
+	*ppxIdleTaskTCBBuffer = &SIM_IdleTaskBuffer;
+	*ppxIdleTaskStackBuffer = SIM_IdleTaskStack;
+	*pusIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(xStaticTaskType **ppxTimerTaskTCBBuffer, portSTACK_TYPE **ppxTimerTaskStackBuffer, unsigned short *pusTimerTaskStackSize)
+{
+	*ppxTimerTaskTCBBuffer = &SIM_TimerTaskBuffer;
+	*ppxTimerTaskStackBuffer = SIM_TimerTaskStack;
+	*pusTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+void vApplicationStackOverflowHook(xTaskHandle pxTask, signed char *pcTaskName)
+{
+	(void)pxTask;
+	fprintf(stderr, "stack overflow in %s\n", (const char *)pcTaskName);
+	abort();
+}
+
+void vApplicationMallocFailedHook(void)
+{
+	fprintf(stderr, "pvPortMalloc() failed\n");
+	abort();
+}
+
+
+/******************************************************************************
+ * Main
+ *****************************************************************************/
+int main (int argc, char *argv[])
+{
+	unsigned long hostUsPerTick = 0;
+
+	if(argc > 1) hostUsPerTick = strtoul(argv[1], NULL, 0);
+	if(hostUsPerTick != 0)
+	{
+		vPortUseVirtualTime(hostUsPerTick);
+	}
+
+	xTaskCreate(SIM_BenchTask, (signed char *)"Bench", configMINIMAL_STACK_SIZE * 2, NULL, tskIDLE_PRIORITY + 1, NULL);
+
+	// Returns when SIM_BenchTask() ends the scheduler
+	vTaskStartScheduler();
+
+	return 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
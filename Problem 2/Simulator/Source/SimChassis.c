@@ -0,0 +1,471 @@
+/*****************************************************************************
+ *   SimChassis.c:  Host side model of the DF Robot chassis
+ *
+ *   Notes: -> Stands in for the PWM1, GPIO, ADC and GPDMA registers that
+ *             dfrobot.c touches, and turns them into wheel motion, encoder
+ *             edges and range finder samples one virtual millisecond at a
+ *             time. Nothing here waits on the wall clock.
+ *          -> GPIO set/clear registers are write-only on the real part, so
+ *             the GPIO driver functions are replaced rather than modelled.
+ *             PinSelect, ADC and GPDMA use the real drivers on RAM registers.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <string.h>
+
+#include "LPC17xx.h"
+#include "LPC17xx_GPIO.h"
+#include "LPC17xx_ADC.h"
+#include "LPC17xx_ClockPower.h"
+#include "LPC17xx_GPDMA.h"
+#include "dfrobot.h"
+#include "SimChassis.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_LEFT_DIR		(1 << 6)	// P2.6
+#define SIM_RIGHT_DIR		(1 << 10)	// P2.10
+#define SIM_LEFT_ENC		(1 << 11)	// P2.11
+#define SIM_RIGHT_ENC		(1 << 12)	// P2.12
+#define SIM_ADC_BURST		(1 << 16)
+#define SIM_ADC_PDN			(1 << 21)
+
+// Write to a register the CMSIS header marks read only
+#define SIM_WRITE(reg, val)	(*(volatile uint32_t *)&(reg) = (val))
+
+typedef struct
+{
+	double Speed;		// mm/s at the wheel rim, signed
+	double Travel;		// mm since the last encoder edge
+	uint32_t Duty;		// MRx value latched at the last MR0 match
+} SIM_Wheel;
+
+
+/******************************************************************************
+ * External global variables
+ *****************************************************************************/
+uint32_t SystemCoreClock = 100000000;
+
+LPC_SC_TypeDef SIM_SC;
+LPC_PINCON_TypeDef SIM_PINCON;
+LPC_GPIO_TypeDef SIM_GPIO[5];
+LPC_GPIOINT_TypeDef SIM_GPIOINT;
+LPC_PWM_TypeDef SIM_PWM1;
+LPC_ADC_TypeDef SIM_ADC;
+LPC_GPDMA_TypeDef SIM_GPDMA;
+LPC_GPDMACH_TypeDef SIM_GPDMACH[8];
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static SIM_Params Params;
+static SIM_Wheel Left, Right;
+static double PoseX, PoseY, PoseHeading;
+static double AdcPending;
+static uint32_t Time;
+static uint32_t RandomState;
+
+// Sharp IR curve the range finder model follows, mm against ADC counts
+#define SIM_SENSOR_POINTS	11
+static const double SensorMm[SIM_SENSOR_POINTS] =
+	{  80,  100,  150,  200,  250,  300,  400,  500,  600,  700,  800};
+static const double SensorCounts[SIM_SENSOR_POINTS] =
+	{3413, 2854, 2048, 1613, 1303, 1142,  931,  745,  620,  558,  496};
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Uniform random number in [-1, 1]
+ *****************************************************************************/
+static double SIM_Uniform (void)
+{
+	return (double)SIM_Random() / 2147483647.5 - 1.0;
+}
+
+/******************************************************************************
+ * Description:
+ *    The drivers hand the DMA 32 bit addresses. On a 64 bit host those are
+ *    truncated pointers, so put the top half back using an object that
+ *    lives in the same image.
+ *****************************************************************************/
+static void *SIM_Pointer (uint32_t address)
+{
+	uintptr_t anchor = (uintptr_t)&Params;
+	uintptr_t pointer;
+
+	if(sizeof(uintptr_t) <= sizeof(uint32_t))
+	{
+		return (void *)(uintptr_t)address;
+	}
+
+	pointer = (anchor & ~(uintptr_t)0xFFFFFFFFUL) | address;
+	if(pointer > anchor + 0x80000000UL)
+	{
+		pointer -= (uintptr_t)1 << 16 << 16;
+	}
+	else if(pointer + 0x80000000UL < anchor)
+	{
+		pointer += (uintptr_t)1 << 16 << 16;
+	}
+	return (void *)pointer;
+}
+
+/******************************************************************************
+ * Description:
+ *    Range finder output in ADC counts for the current pose
+ *****************************************************************************/
+static uint32_t SIM_RangeCounts (void)
+{
+	double distance = 10000;
+	double counts;
+	double along = cos(PoseHeading);
+	uint8_t i;
+
+	if((Params.WallMm > 0) && (along > 0.01) && (PoseY < Params.WallMm))
+	{
+		distance = (Params.WallMm - PoseY) / along;
+	}
+
+	if(distance <= SensorMm[0])
+	{
+		counts = SensorCounts[0];
+	}
+	else if(distance >= SensorMm[SIM_SENSOR_POINTS - 1])
+	{
+		counts = SensorCounts[SIM_SENSOR_POINTS - 1] * SensorMm[SIM_SENSOR_POINTS - 1] / distance;
+	}
+	else
+	{
+		for(i = 1; distance > SensorMm[i]; i++);
+		counts = SensorCounts[i - 1] + (distance - SensorMm[i - 1])
+			* (SensorCounts[i] - SensorCounts[i - 1]) / (SensorMm[i] - SensorMm[i - 1]);
+	}
+
+	counts += Params.RangeNoise * SIM_Uniform();
+	if(counts < 0) counts = 0;
+	if(counts > 4095) counts = 4095;
+	return (uint32_t)counts;
+}
+
+/******************************************************************************
+ * Description:
+ *    Burst mode conversions on AD0.3, pushed through any enabled DMA channel
+ *    reading ADDR3 exactly as the controller would, LLI reloads included.
+ *****************************************************************************/
+static void SIM_StepADC (void)
+{
+	uint32_t clkdiv, sample, control, n;
+	GPDMA_LLI_Type *lli;
+	uint8_t ch;
+
+	if((SIM_ADC.ADCR & (SIM_ADC_BURST | SIM_ADC_PDN)) != (SIM_ADC_BURST | SIM_ADC_PDN)
+		|| (SIM_ADC.ADCR & (1 << 3)) == 0)
+	{
+		return;
+	}
+
+	// 65 ADC clocks per conversion, PCLK is the default CCLK / 4
+	clkdiv = (SIM_ADC.ADCR >> 8) & 0xFF;
+	AdcPending += (SystemCoreClock / 4.0) / (clkdiv + 1) / 65.0 / 1000.0;
+
+	for(n = (uint32_t)AdcPending; n > 0; n--, AdcPending -= 1.0)
+	{
+		sample = ADC_DR_DONE_FLAG | (3 << 24) | (SIM_RangeCounts() << 4);
+		SIM_WRITE(SIM_ADC.ADDR3, sample);
+		SIM_ADC.ADGDR = sample;
+
+		for(ch = 0; ch < 8; ch++)
+		{
+			if(((SIM_GPDMACH[ch].DMACCConfig & GPDMA_DMACCxConfig_E) == 0)
+				|| (SIM_GPDMACH[ch].DMACCSrcAddr != (uint32_t)(uintptr_t)&SIM_ADC.ADDR3))
+			{
+				continue;
+			}
+
+			*(uint32_t *)SIM_Pointer(SIM_GPDMACH[ch].DMACCDestAddr) = sample;
+			SIM_WRITE(SIM_ADC.ADDR3, sample & ~ADC_DR_DONE_FLAG);
+
+			control = SIM_GPDMACH[ch].DMACCControl;
+			SIM_GPDMACH[ch].DMACCDestAddr += 4;
+			SIM_GPDMACH[ch].DMACCControl = (control & ~0xFFF) | ((control & 0xFFF) - 1);
+
+			if((control & 0xFFF) > 1)
+			{
+				continue;
+			}
+
+			// Terminal count, follow the LLI or stop
+			if(SIM_GPDMACH[ch].DMACCLLI == 0)
+			{
+				SIM_GPDMACH[ch].DMACCConfig &= ~GPDMA_DMACCxConfig_E;
+				continue;
+			}
+			lli = (GPDMA_LLI_Type *)SIM_Pointer(SIM_GPDMACH[ch].DMACCLLI);
+			SIM_GPDMACH[ch].DMACCSrcAddr = lli->SrcAddr;
+			SIM_GPDMACH[ch].DMACCDestAddr = lli->DstAddr;
+			SIM_GPDMACH[ch].DMACCLLI = lli->NextLLI;
+			SIM_GPDMACH[ch].DMACCControl = lli->Control;
+		}
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Move one wheel on by a millisecond and raise an encoder edge for every
+ *    tick of travel. Returns the speed over the ground.
+ *****************************************************************************/
+static double SIM_StepWheel (SIM_Wheel *wheel, uint32_t duty, uint8_t forward,
+		double gain, uint32_t encoder)
+{
+	double target, drive;
+
+	drive = (double)duty / (SIM_PWM1.MR0 ? SIM_PWM1.MR0 : 1);
+	if(drive > 1.0) drive = 1.0;
+	drive = (drive - Params.DeadBand) / (1.0 - Params.DeadBand);
+	if(drive < 0) drive = 0;
+
+	target = drive * Params.MaxSpeedMm * gain * (forward ? 1.0 : -1.0);
+	wheel->Speed += (target - wheel->Speed) / Params.TimeConstantMs;
+	wheel->Travel += fabs(wheel->Speed) * (1.0 + Params.SpeedNoise * SIM_Uniform()) / 1000.0;
+
+	// Single channel encoder, counts in either direction
+	while(wheel->Travel >= Params.TickMm)
+	{
+		wheel->Travel -= Params.TickMm;
+		if(SIM_GPIOINT.IO2IntEnR & encoder)
+		{
+			SIM_WRITE(SIM_GPIOINT.IO2IntStatR, encoder);
+			DFR_EncoderIRQHandler();
+			SIM_WRITE(SIM_GPIOINT.IO2IntStatR, 0);
+		}
+	}
+
+	return wheel->Speed * (1.0 - Params.Slip);
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Nominal chassis, numbers match the defaults in dfrobot.c
+ *****************************************************************************/
+void SIM_DefaultParams (SIM_Params *params)
+{
+	params->TrackMm = 130;
+	params->TickMm = 10.21;
+	params->MaxSpeedMm = 500;
+	params->DeadBand = 0.15;
+	params->TimeConstantMs = 60;
+	params->RightGain = 1.0;
+	params->LeftGain = 1.0;
+	params->Slip = 0.0;
+	params->SpeedNoise = 0.0;
+	params->WallMm = 0;
+	params->RangeNoise = 0;
+}
+
+/******************************************************************************
+ * Description:
+ *    Power on reset for every modelled register and the robot back at the
+ *    origin facing +y
+ *****************************************************************************/
+void SIM_Reset (const SIM_Params *params, uint32_t seed)
+{
+	Params = *params;
+	RandomState = seed ? seed : 1;
+
+	memset(&SIM_SC, 0, sizeof(SIM_SC));
+	memset(&SIM_PINCON, 0, sizeof(SIM_PINCON));
+	memset(SIM_GPIO, 0, sizeof(SIM_GPIO));
+	memset(&SIM_GPIOINT, 0, sizeof(SIM_GPIOINT));
+	memset(&SIM_PWM1, 0, sizeof(SIM_PWM1));
+	memset(&SIM_ADC, 0, sizeof(SIM_ADC));
+	memset(&SIM_GPDMA, 0, sizeof(SIM_GPDMA));
+	memset(SIM_GPDMACH, 0, sizeof(SIM_GPDMACH));
+	SIM_ADC.ADINTEN = 0x100;
+
+	memset(&Left, 0, sizeof(Left));
+	memset(&Right, 0, sizeof(Right));
+	PoseX = 0;
+	PoseY = 0;
+	PoseHeading = 0;
+	AdcPending = 0;
+	Time = 0;
+}
+
+/******************************************************************************
+ * Description:
+ *    Advance virtual time. The PWM period is 1ms so shadow registers are
+ *    latched once per step, as they would be on the MR0 match.
+ *****************************************************************************/
+void SIM_Step (uint32_t ms)
+{
+	double left, right, speed, turn;
+
+	while(ms--)
+	{
+		if((SIM_PWM1.TCR & 1) != 0)
+		{
+			if(SIM_PWM1.LER & (1 << 1)) Left.Duty = SIM_PWM1.MR1;
+			if(SIM_PWM1.LER & (1 << 6)) Right.Duty = SIM_PWM1.MR6;
+			SIM_PWM1.LER = 0;
+		}
+		else
+		{
+			Left.Duty = 0;
+			Right.Duty = 0;
+		}
+
+		left = SIM_StepWheel(&Left, Left.Duty, (SIM_GPIO[2].FIOPIN & SIM_LEFT_DIR) != 0,
+				Params.LeftGain, SIM_LEFT_ENC);
+		right = SIM_StepWheel(&Right, Right.Duty, (SIM_GPIO[2].FIOPIN & SIM_RIGHT_DIR) != 0,
+				Params.RightGain, SIM_RIGHT_ENC);
+
+		// Heading is anticlockwise from +y, forward is (-sin, cos)
+		speed = (left + right) / 2.0;
+		turn = (right - left) / Params.TrackMm;
+		PoseHeading += turn / 1000.0;
+		PoseX -= speed * sin(PoseHeading) / 1000.0;
+		PoseY += speed * cos(PoseHeading) / 1000.0;
+
+		SIM_StepADC();
+		Time++;
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Virtual milliseconds since the last reset
+ *****************************************************************************/
+uint32_t SIM_GetTime (void)
+{
+	return Time;
+}
+
+/******************************************************************************
+ * Description:
+ *    True position in mm and heading in radians, anticlockwise from +y
+ *****************************************************************************/
+void SIM_GetPose (double *x, double *y, double *heading)
+{
+	*x = PoseX;
+	*y = PoseY;
+	*heading = PoseHeading;
+}
+
+/******************************************************************************
+ * Description:
+ *    Move the wall, e.g. to drop an obstacle in front of the robot mid run
+ *****************************************************************************/
+void SIM_SetWall (double y)
+{
+	Params.WallMm = y;
+}
+
+/******************************************************************************
+ * Description:
+ *    Duty values the PWM is actually running with, after the MR0 latch
+ *****************************************************************************/
+void SIM_GetDuty (uint32_t *right, uint32_t *left)
+{
+	*right = Right.Duty;
+	*left = Left.Duty;
+}
+
+/******************************************************************************
+ * Description:
+ *    Seeded xorshift so that every run can be repeated exactly
+ *****************************************************************************/
+uint32_t SIM_Random (void)
+{
+	RandomState ^= RandomState << 13;
+	RandomState ^= RandomState >> 17;
+	RandomState ^= RandomState << 5;
+	return RandomState;
+}
+
+/******************************************************************************
+ * Description:
+ *    GPIO driver replacements. FIOPIN holds the output latch directly.
+ *****************************************************************************/
+void GPIO_SetDir (uint8_t portNum, uint32_t bitValue, uint8_t dir)
+{
+	if(dir)
+	{
+		SIM_GPIO[portNum].FIODIR |= bitValue;
+	}
+	else
+	{
+		SIM_GPIO[portNum].FIODIR &= ~bitValue;
+	}
+}
+
+void GPIO_SetValue (uint8_t portNum, uint32_t bitValue)
+{
+	SIM_GPIO[portNum].FIOPIN |= bitValue;
+}
+
+void GPIO_ClearValue (uint8_t portNum, uint32_t bitValue)
+{
+	SIM_GPIO[portNum].FIOPIN &= ~bitValue;
+}
+
+uint32_t GPIO_ReadValue (uint8_t portNum)
+{
+	return SIM_GPIO[portNum].FIOPIN;
+}
+
+void GPIO_IntCmd (uint8_t portNum, uint32_t bitValue, uint8_t edgeState)
+{
+	if((portNum == 0) && (edgeState == 0)) SIM_GPIOINT.IO0IntEnR = bitValue;
+	if((portNum == 2) && (edgeState == 0)) SIM_GPIOINT.IO2IntEnR = bitValue;
+	if((portNum == 0) && (edgeState == 1)) SIM_GPIOINT.IO0IntEnF = bitValue;
+	if((portNum == 2) && (edgeState == 1)) SIM_GPIOINT.IO2IntEnF = bitValue;
+}
+
+void GPIO_ClearInt (uint8_t portNum, uint32_t bitValue)
+{
+	if(portNum == 0) SIM_WRITE(SIM_GPIOINT.IO0IntStatR, SIM_GPIOINT.IO0IntStatR & ~bitValue);
+	if(portNum == 2) SIM_WRITE(SIM_GPIOINT.IO2IntStatR, SIM_GPIOINT.IO2IntStatR & ~bitValue);
+}
+
+/******************************************************************************
+ * Description:
+ *    Clock and power replacements. The real file has WFI in it.
+ *****************************************************************************/
+void CLKPWR_ConfigPPWR (uint32_t PPType, FunctionalState NewState)
+{
+	if(NewState == ENABLE)
+	{
+		SIM_SC.PCONP |= PPType;
+	}
+	else
+	{
+		SIM_SC.PCONP &= ~PPType;
+	}
+}
+
+uint32_t CLKPWR_GetPCLK (uint32_t ClkType)
+{
+	(void)ClkType;
+	return SystemCoreClock / 4;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,207 @@
+/*****************************************************************************
+ *   SimGovernor.c:  Exercises the speed governor against the chassis model
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -ISimulator/Include -IProject/Include \
+ *          -ILibLPC17xx/Include -ILibCMSIS/Include \
+ *          Simulator/Source/SimChassis.c Simulator/Source/SimGovernor.c \
+ *          Project/Source/dfrobot.c \
+ *          LibLPC17xx/Source/LPC17xx_PinSelect.c \
+ *          LibLPC17xx/Source/LPC17xx_ADC.c \
+ *          LibLPC17xx/Source/LPC17xx_GPDMA.c -lm -o governor_sim
+ *
+ *          -> ./governor_sim [runs] [seed]
+ *             Approach: drive at a wall from a random distance, gear and
+ *             speed and record how close it gets.
+ *             Pop up: drop a wall 100mm in front of the robot at a random
+ *             moment and time how long until both PWM channels have
+ *             latched zero. That's the ADC sample to PWM latch latency.
+ *             Calibrate: run DFR_CalibrateFeedforward() once with
+ *             RangeTask still running and count the milliseconds the PWM
+ *             was zero while a calibration step was being measured.
+ *             RangeTask (20ms) and WEEEOutputTask (50ms) are modelled
+ *             with random phases.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "LPC17xx.h"
+#include "dfrobot.h"
+#include "SimChassis.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_RANGE_PERIOD_MS		20		// RangeTask
+#define SIM_DRIVE_PERIOD_MS		50		// WEEEOutputTask
+#define SIM_APPROACH_LIMIT_MS	20000
+#define SIM_POPUP_MM			100		// Inside the hard stop distance
+#define SIM_POPUP_LIMIT_MS		1000
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static uint32_t RangePhase, DrivePhase;
+static int Speed;
+static uint32_t CalStalled;
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    One virtual millisecond of the firmware: the two tasks on their
+ *    periods, then the hardware.
+ *****************************************************************************/
+static void SIM_Tick (void)
+{
+	uint32_t now = SIM_GetTime();
+
+	if(((now + DrivePhase) % SIM_DRIVE_PERIOD_MS) == 0)
+	{
+		DFR_DriveForward(Speed);
+	}
+	if(((now + RangePhase) % SIM_RANGE_PERIOD_MS) == 0)
+	{
+		DFR_RangeUpdate();
+		DFR_Govern();
+	}
+	SIM_Step(1);
+}
+
+/******************************************************************************
+ * Description:
+ *    Delay for DFR_CalibrateFeedforward(). WEEEOutputTask waits on the
+ *    calibration so only RangeTask keeps running.
+ *****************************************************************************/
+static void SIM_CalDelay (uint32_t ms)
+{
+	uint32_t right, left;
+
+	while(ms--)
+	{
+		if(((SIM_GetTime() + RangePhase) % SIM_RANGE_PERIOD_MS) == 0)
+		{
+			DFR_RangeUpdate();
+			DFR_Govern();
+		}
+		SIM_Step(1);
+		SIM_GetDuty(&right, &left);
+		if((right == 0) || (left == 0)) CalStalled++;
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Fresh chassis and driver with a random gear, speed and task phasing
+ *****************************************************************************/
+static void SIM_Start (uint32_t seed, double wall)
+{
+	SIM_Params params;
+	uint8_t gear;
+
+	SIM_DefaultParams(&params);
+	params.Slip = 0.02;
+	params.SpeedNoise = 0.05;
+	params.RangeNoise = 30;
+	params.WallMm = wall;
+	SIM_Reset(&params, seed);
+
+	DFR_RobotInit();
+	DFR_DecGear();
+	DFR_DecGear();
+	DFR_DecGear();
+	for(gear = SIM_Random() % 4; gear > 0; gear--)
+	{
+		DFR_IncGear();
+	}
+	Speed = 40 + SIM_Random() % 61;
+	RangePhase = SIM_Random() % SIM_RANGE_PERIOD_MS;
+	DrivePhase = SIM_Random() % SIM_DRIVE_PERIOD_MS;
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+int main (int argc, char **argv)
+{
+	uint32_t runs = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+	uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+	uint32_t run, right, left, start, latency;
+	uint32_t latencyMax = 0, latencySum = 0, missed = 0;
+	double x, y, heading, wall, gap;
+	double gapMin = 1e9, gapSum = 0;
+
+	printf("run,test,gear,speed,result\n");
+
+	for(run = 0; run < runs; run++)
+	{
+		// Approach
+		SIM_Start(seed + run * 7919, 0);
+		wall = 400 + SIM_Random() % 1100;
+		SIM_SetWall(wall);
+		while(SIM_GetTime() < SIM_APPROACH_LIMIT_MS)
+		{
+			SIM_Tick();
+		}
+		SIM_GetPose(&x, &y, &heading);
+		gap = wall - y;
+		gapSum += gap;
+		if(gap < gapMin) gapMin = gap;
+		printf("%u,approach,%u,%d,%.1f\n", run, DFR_GetGear(), Speed, gap);
+
+		// Pop up, after it has had time to get up to speed
+		SIM_Start(seed + run * 7919 + 1, 0);
+		start = 500 + SIM_Random() % 1000;
+		while(SIM_GetTime() < start)
+		{
+			SIM_Tick();
+		}
+		SIM_GetPose(&x, &y, &heading);
+		SIM_SetWall(y + SIM_POPUP_MM);
+		do
+		{
+			SIM_Tick();
+			SIM_GetDuty(&right, &left);
+		} while(((right != 0) || (left != 0)) && (SIM_GetTime() - start < SIM_POPUP_LIMIT_MS));
+
+		latency = SIM_GetTime() - start;
+		if((right != 0) || (left != 0)) missed++;
+		latencySum += latency;
+		if(latency > latencyMax) latencyMax = latency;
+		printf("%u,popup,%u,%d,%u\n", run, DFR_GetGear(), Speed, latency);
+	}
+
+	// Calibrate, it spans many RangeTask periods
+	SIM_Start(seed, 0);
+	DFR_CalibrateFeedforward(SIM_CalDelay);
+	SIM_Step(SIM_RANGE_PERIOD_MS);	// Let the stop latch
+	SIM_GetDuty(&right, &left);
+	printf("-,calibrate,%u,-,%u\n", DFR_GetGear(), CalStalled);
+
+	printf("# runs %u\n", runs);
+	printf("# approach gap to wall mm: mean %.1f, min %.1f\n",
+			runs ? gapSum / runs : 0.0, gapMin);
+	printf("# popup sample to latch ms: mean %.1f, max %u, missed %u\n",
+			runs ? (double)latencySum / runs : 0.0, latencyMax, missed);
+	printf("# calibrate ms with a PWM channel at zero: %u, stopped after %s\n",
+			CalStalled, ((right == 0) && (left == 0)) ? "yes" : "no");
+
+	return (missed || (gapMin <= 0) || CalStalled || right || left) ? 1 : 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
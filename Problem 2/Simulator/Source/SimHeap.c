@@ -0,0 +1,373 @@
+/*****************************************************************************
+ *   SimHeap.c:  Stress test of the kernel heap against the old heap_2
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -ILibFreeRTOS/Include -ILibCMSIS/Include \
+ *          -IProject/Include Simulator/Source/SimHeap.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Heap.c -o heap_sim
+ *
+ *          -> ./heap_sim [operations] [seed]
+ *             Keeps SIM_SLOTS buffers on the go, like drivers making and
+ *             dropping buffers of mixed sizes over a long run. Each step
+ *             frees a random buffer if it's in use, or allocates one if not.
+ *             The same sequence goes through pvPortMalloc()/vPortFree() and
+ *             through a copy of the heap_2 scheme the kernel used to have.
+ *          -> Reports ns per call, the worst single call, failed
+ *             allocations and the largest free block along the way. At the
+ *             end everything is freed and the largest block is checked
+ *             again; heap_2 never merges blocks so it stays in pieces.
+ *          -> Pointers are 8 bytes here, so headers are twice the size they
+ *             are on the board. Both heaps pay that the same way.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_SLOTS			48			// Buffers alive at once, at most
+#define SIM_CHECK_EVERY		1000		// Steps between fragmentation samples
+#define SIM_HEAP_SIZE		configTOTAL_HEAP_SIZE
+
+// heap_2, as it was
+#define SIM_STRUCT_SIZE		((sizeof(SIM_BlockLink) + (portBYTE_ALIGNMENT - 1)) & ~portBYTE_ALIGNMENT_MASK)
+#define SIM_MINIMUM_BLOCK	((size_t)(SIM_STRUCT_SIZE * 2))
+
+typedef struct SIM_BlockLink
+{
+	struct SIM_BlockLink *Next;
+	size_t Size;
+} SIM_BlockLink;
+
+typedef struct
+{
+	const char *Name;
+	void *(*Malloc)(size_t size);
+	void (*Free)(void *block);
+	size_t (*Largest)(void);
+	size_t (*FreeBytes)(void);
+} SIM_Heap;
+
+typedef struct
+{
+	uint64_t Nanoseconds;
+	uint64_t WorstMalloc;
+	uint64_t WorstFree;
+	uint32_t Calls;
+	uint32_t Failed;
+	uint32_t Checks;
+	uint64_t LargestSum;
+	size_t LargestMin;
+	size_t FreeAtEnd;
+	size_t LargestAtEnd;
+} SIM_Result;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static uint32_t SIM_Seed;
+static uint32_t SIM_MallocFailed;
+
+static union
+{
+	volatile portDOUBLE Dummy;
+	unsigned char Heap[SIM_HEAP_SIZE];
+} SIM_Heap2Memory;
+static SIM_BlockLink SIM_Heap2Start, SIM_Heap2End;
+static size_t SIM_Heap2FreeBytes = SIM_HEAP_SIZE;
+static uint8_t SIM_Heap2Ready = 0;
+
+static void *SIM_Blocks[SIM_SLOTS];
+static size_t SIM_Sizes[SIM_SLOTS];
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+static uint32_t SIM_Random (void)
+{
+	SIM_Seed = SIM_Seed * 1103515245UL + 12345UL;
+	return (SIM_Seed >> 8) & 0xFFFFFF;
+}
+
+static uint64_t SIM_Nanoseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/******************************************************************************
+ * Description:
+ *    Mostly small control blocks and queues, some stacks and frame buffers,
+ *    now and then something big
+ *****************************************************************************/
+static size_t SIM_Size (void)
+{
+	uint32_t pick = SIM_Random() % 100;
+
+	if(pick < 50) return 8 + SIM_Random() % 120;
+	if(pick < 85) return 128 + SIM_Random() % 512;
+	if(pick < 98) return 640 + SIM_Random() % 1024;
+	return 1664 + SIM_Random() % 1536;
+}
+
+static void SIM_Heap2Insert (SIM_BlockLink *block)
+{
+	SIM_BlockLink *iterator;
+
+	for(iterator = &SIM_Heap2Start; iterator->Next->Size < block->Size; iterator = iterator->Next)
+	{
+	}
+	block->Next = iterator->Next;
+	iterator->Next = block;
+}
+
+static void *SIM_Heap2Malloc (size_t size)
+{
+	SIM_BlockLink *block, *previous, *split;
+	void *result = NULL;
+
+	if(!SIM_Heap2Ready)
+	{
+		SIM_Heap2Start.Next = (void *)SIM_Heap2Memory.Heap;
+		SIM_Heap2Start.Size = 0;
+		SIM_Heap2End.Size = SIM_HEAP_SIZE;
+		SIM_Heap2End.Next = NULL;
+		block = (void *)SIM_Heap2Memory.Heap;
+		block->Size = SIM_HEAP_SIZE;
+		block->Next = &SIM_Heap2End;
+		SIM_Heap2Ready = 1;
+	}
+
+	if(size > 0)
+	{
+		size += SIM_STRUCT_SIZE;
+		if(size & portBYTE_ALIGNMENT_MASK)
+		{
+			size += portBYTE_ALIGNMENT - (size & portBYTE_ALIGNMENT_MASK);
+		}
+	}
+
+	if(size > 0 && size < SIM_HEAP_SIZE)
+	{
+		previous = &SIM_Heap2Start;
+		block = SIM_Heap2Start.Next;
+		while(block->Size < size && block->Next)
+		{
+			previous = block;
+			block = block->Next;
+		}
+
+		if(block != &SIM_Heap2End)
+		{
+			result = (uint8_t *)previous->Next + SIM_STRUCT_SIZE;
+			previous->Next = block->Next;
+			if(block->Size - size > SIM_MINIMUM_BLOCK)
+			{
+				split = (void *)((uint8_t *)block + size);
+				split->Size = block->Size - size;
+				block->Size = size;
+				SIM_Heap2Insert(split);
+			}
+			SIM_Heap2FreeBytes -= block->Size;
+		}
+	}
+
+	if(result == NULL)
+	{
+		SIM_MallocFailed++;
+	}
+	return result;
+}
+
+static void SIM_Heap2Free (void *memory)
+{
+	SIM_BlockLink *block;
+
+	if(memory)
+	{
+		block = (void *)((uint8_t *)memory - SIM_STRUCT_SIZE);
+		SIM_Heap2Insert(block);
+		SIM_Heap2FreeBytes += block->Size;
+	}
+}
+
+// Sorted by size, so it's the last one before the end marker
+static size_t SIM_Heap2Largest (void)
+{
+	SIM_BlockLink *block;
+	size_t largest = 0;
+
+	for(block = SIM_Heap2Start.Next; block != &SIM_Heap2End; block = block->Next)
+	{
+		largest = block->Size;
+	}
+	return largest ? largest - SIM_STRUCT_SIZE : 0;
+}
+
+static size_t SIM_Heap2Bytes (void)
+{
+	return SIM_Heap2FreeBytes;
+}
+
+static size_t SIM_KernelLargest (void)
+{
+	xHeapStatsType stats;
+
+	vPortGetHeapStats(&stats);
+	return stats.xSizeOfLargestFreeBlockInBytes;
+}
+
+/******************************************************************************
+ * Description:
+ *    Run the same sequence of operations through one heap
+ *****************************************************************************/
+static void SIM_Run (const SIM_Heap *heap, uint32_t operations, uint32_t seed, SIM_Result *result)
+{
+	uint64_t start, took;
+	uint32_t step, slot;
+	size_t largest;
+
+	memset(result, 0, sizeof(*result));
+	memset(SIM_Blocks, 0, sizeof(SIM_Blocks));
+	result->LargestMin = SIM_HEAP_SIZE;
+	SIM_Seed = seed;
+	SIM_MallocFailed = 0;
+
+	for(step = 0; step < operations; step++)
+	{
+		slot = SIM_Random() % SIM_SLOTS;
+		if(SIM_Blocks[slot] != NULL)
+		{
+			start = SIM_Nanoseconds();
+			heap->Free(SIM_Blocks[slot]);
+			took = SIM_Nanoseconds() - start;
+			SIM_Blocks[slot] = NULL;
+			if(took > result->WorstFree) result->WorstFree = took;
+		}
+		else
+		{
+			SIM_Sizes[slot] = SIM_Size();
+			start = SIM_Nanoseconds();
+			SIM_Blocks[slot] = heap->Malloc(SIM_Sizes[slot]);
+			took = SIM_Nanoseconds() - start;
+			if(took > result->WorstMalloc) result->WorstMalloc = took;
+			if(SIM_Blocks[slot] != NULL)
+			{
+				// Scribble on it so overlapping blocks show up as corruption
+				memset(SIM_Blocks[slot], slot, SIM_Sizes[slot]);
+			}
+		}
+		result->Nanoseconds += took;
+		result->Calls++;
+
+		if((step % SIM_CHECK_EVERY) == SIM_CHECK_EVERY - 1)
+		{
+			largest = heap->Largest();
+			result->LargestSum += largest;
+			if(largest < result->LargestMin) result->LargestMin = largest;
+			result->Checks++;
+		}
+	}
+
+	// Everything back, and check nothing was trodden on
+	for(slot = 0; slot < SIM_SLOTS; slot++)
+	{
+		if(SIM_Blocks[slot] != NULL)
+		{
+			if(((uint8_t *)SIM_Blocks[slot])[SIM_Sizes[slot] - 1] != (uint8_t)slot)
+			{
+				printf("# %s: block %u corrupted\n", heap->Name, slot);
+			}
+			heap->Free(SIM_Blocks[slot]);
+			SIM_Blocks[slot] = NULL;
+		}
+	}
+	result->Failed = SIM_MallocFailed;
+	result->FreeAtEnd = heap->FreeBytes();
+	result->LargestAtEnd = heap->Largest();
+}
+
+static void SIM_Print (const char *name, const SIM_Result *result)
+{
+	printf("%s,%.1f,%llu,%llu,%u,%u,%.0f,%u,%u,%u\n", name,
+			result->Calls ? (double)result->Nanoseconds / result->Calls : 0.0,
+			(unsigned long long)result->WorstMalloc, (unsigned long long)result->WorstFree,
+			result->Calls, result->Failed,
+			result->Checks ? (double)result->LargestSum / result->Checks : 0.0,
+			(unsigned)result->LargestMin, (unsigned)result->FreeAtEnd,
+			(unsigned)result->LargestAtEnd);
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+// What the heap needs from the kernel, there's only one thread here
+void vTaskSuspendAll (void)
+{
+}
+
+signed portBASE_TYPE xTaskResumeAll (void)
+{
+	return pdFALSE;
+}
+
+void vApplicationMallocFailedHook (void)
+{
+	SIM_MallocFailed++;
+}
+
+int main (int argc, char **argv)
+{
+	uint32_t operations = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000000;
+	uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+	static const SIM_Heap heaps[] =
+	{
+		{"heap_2", SIM_Heap2Malloc, SIM_Heap2Free, SIM_Heap2Largest, SIM_Heap2Bytes},
+		{"tlsf", pvPortMalloc, vPortFree, SIM_KernelLargest, xPortGetFreeHeapSize},
+	};
+	SIM_Result result;
+	xHeapStatsType stats;
+	uint32_t i;
+
+	printf("# %u operations, %u byte heap, %u slots, seed %u\n", operations,
+			(unsigned)SIM_HEAP_SIZE, SIM_SLOTS, seed);
+	printf("heap,mean_ns,worst_malloc_ns,worst_free_ns,calls,failed,"
+			"mean_largest,min_largest,free_at_end,largest_at_end\n");
+	for(i = 0; i < sizeof(heaps) / sizeof(heaps[0]); i++)
+	{
+		SIM_Run(&heaps[i], operations, seed, &result);
+		SIM_Print(heaps[i].Name, &result);
+	}
+
+	vPortGetHeapStats(&stats);
+	printf("# tlsf: %u allocations, %u frees, minimum ever free %u, %u free blocks\n",
+			(unsigned)stats.xNumberOfSuccessfulAllocations, (unsigned)stats.xNumberOfSuccessfulFrees,
+			(unsigned)stats.xMinimumEverFreeBytesRemaining, (unsigned)stats.xNumberOfFreeBlocks);
+
+	return (stats.xNumberOfSuccessfulAllocations == stats.xNumberOfSuccessfulFrees
+			&& stats.xNumberOfFreeBlocks == 1) ? 0 : 1;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
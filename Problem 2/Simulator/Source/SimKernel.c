@@ -0,0 +1,777 @@
+/*****************************************************************************
+ *   SimKernel.c:  Runs the kernel and FreeRTOS+IO on the host POSIX port
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -DFREERTOS_POSIX_PORT -ISimulator/Include \
+ *          -ILibFreeRTOS/Include Simulator/Source/SimKernel.c \
+ *          Simulator/Source/FreeRTOS_PortPosix.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Tasks.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Queue.c \
+ *          LibFreeRTOS/Source/FreeRTOS_List.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Timers.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Heap.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Pool.c \
+ *          LibFreeRTOS/Source/FreeRTOS_StreamBuffer.c \
+ *          LibFreeRTOS/Source/FreeRTOS_TraceRecorder.c \
+ *          LibFreeRTOS/Source/FreeRTOS_IOUtils.c \
+ *          LibFreeRTOS/Source/FreeRTOS_IOUtilsCharQueueTxAndRx.c \
+ *          -lpthread -o kernel_sim
+ *
+ *          -> ./kernel_sim [host us per tick] [bytes]
+ *             0 us per tick follows the host clock, anything else runs on
+ *             virtual time. The default 1000 counts host work at host
+ *             speed and skips the idle time. Smaller numbers make the host
+ *             look slower, 10 is too slow to keep up with the UART. Prints
+ *             one CSV line per check and a summary on lines starting with
+ *             #, and exits 1 if any check failed.
+ *          -> Built with -DconfigUSE_TICKLESS_IDLE=0 the idle task spins
+ *             rather than sleeping, and on a single core host it then
+ *             starves the clock thread that raises the UART interrupts.
+ *             Run it with 20000 us per tick there.
+ *          -> The UART is a model of UART3 in loopback: 16 byte FIFOs, one
+ *             byte on the wire every SIM_BYTE_US. Its write, read and
+ *             interrupt handler are the character queue paths of
+ *             FreeRTOS_UART.c with the registers swapped for the model, so
+ *             the IOUtils macros and queues under them are the real ones.
+ *          -> Tasks only call printf() from inside a critical section, see
+ *             FreeRTOS_PortMacroPosix.h.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Semaphore.h"
+#include "FreeRTOS_Queue.h"
+
+#include "FreeRTOS_DriverInterface.h"
+#include "FreeRTOS_IOUtilsCommon.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_HOST_US_PER_TICK	1000		// Default, work at host speed and no waiting
+#define SIM_UART_BYTES			4096		// Default bytes through the loopback
+#define SIM_BYTE_US				87			// 10 bits at 115200 baud
+#define SIM_UART_FIFO			16
+#define SIM_UART_IRQ			1			// Simulated interrupt number
+#define SIM_QUEUE_LENGTH		64			// Character queues, as Main.c gives the console
+#define SIM_DELAY_PERIOD		10			// Ticks, for the delay check
+#define SIM_DELAY_COUNT			100
+#define SIM_DELAY_SLACK			5000		// us, ticks are taken a few late when the host is slow
+#define SIM_ROUND_TRIPS			20000		// Queue ping pong messages
+#define SIM_TIMEOUT_TICKS		2			// How long the lock check's first take waits
+
+#define SIM_CONTROL_PRIORITY	(tskIDLE_PRIORITY + 2)
+#define SIM_ECHO_PRIORITY		(tskIDLE_PRIORITY + 3)
+#define SIM_WRITER_PRIORITY		(tskIDLE_PRIORITY + 1)
+#define SIM_HOLDER_PRIORITY		(tskIDLE_PRIORITY + 1)
+#define SIM_PERIODIC_PRIORITY	(tskIDLE_PRIORITY + 4)
+#define SIM_PERIODIC_PERIOD		10			// Ticks
+#define SIM_PERIODIC_DEADLINE	8			// Ticks
+#define SIM_PERIODIC_BUDGET		2000		// us
+#define SIM_PERIODIC_COUNT		20			// Activations
+#define SIM_PERIODIC_OVERRUN	5			// Activation that runs for twice the budget
+#define SIM_PERIODIC_MISS		10			// Activation that sleeps past the deadline and the next release
+#define SIM_EDF_TASKS			3
+#define SIM_EDF_WRAP_LEAD		10			// Ticks before the wrap the second run is released
+#define SIM_EDF_WRAP_REACH		10000		// Most ticks it waits for the wrap
+
+// The registers of UART3 that the character queue paths use
+typedef struct
+{
+	uint8_t TxFifo[SIM_UART_FIFO];
+	uint8_t RxFifo[SIM_UART_FIFO];
+	uint32_t TxHead, TxCount;
+	uint32_t RxHead, RxCount;
+	uint8_t Shift;				// Byte on the wire
+	uint8_t Shifting;
+	uint64_t Done;				// Simulated time it's all out
+	uint32_t Overruns;
+} SIM_Uart;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static unsigned long SIM_HostUsPerTick = SIM_HOST_US_PER_TICK;
+static uint32_t SIM_Bytes = SIM_UART_BYTES;
+static uint32_t SIM_Checks = 0, SIM_Failures = 0;
+
+static SIM_Uart SIM_Uart3;
+static Peripheral_Control_t SIM_Port;
+static uint8_t *SIM_TxData, *SIM_RxData;
+
+static xQueueHandle SIM_Ping, SIM_Pong;
+#if configUSE_LOCK_PROFILER == 1
+static xSemaphoreHandle SIM_Lock;
+#endif
+#if configUSE_PERIODIC_TASKS == 1
+static xStaticTaskType SIM_PeriodicTaskBuffer;
+static portSTACK_TYPE SIM_PeriodicTaskStack[configMINIMAL_STACK_SIZE];
+static portTickType SIM_FirstRelease;
+static volatile uint32_t SIM_HookMisses = 0;
+#endif
+#if configUSE_EDF_SCHEDULER == 1
+// Period and deadline in ticks of each, made in this order and due in the reverse of it
+static const portTickType SIM_EdfTiming[SIM_EDF_TASKS][2] = {{40, 12}, {20, 20}, {10, 8}};
+static const uint8_t SIM_EdfExpected[SIM_EDF_TASKS] = {2, 0, 1};
+// One set per run, the idle task may not have cleaned up the first yet
+static xStaticTaskType SIM_EdfTaskBuffers[2][SIM_EDF_TASKS];
+static portSTACK_TYPE SIM_EdfTaskStacks[2][SIM_EDF_TASKS][configMINIMAL_STACK_SIZE];
+static volatile uint8_t SIM_EdfOrder[SIM_EDF_TASKS];
+static volatile uint8_t SIM_EdfRuns = 0;
+#endif
+
+static xStaticTaskType SIM_IdleTaskBuffer, SIM_TimerTaskBuffer;
+static portSTACK_TYPE SIM_IdleTaskStack[configMINIMAL_STACK_SIZE];
+static portSTACK_TYPE SIM_TimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+static uint64_t SIM_HostMicroseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+// printf() from a task, with the critical section the port needs round it
+static void SIM_Print (const char *format, ...)
+{
+	va_list args;
+
+	taskENTER_CRITICAL();
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	fflush(stdout);
+	taskEXIT_CRITICAL();
+}
+
+static void SIM_Check (const char *name, int passed, uint64_t simUs, uint64_t hostUs, const char *detail)
+{
+	SIM_Checks++;
+	if(!passed)
+	{
+		SIM_Failures++;
+	}
+	SIM_Print("%s,%s,%llu,%llu,%s\n", name, passed ? "pass" : "FAIL",
+			(unsigned long long)simUs, (unsigned long long)hostUs, detail);
+}
+
+/******************************************************************************
+ * UART model
+ *****************************************************************************/
+// Both empty, the driver's uartTX_BUSY_MASK test
+static uint8_t SIM_UartTxIdle (void)
+{
+	return (SIM_Uart3.TxCount == 0) && !SIM_Uart3.Shifting;
+}
+
+static uint8_t SIM_UartTxFifoFull (void)
+{
+	return SIM_Uart3.TxCount == SIM_UART_FIFO;
+}
+
+static uint8_t SIM_UartRxReady (void)
+{
+	return SIM_Uart3.RxCount != 0;
+}
+
+static uint8_t SIM_UartReadRBR (void)
+{
+	uint8_t c = SIM_Uart3.RxFifo[SIM_Uart3.RxHead];
+
+	SIM_Uart3.RxHead = (SIM_Uart3.RxHead + 1) % SIM_UART_FIFO;
+	SIM_Uart3.RxCount--;
+	return c;
+}
+
+// The next byte goes out straight after the last one, however late its
+// interrupt was taken, as the line doesn't wait for the handler
+static void SIM_UartNextByte (void)
+{
+	uint64_t now = ullPortGetSimulatedTime();
+
+	SIM_Uart3.Done += SIM_BYTE_US;
+	vPortScheduleSimulatedInterrupt(SIM_UART_IRQ, (SIM_Uart3.Done > now) ? (unsigned long)(SIM_Uart3.Done - now) : 0);
+}
+
+// A write to THR, from a task or the handler. A task has it in a critical
+// section, as a register write can't be interrupted half way.
+static void SIM_UartWriteTHR (uint8_t c)
+{
+	if(!SIM_Uart3.Shifting)
+	{
+		SIM_Uart3.Shift = c;
+		SIM_Uart3.Shifting = 1;
+		SIM_Uart3.Done = ullPortGetSimulatedTime() + SIM_BYTE_US;
+		vPortScheduleSimulatedInterrupt(SIM_UART_IRQ, SIM_BYTE_US);
+	}
+	else if(SIM_Uart3.TxCount < SIM_UART_FIFO)
+	{
+		SIM_Uart3.TxFifo[(SIM_Uart3.TxHead + SIM_Uart3.TxCount) % SIM_UART_FIFO] = c;
+		SIM_Uart3.TxCount++;
+	}
+}
+
+static void SIM_UartTaskWriteTHR (uint8_t c)
+{
+	taskENTER_CRITICAL();
+	SIM_UartWriteTHR(c);
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Description:
+ *    A byte has gone out. It comes straight back in, the next one starts,
+ *    then the same as UART3_IRQHandler() for character queues both ways.
+ *****************************************************************************/
+static void SIM_UartIRQHandler (void)
+{
+	uint32_t ulReceived = 0;
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	if(SIM_Uart3.Shifting)
+	{
+		if(SIM_Uart3.RxCount < SIM_UART_FIFO)
+		{
+			SIM_Uart3.RxFifo[(SIM_Uart3.RxHead + SIM_Uart3.RxCount) % SIM_UART_FIFO] = SIM_Uart3.Shift;
+			SIM_Uart3.RxCount++;
+		}
+		else
+		{
+			SIM_Uart3.Overruns++;
+		}
+		SIM_Uart3.Shifting = 0;
+
+		if(SIM_Uart3.TxCount != 0)
+		{
+			SIM_Uart3.Shift = SIM_Uart3.TxFifo[SIM_Uart3.TxHead];
+			SIM_Uart3.TxHead = (SIM_Uart3.TxHead + 1) % SIM_UART_FIFO;
+			SIM_Uart3.TxCount--;
+			SIM_Uart3.Shifting = 1;
+			SIM_UartNextByte();
+		}
+	}
+
+	ioutilsRX_CHARS_INTO_QUEUE_FROM_ISR(SIM_Port.pxRxControl, SIM_UartRxReady(), SIM_UartReadRBR(), ulReceived, xHigherPriorityTaskWoken);
+	ioutilsTX_CHARS_FROM_QUEUE_FROM_ISR(SIM_Port.pxTxControl, !SIM_UartTxFifoFull(), SIM_UartWriteTHR(ucChar), xHigherPriorityTaskWoken);
+
+	(void)ulReceived;
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+// FreeRTOS_UART_write() for ioctlUSE_CHARACTER_QUEUE_TX
+static size_t SIM_UartWrite (const void *pvBuffer, const size_t xBytes)
+{
+	size_t xReturn = 0U;
+	Peripheral_Control_t *pxPeripheralControl = &SIM_Port;
+
+	ioutilsBLOCKING_SEND_CHARS_TO_TX_QUEUE
+		(
+			pxPeripheralControl,
+			SIM_UartTxIdle(),
+			SIM_UartTaskWriteTHR(ucChar),
+			((uint8_t *)pvBuffer),
+			xBytes,
+			xReturn
+		);
+
+	return xReturn;
+}
+
+// FreeRTOS_UART_read() for ioctlUSE_CHARACTER_QUEUE_RX
+static size_t SIM_UartRead (void *pvBuffer, const size_t xBytes)
+{
+	return xIOUtilsReceiveCharsFromRxQueue(&SIM_Port, (uint8_t *)pvBuffer, xBytes);
+}
+
+/******************************************************************************
+ * Tasks
+ *****************************************************************************/
+static void SIM_EchoTask (void *pvParameters)
+{
+	uint32_t value;
+
+	(void)pvParameters;
+
+	for(;;)
+	{
+		xQueueReceive(SIM_Ping, &value, portMAX_DELAY);
+		value++;
+		xQueueSend(SIM_Pong, &value, portMAX_DELAY);
+	}
+}
+
+static void SIM_WriterTask (void *pvParameters)
+{
+	uint32_t sent = 0;
+
+	(void)pvParameters;
+
+	// Uneven chunks, so the Tx queue fills and empties at odd points
+	while(sent < SIM_Bytes)
+	{
+		uint32_t chunk = 1 + (sent * 7) % 97;
+
+		if(chunk > SIM_Bytes - sent)
+		{
+			chunk = SIM_Bytes - sent;
+		}
+		sent += SIM_UartWrite(&SIM_TxData[sent], chunk);
+	}
+
+	vTaskDelete(NULL);
+}
+
+#if configUSE_LOCK_PROFILER == 1
+// SIM_Lock's figures, or NULL if it hasn't got any
+static xLockProfileType *SIM_LockProfile (void)
+{
+	static xLockProfileType profiles[configLOCK_PROFILER_SIZE];
+	unsigned portBASE_TYPE count, i;
+
+	count = uxQueueGetLockProfile(profiles, configLOCK_PROFILER_SIZE, NULL);
+	for(i = 0; i < count; i++)
+	{
+		if(profiles[i].pvLock == (void *)SIM_Lock)
+		{
+			return &profiles[i];
+		}
+	}
+
+	return NULL;
+}
+
+// Holds SIM_Lock from below the control task until it has waited for it twice
+static void SIM_HolderTask (void *pvParameters)
+{
+	xLockProfileType *lock;
+
+	(void)pvParameters;
+
+	xSemaphoreTake(SIM_Lock, portMAX_DELAY);
+	do
+	{
+		vTaskDelay(1);
+		lock = SIM_LockProfile();
+	} while(lock != NULL && lock->ulContentions < 2);
+	xSemaphoreGive(SIM_Lock);
+
+	vTaskDelete(NULL);
+}
+
+/******************************************************************************
+ * Description:
+ *    A lower priority task holds a mutex while the control task first times
+ *    out on it and then waits for it. The profile should have both takes,
+ *    both waits, the timeout, and one inversion: the holder has the control
+ *    task's priority by the second wait. Nothing depends on when the ticks
+ *    land, which they don't always do one at a time on a busy host.
+ *****************************************************************************/
+static void SIM_LockCheck (void)
+{
+	xLockProfileType *lock;
+	xTaskHandle holder;
+	char detail[96];
+	uint64_t sim, host;
+	int passed;
+
+	SIM_Lock = xSemaphoreCreateMutex();
+	host = SIM_HostMicroseconds();
+	sim = ullPortGetSimulatedTime();
+	xTaskCreate(SIM_HolderTask, (signed char *)"Holder", configMINIMAL_STACK_SIZE, NULL, SIM_HOLDER_PRIORITY, &holder);
+	while(xSemaphoreGetMutexHolder(SIM_Lock) != holder)
+	{
+		vTaskDelay(1);
+	}
+	xSemaphoreTake(SIM_Lock, SIM_TIMEOUT_TICKS);
+	xSemaphoreTake(SIM_Lock, portMAX_DELAY);
+	xSemaphoreGive(SIM_Lock);
+	sim = ullPortGetSimulatedTime() - sim;
+	host = SIM_HostMicroseconds() - host;
+
+	lock = SIM_LockProfile();
+	passed = (lock != NULL);
+	if(passed)
+	{
+		sprintf(detail, "%lu takes %lu waits %lu timeouts %lu inversions %lu/%lu us wait/hold", lock->ulTakes,
+				lock->ulContentions, lock->ulTimeouts, lock->ulInversions, lock->ulWaitMax, lock->ulHoldMax);
+		passed = (lock->ulTakes == 2) && (lock->ulContentions == 2) && (lock->ulTimeouts == 1)
+				&& (lock->ulInversions == 1) && (lock->pvLongestHolder == (void *)holder)
+				&& (lock->ulWaitMax > 0) && (lock->ulHoldMax >= lock->ulWaitMax);
+	}
+	else
+	{
+		sprintf(detail, "no profile for the mutex");
+	}
+	SIM_Check("lock", passed, sim, host, detail);
+
+	vQueueDelete(SIM_Lock);
+}
+#endif
+
+#if configUSE_PERIODIC_TASKS == 1
+// SIM_PERIODIC_COUNT activations, one over budget and one past its deadline
+static void SIM_PeriodicTask (void *pvParameters)
+{
+	xPeriodicTaskType timing;
+	uint64_t until;
+	uint32_t i;
+
+	(void)pvParameters;
+
+	xTaskGetPeriodicStatus(NULL, &timing);
+	SIM_FirstRelease = timing.xRelease;
+
+	for(i = 0; i < SIM_PERIODIC_COUNT; i++)
+	{
+		if(i == SIM_PERIODIC_OVERRUN)
+		{
+			until = ullPortGetSimulatedTime() + SIM_PERIODIC_BUDGET * 2;
+			while(ullPortGetSimulatedTime() < until);
+		}
+		else if(i == SIM_PERIODIC_MISS)
+		{
+			// Blocked, so late but not over budget
+			vTaskDelay(SIM_PERIODIC_PERIOD + 2);
+		}
+		vTaskWaitForNextPeriod();
+	}
+
+	vTaskSuspend(NULL);
+}
+
+/******************************************************************************
+ * Description:
+ *    A periodic task above the control task runs SIM_PERIODIC_COUNT
+ *    activations. The one that spins for twice its budget should be the
+ *    only overrun, the one that sleeps through its deadline and on past
+ *    the next release the only miss, and the one after that should start
+ *    straight away so the releases stay a whole number of periods apart.
+ *****************************************************************************/
+static void SIM_PeriodicCheck (void)
+{
+	xPeriodicTaskType timing;
+	xTaskHandle task;
+	char detail[128];
+	uint64_t sim, host;
+	int passed;
+
+	host = SIM_HostMicroseconds();
+	sim = ullPortGetSimulatedTime();
+	task = xTaskCreatePeriodicStatic(SIM_PeriodicTask, (signed char *)"Periodic", configMINIMAL_STACK_SIZE, NULL,
+			SIM_PERIODIC_PRIORITY, SIM_PeriodicTaskStack, &SIM_PeriodicTaskBuffer,
+			SIM_PERIODIC_PERIOD, SIM_PERIODIC_DEADLINE, SIM_PERIODIC_BUDGET);
+	do
+	{
+		vTaskDelay(SIM_PERIODIC_PERIOD);
+		xTaskGetPeriodicStatus(task, &timing);
+	} while(timing.ulActivations < SIM_PERIODIC_COUNT);
+	sim = ullPortGetSimulatedTime() - sim;
+	host = SIM_HostMicroseconds() - host;
+	vTaskDelete(task);
+
+	sprintf(detail, "%lu activations %lu misses %lu overruns %lu/%lu us exec mean/max %lu us jitter max",
+			timing.ulActivations, timing.ulDeadlineMisses, timing.ulBudgetOverruns,
+			timing.ulExecutionTotal / timing.ulActivations, timing.ulExecutionMax, timing.ulJitterMax);
+	passed = (timing.ulActivations == SIM_PERIODIC_COUNT) && (timing.ulDeadlineMisses == 1)
+			&& (timing.ulBudgetOverruns == 1) && (timing.ulExecutionMax >= SIM_PERIODIC_BUDGET * 2)
+			&& (timing.xRelease - SIM_FirstRelease == SIM_PERIODIC_PERIOD * SIM_PERIODIC_COUNT)
+			&& (timing.ulJitterMax < SIM_PERIODIC_PERIOD * portTICK_RATE_MS * 1000);
+#if configUSE_DEADLINE_MISSED_HOOK == 1
+	passed = passed && (SIM_HookMisses == timing.ulDeadlineMisses);
+#endif
+	SIM_Check("periodic", passed, sim, host, detail);
+}
+#endif
+
+#if configUSE_EDF_SCHEDULER == 1
+// Notes when its first activation got to run
+static void SIM_EdfTask (void *pvParameters)
+{
+	SIM_EdfOrder[SIM_EdfRuns++] = (uint8_t)(uintptr_t)pvParameters;
+	vTaskSuspend(NULL);
+}
+
+/******************************************************************************
+ * Description:
+ *    Three periodic tasks at configEDF_PRIORITY, released together, have
+ *    to run earliest deadline first rather than in the order they were
+ *    made or by period. The control task is above them until all three
+ *    exist.
+ *****************************************************************************/
+static void SIM_EdfRun (const char *name, uint8_t run)
+{
+	xTaskHandle tasks[SIM_EDF_TASKS];
+	char detail[64];
+	uint64_t sim, host;
+	uint8_t i;
+	int passed;
+
+	host = SIM_HostMicroseconds();
+	sim = ullPortGetSimulatedTime();
+	SIM_EdfRuns = 0;
+	vTaskPrioritySet(NULL, configMAX_PRIORITIES - 1);
+	for(i = 0; i < SIM_EDF_TASKS; i++)
+	{
+		tasks[i] = xTaskCreatePeriodicStatic(SIM_EdfTask, (signed char *)"Edf", configMINIMAL_STACK_SIZE,
+				(void *)(uintptr_t)i, configEDF_PRIORITY, SIM_EdfTaskStacks[run][i], &SIM_EdfTaskBuffers[run][i],
+				SIM_EdfTiming[i][0], SIM_EdfTiming[i][1], 0);
+	}
+	vTaskPrioritySet(NULL, SIM_CONTROL_PRIORITY);
+
+	while(SIM_EdfRuns < SIM_EDF_TASKS)
+	{
+		vTaskDelay(1);
+	}
+	sim = ullPortGetSimulatedTime() - sim;
+	host = SIM_HostMicroseconds() - host;
+	for(i = 0; i < SIM_EDF_TASKS; i++)
+	{
+		vTaskDelete(tasks[i]);
+	}
+
+	passed = 1;
+	for(i = 0; i < SIM_EDF_TASKS; i++)
+	{
+		passed = passed && (SIM_EdfOrder[i] == SIM_EdfExpected[i]);
+	}
+	sprintf(detail, "ran %u %u %u expected %u %u %u", SIM_EdfOrder[0], SIM_EdfOrder[1], SIM_EdfOrder[2],
+			SIM_EdfExpected[0], SIM_EdfExpected[1], SIM_EdfExpected[2]);
+	SIM_Check(name, passed, sim, host, detail);
+}
+
+/******************************************************************************
+ * Description:
+ *    The EDF run, then again released SIM_EDF_WRAP_LEAD ticks before the
+ *    tick count wraps, so the earliest deadline is just before the wrap
+ *    and the other two just after. The host config starts the tick count
+ *    close enough to the wrap for that, see configINITIAL_TICK_COUNT.
+ *****************************************************************************/
+static void SIM_EdfCheck (void)
+{
+	portTickType release, lead;
+
+	SIM_EdfRun("edf", 0);
+
+	release = xTaskGetTickCount();
+	lead = (portTickType)(0U - release);
+	if(lead > SIM_EDF_WRAP_LEAD && lead <= SIM_EDF_WRAP_REACH)
+	{
+		vTaskDelayUntil(&release, lead - SIM_EDF_WRAP_LEAD);
+		SIM_EdfRun("edf_wrap", 1);
+	}
+	else
+	{
+		SIM_Print("# edf_wrap skipped, the tick count is %lu ticks from the wrap\n", (unsigned long)lead);
+	}
+}
+#endif
+
+/******************************************************************************
+ * Description:
+ *    Each check in turn, then the summary, then ends the scheduler so
+ *    main() can return the result.
+ *****************************************************************************/
+static void SIM_ControlTask (void *pvParameters)
+{
+	char detail[96];
+	uint64_t sim, host, expect;
+	portTickType start, last;
+#if configUSE_TICKLESS_IDLE == 1
+	unsigned long tickInterrupts, suppressedTicks;
+#endif
+	uint32_t i, value, good;
+	size_t received;
+
+	(void)pvParameters;
+
+	SIM_Print("check,result,sim_us,host_us,detail\n");
+
+	// Periodic delays land on exact ticks, and on time
+	host = SIM_HostMicroseconds();
+	vTaskDelay(SIM_DELAY_PERIOD);		// Start on a tick, once the start up has settled
+	sim = ullPortGetSimulatedTime();
+	start = last = xTaskGetTickCount();
+	for(i = 0; i < SIM_DELAY_COUNT; i++)
+	{
+		vTaskDelayUntil(&last, SIM_DELAY_PERIOD);
+	}
+	sim = ullPortGetSimulatedTime() - sim;
+	host = SIM_HostMicroseconds() - host;
+	expect = (uint64_t)SIM_DELAY_PERIOD * SIM_DELAY_COUNT * portTICK_RATE_MS * 1000;
+	sprintf(detail, "%lu ticks for %u", (unsigned long)(xTaskGetTickCount() - start), SIM_DELAY_PERIOD * SIM_DELAY_COUNT);
+	SIM_Check("delay", (xTaskGetTickCount() - start == SIM_DELAY_PERIOD * SIM_DELAY_COUNT)
+			&& (sim + SIM_DELAY_SLACK >= expect) && (sim <= expect + SIM_DELAY_SLACK), sim, host, detail);
+
+	// Queue round trips to a higher priority task, two switches each
+	host = SIM_HostMicroseconds();
+	sim = ullPortGetSimulatedTime();
+	for(i = 0, good = 0; i < SIM_ROUND_TRIPS; i++)
+	{
+		xQueueSend(SIM_Ping, &i, portMAX_DELAY);
+		xQueueReceive(SIM_Pong, &value, portMAX_DELAY);
+		good += (value == i + 1);
+	}
+	sim = ullPortGetSimulatedTime() - sim;
+	host = SIM_HostMicroseconds() - host;
+	sprintf(detail, "%u trips %.2f us each on the host", SIM_ROUND_TRIPS, (double)host / SIM_ROUND_TRIPS);
+	SIM_Check("queue", good == SIM_ROUND_TRIPS, sim, host, detail);
+
+#if configUSE_LOCK_PROFILER == 1
+	// Waits, holds and inversions on a contended mutex
+	SIM_LockCheck();
+#endif
+
+#if configUSE_PERIODIC_TASKS == 1
+	// Jitter, execution time, overruns and misses of a periodic task
+	SIM_PeriodicCheck();
+#endif
+
+#if configUSE_EDF_SCHEDULER == 1
+	// Ready tasks at the EDF priority in deadline order
+	SIM_EdfCheck();
+#endif
+
+	// UART loopback through the character queues
+	for(i = 0; i < SIM_Bytes; i++)
+	{
+		SIM_TxData[i] = (uint8_t)(i * 7 + 3);
+		SIM_RxData[i] = 0;
+	}
+	// The timeout is for the whole read, so twice the time on the wire
+	vIOUtilsSetRxQueueTimeout(&SIM_Port, (portTickType)(((uint64_t)SIM_Bytes * SIM_BYTE_US * 2) / (1000 * portTICK_RATE_MS) + 100));
+	host = SIM_HostMicroseconds();
+	sim = ullPortGetSimulatedTime();
+	xTaskCreate(SIM_WriterTask, (signed char *)"Writer", configMINIMAL_STACK_SIZE, NULL, SIM_WRITER_PRIORITY, NULL);
+	received = SIM_UartRead(SIM_RxData, SIM_Bytes);
+	sim = ullPortGetSimulatedTime() - sim;
+	host = SIM_HostMicroseconds() - host;
+	for(i = 0, good = 0; i < received; i++)
+	{
+		good += (SIM_RxData[i] == SIM_TxData[i]);
+	}
+	expect = (uint64_t)SIM_Bytes * SIM_BYTE_US;
+	sprintf(detail, "%lu of %lu bytes %lu overruns %.0f bytes/s", (unsigned long)good, (unsigned long)SIM_Bytes,
+			(unsigned long)SIM_Uart3.Overruns, sim ? (double)received * 1e6 / sim : 0.0);
+	// Never faster than the line, and at least half of it unless the host is swamped
+	SIM_Check("uart", (good == SIM_Bytes) && (SIM_Uart3.Overruns == 0)
+			&& (sim >= expect) && (sim <= expect * 2), sim, host, detail);
+
+#if configUSE_TICKLESS_IDLE == 1
+	// The idle task slept through the waits above instead of taking ticks
+	vPortGetTickStats(&tickInterrupts, &suppressedTicks);
+	sprintf(detail, "%lu tick interrupts %lu slept", tickInterrupts, suppressedTicks);
+	SIM_Check("tickless", suppressedTicks > 0, ullPortGetSimulatedTime(), 0, detail);
+#endif
+
+	SIM_Print("# %lu of %lu checks passed, %lu host us per tick, %llu simulated us\n",
+			(unsigned long)(SIM_Checks - SIM_Failures), (unsigned long)SIM_Checks,
+			SIM_HostUsPerTick, ullPortGetSimulatedTime());
+
+	vTaskEndScheduler();
+}
+
+
+/******************************************************************************
+ * Kernel hooks
+ *****************************************************************************/
+void vApplicationGetIdleTaskMemory(xStaticTaskType **ppxIdleTaskTCBBuffer, portSTACK_TYPE **ppxIdleTaskStackBuffer, unsigned short *pusIdleTaskStackSize)
+{
+	*ppxIdleTaskTCBBuffer = &SIM_IdleTaskBuffer;
+	*ppxIdleTaskStackBuffer = SIM_IdleTaskStack;
+	*pusIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(xStaticTaskType **ppxTimerTaskTCBBuffer, portSTACK_TYPE **ppxTimerTaskStackBuffer, unsigned short *pusTimerTaskStackSize)
+{
+	*ppxTimerTaskTCBBuffer = &SIM_TimerTaskBuffer;
+	*ppxTimerTaskStackBuffer = SIM_TimerTaskStack;
+	*pusTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+void vApplicationStackOverflowHook(xTaskHandle pxTask, signed char *pcTaskName)
+{
+	(void)pxTask;
+	fprintf(stderr, "stack overflow in %s\n", (const char *)pcTaskName);
+	abort();
+}
+
+void vApplicationMallocFailedHook(void)
+{
+	fprintf(stderr, "pvPortMalloc() failed\n");
+	abort();
+}
+
+#if configUSE_DEADLINE_MISSED_HOOK == 1
+void vApplicationDeadlineMissedHook(xTaskHandle xTask, signed char *pcTaskName)
+{
+	(void)xTask;
+	(void)pcTaskName;
+	SIM_HookMisses++;
+}
+#endif
+
+
+/******************************************************************************
+ * Main
+ *****************************************************************************/
+int main (int argc, char *argv[])
+{
+	if(argc > 1) SIM_HostUsPerTick = strtoul(argv[1], NULL, 0);
+	if(argc > 2) SIM_Bytes = strtoul(argv[2], NULL, 0);
+
+	SIM_TxData = malloc(SIM_Bytes);
+	SIM_RxData = malloc(SIM_Bytes);
+	if(SIM_TxData == NULL || SIM_RxData == NULL)
+	{
+		fprintf(stderr, "no memory for %lu bytes\n", (unsigned long)SIM_Bytes);
+		return 1;
+	}
+
+	if(SIM_HostUsPerTick != 0)
+	{
+		vPortUseVirtualTime(SIM_HostUsPerTick);
+	}
+
+	// What FreeRTOS_open() and the two ioctl()s would leave for UART3
+	if(xIOUtilsConfigureTransferQueue(&SIM_Port, ioctlUSE_CHARACTER_QUEUE_TX, SIM_QUEUE_LENGTH) != pdPASS
+			|| xIOUtilsConfigureTransferQueue(&SIM_Port, ioctlUSE_CHARACTER_QUEUE_RX, SIM_QUEUE_LENGTH) != pdPASS)
+	{
+		fprintf(stderr, "could not create the character queues\n");
+		return 1;
+	}
+	vPortSetInterruptHandler(SIM_UART_IRQ, SIM_UartIRQHandler);
+
+	SIM_Ping = xQueueCreate(1, sizeof(uint32_t));
+	SIM_Pong = xQueueCreate(1, sizeof(uint32_t));
+
+	xTaskCreate(SIM_ControlTask, (signed char *)"Control", configMINIMAL_STACK_SIZE, NULL, SIM_CONTROL_PRIORITY, NULL);
+	xTaskCreate(SIM_EchoTask, (signed char *)"Echo", configMINIMAL_STACK_SIZE, NULL, SIM_ECHO_PRIORITY, NULL);
+
+	// Returns when SIM_ControlTask() ends the scheduler
+	vTaskStartScheduler();
+
+	return SIM_Failures ? 1 : 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
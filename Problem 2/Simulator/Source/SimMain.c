@@ -0,0 +1,175 @@
+/*****************************************************************************
+ *   SimMain.c:  Runs the WEEE navigation against the chassis model
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -ISimulator/Include -IProject/Include \
+ *          -ILibLPC17xx/Include -ILibCMSIS/Include \
+ *          Simulator/Source/SimChassis.c Simulator/Source/SimMain.c \
+ *          Project/Source/dfrobot.c Project/Source/Navigation.c \
+ *          Project/Source/Planner.c Project/Source/Mapping.c \
+ *          LibLPC17xx/Source/LPC17xx_PinSelect.c \
+ *          LibLPC17xx/Source/LPC17xx_ADC.c \
+ *          LibLPC17xx/Source/LPC17xx_GPDMA.c -lm -o chassis_sim
+ *
+ *          -> ./chassis_sim [runs] [seed] [slip] [noise]
+ *             Every run picks a random destination and random motor
+ *             mismatch, steps NAV_Step() every 50 virtual ms like
+ *             WEEEOutputTask and prints one CSV line. The summary at the
+ *             end is on lines starting with #.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "LPC17xx.h"
+#include "dfrobot.h"
+#include "Navigation.h"
+#include "SimChassis.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_NAV_PERIOD_MS	50			// WEEEOutputTask period
+#define SIM_RUN_LIMIT_MS	120000		// Give up on a run after this long
+#define SIM_GRID_TICKS		5			// Encoder counts per grid square
+#define SIM_GRID_RANGE		4			// Destinations are within +/- this
+#define SIM_PI				3.14159265358979323846
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Description:
+ *    Nanoseconds from the host monotonic clock
+ *****************************************************************************/
+static uint64_t SIM_Nanoseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/******************************************************************************
+ * Description:
+ *    Put the driver state that survives DFR_RobotInit() back to how it is
+ *    after main() on the target: wheel counts clear, gear 3.
+ *****************************************************************************/
+static void SIM_RobotInit (void)
+{
+	DFR_RobotInit();
+	DFR_ClearWheelCounts();
+	DFR_DecGear();
+	DFR_DecGear();
+	DFR_DecGear();
+	DFR_IncGear();
+	DFR_IncGear();
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+int main (int argc, char **argv)
+{
+	SIM_Params params;
+	uint32_t runs = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+	uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+	double slip = (argc > 3) ? atof(argv[3]) : 0.02;
+	double noise = (argc > 4) ? atof(argv[4]) : 0.05;
+	double x, y, heading, grid, error, headingError;
+	double errorSum = 0, errorMax = 0, headingMax = 0;
+	uint64_t start, stepStart, stepTime, stepMax = 0, stepSum = 0, steps = 0;
+	uint64_t virtualMs = 0;
+	uint32_t run, failed = 0;
+	uint8_t started, wasIdle;
+
+	start = SIM_Nanoseconds();
+	printf("run,dx,dy,x_mm,y_mm,heading_deg,error_mm,time_ms\n");
+
+	for(run = 0; run < runs; run++)
+	{
+		// Each run gets its own seed so any line can be replayed alone
+		SIM_DefaultParams(&params);
+		SIM_Reset(&params, seed + run * 7919);
+		params.Slip = slip * (SIM_Random() % 1000) / 1000.0;
+		params.SpeedNoise = noise;
+		params.LeftGain = 1.0 + 0.05 * ((int32_t)(SIM_Random() % 2001) - 1000) / 1000.0;
+		params.RightGain = 1.0 + 0.05 * ((int32_t)(SIM_Random() % 2001) - 1000) / 1000.0;
+		SIM_Reset(&params, seed + run * 7919);
+
+		SIM_RobotInit();
+		NAV_Reset();
+		dx = (int)(SIM_Random() % (2 * SIM_GRID_RANGE + 1)) - SIM_GRID_RANGE;
+		dy = (int)(SIM_Random() % (2 * SIM_GRID_RANGE + 1)) - SIM_GRID_RANGE;
+		centrePressed = 1;
+		started = 0;
+
+		while(SIM_GetTime() < SIM_RUN_LIMIT_MS)
+		{
+			// The step after the move finishes is the one that stops the motors
+			wasIdle = NAV_IsIdle();
+
+			stepStart = SIM_Nanoseconds();
+			NAV_Step();
+			stepTime = SIM_Nanoseconds() - stepStart;
+			stepSum += stepTime;
+			if(stepTime > stepMax) stepMax = stepTime;
+			steps++;
+
+			if(!NAV_IsIdle())
+			{
+				started = 1;
+			}
+			else if(started && wasIdle)
+			{
+				break;
+			}
+
+			SIM_Step(SIM_NAV_PERIOD_MS);
+		}
+
+		// Let it coast to a stop before measuring
+		SIM_Step(500);
+		virtualMs += SIM_GetTime();
+
+		SIM_GetPose(&x, &y, &heading);
+		grid = SIM_GRID_TICKS * params.TickMm;
+		error = hypot(x - dx * grid, y - dy * grid);
+		headingError = fabs(remainder(heading, 2 * SIM_PI)) * 180.0 / SIM_PI;
+
+		if(SIM_GetTime() >= SIM_RUN_LIMIT_MS) failed++;
+		errorSum += error;
+		if(error > errorMax) errorMax = error;
+		if(headingError > headingMax) headingMax = headingError;
+
+		printf("%u,%d,%d,%.1f,%.1f,%.1f,%.1f,%u\n", run, dx, dy, x, y,
+				heading * 180.0 / SIM_PI, error, SIM_GetTime());
+	}
+
+	printf("# runs %u, timed out %u\n", runs, failed);
+	printf("# position error mm: mean %.1f, max %.1f\n",
+			runs ? errorSum / runs : 0.0, errorMax);
+	printf("# heading error deg: max %.1f\n", headingMax);
+	printf("# NAV_Step ns: mean %.0f, max %llu\n",
+			steps ? (double)stepSum / steps : 0.0, (unsigned long long)stepMax);
+	printf("# virtual %.1f s in %.3f s wall\n", virtualMs / 1000.0,
+			(SIM_Nanoseconds() - start) / 1e9);
+
+	return failed ? 1 : 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
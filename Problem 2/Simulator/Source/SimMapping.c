@@ -0,0 +1,355 @@
+/*****************************************************************************
+ *   SimMapping.c:  Replays a range finder log through the occupancy grid
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -IProject/Include \
+ *          Simulator/Source/SimMapping.c Project/Source/Mapping.c \
+ *          -lm -o mapping_sim
+ *
+ *          -> ./mapping_sim [seconds] [seed] [map.pgm]
+ *             Drives a robot round a room with a few boxes in it, turning
+ *             away whenever the range finder sees something close, and
+ *             logs the encoder totals and range every 20ms like RangeTask.
+ *             The log is then replayed through MAP_Odometry() and
+ *             MAP_Update() to time them. The grid is checked against the
+ *             room and optionally written out as a PGM, decoded from the
+ *             MAP_Export() stream so the export format gets checked too.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dfrobot.h"
+#include "Mapping.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_PERIOD_MS		20			// RangeTask
+#define SIM_SPEED_MM		200			// Forward speed
+#define SIM_SPIN_RAD		1.5			// Turning speed
+#define SIM_TURN_AT_MM		300			// Turn away from anything this close
+#define SIM_RANGE_NOISE_MM	15
+#define SIM_SENSOR_MM		60
+#define SIM_REPLAY_NS		500000000ULL	// Keep replaying for this long
+#define SIM_EXPORT_MAX		(sizeof(MAP_Header) + MAP_GRID_SIZE * MAP_GRID_SIZE / 2 + 2)
+#define SIM_PI				3.14159265358979323846
+
+typedef struct
+{
+	double X0, Y0, X1, Y1;
+} SIM_Box;
+
+typedef struct
+{
+	int32_t Right;
+	int32_t Left;
+	uint16_t Range;
+} SIM_Entry;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+// Room walls and the boxes in it, mm
+static const SIM_Box SIM_World[] =
+{
+	{-1550, -950, -1500, 1550},
+	{ 1500, -950,  1550, 1550},
+	{-1550, -950,  1550, -900},
+	{-1550, 1500,  1550, 1550},
+	{ -800,  600,  -500,  900},
+	{  400, -300,   700,    0},
+	{  900,  800,  1200, 1100},
+};
+#define SIM_BOXES	(sizeof(SIM_World) / sizeof(SIM_World[0]))
+
+static uint32_t SIM_Seed;
+static uint8_t SIM_Export[SIM_EXPORT_MAX];
+static uint32_t SIM_ExportLength;
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+static uint32_t SIM_Random (void)
+{
+	SIM_Seed = SIM_Seed * 1103515245UL + 12345UL;
+	return (SIM_Seed >> 8) & 0xFFFFFF;
+}
+
+static double SIM_Gaussian (void)
+{
+	double u = (SIM_Random() + 1.0) / 16777218.0;
+	double v = (SIM_Random() + 1.0) / 16777218.0;
+
+	return sqrt(-2.0 * log(u)) * cos(2.0 * SIM_PI * v);
+}
+
+static uint64_t SIM_Nanoseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/******************************************************************************
+ * Description:
+ *    Distance along a ray to the nearest box, slab test on each one
+ *****************************************************************************/
+static double SIM_Cast (double x, double y, double dirX, double dirY)
+{
+	double best = 1e9, near, far, t0, t1, swap;
+	uint32_t i;
+
+	for(i = 0; i < SIM_BOXES; i++)
+	{
+		near = -1e9;
+		far = 1e9;
+		if(fabs(dirX) < 1e-12)
+		{
+			if(x < SIM_World[i].X0 || x > SIM_World[i].X1) continue;
+		}
+		else
+		{
+			t0 = (SIM_World[i].X0 - x) / dirX;
+			t1 = (SIM_World[i].X1 - x) / dirX;
+			if(t0 > t1) { swap = t0; t0 = t1; t1 = swap; }
+			if(t0 > near) near = t0;
+			if(t1 < far) far = t1;
+		}
+		if(fabs(dirY) < 1e-12)
+		{
+			if(y < SIM_World[i].Y0 || y > SIM_World[i].Y1) continue;
+		}
+		else
+		{
+			t0 = (SIM_World[i].Y0 - y) / dirY;
+			t1 = (SIM_World[i].Y1 - y) / dirY;
+			if(t0 > t1) { swap = t0; t0 = t1; t1 = swap; }
+			if(t0 > near) near = t0;
+			if(t1 < far) far = t1;
+		}
+		if(near <= far && far >= 0)
+		{
+			if(near < 0) near = 0;
+			if(near < best) best = near;
+		}
+	}
+	return best;
+}
+
+/******************************************************************************
+ * Description:
+ *    Does a map cell overlap any box
+ *****************************************************************************/
+static uint8_t SIM_Occupied (int x, int y)
+{
+	double half = MAP_CELL_UM / 2000.0;
+	double cx = x * MAP_CELL_UM / 1000.0;
+	double cy = y * MAP_CELL_UM / 1000.0;
+	uint32_t i;
+
+	for(i = 0; i < SIM_BOXES; i++)
+	{
+		if(cx + half > SIM_World[i].X0 && cx - half < SIM_World[i].X1
+				&& cy + half > SIM_World[i].Y0 && cy - half < SIM_World[i].Y1)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/******************************************************************************
+ * Description:
+ *    Drive round the room and log what RangeTask would have seen
+ *****************************************************************************/
+static uint32_t SIM_Record (SIM_Entry *log, uint32_t entries)
+{
+	double x = 0, y = 0, heading = 0, right = 0, left = 0, range, sx, sy;
+	double turnLeft = 0, v, omega, tick = DFR_TICK_UM / 1000.0;
+	uint32_t n;
+
+	for(n = 0; n < entries; n++)
+	{
+		// Range finder, clamped like the lookup table does
+		sx = x - SIM_SENSOR_MM * sin(heading);
+		sy = y + SIM_SENSOR_MM * cos(heading);
+		range = SIM_Cast(sx, sy, -sin(heading), cos(heading)) + SIM_RANGE_NOISE_MM * SIM_Gaussian();
+		if(range < 80) range = 80;
+		if(range > 800) range = 800;
+
+		log[n].Right = (int32_t)floor(right / tick);
+		log[n].Left = (int32_t)floor(left / tick);
+		log[n].Range = (uint16_t)range;
+
+		// Drive until something is close, then spin away a random amount
+		if(turnLeft <= 0 && range < SIM_TURN_AT_MM)
+		{
+			turnLeft = (0.5 + (SIM_Random() % 1000) / 400.0);
+		}
+		if(turnLeft > 0)
+		{
+			v = 0;
+			omega = SIM_SPIN_RAD;
+			turnLeft -= omega * SIM_PERIOD_MS / 1000.0;
+		}
+		else
+		{
+			v = SIM_SPEED_MM;
+			omega = 0;
+		}
+
+		right += (v + omega * DFR_TRACK_MM / 2) * SIM_PERIOD_MS / 1000.0;
+		left += (v - omega * DFR_TRACK_MM / 2) * SIM_PERIOD_MS / 1000.0;
+		heading += omega * SIM_PERIOD_MS / 1000.0;
+		x -= v * sin(heading) * SIM_PERIOD_MS / 1000.0;
+		y += v * cos(heading) * SIM_PERIOD_MS / 1000.0;
+	}
+	return n;
+}
+
+static void SIM_Write (const uint8_t *data, uint32_t length)
+{
+	if(SIM_ExportLength + length <= SIM_EXPORT_MAX)
+	{
+		memcpy(&SIM_Export[SIM_ExportLength], data, length);
+	}
+	SIM_ExportLength += length;
+}
+
+/******************************************************************************
+ * Description:
+ *    Decode an export frame into a PGM, lowest y at the bottom. Unknown is
+ *    mid grey, free white, occupied black. Returns 0 if the frame is bad.
+ *****************************************************************************/
+static uint8_t SIM_WritePGM (const char *name)
+{
+	MAP_Header header;
+	uint16_t sum = 0;
+	uint32_t i, size;
+	int x, y;
+	uint8_t cell;
+	FILE *file;
+
+	if(SIM_ExportLength < sizeof(header) + 2) return 0;
+	for(i = 0; i < SIM_ExportLength - 2; i++)
+	{
+		sum += SIM_Export[i];
+	}
+	memcpy(&header, SIM_Export, sizeof(header));
+	size = header.Size;
+	if(memcmp(header.Magic, "OGM1", 4) != 0
+			|| SIM_ExportLength != sizeof(header) + size * size / 2 + 2
+			|| SIM_Export[SIM_ExportLength - 2] != (sum & 0xFF)
+			|| SIM_Export[SIM_ExportLength - 1] != (sum >> 8))
+	{
+		return 0;
+	}
+
+	file = fopen(name, "wb");
+	if(file == NULL) return 0;
+	fprintf(file, "P5\n%u %u\n255\n", size, size);
+	for(y = size - 1; y >= 0; y--)
+	{
+		for(x = 0; x < (int)size; x++)
+		{
+			cell = SIM_Export[sizeof(header) + (y * size + x) / 2] >> ((x & 1) ? 4 : 0) & 0x0F;
+			fputc(255 - cell * 17, file);
+		}
+	}
+	fclose(file);
+	return 1;
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+int main (int argc, char **argv)
+{
+	uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 120;
+	uint32_t entries = seconds * 1000 / SIM_PERIOD_MS;
+	SIM_Entry *log = malloc(entries * sizeof(SIM_Entry));
+	uint32_t i, passes = 0, occupied = 0, occupiedRight = 0, clear = 0, clearRight = 0;
+	uint64_t start, elapsed, updates = 0;
+	int32_t x, y;
+	uint16_t heading;
+	uint8_t cell, good = 1;
+
+	SIM_Seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+	if(log == NULL) return 1;
+	entries = SIM_Record(log, entries);
+
+	// Replay the whole log over and over until the timing settles
+	start = SIM_Nanoseconds();
+	do
+	{
+		MAP_Init();
+		for(i = 0; i < entries; i++)
+		{
+			MAP_Odometry(log[i].Right, log[i].Left);
+			MAP_Update(log[i].Range);
+		}
+		updates += entries;
+		passes++;
+		elapsed = SIM_Nanoseconds() - start;
+	} while(elapsed < SIM_REPLAY_NS);
+
+	// Score every cell the robot has an opinion on
+	for(y = MAP_GRID_MIN; y <= MAP_GRID_MAX; y++)
+	{
+		for(x = MAP_GRID_MIN; x <= MAP_GRID_MAX; x++)
+		{
+			cell = MAP_GetCell(x, y);
+			if(cell >= MAP_OCCUPIED)
+			{
+				occupied++;
+				occupiedRight += SIM_Occupied(x, y);
+			}
+			else if(cell <= MAP_FREE)
+			{
+				clear++;
+				clearRight += !SIM_Occupied(x, y);
+			}
+		}
+	}
+
+	MAP_GetPose(&x, &y, &heading);
+	SIM_ExportLength = 0;
+	MAP_Export(SIM_Write);
+	if(argc > 3)
+	{
+		good = SIM_WritePGM(argv[3]);
+	}
+
+	printf("# log %u s, %u readings, %u passes\n", seconds, entries, passes);
+	printf("# update ns: mean %.1f, %.0f updates/s\n",
+			(double)elapsed / updates, updates * 1e9 / elapsed);
+	printf("# cells occupied %u (%.1f%% right), free %u (%.1f%% right)\n",
+			occupied, occupied ? 100.0 * occupiedRight / occupied : 0.0,
+			clear, clear ? 100.0 * clearRight / clear : 0.0);
+	printf("# final pose mm %.1f, %.1f heading %.1f deg, export %u bytes%s\n",
+			x / 1000.0, y / 1000.0, heading * 360.0 / 65536.0, SIM_ExportLength,
+			good ? "" : " BAD");
+
+	free(log);
+	return good ? 0 : 1;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,256 @@
+/*****************************************************************************
+ *   SimPlanner.c:  Host benchmark for the grid path planner
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -IProject/Include -DPLN_GRID_BITS=5 \
+ *          Simulator/Source/SimPlanner.c Project/Source/Planner.c \
+ *          -o planner_sim
+ *
+ *             PLN_GRID_BITS=4 gives the 16x16 grid, 5 the full 32x32.
+ *
+ *          -> ./planner_sim [maps] [seed] [density%]
+ *             Every map gets random obstacles and a random start and goal.
+ *             The robot follows the plan one leg at a time and before each
+ *             leg a new obstacle lands a few cells ahead on its path. The
+ *             repair is timed against planning again from scratch, and
+ *             every answer is checked against a breadth first search.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Planner.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_CELLS		(PLN_GRID_SIZE * PLN_GRID_SIZE)
+#define SIM_EVENTS		8		// Obstacles dropped per map
+#define SIM_AHEAD		3		// How far down the path they land
+
+typedef struct
+{
+	uint64_t Sum;
+	uint64_t Max;
+	uint64_t Expansions;
+	uint32_t Count;
+} SIM_Stat;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static uint32_t SIM_Seed;
+static int16_t SIM_Distance[SIM_CELLS];
+static uint8_t SIM_Map[SIM_CELLS];
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+static uint32_t SIM_Random (void)
+{
+	SIM_Seed = SIM_Seed * 1103515245UL + 12345UL;
+	return (SIM_Seed >> 8) & 0xFFFFFF;
+}
+
+static uint64_t SIM_Nanoseconds (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static int SIM_Index (int x, int y)
+{
+	return (y - PLN_GRID_MIN) * PLN_GRID_SIZE + (x - PLN_GRID_MIN);
+}
+
+static void SIM_Record (SIM_Stat *stat, uint64_t ns, uint32_t expansions)
+{
+	stat->Sum += ns;
+	if(ns > stat->Max) stat->Max = ns;
+	stat->Expansions += expansions;
+	stat->Count++;
+}
+
+/******************************************************************************
+ * Description:
+ *    Reference answer, breadth first from the goal over the harness copy
+ *    of the map. Leaves the distance to goal of every cell in SIM_Distance.
+ *****************************************************************************/
+static void SIM_Search (int gx, int gy)
+{
+	static const int stepX[4] = {0, 0, 1, -1};
+	static const int stepY[4] = {1, -1, 0, 0};
+	static int queue[SIM_CELLS];
+	int head = 0, tail = 0, cell, x, y, dir, nx, ny, next;
+
+	memset(SIM_Distance, 0xFF, sizeof(SIM_Distance));
+	cell = SIM_Index(gx, gy);
+	if(SIM_Map[cell]) return;
+	SIM_Distance[cell] = 0;
+	queue[tail++] = cell;
+
+	while(head < tail)
+	{
+		cell = queue[head++];
+		x = cell % PLN_GRID_SIZE + PLN_GRID_MIN;
+		y = cell / PLN_GRID_SIZE + PLN_GRID_MIN;
+		for(dir = 0; dir < 4; dir++)
+		{
+			nx = x + stepX[dir];
+			ny = y + stepY[dir];
+			if(nx < PLN_GRID_MIN || nx > PLN_GRID_MAX || ny < PLN_GRID_MIN || ny > PLN_GRID_MAX)
+			{
+				continue;
+			}
+			next = SIM_Index(nx, ny);
+			if(!SIM_Map[next] && SIM_Distance[next] < 0)
+			{
+				SIM_Distance[next] = SIM_Distance[cell] + 1;
+				queue[tail++] = next;
+			}
+		}
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Walk n steps down the reference shortest path from (x, y)
+ *****************************************************************************/
+static int SIM_Ahead (int x, int y, int n)
+{
+	static const int stepX[4] = {0, 0, 1, -1};
+	static const int stepY[4] = {1, -1, 0, 0};
+	int cell = SIM_Index(x, y), dir, nx = x, ny = y, next = cell;
+
+	while(n-- > 0 && SIM_Distance[cell] > 0)
+	{
+		for(dir = 0; dir < 4; dir++)
+		{
+			nx = x + stepX[dir];
+			ny = y + stepY[dir];
+			if(nx < PLN_GRID_MIN || nx > PLN_GRID_MAX || ny < PLN_GRID_MIN || ny > PLN_GRID_MAX)
+			{
+				continue;
+			}
+			next = SIM_Index(nx, ny);
+			if(SIM_Distance[next] == SIM_Distance[cell] - 1)
+			{
+				break;
+			}
+		}
+		x = nx;
+		y = ny;
+		cell = next;
+	}
+	return cell;
+}
+
+static void SIM_Print (const char *name, SIM_Stat *stat)
+{
+	printf("# %-8s us: mean %7.2f, max %7.2f, expansions mean %6.1f (%u)\n", name,
+			stat->Count ? stat->Sum / 1000.0 / stat->Count : 0.0, stat->Max / 1000.0,
+			stat->Count ? (double)stat->Expansions / stat->Count : 0.0, stat->Count);
+}
+
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+int main (int argc, char **argv)
+{
+	uint32_t maps = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+	uint32_t density = (argc > 3) ? strtoul(argv[3], NULL, 0) : 20;
+	SIM_Stat plan = {0}, replan = {0}, scratch = {0};
+	uint32_t map, event, expansions, repairs, wrong = 0;
+	uint64_t start, ns;
+	int sx, sy, gx, gy, wx, wy, cell, length, repaired, expect;
+
+	SIM_Seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+	printf("map,event,length,replan_us,scratch_us,replan_expansions,scratch_expansions\n");
+
+	for(map = 0; map < maps; map++)
+	{
+		PLN_Init();
+		for(cell = 0; cell < SIM_CELLS; cell++)
+		{
+			SIM_Map[cell] = (SIM_Random() % 100) < density;
+			PLN_SetBlocked(cell % PLN_GRID_SIZE + PLN_GRID_MIN, cell / PLN_GRID_SIZE + PLN_GRID_MIN, SIM_Map[cell]);
+		}
+		do
+		{
+			sx = (int)(SIM_Random() % PLN_GRID_SIZE) + PLN_GRID_MIN;
+			sy = (int)(SIM_Random() % PLN_GRID_SIZE) + PLN_GRID_MIN;
+			gx = (int)(SIM_Random() % PLN_GRID_SIZE) + PLN_GRID_MIN;
+			gy = (int)(SIM_Random() % PLN_GRID_SIZE) + PLN_GRID_MIN;
+			SIM_Search(gx, gy);
+		} while(SIM_Distance[SIM_Index(sx, sy)] < 8);
+
+		expansions = PLN_GetExpansions();
+		start = SIM_Nanoseconds();
+		length = PLN_Plan(sx, sy, gx, gy);
+		ns = SIM_Nanoseconds() - start;
+		SIM_Record(&plan, ns, PLN_GetExpansions() - expansions);
+		if(length != SIM_Distance[SIM_Index(sx, sy)]) wrong++;
+
+		for(event = 0; (event < SIM_EVENTS) && (sx != gx || sy != gy); event++)
+		{
+			// Drive the leg, then something turns up further along
+			if(PLN_NextWaypoint(&wx, &wy) != 1) break;
+			sx = wx;
+			sy = wy;
+			PLN_MoveStart(sx, sy);
+			cell = SIM_Ahead(sx, sy, SIM_AHEAD);
+			if(cell == SIM_Index(sx, sy) || cell == SIM_Index(gx, gy)) continue;
+			SIM_Map[cell] = 1;
+			SIM_Search(gx, gy);
+			expect = SIM_Distance[SIM_Index(sx, sy)];
+
+			expansions = PLN_GetExpansions();
+			start = SIM_Nanoseconds();
+			PLN_SetBlocked(cell % PLN_GRID_SIZE + PLN_GRID_MIN, cell / PLN_GRID_SIZE + PLN_GRID_MIN, 1);
+			repaired = PLN_Replan();
+			ns = SIM_Nanoseconds() - start;
+			repairs = PLN_GetExpansions() - expansions;
+			SIM_Record(&replan, ns, repairs);
+			if(repaired != expect) wrong++;
+			printf("%u,%u,%d,%.2f,", map, event, repaired, ns / 1000.0);
+
+			// Same question from scratch. Leaves the planner in the same
+			// state as the repair did.
+			expansions = PLN_GetExpansions();
+			start = SIM_Nanoseconds();
+			length = PLN_Plan(sx, sy, gx, gy);
+			ns = SIM_Nanoseconds() - start;
+			SIM_Record(&scratch, ns, PLN_GetExpansions() - expansions);
+			if(length != expect) wrong++;
+			printf("%.2f,%u,%u\n", ns / 1000.0, repairs, PLN_GetExpansions() - expansions);
+
+			if(repaired < 0) break;
+		}
+	}
+
+	printf("# grid %dx%d, density %u%%, maps %u\n", PLN_GRID_SIZE, PLN_GRID_SIZE, density, maps);
+	SIM_Print("plan", &plan);
+	SIM_Print("replan", &replan);
+	SIM_Print("scratch", &scratch);
+	printf("# wrong lengths %u\n", wrong);
+
+	return wrong ? 1 : 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
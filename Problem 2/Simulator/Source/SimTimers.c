@@ -0,0 +1,261 @@
+/*****************************************************************************
+ *   SimTimers.c:  Software timer cost against the number of active timers
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -DFREERTOS_POSIX_PORT -ISimulator/Include \
+ *          -ILibFreeRTOS/Include \
+ *          Simulator/Source/SimTimers.c \
+ *          Simulator/Source/FreeRTOS_PortPosix.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Tasks.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Queue.c \
+ *          LibFreeRTOS/Source/FreeRTOS_List.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Timers.c \
+ *          LibFreeRTOS/Source/FreeRTOS_Heap.c \
+ *          LibFreeRTOS/Source/FreeRTOS_TraceRecorder.c \
+ *          -lpthread -o timers_sim
+ *
+ *             and again with -DconfigUSE_TIMER_WHEEL=1 for the wheel.
+ *          -> ./timers_sim > timers.csv
+ *             One row per count of active timers, in nanoseconds of host
+ *             time. start and stop are a whole xTimerStart() or
+ *             xTimerStop() from a task below the timer task, so they
+ *             include the command going through the queue and two task
+ *             switches, which are the same whatever the count. The minimum
+ *             is the one to compare, the mean has the host in it too.
+ *          -> The timer being started has the longest period of all, so
+ *             it goes on the end of the sorted list, the worst case.
+ *          -> expiry is the timer task's run time per expiry while every
+ *             timer reloads on a period of SIM_MIN_PERIOD to
+ *             SIM_MIN_PERIOD + SIM_PERIOD_SPREAD ticks.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Timers.h"
+
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define SIM_MAX_TIMERS		1000
+#define SIM_RUNS			2000		// Starts and stops timed per count
+#define SIM_IDLE_PERIOD		30000		// Ticks, longer than a whole count's run
+#define SIM_TIMED_PERIOD	60000		// Behind every other timer
+#define SIM_MIN_PERIOD		10
+#define SIM_PERIOD_SPREAD	90
+#define SIM_EXPIRY_TICKS	1000		// How long the reloading timers run
+#define SIM_MAX_TASKS		8
+
+#if configGENERATE_RUN_TIME_STATS != 1
+	#error SimTimers.c needs configGENERATE_RUN_TIME_STATS for the timer task run time
+#endif
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static const uint16_t SIM_Counts[] = {10, 30, 100, 300, 1000};
+
+static xStaticTimerType SIM_TimerBuffers[SIM_MAX_TIMERS];
+static xTimerHandle SIM_Timers[SIM_MAX_TIMERS];
+static xStaticTimerType SIM_TimedBuffer;
+
+// Written by the timer task, read by the runner once they have stopped
+static volatile unsigned long SIM_Expiries;
+
+static xTaskStatusType SIM_Status[SIM_MAX_TASKS];
+static char SIM_Line[128];
+
+static xStaticTaskType SIM_IdleTaskBuffer, SIM_TimerTaskBuffer;
+static portSTACK_TYPE SIM_IdleTaskStack[configMINIMAL_STACK_SIZE];
+static portSTACK_TYPE SIM_TimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+static uint64_t SIM_Now (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// Called from a task, so stdout's lock is taken inside a critical section
+static void SIM_Print (void)
+{
+	taskENTER_CRITICAL();
+	fputs(SIM_Line, stdout);
+	fflush(stdout);
+	taskEXIT_CRITICAL();
+}
+
+static void SIM_Callback (xTimerHandle timer)
+{
+	(void)timer;
+	SIM_Expiries++;
+}
+
+// Microseconds the timer task has run for
+static unsigned long SIM_TimerTaskTime (void)
+{
+	unsigned portBASE_TYPE count, i;
+	unsigned long time = 0;
+
+	count = uxTaskGetSystemState(SIM_Status, SIM_MAX_TASKS, NULL);
+	for(i = 0; i < count; i++)
+	{
+		if(strcmp((const char *)SIM_Status[i].pcTaskName, "Tmr Svc") == 0)
+		{
+			time = SIM_Status[i].ulRunTimeCounter;
+		}
+	}
+
+	return time;
+}
+
+static void SIM_Measure (xTimerHandle timed, uint16_t count)
+{
+	uint64_t start, started, stopped;
+	uint64_t startMin = ~0ULL, startSum = 0, stopMin = ~0ULL, stopSum = 0;
+	unsigned long before, spent, expiries;
+	uint16_t i;
+
+	// Everything is active but nothing expires while the timed one is moved
+	for(i = 0; i < count; i++)
+	{
+		SIM_Timers[i] = xTimerCreateStatic((const signed char *)"Sim", SIM_IDLE_PERIOD + i, pdTRUE, NULL, SIM_Callback, &SIM_TimerBuffers[i]);
+		xTimerStart(SIM_Timers[i], portMAX_DELAY);
+	}
+
+	for(i = 0; i < SIM_RUNS; i++)
+	{
+		start = SIM_Now();
+		xTimerStart(timed, portMAX_DELAY);
+		started = SIM_Now();
+		xTimerStop(timed, portMAX_DELAY);
+		stopped = SIM_Now();
+
+		startSum += started - start;
+		stopSum += stopped - started;
+		if(started - start < startMin)
+		{
+			startMin = started - start;
+		}
+		if(stopped - started < stopMin)
+		{
+			stopMin = stopped - started;
+		}
+	}
+
+	// Then all of them reload, many times each
+	for(i = 0; i < count; i++)
+	{
+		xTimerChangePeriod(SIM_Timers[i], SIM_MIN_PERIOD + (i * 37) % SIM_PERIOD_SPREAD, portMAX_DELAY);
+	}
+	SIM_Expiries = 0;
+	before = SIM_TimerTaskTime();
+	vTaskDelay(SIM_EXPIRY_TICKS);
+
+	for(i = 0; i < count; i++)
+	{
+		xTimerStop(SIM_Timers[i], portMAX_DELAY);
+	}
+	spent = SIM_TimerTaskTime() - before;
+	expiries = SIM_Expiries;
+
+	for(i = 0; i < count; i++)
+	{
+		xTimerDelete(SIM_Timers[i], portMAX_DELAY);
+	}
+
+	sprintf(SIM_Line, "%u,%lu,%lu,%lu,%lu,%lu,%lu\n", count,
+			(unsigned long)startMin, (unsigned long)(startSum / SIM_RUNS),
+			(unsigned long)stopMin, (unsigned long)(stopSum / SIM_RUNS),
+			expiries, (expiries != 0) ? (unsigned long)((uint64_t)spent * 1000 / expiries) : 0UL);
+	SIM_Print();
+}
+
+static void SIM_TimersTask (void *pvParameters)
+{
+	xTimerHandle timed;
+	uint8_t i;
+
+	(void)pvParameters;
+
+	timed = xTimerCreateStatic((const signed char *)"Timed", SIM_TIMED_PERIOD, pdFALSE, NULL, SIM_Callback, &SIM_TimedBuffer);
+
+	sprintf(SIM_Line, "# timer wheel %s, ns of host time\n", (configUSE_TIMER_WHEEL == 1) ? "on" : "off");
+	SIM_Print();
+	sprintf(SIM_Line, "timers,start_min,start_mean,stop_min,stop_mean,expiries,expiry\n");
+	SIM_Print();
+
+	for(i = 0; i < sizeof(SIM_Counts) / sizeof(SIM_Counts[0]); i++)
+	{
+		SIM_Measure(timed, SIM_Counts[i]);
+	}
+
+	vTaskEndScheduler();
+}
+
+
+/******************************************************************************
+ * Kernel hooks
+ *****************************************************************************/
+void vApplicationGetIdleTaskMemory(xStaticTaskType **ppxIdleTaskTCBBuffer, portSTACK_TYPE **ppxIdleTaskStackBuffer, unsigned short *pusIdleTaskStackSize)
+{
+	*ppxIdleTaskTCBBuffer = &SIM_IdleTaskBuffer;
+	*ppxIdleTaskStackBuffer = SIM_IdleTaskStack;
+	*pusIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(xStaticTaskType **ppxTimerTaskTCBBuffer, portSTACK_TYPE **ppxTimerTaskStackBuffer, unsigned short *pusTimerTaskStackSize)
+{
+	*ppxTimerTaskTCBBuffer = &SIM_TimerTaskBuffer;
+	*ppxTimerTaskStackBuffer = SIM_TimerTaskStack;
+	*pusTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+void vApplicationStackOverflowHook(xTaskHandle pxTask, signed char *pcTaskName)
+{
+	(void)pxTask;
+	fprintf(stderr, "stack overflow in %s\n", (const char *)pcTaskName);
+	abort();
+}
+
+void vApplicationMallocFailedHook(void)
+{
+	fprintf(stderr, "pvPortMalloc() failed\n");
+	abort();
+}
+
+
+/******************************************************************************
+ * Main
+ *****************************************************************************/
+int main (void)
+{
+	xTaskCreate(SIM_TimersTask, (signed char *)"Timers", configMINIMAL_STACK_SIZE * 2, NULL, tskIDLE_PRIORITY + 1, NULL);
+
+	// Returns when SIM_TimersTask() ends the scheduler
+	vTaskStartScheduler();
+
+	return 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/
@@ -0,0 +1,626 @@
+/*****************************************************************************
+ *   TraceDecode.c:  Turns a scheduler trace into a Chrome/Perfetto timeline
+ *
+ *   Notes: -> Builds on the host from the "Problem 2" directory with
+ *
+ *      gcc -std=gnu99 -O2 -ILibFreeRTOS/Include -ILibCMSIS/Include \
+ *          -IProject/Include Simulator/Source/TraceDecode.c \
+ *          -o trace_decode
+ *
+ *          -> ./trace_decode capture [timeline.json]
+ *             The capture is either what vTraceDump() sent down the UART
+ *             (other output around the TRACE BEGIN/TRACE END lines is
+ *             skipped, the last dump is used) or xTraceImage saved from
+ *             the debugger as raw memory.
+ *          -> Open the JSON in ui.perfetto.dev or chrome://tracing. Each
+ *             task is a track of slices from switch in to switch out,
+ *             each interrupt and tickless sleep a track of their own.
+ *             Queue and semaphore operations are instants on the track
+ *             of whoever did them, queue fill levels are counters.
+ *          -> A summary of the run time each task got goes to stderr.
+ *
+ *   Copyright(C) 2015, Jeremy Dalton (jd0185@my.bristol.ac.uk)
+ *   All rights reserved.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// For the image layout and event codes, FreeRTOS_Config.h pulls in
+// FreeRTOS_TraceRecorder.h
+#include "FreeRTOS.h"
+
+/******************************************************************************
+ * Defines and typedefs
+ *****************************************************************************/
+#define TRC_HEADER_SIZE		28			// Bytes before xTaskNames
+#define TRC_OBJECTS			256			// Task, queue and IRQ numbers are a byte
+#define TRC_IRQS			35			// External interrupts on the LPC17xx
+#define TRC_TID_ISR			256			// Track of IRQ n is TRC_TID_ISR + n
+#define TRC_TID_SLEEP		512			// Tickless idle track
+#define TRC_TID_USER		513			// vTraceUserEvent() track
+#define TRC_TID_KERNEL		514			// Events with no known task or ISR
+#define TRC_ISR_NESTING		8			// Deepest interrupt nesting followed
+
+// Queue types from FreeRTOS_Queue.c
+#define TRC_TYPE_QUEUE				0
+#define TRC_TYPE_MUTEX				1
+#define TRC_TYPE_COUNTING_SEMAPHORE	2
+#define TRC_TYPE_BINARY_SEMAPHORE	3
+#define TRC_TYPE_RECURSIVE_MUTEX	4
+
+typedef struct
+{
+	uint32_t Magic;
+	uint16_t Version;
+	uint16_t RecordSize;
+	uint32_t TimerHz;
+	uint32_t Length;
+	uint32_t Head;
+	uint16_t MaxTaskNames;
+	uint16_t NameLength;
+	const uint8_t *Names;
+	uint32_t NameSize;			// Bytes per xTraceTaskNameType
+	const uint8_t *QueueTypes;
+	const uint8_t *Records;
+	uint32_t Available;			// Records actually in the capture
+} TRC_Image;
+
+typedef struct
+{
+	uint8_t Seen;
+	uint8_t Running;
+	uint16_t Priority;
+	uint64_t Start;				// When it was last switched in
+	uint64_t Total;				// Time spent running
+	uint32_t Switches;
+} TRC_Task;
+
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+static const char * const TRC_IrqNames[TRC_IRQS] =
+{
+	"WDT", "TIMER0", "TIMER1", "TIMER2", "TIMER3", "UART0", "UART1", "UART2",
+	"UART3", "PWM1", "I2C0", "I2C1", "I2C2", "SPI", "SSP0", "SSP1", "PLL0",
+	"RTC", "EINT0", "EINT1", "EINT2", "EINT3", "ADC", "BOD", "USB", "CAN",
+	"DMA", "I2S", "ENET", "RIT", "MCPWM", "QEI", "PLL1", "USBActivity",
+	"CANActivity"
+};
+
+static TRC_Task TRC_Tasks[TRC_OBJECTS];
+static uint8_t TRC_IrqSeen[TRC_OBJECTS];
+static uint8_t TRC_IrqOpen[TRC_OBJECTS];		// Enters without an exit yet
+static double TRC_MicrosecondsPerTick;
+static FILE *TRC_Out;
+static uint32_t TRC_Events;
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+static uint32_t TRC_Read32 (const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t TRC_Read16 (const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/******************************************************************************
+ * Description:
+ *    Read the whole of a file. Returns NULL if it can't be read.
+ *****************************************************************************/
+static uint8_t *TRC_Load (const char *path, size_t *size)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *data = NULL;
+	size_t used = 0, capacity = 0, got;
+
+	if (file == NULL)
+		return NULL;
+
+	do
+	{
+		if (used == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 65536;
+			data = realloc(data, capacity);
+			if (data == NULL)
+				break;
+		}
+		got = fread(data + used, 1, capacity - used, file);
+		used += got;
+	} while (got != 0);
+
+	fclose(file);
+	*size = used;
+	return data;
+}
+
+static int TRC_HexDigit (uint8_t c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	else if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	else if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/******************************************************************************
+ * Description:
+ *    Find the last TRACE BEGIN ... TRACE END dump in a capture and turn the
+ *    hex back into bytes, in place. A dump cut short by the end of the
+ *    capture is used as far as it goes. Returns the number of bytes, 0 if
+ *    there is no dump.
+ *****************************************************************************/
+static size_t TRC_Unhex (uint8_t *data, size_t size)
+{
+	static const char begin[] = "TRACE BEGIN";
+	static const char end[] = "TRACE END";
+	size_t start = size, i, out = 0;
+	int high = -1, digit;
+
+	for (i = 0; i + sizeof(begin) - 1 <= size; i++)
+	{
+		if (memcmp(data + i, begin, sizeof(begin) - 1) == 0)
+			start = i + sizeof(begin) - 1;
+	}
+	if (start == size)
+		return 0;
+
+	for (i = start; i < size; i++)
+	{
+		if (i + sizeof(end) - 1 <= size && memcmp(data + i, end, sizeof(end) - 1) == 0)
+			break;
+
+		digit = TRC_HexDigit(data[i]);
+		if (digit < 0)
+			continue;
+		if (high < 0)
+		{
+			high = digit;
+		}
+		else
+		{
+			data[out++] = (uint8_t)(high << 4 | digit);
+			high = -1;
+		}
+	}
+	return out;
+}
+
+/******************************************************************************
+ * Description:
+ *    Check the header and find the tables. Returns 0 if it isn't an image
+ *    this decoder understands.
+ *****************************************************************************/
+static int TRC_Parse (const uint8_t *data, size_t size, TRC_Image *image)
+{
+	uint32_t offset;
+
+	if (size < TRC_HEADER_SIZE)
+		return 0;
+
+	image->Magic = TRC_Read32(data);
+	image->Version = TRC_Read16(data + 4);
+	image->RecordSize = TRC_Read16(data + 6);
+	image->TimerHz = TRC_Read32(data + 8);
+	image->Length = TRC_Read32(data + 12);
+	image->Head = TRC_Read32(data + 16);
+	image->MaxTaskNames = TRC_Read16(data + 24);
+	image->NameLength = TRC_Read16(data + 26);
+
+	if (image->Magic != traceMAGIC || image->Version != traceVERSION
+			|| image->RecordSize != 8 || image->TimerHz == 0 || image->Length == 0)
+		return 0;
+
+	// The name array is padded to keep the next ulNumber aligned
+	image->NameSize = 4 + ((image->NameLength + 3u) & ~3u);
+	offset = TRC_HEADER_SIZE;
+	image->Names = data + offset;
+	offset += image->MaxTaskNames * image->NameSize;
+	image->QueueTypes = data + offset;
+	offset += TRC_OBJECTS;
+	offset = (offset + 3u) & ~3u;
+	if (offset > size)
+		return 0;
+	image->Records = data + offset;
+	image->Available = (uint32_t)((size - offset) / image->RecordSize);
+	return 1;
+}
+
+/******************************************************************************
+ * Description:
+ *    The name vTraceTaskCreate() kept for a task, or NULL if its slot has
+ *    been taken by a later task.
+ *****************************************************************************/
+static const char *TRC_TaskName (const TRC_Image *image, uint32_t task, char *name)
+{
+	const uint8_t *entry;
+
+	if (image->MaxTaskNames == 0)
+		return NULL;
+
+	entry = image->Names + (task % image->MaxTaskNames) * image->NameSize;
+	if (TRC_Read32(entry) != task || entry[4] == '\0')
+		return NULL;
+
+	memcpy(name, entry + 4, image->NameLength);
+	name[image->NameLength] = '\0';
+	return name;
+}
+
+/******************************************************************************
+ * Description:
+ *    Print a string as JSON, dropping anything that would need escaping
+ *****************************************************************************/
+static void TRC_String (const char *s)
+{
+	fputc('"', TRC_Out);
+	for (; *s != '\0'; s++)
+	{
+		if (*s >= ' ' && *s != '"' && *s != '\\')
+			fputc(*s, TRC_Out);
+	}
+	fputc('"', TRC_Out);
+}
+
+static void TRC_Begin (void)
+{
+	fputs(TRC_Events++ ? ",\n" : "", TRC_Out);
+}
+
+static void TRC_Metadata (uint32_t tid, const char *name, uint32_t sort)
+{
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", tid);
+	TRC_String(name);
+	fprintf(TRC_Out, "}}");
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%u}}", tid, sort);
+}
+
+static void TRC_Slice (uint32_t tid, const char *name, uint64_t start, uint64_t end, uint16_t priority)
+{
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+			tid, start * TRC_MicrosecondsPerTick, (end - start) * TRC_MicrosecondsPerTick);
+	TRC_String(name);
+	fprintf(TRC_Out, ",\"args\":{\"priority\":%u}}", priority);
+}
+
+static void TRC_Edge (uint32_t tid, const char *phase, const char *name, uint64_t time)
+{
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"name\":", phase, tid, time * TRC_MicrosecondsPerTick);
+	TRC_String(name);
+	fputc('}', TRC_Out);
+}
+
+static void TRC_Instant (uint32_t tid, const char *name, uint64_t time, const char *arg, uint32_t value)
+{
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"name\":", tid, time * TRC_MicrosecondsPerTick);
+	TRC_String(name);
+	fprintf(TRC_Out, ",\"args\":{\"%s\":%u}}", arg, value);
+}
+
+static void TRC_Counter (const char *name, uint64_t time, uint32_t value)
+{
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"name\":", time * TRC_MicrosecondsPerTick);
+	TRC_String(name);
+	fprintf(TRC_Out, ",\"args\":{\"items\":%u}}", value);
+}
+
+/******************************************************************************
+ * Description:
+ *    What a queue operation is called given the queue type, so semaphore
+ *    gives and takes read as such.
+ *****************************************************************************/
+static void TRC_QueueName (uint8_t type, uint8_t queue, int send, char *name, size_t size)
+{
+	if (type == TRC_TYPE_MUTEX || type == TRC_TYPE_RECURSIVE_MUTEX)
+		snprintf(name, size, "%s mutex %u", send ? "Give" : "Take", queue);
+	else if (type == TRC_TYPE_COUNTING_SEMAPHORE || type == TRC_TYPE_BINARY_SEMAPHORE)
+		snprintf(name, size, "%s semaphore %u", send ? "Give" : "Take", queue);
+	else
+		snprintf(name, size, "%s queue %u", send ? "Send" : "Receive", queue);
+}
+
+/******************************************************************************
+ * Description:
+ *    Convert every record in the ring, oldest first
+ *****************************************************************************/
+static void TRC_Decode (const TRC_Image *image)
+{
+	uint32_t count, first, i;
+	uint32_t last = 0;
+	uint64_t now = 0, begin = 0;
+	int running = -1;
+	uint8_t isr[TRC_ISR_NESTING];
+	uint32_t nesting = 0;
+	int sleeping = 0;
+	char name[96], task[48];
+
+	// Once the ring has wrapped the oldest record is the one at the head
+	count = image->Head < image->Length ? image->Head : image->Length;
+	first = image->Head > image->Length ? image->Head % image->Length : 0;
+	if (count > image->Available)
+	{
+		fprintf(stderr, "capture holds %u of %u records\n", image->Available, count);
+		count = image->Available;
+		first = 0;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		const uint8_t *record = image->Records + ((first + i) % image->Length) * image->RecordSize;
+		uint32_t time = TRC_Read32(record);
+		uint8_t event = record[4];
+		uint8_t object = record[5];
+		uint16_t parameter = TRC_Read16(record + 6);
+		uint32_t tid;
+
+		// The counter wraps every 71 minutes at 1MHz, the ring never spans that
+		if (i == 0)
+			begin = time;
+		else
+			now += (uint32_t)(time - last);
+		last = time;
+
+		// Whoever is running gets the instants
+		if (nesting != 0)
+			tid = TRC_TID_ISR + isr[nesting - 1];
+		else if (running >= 0)
+			tid = (uint32_t)running;
+		else
+			tid = TRC_TID_KERNEL;
+
+		if (event == traceEVENT_TASK_SWITCHED_IN)
+		{
+			TRC_Tasks[object].Seen = 1;
+			TRC_Tasks[object].Running = 1;
+			TRC_Tasks[object].Priority = parameter;
+			TRC_Tasks[object].Start = now;
+			TRC_Tasks[object].Switches++;
+			running = object;
+		}
+		else if (event == traceEVENT_TASK_SWITCHED_OUT)
+		{
+			// The task running when the ring starts was never switched in
+			if (!TRC_Tasks[object].Running)
+				TRC_Tasks[object].Start = 0;
+			TRC_Tasks[object].Seen = 1;
+			TRC_Tasks[object].Running = 0;
+			TRC_Tasks[object].Total += now - TRC_Tasks[object].Start;
+			TRC_Slice(object, "Running", TRC_Tasks[object].Start, now, TRC_Tasks[object].Priority);
+			running = -1;
+		}
+		else if (event == traceEVENT_TASK_CREATE)
+		{
+			TRC_Tasks[object].Seen = 1;
+			TRC_Tasks[object].Priority = parameter;
+			TRC_Instant(object, "Created", now, "priority", parameter);
+		}
+		else if (event == traceEVENT_TASK_DELETE)
+		{
+			TRC_Instant(object, "Deleted", now, "task", object);
+		}
+		else if (event == traceEVENT_TASK_DELAY || event == traceEVENT_TASK_DELAY_UNTIL)
+		{
+			TRC_Instant(object, event == traceEVENT_TASK_DELAY ? "Delay" : "Delay until", now, "ticks", parameter);
+		}
+		else if (event == traceEVENT_QUEUE_CREATE)
+		{
+			snprintf(name, sizeof(name), "Create %u", object);
+			TRC_Instant(tid, name, now, "type", parameter);
+		}
+		else if (event == traceEVENT_QUEUE_DELETE)
+		{
+			snprintf(name, sizeof(name), "Delete %u", object);
+			TRC_Instant(tid, name, now, "queue", object);
+		}
+		else if (event >= traceEVENT_QUEUE_SEND && event <= traceEVENT_QUEUE_BLOCK_RECEIVE)
+		{
+			uint8_t type = image->QueueTypes[object];
+			int send = (event == traceEVENT_QUEUE_SEND || event == traceEVENT_QUEUE_SEND_FAILED
+					|| event == traceEVENT_QUEUE_SEND_FROM_ISR || event == traceEVENT_QUEUE_SEND_FROM_ISR_FAILED
+					|| event == traceEVENT_QUEUE_BLOCK_SEND);
+			int failed = (event == traceEVENT_QUEUE_SEND_FAILED || event == traceEVENT_QUEUE_RECEIVE_FAILED
+					|| event == traceEVENT_QUEUE_SEND_FROM_ISR_FAILED || event == traceEVENT_QUEUE_RECEIVE_FROM_ISR_FAILED);
+			int block = (event == traceEVENT_QUEUE_BLOCK_SEND || event == traceEVENT_QUEUE_BLOCK_RECEIVE);
+
+			TRC_QueueName(type, object, send, task, sizeof(task));
+			if (block)
+			{
+				snprintf(name, sizeof(name), "Block: %s", task);
+				TRC_Instant(tid, name, now, "ticks", parameter);
+			}
+			else if (failed)
+			{
+				snprintf(name, sizeof(name), "%s failed", task);
+				TRC_Instant(tid, name, now, "items", parameter);
+			}
+			else if (event == traceEVENT_QUEUE_PEEK)
+			{
+				snprintf(name, sizeof(name), "Peek %u", object);
+				TRC_Instant(tid, name, now, "items", parameter);
+			}
+			else
+			{
+				// The parameter is the count before the item moved
+				uint32_t items = send ? parameter + 1u : (parameter ? parameter - 1u : 0u);
+
+				TRC_Instant(tid, task, now, "items", items);
+				snprintf(name, sizeof(name), "Queue %u", object);
+				TRC_Counter(name, now, items);
+			}
+		}
+		else if (event == traceEVENT_ISR_ENTER)
+		{
+			snprintf(name, sizeof(name), "%s", object < TRC_IRQS ? TRC_IrqNames[object] : "IRQ");
+			TRC_Edge(TRC_TID_ISR + object, "B", name, now);
+			TRC_IrqSeen[object] = 1;
+			TRC_IrqOpen[object]++;
+			if (nesting < TRC_ISR_NESTING)
+				isr[nesting++] = object;
+		}
+		else if (event == traceEVENT_ISR_EXIT)
+		{
+			// The enter may have been overwritten, an unmatched end upsets the viewers
+			if (TRC_IrqOpen[object] != 0)
+			{
+				snprintf(name, sizeof(name), "%s", object < TRC_IRQS ? TRC_IrqNames[object] : "IRQ");
+				TRC_Edge(TRC_TID_ISR + object, "E", name, now);
+				TRC_IrqOpen[object]--;
+				if (nesting != 0)
+					nesting--;
+			}
+		}
+		else if (event == traceEVENT_LOW_POWER_IDLE_BEGIN)
+		{
+			TRC_Edge(TRC_TID_SLEEP, "B", "Sleep", now);
+			sleeping = 1;
+		}
+		else if (event == traceEVENT_LOW_POWER_IDLE_END)
+		{
+			if (sleeping)
+				TRC_Edge(TRC_TID_SLEEP, "E", "Sleep", now);
+			sleeping = 0;
+		}
+		else if (event == traceEVENT_USER)
+		{
+			snprintf(name, sizeof(name), "User %u", object);
+			TRC_Instant(TRC_TID_USER, name, now, "value", parameter);
+		}
+		else
+		{
+			fprintf(stderr, "record %u: unknown event 0x%02x\n", i, event);
+		}
+	}
+
+	// Close whatever was running when the ring was saved
+	if (running >= 0)
+	{
+		TRC_Tasks[running].Total += now - TRC_Tasks[running].Start;
+		TRC_Slice((uint32_t)running, "Running", TRC_Tasks[running].Start, now, TRC_Tasks[running].Priority);
+	}
+
+	fprintf(stderr, "%u records, %.3f ms", count, now * TRC_MicrosecondsPerTick / 1000.0);
+	if (image->Head > image->Length)
+		fprintf(stderr, ", %u older records overwritten", image->Head - image->Length);
+	fprintf(stderr, ", starting at counter %u\n", (unsigned)begin);
+	fprintf(stderr, "task,name,priority,switches,run_us,share\n");
+	for (i = 0; i < TRC_OBJECTS; i++)
+	{
+		if (TRC_Tasks[i].Seen)
+		{
+			fprintf(stderr, "%u,%s,%u,%u,%.1f,%.1f%%\n", i,
+					TRC_TaskName(image, i, task) ? task : "?", TRC_Tasks[i].Priority,
+					TRC_Tasks[i].Switches, TRC_Tasks[i].Total * TRC_MicrosecondsPerTick,
+					now ? 100.0 * TRC_Tasks[i].Total / now : 0.0);
+		}
+	}
+}
+
+/******************************************************************************
+ * Description:
+ *    Name the tracks that turned up
+ *****************************************************************************/
+static void TRC_NameTracks (const TRC_Image *image)
+{
+	char name[96], task[48];
+	uint32_t i;
+
+	TRC_Begin();
+	fprintf(TRC_Out, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"LPC1769\"}}");
+
+	for (i = 0; i < TRC_OBJECTS; i++)
+	{
+		if (TRC_Tasks[i].Seen)
+		{
+			if (TRC_TaskName(image, i, task))
+				snprintf(name, sizeof(name), "%s (%u)", task, i);
+			else
+				snprintf(name, sizeof(name), "Task %u", i);
+			TRC_Metadata(i, name, 100 + i);
+		}
+	}
+	for (i = 0; i < TRC_OBJECTS; i++)
+	{
+		if (TRC_IrqSeen[i])
+		{
+			snprintf(name, sizeof(name), "IRQ %s", i < TRC_IRQS ? TRC_IrqNames[i] : "?");
+			TRC_Metadata(TRC_TID_ISR + i, name, i);
+		}
+	}
+	TRC_Metadata(TRC_TID_SLEEP, "Tickless idle", 90);
+	TRC_Metadata(TRC_TID_USER, "User events", 91);
+	TRC_Metadata(TRC_TID_KERNEL, "Kernel", 92);
+}
+
+int main (int argc, char **argv)
+{
+	uint8_t *data;
+	size_t size;
+	TRC_Image image;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s capture [timeline.json]\n", argv[0]);
+		return 2;
+	}
+
+	data = TRC_Load(argv[1], &size);
+	if (data == NULL)
+	{
+		fprintf(stderr, "can't read %s\n", argv[1]);
+		return 1;
+	}
+
+	// Raw memory starts with the magic, anything else should be a dump
+	if (size < 4 || TRC_Read32(data) != traceMAGIC)
+		size = TRC_Unhex(data, size);
+
+	if (!TRC_Parse(data, size, &image))
+	{
+		fprintf(stderr, "no version %u trace image in %s\n", traceVERSION, argv[1]);
+		free(data);
+		return 1;
+	}
+
+	TRC_Out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+	if (TRC_Out == NULL)
+	{
+		fprintf(stderr, "can't write %s\n", argv[2]);
+		free(data);
+		return 1;
+	}
+
+	TRC_MicrosecondsPerTick = 1000000.0 / image.TimerHz;
+	fprintf(TRC_Out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	TRC_Decode(&image);
+	TRC_NameTracks(&image);
+	fprintf(TRC_Out, "\n]}\n");
+
+	if (TRC_Out != stdout)
+		fclose(TRC_Out);
+	free(data);
+	return 0;
+}
+/****************************************************************************
+**                            End Of File
+*****************************************************************************/